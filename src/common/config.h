@@ -31,11 +31,46 @@ static constexpr int INVALID_TXN_ID = -1;                                     //
 static constexpr int INVALID_TIMESTAMP = -1;                                  // invalid transaction timestamp
 static constexpr int INVALID_LSN = -1;                                        // invalid log sequence number
 static constexpr int HEADER_PAGE_ID = 0;                                      // the header page id
-static constexpr int PAGE_SIZE = 4096;                                        // size of a data page in byte  4KB
-static constexpr int BUFFER_POOL_SIZE = 65536;                                // size of buffer pool 256MB
+static constexpr int PAGE_SIZE = 4096;                                        // default size of a data page in byte  4KB
+static constexpr int MIN_PAGE_SIZE = 4096;                                    // smallest page size a database may choose, also the O_DIRECT alignment
+static constexpr int MAX_PAGE_SIZE = 65536;                                   // largest page size a database may choose 64KB
+static constexpr int BUFFER_POOL_SIZE = 65536;                                // default frames in buffer pool 256MB, can be set with -b
 // static constexpr int BUFFER_POOL_SIZE = 262144;                                // size of buffer pool 1GB
+static constexpr int BUFFER_POOL_INSTANCES = 16;                              // number of independently latched buffer pool instances
+static constexpr size_t BULK_READ_RING_SIZE = 64;                              // frames in a sequential scan's private ring 256KB
+static constexpr size_t FLUSH_BATCH_SIZE = 64;                                // pages pinned at once while flushing a file
+static constexpr int PREFETCH_DEPTH = 8;                                      // pages read ahead of a sequential scan
+static constexpr size_t PREFETCH_WORKERS = 4;                                 // background read-ahead threads
+static constexpr size_t PREFETCH_QUEUE_SIZE = 1024;                           // pending read-ahead requests before dropping
+static constexpr int PREFETCH_MAX_RUN = 32;                                   // contiguous pages loaded by one read-ahead I/O
+static constexpr int FLUSHER_INTERVAL_MS = 100;                               // background dirty-page writer sleep between rounds
+static constexpr size_t FLUSHER_MAX_PAGES = 256;                              // dirty pages written back per round
+static constexpr double FLUSHER_LOW_WATERMARK = 0.1;                          // dirty ratio below which the writer stays idle
+static constexpr double FLUSHER_HIGH_WATERMARK = 0.5;                         // dirty ratio above which the writer skips sleeping
+static constexpr bool USE_IO_URING = true;                                    // submit batched disk I/O through io_uring when supported
+static constexpr unsigned IO_URING_QUEUE_DEPTH = 64;                          // in-flight requests per io_uring
+static constexpr size_t IO_URING_MAX_QUEUES = 16;                             // io_urings shared by concurrent batches
+static constexpr bool USE_DIRECT_IO = false;                                  // open table and index files with O_DIRECT, can be set with -d
+static constexpr bool USE_HUGE_PAGES = true;                                  // back the buffer pool frame arena with huge pages when possible
+static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;                     // size of a huge page in byte 2MB
+static constexpr size_t BUFFER_STATS_SHARDS = 16;                             // stripes of buffer pool counters, each thread sticks to one
+static constexpr size_t BUFFER_STATS_MAX_FILES = 64;                          // files counted separately per stripe, the rest are lumped together
+static constexpr int BUFFER_STATS_HISTOGRAM_BUCKETS = 32;                     // log2(ns) latency buckets, the last one holds everything above 1s
+static constexpr int BUFFER_STATS_DUMP_INTERVAL_S = 0;                        // seconds between buffer stats dumps, 0 disables, can be set with -s
+static constexpr bool USE_WARM_UP = true;                                     // reload the pages listed in the buffer pool snapshot at startup
+static constexpr size_t WARM_UP_THREADS = 4;                                  // threads loading snapshot pages in parallel
+static constexpr int BUFFER_SNAPSHOT_INTERVAL_S = 60;                         // seconds between buffer pool snapshots, 0 saves only at shutdown
+static constexpr size_t IX_SORT_BUFFER_SIZE = 64 * 1024 * 1024;               // memory for sorting (key, rid) pairs in CREATE INDEX 64MB
+static constexpr size_t IX_SORT_MERGE_FANIN = 64;                             // sorted runs merged in one pass when building an index
+static constexpr double IX_BULK_LOAD_FILL_FACTOR = 0.9;                       // fraction of each B+ tree node filled by CREATE INDEX, 0.5 to 1
+static constexpr int IX_SEPARATOR_INIT_LEN = 16;                              // bytes of a string key kept in B+ tree internal nodes, grown on demand
+static constexpr bool USE_SIMD_KEY_SEARCH = true;                             // search single INT/FLOAT column index nodes with SSE2/AVX2
+static constexpr int IX_SIMD_SEARCH_WINDOW = 64;                              // keys compared with SIMD after binary search narrows the range
+static constexpr size_t BATCH_SIZE = 1024;                                    // tuples passed between executors by one NextBatch call
+static constexpr size_t HASH_JOIN_MEMORY = 64 * 1024 * 1024;                  // memory for a hash join's build side before it spills to disk 64MB
+static constexpr size_t HASH_JOIN_PARTITIONS = 32;                            // partitions each input of a spilling hash join is split into
+static constexpr size_t NESTED_LOOP_BLOCK_MEMORY = 4 * 1024 * 1024;           // outer tuples a nested loop join buffers per scan of its inner side 4MB
 static constexpr int LOG_BUFFER_SIZE = (1024 * PAGE_SIZE);                    // size of a log buffer in byte
-static constexpr int BUCKET_SIZE = 50;                                        // size of extendible hash bucket
 
 using frame_id_t = int32_t;  // frame id type, 帧页ID, 页在BufferPool中的存储单元称为帧,一帧对应一页
 using page_id_t = int32_t;   // page id type , 页ID
@@ -48,7 +83,13 @@ using timestamp_t = int32_t;  // timestamp type, used for transaction concurrenc
 // log file
 static const std::string LOG_FILE_NAME = "db.log";
 
-// replacer
+// buffer pool statistics dumped periodically into the database directory
+static const std::string BUFFER_STATS_FILE_NAME = "buffer_stats.log";
+// resident pages of the buffer pool, saved at shutdown and reloaded at startup
+static const std::string BUFFER_SNAPSHOT_FILE_NAME = "buffer_pool.snapshot";
+
+// replacer, 可选"LRU", "CLOCK", "LRU-K", 可以通过rmdb的启动参数-r修改
 static const std::string REPLACER_TYPE = "LRU";
+static constexpr size_t LRUK_REPLACER_K = 2;
 
 static const std::string DB_META_NAME = "db.meta";
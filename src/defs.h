@@ -52,6 +52,19 @@ inline std::string coltype2str(ColType type) {
     return m.at(type);
 }
 
+// 索引的存储结构
+enum IndexType {
+    INDEX_BTREE, INDEX_HASH
+};
+
+inline std::string indextype2str(IndexType type) {
+    std::map<IndexType, std::string> m = {
+            {INDEX_BTREE, "BTREE"},
+            {INDEX_HASH,  "HASH"}
+    };
+    return m.at(type);
+}
+
 class RecScan {
 public:
     virtual ~RecScan() = default;
@@ -15,35 +15,82 @@ See the Mulan PSL v2 for more details. */
 #include "index/ix.h"
 #include "system/sm.h"
 
+/**
+ * 排序：beginTuple()时按批读入儿子节点的全部元组，对元组的下标排序后按顺序输出
+ */
 class SortExecutor : public AbstractExecutor {
    private:
     std::unique_ptr<AbstractExecutor> prev_;
     ColMeta cols_;                              // 框架中只支持一个键排序，需要自行修改数据结构支持多个键排序
     size_t tuple_num;
     bool is_desc_;
-    std::vector<size_t> used_tuple;
-    std::unique_ptr<RmRecord> current_tuple;
+    std::vector<size_t> used_tuple;             // 排序后的元组下标
+    size_t len_;                                // 元组的长度
+    std::vector<char> tuples_;                  // 儿子节点的全部元组，第i条从i * len_开始
+    std::vector<Rid> rids_;
+    size_t pos_ = 0;                            // 当前元组在used_tuple中的位置
 
    public:
     SortExecutor(std::unique_ptr<AbstractExecutor> prev, TabCol sel_cols, bool is_desc) {
         prev_ = std::move(prev);
-        cols_ = prev_->get_col_offset(sel_cols);
+        cols_ = *get_col(prev_->cols(), sel_cols);
         is_desc_ = is_desc;
         tuple_num = 0;
         used_tuple.clear();
+        len_ = prev_->tupleLen();
     }
 
     void beginTuple() override { 
-        
+        tuples_.clear();
+        rids_.clear();
+        TupleBatch batch;
+        for (prev_->beginTuple(); prev_->NextBatch(&batch);) {
+            const char *data = batch.get(0);
+            tuples_.insert(tuples_.end(), data, data + batch.size() * len_);
+            for (size_t i = 0; i < batch.size(); i++) {
+                rids_.push_back(batch.rid(i));
+            }
+        }
+        tuple_num = rids_.size();
+        used_tuple.resize(tuple_num);
+        for (size_t i = 0; i < tuple_num; i++) {
+            used_tuple[i] = i;
+        }
+        std::stable_sort(used_tuple.begin(), used_tuple.end(), [&](size_t a, size_t b) {
+            int cmp = ix_compare(key(a), key(b), cols_.type, cols_.len);
+            return is_desc_ ? cmp > 0 : cmp < 0;
+        });
+        pos_ = 0;
     }
 
     void nextTuple() override {
-        
+        pos_++;
     }
 
+    bool is_end() const override { return pos_ >= tuple_num; }
+
     std::unique_ptr<RmRecord> Next() override {
-        return nullptr;
+        return std::make_unique<RmRecord>(len_, tuple(used_tuple[pos_]));
+    }
+
+    bool NextBatch(TupleBatch *batch) override {
+        batch->reset(len_);
+        for (; pos_ < tuple_num && !batch->full(); pos_++) {
+            batch->append(tuple(used_tuple[pos_]), rids_[used_tuple[pos_]]);
+        }
+        return !batch->empty();
     }
 
-    Rid &rid() override { return _abstract_rid; }
+    size_t tupleLen() const override { return len_; }
+
+    const std::vector<ColMeta> &cols() const override { return prev_->cols(); }
+
+    std::string getType() override { return "SortExecutor"; }
+
+    Rid &rid() override { return rids_[used_tuple[pos_]]; }
+
+   private:
+    char *tuple(size_t idx) { return tuples_.data() + idx * len_; }
+
+    const char *key(size_t idx) const { return tuples_.data() + idx * len_ + cols_.offset; }
 };
\ No newline at end of file
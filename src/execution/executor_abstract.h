@@ -11,10 +11,21 @@ See the Mulan PSL v2 for more details. */
 #pragma once
 
 #include "execution_defs.h"
+#include "tuple_batch.h"
 #include "common/common.h"
 #include "index/ix.h"
 #include "system/sm.h"
 
+// 按记录的字段布局绑定好的条件，求值时不再按字段名查找字段
+struct BoundCond {
+    int lhs_offset;             // 左侧字段在记录中的偏移量
+    ColType type;
+    int len;
+    CompOp op;
+    const char *rhs_val;        // 右侧为常量时指向常量的数据，否则为nullptr
+    int rhs_offset;             // 右侧为字段时该字段在记录中的偏移量
+};
+
 class AbstractExecutor {
    public:
     Rid _abstract_rid;
@@ -42,6 +53,21 @@ class AbstractExecutor {
 
     virtual std::unique_ptr<RmRecord> Next() = 0;
 
+    /**
+     * @brief 从当前位置起取出最多batch->capacity()条元组放入batch，覆盖batch原有的内容。
+     * 先调用beginTuple()，之后反复调用直到返回false；开始按批读取后不再混用Next()。
+     * 默认实现逐条调用Next()和nextTuple()，供还没有批量实现的算子使用
+     * @return 没有剩余的元组时返回false，否则batch中至少有一条元组
+     */
+    virtual bool NextBatch(TupleBatch *batch) {
+        batch->reset(tupleLen());
+        for (; !is_end() && !batch->full(); nextTuple()) {
+            auto rec = Next();
+            batch->append(rec->data, rid());
+        }
+        return !batch->empty();
+    }
+
     virtual ColMeta get_col_offset(const TabCol &target) { return ColMeta();};
 
     std::vector<ColMeta>::const_iterator get_col(const std::vector<ColMeta> &rec_cols, const TabCol &target) {
@@ -53,4 +79,163 @@ class AbstractExecutor {
         }
         return pos;
     }
-};
\ No newline at end of file
+
+    /**
+     * @brief 判断记录rec是否满足条件cond，条件右侧为列时也从rec中取值
+     */
+    bool eval_cond(const std::vector<ColMeta> &rec_cols, const Condition &cond, const RmRecord *rec) {
+        auto lhs_col = get_col(rec_cols, cond.lhs_col);
+        char *lhs = rec->data + lhs_col->offset;
+        char *rhs;
+        if (cond.is_rhs_val) {
+            rhs = cond.rhs_val.raw->data;
+        } else {
+            rhs = rec->data + get_col(rec_cols, cond.rhs_col)->offset;
+        }
+        return compare_op(ix_compare(lhs, rhs, lhs_col->type, lhs_col->len), cond.op);
+    }
+
+    /**
+     * @brief 判断记录rec是否满足所有条件
+     */
+    bool eval_conds(const std::vector<ColMeta> &rec_cols, const std::vector<Condition> &conds, const RmRecord *rec) {
+        return std::all_of(conds.begin(), conds.end(),
+                           [&](const Condition &cond) { return eval_cond(rec_cols, cond, rec); });
+    }
+
+    /**
+     * @brief 把条件绑定到rec_cols描述的记录布局上。绑定的条件引用conds中常量的数据，conds需要比结果存活得更久
+     */
+    std::vector<BoundCond> bind_conds(const std::vector<ColMeta> &rec_cols, const std::vector<Condition> &conds) {
+        std::vector<BoundCond> bound;
+        for (auto &cond : conds) {
+            auto lhs_col = get_col(rec_cols, cond.lhs_col);
+            BoundCond bc = {.lhs_offset = lhs_col->offset, .type = lhs_col->type, .len = lhs_col->len,
+                            .op = cond.op, .rhs_val = nullptr, .rhs_offset = 0};
+            if (cond.is_rhs_val) {
+                bc.rhs_val = cond.rhs_val.raw->data;
+            } else {
+                bc.rhs_offset = get_col(rec_cols, cond.rhs_col)->offset;
+            }
+            bound.push_back(bc);
+        }
+        return bound;
+    }
+
+    /**
+     * @brief 判断data指向的记录是否满足所有绑定好的条件
+     */
+    static bool eval_bound_conds(const std::vector<BoundCond> &conds, const char *data) {
+        for (auto &cond : conds) {
+            const char *rhs = cond.rhs_val != nullptr ? cond.rhs_val : data + cond.rhs_offset;
+            if (!compare_op(ix_compare(data + cond.lhs_offset, rhs, cond.type, cond.len), cond.op)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief 从记录rec中依次取出索引index的各个字段，拼接成索引的key
+     */
+    static void make_index_key(const IndexMeta &index, const char *rec, char *key) {
+        int offset = 0;
+        for (auto &col : index.cols) {
+            memcpy(key + offset, rec + col.offset, col.len);
+            offset += col.len;
+        }
+    }
+
+    /**
+     * @brief 在表tab_name的索引index上查找key，索引中的key唯一
+     * @return 找到时返回true，并把key对应的记录位置写入rid
+     */
+    static bool lookup_index_key(SmManager *sm_manager, const std::string &tab_name, const IndexMeta &index,
+                                 const char *key, Rid *rid, Transaction *txn) {
+        std::string ix_name = sm_manager->get_ix_manager()->get_index_name(tab_name, index.cols);
+        std::vector<Rid> result;
+        if (index.type == INDEX_HASH) {
+            sm_manager->hash_ihs_.at(ix_name)->get_value(key, &result, txn);
+        } else {
+            sm_manager->ihs_.at(ix_name)->get_value(key, &result, txn);
+        }
+        if (result.empty()) {
+            return false;
+        }
+        *rid = result.front();
+        return true;
+    }
+
+    static bool compare_op(int cmp, CompOp op) {
+        switch (op) {
+            case OP_EQ: return cmp == 0;
+            case OP_NE: return cmp != 0;
+            case OP_LT: return cmp < 0;
+            case OP_GT: return cmp > 0;
+            case OP_LE: return cmp <= 0;
+            case OP_GE: return cmp >= 0;
+            default: throw InternalError("Unexpected op type");
+        }
+    }
+};
+/**
+ * 以批为单位产生元组的算子的基类。子类实现begin_batches()和produce_batch()，
+ * 逐条读取的接口由内部缓存的一批元组提供，Next()从这批元组中复制一条
+ */
+class BatchExecutor : public AbstractExecutor {
+   private:
+    TupleBatch buffer_;         // 逐条读取时缓存的一批元组
+    size_t pos_ = 0;            // 当前元组在buffer_中的位置
+
+   protected:
+    // 重新开始产生元组
+    virtual void begin_batches() = 0;
+
+    // 产生下一批元组，和NextBatch一样，返回false表示没有剩余的元组
+    virtual bool produce_batch(TupleBatch *batch) = 0;
+
+   public:
+    void beginTuple() override {
+        begin_batches();
+        pos_ = 0;
+        if (!produce_batch(&buffer_)) {
+            buffer_.clear();
+        }
+    }
+
+    void nextTuple() override {
+        if (++pos_ >= buffer_.size()) {
+            pos_ = 0;
+            if (!produce_batch(&buffer_)) {
+                buffer_.clear();
+            }
+        }
+    }
+
+    bool is_end() const override { return pos_ >= buffer_.size(); }
+
+    std::unique_ptr<RmRecord> Next() override { return buffer_.to_record(pos_); }
+
+    Rid &rid() override { return buffer_.rid(pos_); }
+
+    bool NextBatch(TupleBatch *batch) override {
+        if (pos_ >= buffer_.size()) {
+            return produce_batch(batch);
+        }
+        // 先交出beginTuple()已经产生、还没有读取的元组，整批未读时直接交换缓冲区
+        if (pos_ == 0 && batch->capacity() == buffer_.capacity()) {
+            std::swap(*batch, buffer_);
+        } else {
+            batch->reset(buffer_.tuple_len());
+            for (; pos_ < buffer_.size() && !batch->full(); pos_++) {
+                batch->append(buffer_.get(pos_), buffer_.rid(pos_));
+            }
+            if (pos_ < buffer_.size()) {
+                return true;
+            }
+        }
+        buffer_.clear();
+        pos_ = 0;
+        return true;
+    }
+};
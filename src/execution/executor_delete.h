@@ -36,7 +36,32 @@ class DeleteExecutor : public AbstractExecutor {
         context_ = context;
     }
 
+    /**
+     * @brief 删除rids_中的记录：先从表上的每个索引删除记录的key，再删除记录。
+     * 只删除指向这条记录的索引项，key对应的是别的记录时保留
+     */
     std::unique_ptr<RmRecord> Next() override {
+        std::vector<char> rec(fh_->get_file_hdr().record_size);
+        std::vector<char> key;
+        for (auto &rid : rids_) {
+            fh_->get_record(rid, rec.data(), context_);
+            for (auto &index : tab_.indexes) {
+                key.resize(index.col_tot_len);
+                make_index_key(index, rec.data(), key.data());
+                Rid owner;
+                if (!lookup_index_key(sm_manager_, tab_name_, index, key.data(), &owner, context_->txn_) ||
+                    owner != rid) {
+                    continue;
+                }
+                std::string ix_name = sm_manager_->get_ix_manager()->get_index_name(tab_name_, index.cols);
+                if (index.type == INDEX_HASH) {
+                    sm_manager_->hash_ihs_.at(ix_name)->delete_entry(key.data(), context_->txn_);
+                } else {
+                    sm_manager_->ihs_.at(ix_name)->delete_entry(key.data(), context_->txn_);
+                }
+            }
+            fh_->delete_record(rid, context_);
+        }
         return nullptr;
     }
 
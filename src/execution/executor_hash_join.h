@@ -0,0 +1,473 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+
+#include "execution_defs.h"
+#include "execution_manager.h"
+#include "executor_abstract.h"
+#include "index/ix.h"
+#include "system/sm.h"
+
+/**
+ * 哈希连接，用于两侧字段之间有等值条件的连接。
+ * beginTuple()时两侧交替按批读入内存，每次读入已读数据较少的一侧：一侧先读完时它就是较小的输入，
+ * 在它上面建哈希表，另一侧先探测已经读入的元组，再继续按批读取并探测。
+ * 两侧读入的数据超出内存预算时改为grace hash join：两侧都按哈希值划分成HASH_JOIN_PARTITIONS个分区写到磁盘，
+ * 再逐对处理编号相同的分区，在较小的一侧上建哈希表；较小的一侧仍然超出预算时换一个哈希种子继续划分
+ */
+class HashJoinExecutor : public BatchExecutor {
+   private:
+    static constexpr uint32_t NO_ENTRY = UINT32_MAX;
+    static constexpr int MAX_LEVEL = 3;         // 分区最多递归划分的层数，之后即使超出预算也直接建哈希表
+
+    // 一对编号相同的分区文件，下标0为左侧，1为右侧
+    struct Partition {
+        std::string paths[2];
+        size_t rows[2];
+        int level;                              // 计算分区内元组的哈希值使用的种子
+    };
+
+    // 把一侧的元组按哈希值写到HASH_JOIN_PARTITIONS个分区文件
+    struct PartitionWriter {
+        std::vector<std::ofstream> files;
+        std::vector<std::string> paths;
+        std::vector<size_t> rows;
+    };
+
+    enum ProbeSource { PROBE_NONE, PROBE_MEMORY, PROBE_CHILD, PROBE_FILE };
+
+    std::unique_ptr<AbstractExecutor> left_;    // 左儿子节点
+    std::unique_ptr<AbstractExecutor> right_;   // 右儿子节点
+    size_t len_;                                // join后获得的每条记录的长度
+    std::vector<ColMeta> cols_;                 // join后获得的记录的字段
+    size_t tuple_lens_[2];                      // 左右两侧元组的长度
+
+    std::vector<Condition> fed_conds_;          // join条件
+    std::vector<ColMeta> key_cols_[2];          // 等值条件两侧的字段，偏移量为字段在各自元组中的位置
+    std::vector<Condition> other_conds_;        // 等值连接条件以外的条件
+    std::vector<BoundCond> bound_conds_;        // 绑定到join后记录布局上的other_conds_
+    size_t memory_budget_;
+
+    // 构建侧
+    int build_side_ = 0;
+    int level_ = 0;                             // 当前哈希表使用的种子
+    std::vector<char> build_rows_;
+    std::vector<uint64_t> hashes_;              // 构建侧每条元组的哈希值
+    std::vector<uint32_t> next_;                // 同一个桶中的下一条元组
+    std::vector<uint32_t> heads_;               // 每个桶的第一条元组，桶数为2的幂
+
+    // 探测侧
+    ProbeSource probe_source_ = PROBE_NONE;
+    std::vector<char> probe_rows_;              // 建表之前已经读入内存的探测侧元组
+    size_t probe_mem_pos_ = 0;
+    std::ifstream probe_file_;
+    std::string probe_path_;
+    size_t probe_file_rows_ = 0;                // 探测侧分区文件中还没有读取的元组数
+    TupleBatch probe_batch_;
+    size_t probe_next_ = 0;                     // probe_batch_中下一条要探测的元组
+    const char *probe_row_ = nullptr;           // 正在探测的元组
+    uint64_t probe_hash_ = 0;
+    uint32_t chain_ = NO_ENTRY;                 // 正在探测的元组在桶中下一个要比较的构建侧元组
+
+    std::vector<Partition> pending_;            // 还没有处理的分区
+    std::string spill_prefix_;
+    size_t num_spill_files_ = 0;
+    std::vector<std::string> spill_files_;      // 创建过且还没有删除的分区文件
+
+    inline static std::atomic<uint64_t> next_spill_id_{0};
+
+   public:
+    HashJoinExecutor(std::unique_ptr<AbstractExecutor> left, std::unique_ptr<AbstractExecutor> right,
+                     std::vector<Condition> conds, size_t memory_budget = HASH_JOIN_MEMORY) {
+        left_ = std::move(left);
+        right_ = std::move(right);
+        tuple_lens_[0] = left_->tupleLen();
+        tuple_lens_[1] = right_->tupleLen();
+        len_ = tuple_lens_[0] + tuple_lens_[1];
+        cols_ = left_->cols();
+        auto right_cols = right_->cols();
+        for (auto &col : right_cols) {
+            col.offset += tuple_lens_[0];
+        }
+        cols_.insert(cols_.end(), right_cols.begin(), right_cols.end());
+        fed_conds_ = std::move(conds);
+        memory_budget_ = memory_budget;
+        spill_prefix_ = "hash_join" + std::to_string(next_spill_id_++);
+
+        for (auto &cond : fed_conds_) {
+            const ColMeta *left_col = nullptr, *right_col = nullptr;
+            if (!cond.is_rhs_val && cond.op == OP_EQ) {
+                left_col = find_col(left_->cols(), cond.lhs_col);
+                right_col = find_col(right_->cols(), cond.rhs_col);
+                if (left_col == nullptr || right_col == nullptr) {
+                    left_col = find_col(left_->cols(), cond.rhs_col);
+                    right_col = find_col(right_->cols(), cond.lhs_col);
+                }
+            }
+            if (left_col != nullptr && right_col != nullptr && left_col->type == right_col->type &&
+                left_col->len == right_col->len) {
+                key_cols_[0].push_back(*left_col);
+                key_cols_[1].push_back(*right_col);
+            } else {
+                other_conds_.push_back(cond);
+            }
+        }
+        if (key_cols_[0].empty()) {
+            throw InternalError("Hash join requires an equality condition between its inputs");
+        }
+        bound_conds_ = bind_conds(cols_, other_conds_);
+    }
+
+    ~HashJoinExecutor() override { remove_spill_files(); }
+
+    size_t tupleLen() const override { return len_; }
+
+    const std::vector<ColMeta> &cols() const override { return cols_; }
+
+    std::string getType() override { return "HashJoinExecutor"; }
+
+    // 创建过的分区文件数，没有写出分区时为0
+    size_t num_spill_files() const { return num_spill_files_; }
+
+   protected:
+    void begin_batches() override {
+        remove_spill_files();
+        pending_.clear();
+        probe_source_ = PROBE_NONE;
+        probe_batch_.clear();
+        probe_next_ = 0;
+        chain_ = NO_ENTRY;
+
+        left_->beginTuple();
+        right_->beginTuple();
+        std::vector<char> rows[2];
+        TupleBatch batch;
+        while (true) {
+            int side = rows[0].size() <= rows[1].size() ? 0 : 1;
+            if (!child(side)->NextBatch(&batch)) {
+                // side先读完，在它上面建哈希表
+                build_side_ = side;
+                level_ = 0;
+                build_rows_ = std::move(rows[side]);
+                probe_rows_ = std::move(rows[1 - side]);
+                probe_mem_pos_ = 0;
+                build_table();
+                probe_source_ = PROBE_MEMORY;
+                return;
+            }
+            rows[side].insert(rows[side].end(), batch.get(0), batch.get(0) + batch.size() * tuple_lens_[side]);
+            if (table_memory(rows[0].size() / tuple_lens_[0], 0) + table_memory(rows[1].size() / tuple_lens_[1], 1) >
+                memory_budget_) {
+                break;
+            }
+        }
+
+        // 超出内存预算，两侧都划分到磁盘
+        PartitionWriter writers[2];
+        for (int side = 0; side < 2; side++) {
+            open_partitions(&writers[side]);
+            write_partitioned(&writers[side], side, rows[side].data(), rows[side].size() / tuple_lens_[side], 0);
+            std::vector<char>().swap(rows[side]);
+            while (child(side)->NextBatch(&batch)) {
+                write_partitioned(&writers[side], side, batch.get(0), batch.size(), 0);
+            }
+        }
+        add_partitions(writers, 1);
+        next_partition();
+    }
+
+    bool produce_batch(TupleBatch *batch) override {
+        batch->reset(len_);
+        while (!batch->full()) {
+            if (chain_ != NO_ENTRY) {
+                uint32_t idx = chain_;
+                chain_ = next_[idx];
+                // next_partition()可能换了构建侧，每次按当前的构建侧计算位置
+                const char *build_row = build_rows_.data() + idx * tuple_lens_[build_side_];
+                if (hashes_[idx] == probe_hash_ && keys_equal(build_row, probe_row_)) {
+                    emit(batch, build_row);
+                }
+                continue;
+            }
+            if (probe_next_ >= probe_batch_.size()) {
+                if (next_probe_batch() || next_partition()) {
+                    continue;
+                }
+                break;
+            }
+            probe_row_ = probe_batch_.get(probe_next_++);
+            probe_hash_ = hash_key(probe_row_, key_cols_[1 - build_side_], level_);
+            chain_ = heads_[probe_hash_ & (heads_.size() - 1)];
+        }
+        return !batch->empty();
+    }
+
+   private:
+    AbstractExecutor *child(int side) const { return side == 0 ? left_.get() : right_.get(); }
+
+    static const ColMeta *find_col(const std::vector<ColMeta> &cols, const TabCol &target) {
+        for (auto &col : cols) {
+            if (col.tab_name == target.tab_name && col.name == target.col_name) {
+                return &col;
+            }
+        }
+        return nullptr;
+    }
+
+    // 在side一侧的rows条元组上建哈希表需要的内存
+    size_t table_memory(size_t rows, int side) const {
+        return rows * (tuple_lens_[side] + sizeof(uint64_t) + 2 * sizeof(uint32_t));
+    }
+
+    /**
+     * @brief 计算元组在keys字段上的哈希值，不同的level使用不同的种子，使递归划分的分区能继续分开
+     */
+    static uint64_t hash_key(const char *row, const std::vector<ColMeta> &keys, int level) {
+        uint64_t h = 14695981039346656037ULL ^ (static_cast<uint64_t>(level) * 0x9e3779b97f4a7c15ULL);
+        auto mix = [&h](const char *data, int len) {
+            for (int i = 0; i < len; i++) {
+                h ^= static_cast<unsigned char>(data[i]);
+                h *= 1099511628211ULL;
+            }
+        };
+        for (auto &key : keys) {
+            if (key.type == TYPE_FLOAT) {
+                // 0.0和-0.0比较相等，哈希值也必须相同
+                float f;
+                memcpy(&f, row + key.offset, sizeof(float));
+                if (f == 0.0f) f = 0.0f;
+                mix(reinterpret_cast<const char *>(&f), sizeof(float));
+            } else {
+                mix(row + key.offset, key.len);
+            }
+        }
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+    bool keys_equal(const char *build_row, const char *probe_row) const {
+        auto &build_keys = key_cols_[build_side_];
+        auto &probe_keys = key_cols_[1 - build_side_];
+        for (size_t i = 0; i < build_keys.size(); i++) {
+            if (ix_compare(build_row + build_keys[i].offset, probe_row + probe_keys[i].offset, build_keys[i].type,
+                           build_keys[i].len) != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 把构建侧元组和正在探测的元组按左、右的顺序拼接，满足其余条件时保留
+    void emit(TupleBatch *batch, const char *build_row) {
+        const char *left_row = build_side_ == 0 ? build_row : probe_row_;
+        const char *right_row = build_side_ == 0 ? probe_row_ : build_row;
+        char *tuple = batch->append(Rid{RM_NO_PAGE, -1});
+        memcpy(tuple, left_row, tuple_lens_[0]);
+        memcpy(tuple + tuple_lens_[0], right_row, tuple_lens_[1]);
+        if (!eval_bound_conds(bound_conds_, tuple)) {
+            batch->pop_back();
+        }
+    }
+
+    void build_table() {
+        size_t len = tuple_lens_[build_side_];
+        size_t n = build_rows_.size() / len;
+        if (n >= NO_ENTRY) {
+            throw InternalError("Hash join build side is too large");
+        }
+        size_t buckets = 1;
+        while (buckets < n) buckets <<= 1;
+        heads_.assign(buckets, NO_ENTRY);
+        hashes_.resize(n);
+        next_.resize(n);
+        for (size_t i = 0; i < n; i++) {
+            uint64_t h = hash_key(build_rows_.data() + i * len, key_cols_[build_side_], level_);
+            size_t bucket = h & (buckets - 1);
+            hashes_[i] = h;
+            next_[i] = heads_[bucket];
+            heads_[bucket] = static_cast<uint32_t>(i);
+        }
+    }
+
+    /**
+     * @brief 读取探测侧的下一批元组：先是建表前已经读入内存的元组，然后是儿子节点或分区文件
+     */
+    bool next_probe_batch() {
+        probe_next_ = 0;
+        size_t len = tuple_lens_[1 - build_side_];
+        switch (probe_source_) {
+            case PROBE_MEMORY: {
+                size_t total = probe_rows_.size() / len;
+                if (probe_mem_pos_ < total) {
+                    size_t n = std::min(probe_batch_.capacity(), total - probe_mem_pos_);
+                    probe_batch_.reset(len);
+                    memcpy(probe_batch_.append_rows(n), probe_rows_.data() + probe_mem_pos_ * len, n * len);
+                    probe_mem_pos_ += n;
+                    return true;
+                }
+                std::vector<char>().swap(probe_rows_);
+                probe_source_ = PROBE_CHILD;
+                return child(1 - build_side_)->NextBatch(&probe_batch_);
+            }
+            case PROBE_CHILD:
+                return child(1 - build_side_)->NextBatch(&probe_batch_);
+            case PROBE_FILE:
+                return read_rows(probe_file_, &probe_file_rows_, len, &probe_batch_);
+            default:
+                probe_batch_.clear();
+                return false;
+        }
+    }
+
+    /**
+     * @brief 结束当前的分区，取出下一对分区建哈希表。较小的一侧超出内存预算时继续划分
+     * @return 没有剩余的分区时返回false
+     */
+    bool next_partition() {
+        if (probe_source_ == PROBE_FILE) {
+            probe_file_.close();
+            remove_spill_file(probe_path_);
+        }
+        probe_source_ = PROBE_NONE;
+        while (!pending_.empty()) {
+            Partition part = pending_.back();
+            pending_.pop_back();
+            int build = part.rows[0] * tuple_lens_[0] <= part.rows[1] * tuple_lens_[1] ? 0 : 1;
+            if (table_memory(part.rows[build], build) > memory_budget_ && part.level < MAX_LEVEL) {
+                PartitionWriter writers[2];
+                TupleBatch batch;
+                for (int side = 0; side < 2; side++) {
+                    open_partitions(&writers[side]);
+                    std::ifstream in = open_spill_file(part.paths[side]);
+                    while (read_rows(in, &part.rows[side], tuple_lens_[side], &batch)) {
+                        write_partitioned(&writers[side], side, batch.get(0), batch.size(), part.level);
+                    }
+                    in.close();
+                    remove_spill_file(part.paths[side]);
+                }
+                add_partitions(writers, part.level + 1);
+                continue;
+            }
+            build_side_ = build;
+            level_ = part.level;
+            size_t build_len = tuple_lens_[build];
+            build_rows_.resize(part.rows[build] * build_len);
+            std::ifstream in = open_spill_file(part.paths[build]);
+            if (!in.read(build_rows_.data(), build_rows_.size())) {
+                throw UnixError();
+            }
+            in.close();
+            remove_spill_file(part.paths[build]);
+            build_table();
+
+            probe_path_ = part.paths[1 - build];
+            probe_file_ = open_spill_file(probe_path_);
+            probe_file_rows_ = part.rows[1 - build];
+            probe_source_ = PROBE_FILE;
+            probe_batch_.clear();
+            probe_next_ = 0;
+            return true;
+        }
+        return false;
+    }
+
+    void open_partitions(PartitionWriter *writer) {
+        for (size_t p = 0; p < HASH_JOIN_PARTITIONS; p++) {
+            std::string path = spill_prefix_ + ".part" + std::to_string(num_spill_files_++);
+            spill_files_.push_back(path);
+            writer->files.emplace_back(path, std::ios::binary | std::ios::trunc);
+            if (!writer->files.back()) {
+                throw UnixError();
+            }
+            writer->paths.push_back(path);
+            writer->rows.push_back(0);
+        }
+    }
+
+    // 按level种子的哈希值的高位把side一侧的n条元组写到各个分区，低位留给分区内的哈希表
+    void write_partitioned(PartitionWriter *writer, int side, const char *rows, size_t n, int level) {
+        size_t len = tuple_lens_[side];
+        for (size_t i = 0; i < n; i++) {
+            const char *row = rows + i * len;
+            size_t p = (hash_key(row, key_cols_[side], level) >> 32) % HASH_JOIN_PARTITIONS;
+            writer->files[p].write(row, len);
+            writer->rows[p]++;
+        }
+    }
+
+    // 关闭两侧的分区文件，编号相同的分区两侧都有元组时才需要连接，否则直接删除
+    void add_partitions(PartitionWriter *writers, int level) {
+        for (size_t p = 0; p < HASH_JOIN_PARTITIONS; p++) {
+            for (int side = 0; side < 2; side++) {
+                writers[side].files[p].close();
+                if (!writers[side].files[p]) {
+                    throw UnixError();
+                }
+            }
+            if (writers[0].rows[p] == 0 || writers[1].rows[p] == 0) {
+                remove_spill_file(writers[0].paths[p]);
+                remove_spill_file(writers[1].paths[p]);
+                continue;
+            }
+            pending_.push_back(Partition{.paths = {writers[0].paths[p], writers[1].paths[p]},
+                                         .rows = {writers[0].rows[p], writers[1].rows[p]},
+                                         .level = level});
+        }
+    }
+
+    static std::ifstream open_spill_file(const std::string &path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            throw UnixError();
+        }
+        return in;
+    }
+
+    // 从分区文件读取最多一批元组，rows_left为文件中还没有读取的元组数
+    static bool read_rows(std::ifstream &in, size_t *rows_left, size_t len, TupleBatch *batch) {
+        batch->reset(len);
+        size_t n = std::min(batch->capacity(), *rows_left);
+        if (n == 0) {
+            return false;
+        }
+        if (!in.read(batch->append_rows(n), n * len)) {
+            throw UnixError();
+        }
+        *rows_left -= n;
+        return true;
+    }
+
+    void remove_spill_file(const std::string &path) {
+        auto pos = std::find(spill_files_.begin(), spill_files_.end(), path);
+        if (pos != spill_files_.end()) {
+            std::remove(path.c_str());
+            spill_files_.erase(pos);
+        }
+    }
+
+    void remove_spill_files() {
+        if (probe_file_.is_open()) {
+            probe_file_.close();
+        }
+        for (auto &path : spill_files_) {
+            std::remove(path.c_str());
+        }
+        spill_files_.clear();
+    }
+};
@@ -0,0 +1,281 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <algorithm>
+#include <numeric>
+
+#include "execution_defs.h"
+#include "execution_manager.h"
+#include "executor_abstract.h"
+#include "executor_index_scan.h"
+#include "index/ix.h"
+#include "system/sm.h"
+
+/**
+ * 索引嵌套循环连接：左侧为外表，右侧为内表tab_name上的索引查找。内表索引最左边连续的字段由连接等值条件
+ * (取左侧元组中的字段)或内表上的常量等值条件确定，至少有一个字段来自连接条件；哈希索引要求所有字段都确定。
+ * 每次读入左侧的一批元组，按探测key排序后依次查找索引，相邻的查找落在相同或相邻的叶子上；
+ * key相同的左侧元组只查找一次，共用读到的内表记录
+ */
+class IndexNestedLoopJoinExecutor : public BatchExecutor {
+   private:
+    // 索引字段的取值来源
+    struct KeySource {
+        int outer_offset;       // 来自连接条件时为左侧字段在左侧元组中的偏移量，否则为-1
+        const char *val;        // 来自内表上的常量等值条件时指向常量的数据
+    };
+
+    std::unique_ptr<AbstractExecutor> left_;    // 左儿子节点，外表
+    std::string tab_name_;                      // 内表名称
+    TabMeta tab_;                               // 内表的元数据
+    RmFileHandle *fh_;                          // 内表的数据文件句柄
+    size_t left_len_;                           // 左侧元组的长度
+    size_t inner_len_;                          // 内表记录的长度
+    size_t len_;                                // join后获得的每条记录的长度
+    std::vector<ColMeta> cols_;                 // join后获得的记录的字段
+
+    std::vector<Condition> fed_conds_;          // 内表上的条件和join条件
+    std::vector<BoundCond> bound_conds_;        // 绑定到join后记录布局上的fed_conds_
+
+    IndexMeta index_meta_;                      // 内表上用于查找的索引
+    IxIndexHandle *ih_ = nullptr;               // B+树索引的文件句柄
+    IxHashIndexHandle *hash_ih_ = nullptr;      // 哈希索引的文件句柄
+    std::vector<KeySource> key_sources_;        // 索引最左边有取值的字段的来源，之后的字段取最小值和最大值
+
+    TupleBatch left_batch_;                     // 当前的一批左侧元组
+    std::vector<char> lower_keys_;              // left_batch_中每条元组的探测范围下界
+    std::vector<char> upper_keys_;              // left_batch_中每条元组的探测范围上界
+    std::vector<uint32_t> order_;               // 按探测key排序后的左侧元组下标
+    size_t group_end_ = 0;                      // 当前探测key相同的一组左侧元组在order_中的结束位置
+    size_t outer_pos_ = 0;                      // 正在组合的左侧元组在order_中的位置
+    std::vector<char> inner_rows_;              // 当前一组查找到的内表记录
+    size_t inner_count_ = 0;                    // inner_rows_中的记录数
+    size_t inner_pos_ = 0;                      // 下一条要组合的内表记录
+    bool isend;
+
+    SmManager *sm_manager_;
+
+   public:
+    IndexNestedLoopJoinExecutor(SmManager *sm_manager, std::unique_ptr<AbstractExecutor> left, std::string tab_name,
+                                std::vector<Condition> inner_conds, std::vector<Condition> join_conds,
+                                std::vector<std::string> index_col_names, Context *context) {
+        sm_manager_ = sm_manager;
+        context_ = context;
+        left_ = std::move(left);
+        tab_name_ = std::move(tab_name);
+        tab_ = sm_manager_->db_.get_table(tab_name_);
+        fh_ = sm_manager_->fhs_.at(tab_name_).get();
+        left_len_ = left_->tupleLen();
+        inner_len_ = fh_->get_file_hdr().record_size;
+        len_ = left_len_ + inner_len_;
+        cols_ = left_->cols();
+        for (auto col : tab_.cols) {
+            col.offset += left_len_;
+            cols_.push_back(col);
+        }
+        fed_conds_ = std::move(inner_conds);
+        fed_conds_.insert(fed_conds_.end(), join_conds.begin(), join_conds.end());
+        bound_conds_ = bind_conds(cols_, fed_conds_);
+
+        index_meta_ = *(tab_.get_index_meta(index_col_names));
+        std::string ix_name = sm_manager_->get_ix_manager()->get_index_name(tab_name_, index_col_names);
+        if (index_meta_.type == INDEX_HASH) {
+            hash_ih_ = sm_manager_->hash_ihs_.at(ix_name).get();
+        } else {
+            ih_ = sm_manager_->ihs_.at(ix_name).get();
+        }
+        bind_key_sources();
+        isend = false;
+    }
+
+    size_t tupleLen() const override { return len_; }
+
+    const std::vector<ColMeta> &cols() const override { return cols_; }
+
+    std::string getType() override { return "IndexNestedLoopJoinExecutor"; }
+
+   protected:
+    void begin_batches() override {
+        left_->beginTuple();
+        isend = false;
+        order_.clear();
+        group_end_ = outer_pos_ = 0;
+        inner_count_ = inner_pos_ = 0;
+    }
+
+    bool produce_batch(TupleBatch *batch) override {
+        batch->reset(len_);
+        while (!batch->full()) {
+            if (outer_pos_ >= group_end_) {
+                if (!next_group()) {
+                    break;
+                }
+                continue;
+            }
+            if (inner_pos_ >= inner_count_) {
+                inner_pos_ = 0;
+                outer_pos_++;
+                continue;
+            }
+            char *tuple = batch->append(Rid{RM_NO_PAGE, -1});
+            memcpy(tuple, left_batch_.get(order_[outer_pos_]), left_len_);
+            memcpy(tuple + left_len_, inner_rows_.data() + inner_pos_ * inner_len_, inner_len_);
+            if (!eval_bound_conds(bound_conds_, tuple)) {
+                batch->pop_back();
+            }
+            inner_pos_++;
+        }
+        return !batch->empty();
+    }
+
+   private:
+    /**
+     * @brief 按索引字段的顺序为每个字段找取值来源：优先取左侧字段的连接等值条件，其次取内表上的常量等值条件，
+     * 遇到第一个没有来源的字段为止
+     */
+    void bind_key_sources() {
+        auto &left_cols = left_->cols();
+        bool has_join_key = false;
+        for (auto &col : index_meta_.cols) {
+            KeySource src = {.outer_offset = -1, .val = nullptr};
+            for (auto &cond : fed_conds_) {
+                if (cond.op != OP_EQ) continue;
+                if (cond.is_rhs_val) {
+                    if (cond.lhs_col.tab_name == tab_name_ && cond.lhs_col.col_name == col.name) {
+                        src.val = cond.rhs_val.raw->data;
+                    }
+                    continue;
+                }
+                const TabCol *inner = &cond.lhs_col, *outer = &cond.rhs_col;
+                if (inner->tab_name != tab_name_) std::swap(inner, outer);
+                if (inner->tab_name != tab_name_ || outer->tab_name == tab_name_ || inner->col_name != col.name) continue;
+                auto pos = std::find_if(left_cols.begin(), left_cols.end(), [&](const ColMeta &left_col) {
+                    return left_col.tab_name == outer->tab_name && left_col.name == outer->col_name;
+                });
+                if (pos != left_cols.end() && pos->type == col.type && pos->len == col.len) {
+                    src.outer_offset = pos->offset;
+                }
+            }
+            if (src.outer_offset < 0 && src.val == nullptr) {
+                break;
+            }
+            has_join_key |= src.outer_offset >= 0;
+            key_sources_.push_back(src);
+        }
+        if (!has_join_key) {
+            throw InternalError("Index nested loop join requires an equality condition on the index columns");
+        }
+        if (hash_ih_ != nullptr && key_sources_.size() != index_meta_.cols.size()) {
+            throw InternalError("Index nested loop join on a hash index requires all index columns to be bound");
+        }
+    }
+
+    // 读入左侧的下一批元组，计算每条元组的探测范围并排序
+    bool next_outer_batch() {
+        if (isend || !left_->NextBatch(&left_batch_)) {
+            isend = true;
+            return false;
+        }
+        size_t n = left_batch_.size();
+        size_t key_len = index_meta_.col_tot_len;
+        lower_keys_.resize(n * key_len);
+        upper_keys_.resize(n * key_len);
+        for (size_t i = 0; i < n; i++) {
+            const char *row = left_batch_.get(i);
+            char *lo = lower_keys_.data() + i * key_len;
+            char *hi = upper_keys_.data() + i * key_len;
+            int offset = 0;
+            for (size_t j = 0; j < index_meta_.cols.size(); j++) {
+                auto &col = index_meta_.cols[j];
+                if (j < key_sources_.size()) {
+                    auto &src = key_sources_[j];
+                    const char *val = src.outer_offset >= 0 ? row + src.outer_offset : src.val;
+                    memcpy(lo + offset, val, col.len);
+                    memcpy(hi + offset, val, col.len);
+                } else {
+                    IndexScanExecutor::fill_min_max(col, lo + offset, hi + offset);
+                }
+                offset += col.len;
+            }
+        }
+        order_.resize(n);
+        std::iota(order_.begin(), order_.end(), 0);
+        std::sort(order_.begin(), order_.end(), [&](uint32_t a, uint32_t b) { return compare_keys(a, b) < 0; });
+        group_end_ = 0;
+        return true;
+    }
+
+    // 比较两条左侧元组的探测key，只比较有取值的字段
+    int compare_keys(uint32_t a, uint32_t b) const {
+        size_t key_len = index_meta_.col_tot_len;
+        const char *ka = lower_keys_.data() + a * key_len;
+        const char *kb = lower_keys_.data() + b * key_len;
+        int offset = 0;
+        for (size_t j = 0; j < key_sources_.size(); j++) {
+            auto &col = index_meta_.cols[j];
+            int res = ix_compare(ka + offset, kb + offset, col.type, col.len);
+            if (res != 0) {
+                return res;
+            }
+            offset += col.len;
+        }
+        return 0;
+    }
+
+    /**
+     * @brief 取出下一组探测key相同的左侧元组并查找索引，跳过没有查找到记录的组
+     * @return 左侧读完时返回false
+     */
+    bool next_group() {
+        while (true) {
+            if (group_end_ >= order_.size() && !next_outer_batch()) {
+                return false;
+            }
+            size_t group_begin = group_end_;
+            group_end_ = group_begin + 1;
+            while (group_end_ < order_.size() && compare_keys(order_[group_begin], order_[group_end_]) == 0) {
+                group_end_++;
+            }
+            outer_pos_ = group_begin;
+            inner_pos_ = 0;
+            lookup(order_[group_begin]);
+            if (inner_count_ > 0) {
+                return true;
+            }
+            outer_pos_ = group_end_;
+        }
+    }
+
+    // 查找第idx条左侧元组的探测范围，按rid的顺序读入内表记录
+    void lookup(uint32_t idx) {
+        size_t key_len = index_meta_.col_tot_len;
+        const char *lo = lower_keys_.data() + idx * key_len;
+        const char *hi = upper_keys_.data() + idx * key_len;
+        std::vector<Rid> rids;
+        if (hash_ih_ != nullptr) {
+            hash_ih_->get_value(lo, &rids, context_ ? context_->txn_ : nullptr);
+        } else {
+            IxScan scan(ih_, ih_->lower_bound(lo), ih_->upper_bound(hi), sm_manager_->get_bpm());
+            for (; !scan.is_end(); scan.next()) {
+                rids.push_back(scan.rid());
+            }
+            std::sort(rids.begin(), rids.end(), [](const Rid &a, const Rid &b) {
+                return a.page_no != b.page_no ? a.page_no < b.page_no : a.slot_no < b.slot_no;
+            });
+        }
+        inner_count_ = rids.size();
+        inner_rows_.resize(inner_count_ * inner_len_);
+        for (size_t i = 0; i < inner_count_; i++) {
+            fh_->get_record(rids[i], inner_rows_.data() + i * inner_len_, context_);
+        }
+    }
+};
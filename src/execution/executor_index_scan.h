@@ -10,6 +10,8 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <limits>
+
 #include "execution_defs.h"
 #include "execution_manager.h"
 #include "executor_abstract.h"
@@ -22,21 +24,30 @@ class IndexScanExecutor : public AbstractExecutor {
     TabMeta tab_;                               // 表的元数据
     std::vector<Condition> conds_;              // 扫描条件
     RmFileHandle *fh_;                          // 表的数据文件句柄
-    std::vector<ColMeta> cols_;                 // 需要读取的字段
+    std::vector<ColMeta> cols_;                 // 需要读取的字段，只读索引时为索引包含的字段，偏移量为字段在key中的位置
     size_t len_;                                // 选取出来的一条记录的长度
     std::vector<Condition> fed_conds_;          // 扫描条件，和conds_字段相同
+    std::vector<BoundCond> bound_conds_;        // 绑定到输出记录布局上的fed_conds_
 
     std::vector<std::string> index_col_names_;  // index scan涉及到的索引包含的字段
     IndexMeta index_meta_;                      // index scan涉及到的索引元数据
+    IxIndexHandle *ih_ = nullptr;               // B+树索引的文件句柄
+    IxHashIndexHandle *hash_ih_ = nullptr;      // 哈希索引的文件句柄，只用于所有索引字段都是等值条件的查找
+    bool index_only_;                           // 索引覆盖查询用到的所有字段，直接从叶子的key生成记录，不回表
+    bool reverse_;                              // 从范围的末尾向前扫描B+树索引，按索引逆序输出
 
     Rid rid_;
-    std::unique_ptr<RecScan> scan_;
+    std::unique_ptr<IxScan> scan_;
+    std::vector<Rid> hash_rids_;                // 哈希索引查找到的记录位置
+    size_t hash_pos_ = 0;                       // 当前记录在hash_rids_中的位置
+    std::vector<char> hash_key_;                // 哈希索引查找的key
+    std::vector<char> rec_buf_;                 // 回表时当前记录的数据，find_next_match读入后供Next()使用
 
     SmManager *sm_manager_;
 
    public:
     IndexScanExecutor(SmManager *sm_manager, std::string tab_name, std::vector<Condition> conds, std::vector<std::string> index_col_names,
-                    Context *context) {
+                    bool index_only, Context *context, bool reverse = false) {
         sm_manager_ = sm_manager;
         context_ = context;
         tab_name_ = std::move(tab_name);
@@ -46,8 +57,27 @@ class IndexScanExecutor : public AbstractExecutor {
         index_col_names_ = index_col_names; 
         index_meta_ = *(tab_.get_index_meta(index_col_names_));
         fh_ = sm_manager_->fhs_.at(tab_name_).get();
-        cols_ = tab_.cols;
-        len_ = cols_.back().offset + cols_.back().len;
+        std::string ix_name = sm_manager_->get_ix_manager()->get_index_name(tab_name_, index_col_names_);
+        if (index_meta_.type == INDEX_HASH) {
+            hash_ih_ = sm_manager_->hash_ihs_.at(ix_name).get();
+        } else {
+            ih_ = sm_manager_->ihs_.at(ix_name).get();
+        }
+        index_only_ = index_only;
+        reverse_ = reverse;
+        if (index_only_) {
+            // key由索引字段按顺序拼接而成，直接作为输出的记录
+            cols_ = index_meta_.cols;
+            int offset = 0;
+            for (auto &col : cols_) {
+                col.offset = offset;
+                offset += col.len;
+            }
+            len_ = offset;
+        } else {
+            cols_ = tab_.cols;
+            len_ = cols_.back().offset + cols_.back().len;
+        }
         std::map<CompOp, CompOp> swap_op = {
             {OP_EQ, OP_EQ}, {OP_NE, OP_NE}, {OP_LT, OP_GT}, {OP_GT, OP_LT}, {OP_LE, OP_GE}, {OP_GE, OP_LE},
         };
@@ -62,19 +92,147 @@ class IndexScanExecutor : public AbstractExecutor {
             }
         }
         fed_conds_ = conds_;
+        bound_conds_ = bind_conds(cols_, fed_conds_);
+        rec_buf_.resize(index_only_ ? 0 : fh_->get_file_hdr().record_size);
     }
 
+    /**
+     * @brief 根据条件确定索引上的扫描范围，构建索引迭代器scan_，并定位到第一个满足谓词条件的元组
+     */
     void beginTuple() override {
-        
+        std::vector<char> lower_key(index_meta_.col_tot_len);
+        std::vector<char> upper_key(index_meta_.col_tot_len);
+        if (hash_ih_ != nullptr) {
+            // 哈希索引只能查找一个key，范围的上下界必须相同
+            hash_rids_.clear();
+            hash_pos_ = 0;
+            if (build_range(lower_key.data(), upper_key.data())) {
+                if (lower_key != upper_key) {
+                    throw InternalError("Hash index scan requires equality conditions on all index columns");
+                }
+                hash_key_ = lower_key;
+                hash_ih_->get_value(hash_key_.data(), &hash_rids_, context_ ? context_->txn_ : nullptr);
+            }
+            find_next_match();
+            return;
+        }
+        Iid lower = ih_->leaf_end();
+        Iid upper = lower;
+        if (build_range(lower_key.data(), upper_key.data())) {
+            lower = ih_->lower_bound(lower_key.data());
+            upper = ih_->upper_bound(upper_key.data());
+        }
+        scan_ = std::make_unique<IxScan>(ih_, lower, upper, sm_manager_->get_bpm(), reverse_, index_only_);
+        find_next_match();
     }
 
     void nextTuple() override {
-        
+        if (hash_ih_ != nullptr) {
+            hash_pos_++;
+        } else {
+            scan_->next();
+        }
+        find_next_match();
     }
 
-    std::unique_ptr<RmRecord> Next() override {
-        return nullptr;
+    /**
+     * @brief 返回当前满足扫描条件的记录，只读索引时由key生成，否则为find_next_match回表读到的记录
+     */
+    std::unique_ptr<RmRecord> Next() override { return std::make_unique<RmRecord>(len_, const_cast<char *>(current())); }
+
+    bool NextBatch(TupleBatch *batch) override {
+        batch->reset(len_);
+        for (; !is_end() && !batch->full(); nextTuple()) {
+            batch->append(current(), rid_);
+        }
+        return !batch->empty();
     }
 
+    bool is_end() const override { return hash_ih_ != nullptr ? hash_pos_ == hash_rids_.size() : scan_->is_end(); }
+
+    size_t tupleLen() const override { return len_; }
+
+    const std::vector<ColMeta> &cols() const override { return cols_; }
+
+    std::string getType() override { return index_only_ ? "IndexOnlyScanExecutor" : "IndexScanExecutor"; }
+
     Rid &rid() override { return rid_; }
+
+   private:
+    // 当前记录的数据
+    const char *current() const {
+        if (index_only_) {
+            return hash_ih_ != nullptr ? hash_key_.data() : scan_->key();
+        }
+        return rec_buf_.data();
+    }
+
+    // 从scan_当前位置开始跳过不满足fed_conds_的记录
+    void find_next_match() {
+        while (!is_end()) {
+            rid_ = hash_ih_ != nullptr ? hash_rids_[hash_pos_] : scan_->rid();
+            if (!index_only_) {
+                fh_->get_record(rid_, rec_buf_.data(), context_);
+            }
+            if (eval_bound_conds(bound_conds_, current())) {
+                return;
+            }
+            if (hash_ih_ != nullptr) {
+                hash_pos_++;
+            } else {
+                scan_->next();
+            }
+        }
+    }
+
+    /**
+     * @brief 由条件得到扫描范围[lower_key, upper_key]：索引最左边连续的等值字段取条件中的值，
+     * 其后第一个字段取范围条件中最紧的上下界，剩下的字段分别取最小值和最大值。
+     * 范围只用于缩小扫描的叶子，扫描到的记录仍然用全部条件过滤
+     * @return 范围为空时返回false
+     */
+    bool build_range(char *lower_key, char *upper_key) {
+        int offset = 0;
+        bool prefix = true;     // 之前的字段都有等值条件
+        for (auto &col : index_meta_.cols) {
+            char *lo = lower_key + offset;
+            char *hi = upper_key + offset;
+            fill_min_max(col, lo, hi);
+            bool has_eq = false;
+            for (auto &cond : fed_conds_) {
+                if (!prefix || !cond.is_rhs_val || cond.lhs_col.col_name != col.name || cond.op == OP_NE) continue;
+                const char *val = cond.rhs_val.raw->data;
+                if ((cond.op == OP_EQ || cond.op == OP_GT || cond.op == OP_GE) && ix_compare(val, lo, col.type, col.len) > 0) {
+                    memcpy(lo, val, col.len);
+                }
+                if ((cond.op == OP_EQ || cond.op == OP_LT || cond.op == OP_LE) && ix_compare(val, hi, col.type, col.len) < 0) {
+                    memcpy(hi, val, col.len);
+                }
+                has_eq |= cond.op == OP_EQ;
+            }
+            if (ix_compare(lo, hi, col.type, col.len) > 0) {
+                return false;
+            }
+            prefix = prefix && has_eq;
+            offset += col.len;
+        }
+        return true;
+    }
+
+   public:
+    // 把字段col的取值lo、hi分别填为该字段类型的最小值和最大值，用于没有条件限制的索引字段
+    static void fill_min_max(const ColMeta &col, char *lo, char *hi) {
+        if (col.type == TYPE_INT) {
+            int min = std::numeric_limits<int>::min(), max = std::numeric_limits<int>::max();
+            memcpy(lo, &min, sizeof(int));
+            memcpy(hi, &max, sizeof(int));
+        } else if (col.type == TYPE_FLOAT) {
+            float min = -std::numeric_limits<float>::infinity(), max = std::numeric_limits<float>::infinity();
+            memcpy(lo, &min, sizeof(float));
+            memcpy(hi, &max, sizeof(float));
+        } else {
+            memset(lo, 0, col.len);
+            memset(hi, 0xff, col.len);
+        }
+    }
 };
\ No newline at end of file
@@ -49,20 +49,29 @@ class InsertExecutor : public AbstractExecutor {
             val.init_raw(col.len);
             memcpy(rec.data + col.offset, val.raw->data, col.len);
         }
+        // 索引中的key唯一，插入记录前先检查每个索引上是否已经有相同的key
+        std::vector<std::vector<char>> keys(tab_.indexes.size());
+        for (size_t i = 0; i < tab_.indexes.size(); ++i) {
+            auto &index = tab_.indexes[i];
+            keys[i].resize(index.col_tot_len);
+            make_index_key(index, rec.data, keys[i].data());
+            Rid existing;
+            if (lookup_index_key(sm_manager_, tab_name_, index, keys[i].data(), &existing, context_->txn_)) {
+                throw IndexEntryExistsError();
+            }
+        }
         // Insert into record file
         rid_ = fh_->insert_record(rec.data, context_);
-        
+
         // Insert into index
-        for(size_t i = 0; i < tab_.indexes.size(); ++i) {
-            auto& index = tab_.indexes[i];
-            auto ih = sm_manager_->ihs_.at(sm_manager_->get_ix_manager()->get_index_name(tab_name_, index.cols)).get();
-            char* key = new char[index.col_tot_len];
-            int offset = 0;
-            for(size_t i = 0; i < index.col_num; ++i) {
-                memcpy(key + offset, rec.data + index.cols[i].offset, index.cols[i].len);
-                offset += index.cols[i].len;
+        for (size_t i = 0; i < tab_.indexes.size(); ++i) {
+            auto &index = tab_.indexes[i];
+            std::string ix_name = sm_manager_->get_ix_manager()->get_index_name(tab_name_, index.cols);
+            if (index.type == INDEX_HASH) {
+                sm_manager_->hash_ihs_.at(ix_name)->insert_entry(keys[i].data(), rid_, context_->txn_);
+            } else {
+                sm_manager_->ihs_.at(ix_name)->insert_entry(keys[i].data(), rid_, context_->txn_);
             }
-            ih->insert_entry(key, rid_, context_->txn_);
         }
         return nullptr;
     }
@@ -0,0 +1,182 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "execution_defs.h"
+#include "execution_manager.h"
+#include "executor_abstract.h"
+#include "index/ix.h"
+#include "system/sm.h"
+
+/**
+ * 排序归并连接：两侧输入都已经按连接key升序排列(B+树索引扫描或SortExecutor的输出)，连接key为第一个
+ * 两侧字段之间、类型和长度相同的等值条件，其余条件在连接后的记录上判断。
+ * 两侧同时按批向前读，key较小的一侧前进；key相等时把右侧key相同的一组元组复制下来，
+ * 与左侧key相同的每条元组逐一组合。只需要缓存右侧一组重复的key，两侧都只读一遍
+ */
+class MergeJoinExecutor : public BatchExecutor {
+   private:
+    // 按批读取一侧输入的位置
+    struct Cursor {
+        AbstractExecutor *child;
+        TupleBatch batch;
+        size_t pos = 0;
+        bool end = false;
+
+        void begin() {
+            child->beginTuple();
+            pos = 0;
+            end = !child->NextBatch(&batch);
+        }
+
+        const char *current() const { return batch.get(pos); }
+
+        void advance() {
+            if (++pos == batch.size()) {
+                pos = 0;
+                end = !child->NextBatch(&batch);
+            }
+        }
+    };
+
+    std::unique_ptr<AbstractExecutor> left_;    // 左儿子节点
+    std::unique_ptr<AbstractExecutor> right_;   // 右儿子节点
+    size_t left_len_;                           // 左侧元组的长度
+    size_t right_len_;                          // 右侧元组的长度
+    size_t len_;                                // join后获得的每条记录的长度
+    std::vector<ColMeta> cols_;                 // join后获得的记录的字段
+
+    std::vector<Condition> fed_conds_;          // join条件
+    ColMeta key_cols_[2];                       // 连接key在左右两侧的字段，偏移量为字段在各自元组中的位置
+    std::vector<BoundCond> bound_conds_;        // 绑定到join后记录布局上的fed_conds_
+
+    Cursor cursors_[2];
+    std::vector<char> group_;                   // 右侧key相同的一组元组
+    size_t group_size_ = 0;                     // group_中的元组数，为0时不在组合一组元组
+    size_t group_pos_ = 0;                      // 下一条要和左侧当前元组组合的group_中的元组
+
+   public:
+    MergeJoinExecutor(std::unique_ptr<AbstractExecutor> left, std::unique_ptr<AbstractExecutor> right,
+                      std::vector<Condition> conds) {
+        left_ = std::move(left);
+        right_ = std::move(right);
+        left_len_ = left_->tupleLen();
+        right_len_ = right_->tupleLen();
+        len_ = left_len_ + right_len_;
+        cols_ = left_->cols();
+        auto right_cols = right_->cols();
+        for (auto &col : right_cols) {
+            col.offset += left_len_;
+        }
+        cols_.insert(cols_.end(), right_cols.begin(), right_cols.end());
+        fed_conds_ = std::move(conds);
+        bound_conds_ = bind_conds(cols_, fed_conds_);
+        if (!find_key()) {
+            throw InternalError("Merge join requires an equality condition between its inputs");
+        }
+        cursors_[0].child = left_.get();
+        cursors_[1].child = right_.get();
+    }
+
+    size_t tupleLen() const override { return len_; }
+
+    const std::vector<ColMeta> &cols() const override { return cols_; }
+
+    std::string getType() override { return "MergeJoinExecutor"; }
+
+   protected:
+    void begin_batches() override {
+        cursors_[0].begin();
+        cursors_[1].begin();
+        group_size_ = group_pos_ = 0;
+    }
+
+    bool produce_batch(TupleBatch *batch) override {
+        batch->reset(len_);
+        Cursor &left = cursors_[0], &right = cursors_[1];
+        while (!batch->full()) {
+            if (group_size_ > 0) {
+                if (group_pos_ == group_size_) {
+                    // 左侧当前元组和这一组组合完，左侧下一条元组的key不同时结束这一组
+                    group_pos_ = 0;
+                    left.advance();
+                    if (left.end || compare_key(left.current(), group_.data()) != 0) {
+                        group_size_ = 0;
+                    }
+                    continue;
+                }
+                char *tuple = batch->append(Rid{RM_NO_PAGE, -1});
+                memcpy(tuple, left.current(), left_len_);
+                memcpy(tuple + left_len_, group_.data() + group_pos_ * right_len_, right_len_);
+                if (!eval_bound_conds(bound_conds_, tuple)) {
+                    batch->pop_back();
+                }
+                group_pos_++;
+                continue;
+            }
+            if (left.end || right.end) {
+                break;
+            }
+            int cmp = compare_key(left.current(), right.current());
+            if (cmp < 0) {
+                left.advance();
+            } else if (cmp > 0) {
+                right.advance();
+            } else {
+                // 复制右侧key相同的一组元组，右侧停在这一组之后
+                group_.clear();
+                group_size_ = 0;
+                do {
+                    group_.insert(group_.end(), right.current(), right.current() + right_len_);
+                    group_size_++;
+                    right.advance();
+                } while (!right.end && compare_key(left.current(), right.current()) == 0);
+                group_pos_ = 0;
+            }
+        }
+        return !batch->empty();
+    }
+
+   private:
+    // 在fed_conds_中找第一个两侧字段之间、类型和长度相同的等值条件作为连接key
+    bool find_key() {
+        auto find_col = [](const std::vector<ColMeta> &cols, const TabCol &target) -> const ColMeta * {
+            for (auto &col : cols) {
+                if (col.tab_name == target.tab_name && col.name == target.col_name) {
+                    return &col;
+                }
+            }
+            return nullptr;
+        };
+        for (auto &cond : fed_conds_) {
+            if (cond.is_rhs_val || cond.op != OP_EQ) continue;
+            const ColMeta *left_col = find_col(left_->cols(), cond.lhs_col);
+            const ColMeta *right_col = find_col(right_->cols(), cond.rhs_col);
+            if (left_col == nullptr || right_col == nullptr) {
+                left_col = find_col(left_->cols(), cond.rhs_col);
+                right_col = find_col(right_->cols(), cond.lhs_col);
+            }
+            if (left_col != nullptr && right_col != nullptr && left_col->type == right_col->type &&
+                left_col->len == right_col->len) {
+                key_cols_[0] = *left_col;
+                key_cols_[1] = *right_col;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // 比较左侧元组和右侧元组的连接key
+    int compare_key(const char *left_row, const char *right_row) const {
+        return ix_compare(left_row + key_cols_[0].offset, right_row + key_cols_[1].offset, key_cols_[0].type,
+                          key_cols_[0].len);
+    }
+};
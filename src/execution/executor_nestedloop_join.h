@@ -15,7 +15,12 @@ See the Mulan PSL v2 for more details. */
 #include "index/ix.h"
 #include "system/sm.h"
 
-class NestedLoopJoinExecutor : public AbstractExecutor {
+/**
+ * 块嵌套循环连接：每次按批读入左侧元组，直到填满block_memory字节的块，再扫描一遍右侧，
+ * 右侧的每条元组和块中的左侧元组逐一组合。右侧的扫描次数为左侧的块数而不是左侧的元组数，
+ * 左侧能全部放进一个块时右侧只扫描一遍
+ */
+class NestedLoopJoinExecutor : public BatchExecutor {
    private:
     std::unique_ptr<AbstractExecutor> left_;    // 左儿子节点（需要join的表）
     std::unique_ptr<AbstractExecutor> right_;   // 右儿子节点（需要join的表）
@@ -23,11 +28,21 @@ class NestedLoopJoinExecutor : public AbstractExecutor {
     std::vector<ColMeta> cols_;                 // join后获得的记录的字段
 
     std::vector<Condition> fed_conds_;          // join条件
+    std::vector<BoundCond> bound_conds_;        // 绑定到join后记录布局上的fed_conds_
     bool isend;
 
+    size_t block_memory_;                       // 左侧块的大小
+    std::vector<char> left_block_;              // 当前块中的左侧元组，按行连续存放
+    size_t left_rows_ = 0;                      // 当前块中的左侧元组数
+    bool left_done_ = false;                    // 左侧是否已经读完
+    TupleBatch left_batch_;                     // 读入左侧使用的批
+    TupleBatch right_batch_;                    // 当前的一批右侧元组
+    size_t left_pos_ = 0;                       // 下一个要组合的左侧元组
+    size_t right_pos_ = 0;                      // 正在组合的右侧元组
+
    public:
     NestedLoopJoinExecutor(std::unique_ptr<AbstractExecutor> left, std::unique_ptr<AbstractExecutor> right, 
-                            std::vector<Condition> conds) {
+                            std::vector<Condition> conds, size_t block_memory = NESTED_LOOP_BLOCK_MEMORY) {
         left_ = std::move(left);
         right_ = std::move(right);
         len_ = left_->tupleLen() + right_->tupleLen();
@@ -40,20 +55,79 @@ class NestedLoopJoinExecutor : public AbstractExecutor {
         cols_.insert(cols_.end(), right_cols.begin(), right_cols.end());
         isend = false;
         fed_conds_ = std::move(conds);
-
+        bound_conds_ = bind_conds(cols_, fed_conds_);
+        block_memory_ = block_memory;
     }
 
-    void beginTuple() override {
+    size_t tupleLen() const override { return len_; }
 
-    }
+    const std::vector<ColMeta> &cols() const override { return cols_; }
 
-    void nextTuple() override {
-        
+    std::string getType() override { return "NestedLoopJoinExecutor"; }
+
+   protected:
+    void begin_batches() override {
+        left_->beginTuple();
+        left_done_ = false;
+        left_pos_ = right_pos_ = 0;
+        right_batch_.clear();
+        isend = !fill_block();
+        if (!isend) {
+            right_->beginTuple();
+        }
     }
 
-    std::unique_ptr<RmRecord> Next() override {
-        return nullptr;
+    bool produce_batch(TupleBatch *batch) override {
+        batch->reset(len_);
+        size_t left_len = left_->tupleLen();
+        while (!isend && !batch->full()) {
+            if (right_pos_ >= right_batch_.size()) {
+                // 读取右侧的下一批；右侧读完后读取左侧的下一块，重新扫描右侧
+                left_pos_ = right_pos_ = 0;
+                if (right_->NextBatch(&right_batch_)) {
+                    continue;
+                }
+                if (!fill_block()) {
+                    isend = true;
+                    break;
+                }
+                right_->beginTuple();
+                continue;
+            }
+            const char *right_tuple = right_batch_.get(right_pos_);
+            for (; left_pos_ < left_rows_ && !batch->full(); left_pos_++) {
+                char *tuple = batch->append(Rid{RM_NO_PAGE, -1});
+                memcpy(tuple, left_block_.data() + left_pos_ * left_len, left_len);
+                memcpy(tuple + left_len, right_tuple, right_batch_.tuple_len());
+                if (!eval_bound_conds(bound_conds_, tuple)) {
+                    batch->pop_back();
+                }
+            }
+            if (left_pos_ == left_rows_) {
+                left_pos_ = 0;
+                right_pos_++;
+            }
+        }
+        return !batch->empty();
     }
 
-    Rid &rid() override { return _abstract_rid; }
+   private:
+    /**
+     * @description: 按批读入左侧元组，直到块中的数据达到block_memory_字节或左侧读完
+     * @return {bool} 块中没有元组，即左侧已经读完时返回false
+     */
+    bool fill_block() {
+        size_t left_len = left_->tupleLen();
+        left_block_.clear();
+        left_rows_ = 0;
+        while (!left_done_ && left_block_.size() < block_memory_) {
+            if (!left_->NextBatch(&left_batch_)) {
+                left_done_ = true;
+                break;
+            }
+            left_block_.insert(left_block_.end(), left_batch_.get(0), left_batch_.get(0) + left_batch_.size() * left_len);
+            left_rows_ += left_batch_.size();
+        }
+        return left_rows_ > 0;
+    }
 };
\ No newline at end of file
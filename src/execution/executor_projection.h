@@ -21,6 +21,7 @@ class ProjectionExecutor : public AbstractExecutor {
     std::vector<ColMeta> cols_;                     // 需要投影的字段
     size_t len_;                                    // 字段总长度
     std::vector<size_t> sel_idxs_;                  
+    TupleBatch input_;                              // 从儿子节点读入的一批元组
 
    public:
     ProjectionExecutor(std::unique_ptr<AbstractExecutor> prev, const std::vector<TabCol> &sel_cols) {
@@ -39,13 +40,45 @@ class ProjectionExecutor : public AbstractExecutor {
         len_ = curr_offset;
     }
 
-    void beginTuple() override {}
+    void beginTuple() override { prev_->beginTuple(); }
 
-    void nextTuple() override {}
+    void nextTuple() override { prev_->nextTuple(); }
+
+    bool is_end() const override { return prev_->is_end(); }
 
     std::unique_ptr<RmRecord> Next() override {
-        return nullptr;
+        auto prev_rec = prev_->Next();
+        auto rec = std::make_unique<RmRecord>(len_);
+        project(prev_rec->data, rec->data);
+        return rec;
     }
 
-    Rid &rid() override { return _abstract_rid; }
+    bool NextBatch(TupleBatch *batch) override {
+        batch->reset(len_);
+        input_.reset(prev_->tupleLen(), batch->capacity());
+        if (!prev_->NextBatch(&input_)) {
+            return false;
+        }
+        for (size_t i = 0; i < input_.size(); i++) {
+            project(input_.get(i), batch->append(input_.rid(i)));
+        }
+        return true;
+    }
+
+    size_t tupleLen() const override { return len_; }
+
+    const std::vector<ColMeta> &cols() const override { return cols_; }
+
+    std::string getType() override { return "ProjectionExecutor"; }
+
+    Rid &rid() override { return prev_->rid(); }
+
+   private:
+    // 把儿子节点的元组src中选取的字段依次复制到dest
+    void project(const char *src, char *dest) const {
+        auto &prev_cols = prev_->cols();
+        for (size_t i = 0; i < cols_.size(); i++) {
+            memcpy(dest + cols_[i].offset, src + prev_cols[sel_idxs_[i]].offset, cols_[i].len);
+        }
+    }
 };
\ No newline at end of file
@@ -24,9 +24,12 @@ class SeqScanExecutor : public AbstractExecutor {
     std::vector<ColMeta> cols_;         // scan后生成的记录的字段
     size_t len_;                        // scan后生成的每条记录的长度
     std::vector<Condition> fed_conds_;  // 同conds_，两个字段相同
+    std::vector<BoundCond> bound_conds_;    // 绑定到表的记录布局上的fed_conds_
+    int records_per_page_;              // 每个页面的slot数量
 
     Rid rid_;
-    std::unique_ptr<RecScan> scan_;     // table_iterator
+    std::unique_ptr<RmScan> scan_;      // table_iterator
+    BufferAccessStrategy strategy_;     // 顺序扫描使用私有帧环，避免大表扫描冲刷缓冲池中的热点页
 
     SmManager *sm_manager_;
 
@@ -43,6 +46,8 @@ class SeqScanExecutor : public AbstractExecutor {
         context_ = context;
 
         fed_conds_ = conds_;
+        bound_conds_ = bind_conds(cols_, fed_conds_);
+        records_per_page_ = fh_->get_file_hdr().num_records_per_page;
     }
 
     /**
@@ -50,7 +55,8 @@ class SeqScanExecutor : public AbstractExecutor {
      *
      */
     void beginTuple() override {
-        
+        scan_ = std::make_unique<RmScan>(fh_, &strategy_);
+        find_next_match();
     }
 
     /**
@@ -58,7 +64,8 @@ class SeqScanExecutor : public AbstractExecutor {
      *
      */
     void nextTuple() override {
-        
+        scan_->next();
+        find_next_match();
     }
 
     /**
@@ -67,8 +74,69 @@ class SeqScanExecutor : public AbstractExecutor {
      * @return std::unique_ptr<RmRecord>
      */
     std::unique_ptr<RmRecord> Next() override {
-        return nullptr;
+        return fh_->get_record(rid_, context_);
     }
 
+    /**
+     * @brief 从当前位置起一次读取一个页面中的记录，在页面上直接判断条件，只复制满足条件的记录
+     */
+    bool NextBatch(TupleBatch *batch) override {
+        batch->reset(len_);
+        scan_matches([&](const Rid &rid, const char *data) {
+            if (batch->full()) {
+                return false;
+            }
+            batch->append(data, rid);
+            return true;
+        });
+        return !batch->empty();
+    }
+
+    bool is_end() const override { return scan_->is_end(); }
+
+    size_t tupleLen() const override { return len_; }
+
+    const std::vector<ColMeta> &cols() const override { return cols_; }
+
+    std::string getType() override { return "SeqScanExecutor"; }
+
     Rid &rid() override { return rid_; }
+
+   private:
+    // 从scan_当前位置开始跳过不满足fed_conds_的记录
+    void find_next_match() {
+        scan_matches([](const Rid &, const char *) { return false; });
+    }
+
+    /**
+     * @brief 从scan_当前位置开始逐个页面检查记录，每个页面只固定一次：读完一个页面后用seek_page跳到下一个页面，
+     * 在读入的页面上查找第一条记录，不经过RmScan::next()重新读取页面。满足条件的记录交给emit，
+     * emit返回false时停在这条记录上(它没有被读取)，此时rid_为这条记录的位置
+     */
+    template <typename Emit>
+    void scan_matches(Emit &&emit) {
+        while (!scan_->is_end()) {
+            Rid rid = scan_->rid();
+            RmPageHandle page_handle = fh_->fetch_page_handle(rid.page_no, &strategy_);
+            if (rid.slot_no < 0) {
+                rid.slot_no = Bitmap::next_bit(true, page_handle.bitmap, records_per_page_, -1);
+            }
+            bool stopped = false;
+            while (rid.slot_no < records_per_page_) {
+                const char *data = page_handle.get_slot(rid.slot_no);
+                if (eval_bound_conds(bound_conds_, data) && !emit(rid, data)) {
+                    stopped = true;
+                    break;
+                }
+                rid.slot_no = Bitmap::next_bit(true, page_handle.bitmap, records_per_page_, rid.slot_no);
+            }
+            sm_manager_->get_bpm()->unpin_page(page_handle.page->get_page_id(), false);
+            if (stopped) {
+                scan_->seek(rid);
+                rid_ = rid;
+                return;
+            }
+            scan_->seek_page(rid.page_no + 1);
+        }
+    }
 };
\ No newline at end of file
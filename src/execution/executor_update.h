@@ -9,6 +9,8 @@ MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
 See the Mulan PSL v2 for more details. */
 
 #pragma once
+#include <set>
+
 #include "execution_defs.h"
 #include "execution_manager.h"
 #include "executor_abstract.h"
@@ -37,8 +39,85 @@ class UpdateExecutor : public AbstractExecutor {
         rids_ = rids;
         context_ = context;
     }
+    /**
+     * @brief 更新rids_中的记录：按set子句修改字段，key发生变化的索引先删除旧key再插入新key。
+     * 第一遍计算所有记录修改后的内容和索引key并检查唯一性：新key不能属于rids_以外的记录，rids_中的记录之间
+     * 新key也不能重复。有冲突时抛出IndexEntryExistsError，表和索引都保持不变。第二遍才修改索引和表
+     */
     std::unique_ptr<RmRecord> Next() override {
-        
+        std::vector<ColMeta> set_cols;
+        for (auto &set_clause : set_clauses_) {
+            auto col = tab_.get_col(set_clause.lhs.col_name);
+            if (col->type != set_clause.rhs.type) {
+                throw IncompatibleTypeError(coltype2str(col->type), coltype2str(set_clause.rhs.type));
+            }
+            if (set_clause.rhs.raw == nullptr) {
+                set_clause.rhs.init_raw(col->len);
+            }
+            set_cols.push_back(*col);
+        }
+        size_t num_indexes = tab_.indexes.size();
+        std::vector<char> old_rec(fh_->get_file_hdr().record_size);
+        std::vector<std::vector<char>> new_recs(rids_.size());
+        // old_keys[i][r]、new_keys[i][r]为第r条记录在第i个索引上修改前后的key
+        std::vector<std::vector<std::vector<char>>> old_keys(num_indexes), new_keys(num_indexes);
+        std::vector<std::set<std::vector<char>>> seen_keys(num_indexes);
+        std::set<std::pair<int, int>> updating;
+        for (auto &rid : rids_) {
+            updating.insert({rid.page_no, rid.slot_no});
+        }
+        for (size_t r = 0; r < rids_.size(); r++) {
+            fh_->get_record(rids_[r], old_rec.data(), context_);
+            new_recs[r] = old_rec;
+            for (size_t i = 0; i < set_clauses_.size(); i++) {
+                memcpy(new_recs[r].data() + set_cols[i].offset, set_clauses_[i].rhs.raw->data, set_cols[i].len);
+            }
+            for (size_t i = 0; i < num_indexes; i++) {
+                auto &index = tab_.indexes[i];
+                old_keys[i].emplace_back(index.col_tot_len);
+                new_keys[i].emplace_back(index.col_tot_len);
+                make_index_key(index, old_rec.data(), old_keys[i][r].data());
+                make_index_key(index, new_recs[r].data(), new_keys[i][r].data());
+                if (!seen_keys[i].insert(new_keys[i][r]).second) {
+                    throw IndexEntryExistsError();
+                }
+                if (old_keys[i][r] == new_keys[i][r]) {
+                    continue;
+                }
+                // 新key属于rids_中的另一条记录时，那条记录的key一定也会改变，否则上面已经报告重复
+                Rid owner;
+                if (lookup_index_key(sm_manager_, tab_name_, index, new_keys[i][r].data(), &owner, context_->txn_) &&
+                    !updating.count({owner.page_no, owner.slot_no})) {
+                    throw IndexEntryExistsError();
+                }
+            }
+        }
+        // 每个索引先删除所有变化的旧key再插入新key，记录之间交换key时不会和还没删除的旧key冲突
+        for (size_t i = 0; i < num_indexes; i++) {
+            auto &index = tab_.indexes[i];
+            std::string ix_name = sm_manager_->get_ix_manager()->get_index_name(tab_name_, index.cols);
+            auto hash_ih = index.type == INDEX_HASH ? sm_manager_->hash_ihs_.at(ix_name).get() : nullptr;
+            auto ih = index.type == INDEX_HASH ? nullptr : sm_manager_->ihs_.at(ix_name).get();
+            for (size_t r = 0; r < rids_.size(); r++) {
+                if (old_keys[i][r] == new_keys[i][r]) continue;
+                if (hash_ih != nullptr) {
+                    hash_ih->delete_entry(old_keys[i][r].data(), context_->txn_);
+                } else {
+                    ih->delete_entry(old_keys[i][r].data(), context_->txn_);
+                }
+            }
+            for (size_t r = 0; r < rids_.size(); r++) {
+                if (old_keys[i][r] == new_keys[i][r]) continue;
+                if (hash_ih != nullptr) {
+                    hash_ih->insert_entry(new_keys[i][r].data(), rids_[r], context_->txn_);
+                } else {
+                    ih->insert_entry(new_keys[i][r].data(), rids_[r], context_->txn_);
+                }
+            }
+        }
+        for (size_t r = 0; r < rids_.size(); r++) {
+            fh_->update_record(rids_[r], new_recs[r].data(), context_);
+        }
         return nullptr;
     }
 
@@ -0,0 +1,110 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <cassert>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "common/config.h"
+#include "record/rm_defs.h"
+
+/**
+ * 算子之间成批传递的元组：最多capacity条定长的元组按行连续存放在一块可以重复使用的内存中，
+ * 同时记录每条元组的rid(没有对应记录的元组为{RM_NO_PAGE, -1})
+ */
+class TupleBatch {
+   private:
+    size_t tuple_len_ = 0;      // 每条元组的长度
+    size_t capacity_;           // 最多容纳的元组数量
+    size_t size_ = 0;           // 当前的元组数量
+    std::vector<char> data_;    // 元组数据，第i条元组从i * tuple_len_开始
+    std::vector<Rid> rids_;
+
+   public:
+    explicit TupleBatch(size_t capacity = BATCH_SIZE) : capacity_(capacity), rids_(capacity) {}
+
+    /**
+     * @description: 清空并按元组长度准备空间，长度不变时不重新分配内存
+     */
+    void reset(size_t tuple_len) {
+        if (tuple_len != tuple_len_ || data_.size() != tuple_len * capacity_) {
+            tuple_len_ = tuple_len;
+            data_.resize(tuple_len_ * capacity_);
+        }
+        size_ = 0;
+    }
+
+    void reset(size_t tuple_len, size_t capacity) {
+        if (capacity != capacity_) {
+            capacity_ = capacity;
+            rids_.resize(capacity_);
+        }
+        reset(tuple_len);
+    }
+
+    void clear() { size_ = 0; }
+
+    size_t size() const { return size_; }
+
+    size_t capacity() const { return capacity_; }
+
+    size_t tuple_len() const { return tuple_len_; }
+
+    bool empty() const { return size_ == 0; }
+
+    bool full() const { return size_ == capacity_; }
+
+    char *get(size_t idx) { return data_.data() + idx * tuple_len_; }
+
+    const char *get(size_t idx) const { return data_.data() + idx * tuple_len_; }
+
+    Rid &rid(size_t idx) { return rids_[idx]; }
+
+    const Rid &rid(size_t idx) const { return rids_[idx]; }
+
+    /**
+     * @description: 在末尾占用一条元组的位置，由调用者写入元组数据
+     * @return {char*} 新元组的首地址
+     */
+    char *append(const Rid &rid) {
+        assert(!full());
+        rids_[size_] = rid;
+        return get(size_++);
+    }
+
+    void append(const char *tuple, const Rid &rid) { memcpy(append(rid), tuple, tuple_len_); }
+
+    /**
+     * @description: 在末尾占用n条元组的位置，用于整块读入元组，这些元组没有rid
+     * @return {char*} 第一条新元组的首地址
+     */
+    char *append_rows(size_t n) {
+        assert(size_ + n <= capacity_);
+        for (size_t i = size_; i < size_ + n; i++) {
+            rids_[i] = Rid{RM_NO_PAGE, -1};
+        }
+        char *dest = get(size_);
+        size_ += n;
+        return dest;
+    }
+
+    // 撤销最后一次append，用于先写入元组再判断条件的情况
+    void pop_back() {
+        assert(size_ > 0);
+        size_--;
+    }
+
+    std::unique_ptr<RmRecord> to_record(size_t idx) const {
+        return std::make_unique<RmRecord>(tuple_len_, const_cast<char *>(get(idx)));
+    }
+};
@@ -0,0 +1,137 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <cstring>
+#include <vector>
+
+#include "defs.h"
+#include "errors.h"
+
+inline int ix_compare(const char *a, const char *b, ColType type, int col_len) {
+    switch (type) {
+        case TYPE_INT: {
+            int ia = *(int *)a;
+            int ib = *(int *)b;
+            return (ia < ib) ? -1 : ((ia > ib) ? 1 : 0);
+        }
+        case TYPE_FLOAT: {
+            float fa = *(float *)a;
+            float fb = *(float *)b;
+            return (fa < fb) ? -1 : ((fa > fb) ? 1 : 0);
+        }
+        case TYPE_STRING:
+            return memcmp(a, b, col_len);
+        default:
+            throw InternalError("Unexpected data type");
+    }
+}
+
+inline int ix_compare(const char* a, const char* b, const std::vector<ColType>& col_types, const std::vector<int>& col_lens) {
+    int offset = 0;
+    for(size_t i = 0; i < col_types.size(); ++i) {
+        int res = ix_compare(a + offset, b + offset, col_types[i], col_lens[i]);
+        if(res != 0) return res;
+        offset += col_lens[i];
+    }
+    return 0;
+}
+
+/**
+ * @description: 比较索引key的函数，打开索引时根据字段类型绑定。
+ * 常见的字段组合使用按类型展开的模板函数，不需要每次比较都按ColType分支、遍历col_types和col_lens，
+ * 其余组合使用通用的ix_compare
+ */
+class IxKeyComparator {
+   public:
+    IxKeyComparator() = default;
+
+    IxKeyComparator(const std::vector<ColType> &col_types, const std::vector<int> &col_lens) {
+        bind(col_types, col_lens);
+    }
+
+    void bind(const std::vector<ColType> &col_types, const std::vector<int> &col_lens) {
+        col_types_ = col_types;
+        col_lens_ = col_lens;
+        compare_ = &compare_generic;
+        if (match<TYPE_INT>()) compare_ = &compare_typed<TYPE_INT>;
+        else if (match<TYPE_FLOAT>()) compare_ = &compare_typed<TYPE_FLOAT>;
+        else if (match<TYPE_STRING>()) compare_ = &compare_typed<TYPE_STRING>;
+        else if (match<TYPE_INT, TYPE_INT>()) compare_ = &compare_typed<TYPE_INT, TYPE_INT>;
+        else if (match<TYPE_INT, TYPE_FLOAT>()) compare_ = &compare_typed<TYPE_INT, TYPE_FLOAT>;
+        else if (match<TYPE_INT, TYPE_STRING>()) compare_ = &compare_typed<TYPE_INT, TYPE_STRING>;
+        else if (match<TYPE_STRING, TYPE_INT>()) compare_ = &compare_typed<TYPE_STRING, TYPE_INT>;
+        else if (match<TYPE_STRING, TYPE_STRING>()) compare_ = &compare_typed<TYPE_STRING, TYPE_STRING>;
+        else if (match<TYPE_INT, TYPE_INT, TYPE_INT>()) compare_ = &compare_typed<TYPE_INT, TYPE_INT, TYPE_INT>;
+    }
+
+    // 返回值<0、=0、>0分别表示a<b、a=b、a>b
+    int compare(const char *a, const char *b) const { return compare_(a, b, this); }
+
+   private:
+    using CompareFn = int (*)(const char *a, const char *b, const IxKeyComparator *self);
+
+    template <ColType... Types>
+    bool match() const {
+        static constexpr ColType types[] = {Types...};
+        if (col_types_.size() != sizeof...(Types)) return false;
+        for (size_t i = 0; i < col_types_.size(); i++) {
+            if (col_types_[i] != types[i]) return false;
+            // INT和FLOAT按4字节比较，长度不同的字段只能使用通用的比较函数
+            if (types[i] != TYPE_STRING && col_lens_[i] != 4) return false;
+        }
+        return true;
+    }
+
+    template <ColType Type>
+    static int compare_col(const char *a, const char *b, int col_len) {
+        if constexpr (Type == TYPE_INT) {
+            int ia, ib;
+            memcpy(&ia, a, sizeof(int));
+            memcpy(&ib, b, sizeof(int));
+            return (ia < ib) ? -1 : ((ia > ib) ? 1 : 0);
+        } else if constexpr (Type == TYPE_FLOAT) {
+            float fa, fb;
+            memcpy(&fa, a, sizeof(float));
+            memcpy(&fb, b, sizeof(float));
+            return (fa < fb) ? -1 : ((fa > fb) ? 1 : 0);
+        } else {
+            return memcmp(a, b, col_len);
+        }
+    }
+
+    // 依次比较第i个及之后的字段，INT和FLOAT的长度在编译时确定
+    template <size_t I, ColType Type, ColType... Rest>
+    static int compare_from(const char *a, const char *b, const int *col_lens) {
+        constexpr bool fixed = Type != TYPE_STRING;
+        int len = fixed ? 4 : col_lens[I];
+        int res = compare_col<Type>(a, b, len);
+        if constexpr (sizeof...(Rest) == 0) {
+            return res;
+        } else {
+            if (res != 0) return res;
+            return compare_from<I + 1, Rest...>(a + len, b + len, col_lens);
+        }
+    }
+
+    template <ColType... Types>
+    static int compare_typed(const char *a, const char *b, const IxKeyComparator *self) {
+        return compare_from<0, Types...>(a, b, self->col_lens_.data());
+    }
+
+    static int compare_generic(const char *a, const char *b, const IxKeyComparator *self) {
+        return ix_compare(a, b, self->col_types_, self->col_lens_);
+    }
+
+    CompareFn compare_ = &compare_generic;
+    std::vector<ColType> col_types_;
+    std::vector<int> col_lens_;
+};
@@ -13,6 +13,7 @@ See the Mulan PSL v2 for more details. */
 #include <vector>
 
 #include "defs.h"
+#include "ix_comparator.h"
 #include "storage/buffer_pool_manager.h"
 
 constexpr int IX_NO_PAGE = -1;
@@ -21,6 +22,19 @@ constexpr int IX_LEAF_HEADER_PAGE = 1;
 constexpr int IX_INIT_ROOT_PAGE = 2;
 constexpr int IX_INIT_NUM_PAGES = 3;
 constexpr int IX_MAX_COL_LEN = 512;
+// 索引文件格式的版本：1为最初的格式，内部结点和叶子结点保存完整的key；
+// 2在文件头中增加sep_len_和internal_order_，第一个字段为字符串的索引在内部结点中只保存key的前sep_len_个字节
+constexpr int IX_FORMAT_VERSION = 2;
+
+class IxPageHdr {
+public:
+    page_id_t next_free_page_no;    // unused
+    page_id_t parent;               // 父亲节点所在页面的叶号
+    int num_key;                    // # current keys (always equals to #child - 1) 已插入的keys数量，key_idx∈[0,num_key)
+    bool is_leaf;                   // 是否为叶节点
+    page_id_t prev_leaf;            // previous leaf node's page_no, effective only when is_leaf is true
+    page_id_t next_leaf;            // next leaf node's page_no, effective only when is_leaf is true
+};
 
 class IxFileHdr {
 public: 
@@ -37,24 +51,70 @@ public:
     page_id_t first_leaf_;              // 首叶节点对应的页号，在上层IxManager的open函数进行初始化，初始化为root page_no
     page_id_t last_leaf_;               // 尾叶节点对应的页号
     int tot_len_;                       // 记录结构体的整体长度
+    int version_;                       // 索引文件格式的版本，见IX_FORMAT_VERSION
+    int sep_len_;                       // 内部结点中key(分隔key)的长度，小于col_tot_len_时为第一个字段的前缀
+    int internal_order_;                // 内部结点最多可插入的键值对数量
+    IxKeyComparator key_comparator_;    // 按字段类型绑定的key比较函数，不写入磁盘，在deserialize时绑定
 
     IxFileHdr() {
         tot_len_ = col_num_ = 0;
+        version_ = IX_FORMAT_VERSION;
+        sep_len_ = internal_order_ = 0;
     }
 
     IxFileHdr(page_id_t first_free_page_no, int num_pages, page_id_t root_page, int col_num,
                 int col_tot_len, int btree_order, int keys_size, page_id_t first_leaf, page_id_t last_leaf)
                 : first_free_page_no_(first_free_page_no), num_pages_(num_pages), root_page_(root_page), col_num_(col_num),
-                col_tot_len_(col_tot_len), btree_order_(btree_order), keys_size_(keys_size), first_leaf_(first_leaf), last_leaf_(last_leaf) {
+                col_tot_len_(col_tot_len), btree_order_(btree_order), keys_size_(keys_size), first_leaf_(first_leaf), last_leaf_(last_leaf),
+                version_(IX_FORMAT_VERSION), sep_len_(col_tot_len), internal_order_(btree_order) {
                     tot_len_ = 0;
                 } 
 
     void update_tot_len() {
         tot_len_ = 0;
-        tot_len_ += sizeof(page_id_t) * 4 + sizeof(int) * 6;
+        tot_len_ += sizeof(page_id_t) * 4 + sizeof(int) * 9;
         tot_len_ += sizeof(ColType) * col_num_ + sizeof(int) * col_num_;
     }
 
+    /**
+     * @description: 设置内部结点中分隔key的长度，并按页面大小计算内部结点最多可插入的键值对数量
+     * @param {int} sep_len 分隔key的长度，等于col_tot_len_时内部结点保存完整的key
+     * @param {int} page_size 页面大小
+     */
+    void set_sep_len(int sep_len, int page_size) {
+        sep_len_ = sep_len;
+        internal_order_ = static_cast<int>((page_size - sizeof(IxPageHdr)) / (sep_len_ + sizeof(Rid)) - 1);
+    }
+
+    // 内部结点是否只保存key的前缀
+    bool truncates_separators() const { return sep_len_ < col_tot_len_; }
+
+    /**
+     * @description: 比较内部结点中的分隔key和完整的key，只比较分隔key保存的前sep_len_个字节
+     * @return {int} 返回值<0、=0、>0分别表示sep<key、sep与key的前缀相等、sep>key
+     */
+    int compare_separator(const char *sep, const char *key) const {
+        if (!truncates_separators()) {
+            return key_comparator_.compare(sep, key);
+        }
+        return memcmp(sep, key, sep_len_);
+    }
+
+    /**
+     * @description: 为了区分相邻的两个key a<b，分隔key至少需要的长度
+     * @return {int} 第一个字段的公共前缀长度加一；第一个字段相同时需要完整的key，返回col_tot_len_
+     */
+    int separator_len_between(const char *a, const char *b) const {
+        if (col_types_[0] != TYPE_STRING) {
+            return col_tot_len_;
+        }
+        int prefix = 0;
+        while (prefix < col_lens_[0] && a[prefix] == b[prefix]) {
+            prefix++;
+        }
+        return prefix < col_lens_[0] ? prefix + 1 : col_tot_len_;
+    }
+
     void serialize(char* dest) {
         int offset = 0;
         memcpy(dest + offset, &tot_len_, sizeof(int));
@@ -85,6 +145,12 @@ public:
         offset += sizeof(page_id_t);
         memcpy(dest + offset, &last_leaf_, sizeof(page_id_t));
         offset += sizeof(page_id_t);
+        memcpy(dest + offset, &version_, sizeof(int));
+        offset += sizeof(int);
+        memcpy(dest + offset, &sep_len_, sizeof(int));
+        offset += sizeof(int);
+        memcpy(dest + offset, &internal_order_, sizeof(int));
+        offset += sizeof(int);
         assert(offset == tot_len_);
     }
 
@@ -123,20 +189,26 @@ public:
         offset += sizeof(page_id_t);
         last_leaf_ = *reinterpret_cast<const page_id_t*>(src + offset);
         offset += sizeof(page_id_t);
-        assert(offset == tot_len_);
+        if (offset < tot_len_) {
+            version_ = *reinterpret_cast<const int*>(src + offset);
+            offset += sizeof(int);
+            sep_len_ = *reinterpret_cast<const int*>(src + offset);
+            offset += sizeof(int);
+            internal_order_ = *reinterpret_cast<const int*>(src + offset);
+            offset += sizeof(int);
+            assert(offset == tot_len_);
+        } else {
+            assert(offset == tot_len_);
+            // 版本1的文件头没有这几项，内部结点与叶子结点的格式相同，按版本2写回时不需要改动任何结点
+            version_ = IX_FORMAT_VERSION;
+            sep_len_ = col_tot_len_;
+            internal_order_ = btree_order_;
+            update_tot_len();
+        }
+        key_comparator_.bind(col_types_, col_lens_);
     }
 };
 
-class IxPageHdr {
-public:
-    page_id_t next_free_page_no;    // unused
-    page_id_t parent;               // 父亲节点所在页面的叶号
-    int num_key;                    // # current keys (always equals to #child - 1) 已插入的keys数量，key_idx∈[0,num_key)
-    bool is_leaf;                   // 是否为叶节点
-    page_id_t prev_leaf;            // previous leaf node's page_no, effective only when is_leaf is true
-    page_id_t next_leaf;            // next leaf node's page_no, effective only when is_leaf is true
-};
-
 class Iid {
 public:
     int page_no;
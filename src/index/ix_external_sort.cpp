@@ -0,0 +1,251 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "ix_external_sort.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <numeric>
+
+/**
+ * @description: 创建外部排序器
+ * @param {vector<ColType>&} col_types key中每个字段的类型
+ * @param {vector<int>&} col_lens key中每个字段的长度
+ * @param {string&} run_prefix 有序段文件名的前缀，文件名为<run_prefix>.run<i>
+ * @param {size_t} memory_budget 排序使用的内存大小
+ */
+IxExternalSorter::IxExternalSorter(const std::vector<ColType> &col_types, const std::vector<int> &col_lens,
+                                   const std::string &run_prefix, size_t memory_budget)
+    : comparator_(col_types, col_lens), run_prefix_(run_prefix), memory_budget_(memory_budget) {
+    key_len_ = std::accumulate(col_lens.begin(), col_lens.end(), 0);
+    entry_size_ = key_len_ + sizeof(Rid);
+    // 每个键值对在缓冲区中占entry_size_字节，排序时在order_中再占一个下标
+    max_entries_ = std::max<size_t>(memory_budget_ / (entry_size_ + sizeof(size_t)), 1024);
+}
+
+IxExternalSorter::~IxExternalSorter() {
+    readers_.clear();
+    for (auto &path : run_files_) {
+        std::remove(path.c_str());
+    }
+}
+
+/**
+ * @description: 加入一个键值对，内存缓冲区满时写出一个有序段
+ * @param {char*} key 索引包含的字段按顺序拼接而成的key
+ * @param {Rid&} rid 记录的位置
+ */
+void IxExternalSorter::add(const char *key, const Rid &rid) {
+    if (finished_) {
+        throw InternalError("IxExternalSorter::add called after finish");
+    }
+    if (buffer_.empty()) {
+        buffer_.reserve(max_entries_ * entry_size_);
+    }
+    buffer_.insert(buffer_.end(), key, key + key_len_);
+    buffer_.insert(buffer_.end(), reinterpret_cast<const char *>(&rid), reinterpret_cast<const char *>(&rid) + sizeof(Rid));
+    num_entries_++;
+    if (buffer_.size() / entry_size_ >= max_entries_) {
+        spill();
+    }
+}
+
+/**
+ * @description: 结束输入。所有键值对都在内存中时直接排序，否则写出剩余的键值对，
+ * 有序段多于IX_SORT_MERGE_FANIN个时每次归并其中IX_SORT_MERGE_FANIN个，直到可以一趟归并完
+ */
+void IxExternalSorter::finish() {
+    if (finished_) return;
+    finished_ = true;
+    if (runs_.empty()) {
+        order_.resize(buffer_.size() / entry_size_);
+        std::iota(order_.begin(), order_.end(), 0);
+        std::sort(order_.begin(), order_.end(), [this](size_t a, size_t b) {
+            return compare(buffer_.data() + a * entry_size_, buffer_.data() + b * entry_size_) < 0;
+        });
+        return;
+    }
+    if (!buffer_.empty()) {
+        spill();
+    }
+    // 归并阶段不再需要内存缓冲区，把内存平均分给参与归并的有序段
+    std::vector<char>().swap(buffer_);
+    std::vector<size_t>().swap(order_);
+    size_t block_size = std::max<size_t>(memory_budget_ / IX_SORT_MERGE_FANIN / entry_size_, 1) * entry_size_;
+
+    while (runs_.size() > IX_SORT_MERGE_FANIN) {
+        std::vector<std::string> merged;
+        for (size_t start = 0; start < runs_.size(); start += IX_SORT_MERGE_FANIN) {
+            std::vector<std::string> group(runs_.begin() + start,
+                                           runs_.begin() + std::min(start + IX_SORT_MERGE_FANIN, runs_.size()));
+            std::string path = new_run_path();
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            if (!out) {
+                throw UnixError();
+            }
+            init_merge(group, block_size);
+            const char *entry;
+            while (merge_next(&entry)) {
+                out.write(entry, entry_size_);
+            }
+            if (!out) {
+                throw UnixError();
+            }
+            readers_.clear();
+            for (auto &run : group) {
+                std::remove(run.c_str());
+                run_files_.erase(std::find(run_files_.begin(), run_files_.end(), run));
+            }
+            merged.push_back(path);
+        }
+        runs_ = std::move(merged);
+    }
+    init_merge(runs_, block_size);
+}
+
+/**
+ * @description: 按key升序输出下一个键值对，key相同时按Rid升序
+ * @return {bool} 是否还有键值对
+ * @param {char**} key 指向key，下一次调用next之前有效
+ * @param {Rid*} rid 记录的位置
+ */
+bool IxExternalSorter::next(const char **key, Rid *rid) {
+    if (!finished_) {
+        throw InternalError("IxExternalSorter::next called before finish");
+    }
+    const char *entry;
+    if (runs_.empty()) {
+        if (cursor_ >= order_.size()) return false;
+        entry = buffer_.data() + order_[cursor_++] * entry_size_;
+    } else if (!merge_next(&entry)) {
+        return false;
+    }
+    *key = entry;
+    memcpy(rid, entry + key_len_, sizeof(Rid));
+    return true;
+}
+
+/**
+ * @description: 比较两个键值对，先比较key，key相同时比较Rid，保证输出的顺序是确定的
+ */
+int IxExternalSorter::compare(const char *a, const char *b) const {
+    int res = comparator_.compare(a, b);
+    if (res != 0) return res;
+    Rid ra, rb;
+    memcpy(&ra, a + key_len_, sizeof(Rid));
+    memcpy(&rb, b + key_len_, sizeof(Rid));
+    if (ra.page_no != rb.page_no) return ra.page_no < rb.page_no ? -1 : 1;
+    if (ra.slot_no != rb.slot_no) return ra.slot_no < rb.slot_no ? -1 : 1;
+    return 0;
+}
+
+/**
+ * @description: 将内存缓冲区中的键值对排序后写成一个有序段，并清空缓冲区
+ */
+void IxExternalSorter::spill() {
+    size_t num = buffer_.size() / entry_size_;
+    order_.resize(num);
+    std::iota(order_.begin(), order_.end(), 0);
+    std::sort(order_.begin(), order_.end(), [this](size_t a, size_t b) {
+        return compare(buffer_.data() + a * entry_size_, buffer_.data() + b * entry_size_) < 0;
+    });
+
+    std::string path = new_run_path();
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw UnixError();
+    }
+    for (size_t idx : order_) {
+        out.write(buffer_.data() + idx * entry_size_, entry_size_);
+    }
+    if (!out) {
+        throw UnixError();
+    }
+    runs_.push_back(path);
+    buffer_.clear();
+    order_.clear();
+}
+
+std::string IxExternalSorter::new_run_path() {
+    std::string path = run_prefix_ + ".run" + std::to_string(num_runs_written_++);
+    run_files_.push_back(path);
+    return path;
+}
+
+/**
+ * @description: 打开一个有序段，并读入第一个缓冲块
+ */
+std::unique_ptr<IxExternalSorter::RunReader> IxExternalSorter::open_run(const std::string &path, size_t block_size) {
+    auto reader = std::make_unique<RunReader>();
+    reader->path = path;
+    reader->in.open(path, std::ios::binary);
+    if (!reader->in) {
+        throw UnixError();
+    }
+    reader->block.resize(block_size);
+    return reader;
+}
+
+/**
+ * @description: 前进到有序段中的下一个键值对，缓冲块读完时读入下一块。
+ * 缓冲块的大小是键值对长度的整数倍，键值对不会跨越两个缓冲块
+ * @return {bool} 是否还有键值对
+ */
+bool IxExternalSorter::advance(RunReader *reader) {
+    if (reader->len > 0) {
+        reader->pos += entry_size_;
+    }
+    if (reader->pos >= reader->len) {
+        reader->in.read(reader->block.data(), reader->block.size());
+        reader->len = reader->in.gcount();
+        reader->pos = 0;
+    }
+    return reader->pos + entry_size_ <= reader->len;
+}
+
+/**
+ * @description: 打开需要归并的有序段，将每个有序段的第一个键值对放入小根堆
+ */
+void IxExternalSorter::init_merge(const std::vector<std::string> &runs, size_t block_size) {
+    readers_.clear();
+    heap_.clear();
+    last_reader_ = -1;
+    for (auto &path : runs) {
+        readers_.push_back(open_run(path, block_size));
+        if (advance(readers_.back().get())) {
+            heap_.push_back(readers_.size() - 1);
+        }
+    }
+    auto greater = [this](int a, int b) {
+        return compare(readers_[a]->block.data() + readers_[a]->pos, readers_[b]->block.data() + readers_[b]->pos) > 0;
+    };
+    std::make_heap(heap_.begin(), heap_.end(), greater);
+}
+
+/**
+ * @description: 从小根堆中取出最小的键值对。上一次取出的键值对直到这次调用才前进，
+ * 因此返回的指针在下一次调用之前一直有效
+ */
+bool IxExternalSorter::merge_next(const char **entry) {
+    auto greater = [this](int a, int b) {
+        return compare(readers_[a]->block.data() + readers_[a]->pos, readers_[b]->block.data() + readers_[b]->pos) > 0;
+    };
+    if (last_reader_ >= 0 && advance(readers_[last_reader_].get())) {
+        heap_.push_back(last_reader_);
+        std::push_heap(heap_.begin(), heap_.end(), greater);
+    }
+    last_reader_ = -1;
+    if (heap_.empty()) return false;
+    std::pop_heap(heap_.begin(), heap_.end(), greater);
+    last_reader_ = heap_.back();
+    heap_.pop_back();
+    *entry = readers_[last_reader_]->block.data() + readers_[last_reader_]->pos;
+    return true;
+}
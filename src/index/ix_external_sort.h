@@ -0,0 +1,89 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ix_index_handle.h"
+
+/**
+ * @description: 创建索引时对(key, Rid)对进行外部排序。
+ * 键值对按定长格式追加到内存缓冲区中，缓冲区满时排好序写成一个有序段(run)文件；
+ * finish之后按key升序、key相同时按Rid升序依次输出，有序段多于IX_SORT_MERGE_FANIN个时先多趟归并。
+ * 内存中只有一个缓冲区和每个有序段的一个读缓冲块，总大小不超过memory_budget
+ */
+class IxExternalSorter {
+   public:
+    IxExternalSorter(const std::vector<ColType> &col_types, const std::vector<int> &col_lens,
+                     const std::string &run_prefix, size_t memory_budget = IX_SORT_BUFFER_SIZE);
+
+    ~IxExternalSorter();
+
+    void add(const char *key, const Rid &rid);
+
+    void finish();
+
+    bool next(const char **key, Rid *rid);
+
+    // 加入的键值对总数，包括重复的key
+    size_t size() const { return num_entries_; }
+
+    // 写过的有序段文件个数，包括多趟归并产生的中间文件
+    size_t num_runs_written() const { return num_runs_written_; }
+
+   private:
+    // 顺序读取一个有序段文件，每次读入一个缓冲块
+    struct RunReader {
+        std::string path;
+        std::ifstream in;
+        std::vector<char> block;
+        size_t pos = 0;     // 当前键值对在block中的偏移
+        size_t len = 0;     // block中有效数据的长度
+    };
+
+    int compare(const char *a, const char *b) const;
+
+    void spill();
+
+    std::string new_run_path();
+
+    std::unique_ptr<RunReader> open_run(const std::string &path, size_t block_size);
+
+    bool advance(RunReader *reader);
+
+    void init_merge(const std::vector<std::string> &runs, size_t block_size);
+
+    bool merge_next(const char **entry);
+
+    IxKeyComparator comparator_;
+    int key_len_;                               // 所有字段的总长度
+    size_t entry_size_;                         // 每个键值对的长度，key之后紧跟Rid
+    std::string run_prefix_;
+    size_t memory_budget_;
+    size_t max_entries_;                        // 内存缓冲区最多容纳的键值对数量
+
+    std::vector<char> buffer_;                  // 还没有写出的键值对
+    std::vector<size_t> order_;                 // 排序后缓冲区中键值对的下标
+    size_t cursor_ = 0;                         // 没有写出有序段时，下一个输出的键值对在order_中的位置
+
+    std::vector<std::string> runs_;             // 等待归并的有序段文件
+    std::vector<std::string> run_files_;        // 创建过且还没有删除的有序段文件
+    std::vector<std::unique_ptr<RunReader>> readers_;
+    std::vector<int> heap_;                     // 按当前键值对排成小根堆的readers_下标
+    int last_reader_ = -1;                      // 上一次输出的键值对所在的reader，下一次输出前才前进
+
+    size_t num_entries_ = 0;
+    size_t num_runs_written_ = 0;
+    bool finished_ = false;
+};
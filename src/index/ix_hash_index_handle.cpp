@@ -0,0 +1,315 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "ix_hash_index_handle.h"
+
+/**
+ * @brief 打开哈希索引：读入文件头，再通过缓冲池读入目录。新建的索引还没有写过目录，只有一个桶
+ */
+IxHashIndexHandle::IxHashIndexHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd)
+    : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager), fd_(fd) {
+    int page_size = disk_manager_->get_page_size();
+    std::vector<char> buf(page_size);
+    disk_manager_->read_page(fd, IX_FILE_HDR_PAGE, buf.data(), page_size);
+    file_hdr_.deserialize(buf.data());
+    // disk_manager管理的fd对应的文件中，从file_hdr_.num_pages_开始分配page_no
+    disk_manager_->set_fd2pageno(fd, file_hdr_.num_pages_);
+
+    if (file_hdr_.dir_pages_.empty()) {
+        assert(file_hdr_.global_depth_ == 0);
+        dir_.assign(1, IX_HASH_INIT_BUCKET_PAGE);
+        return;
+    }
+    dir_.resize(size_t{1} << file_hdr_.global_depth_);
+    size_t per_page = page_size / sizeof(page_id_t);
+    for (size_t i = 0; i < file_hdr_.dir_pages_.size(); i++) {
+        size_t begin = i * per_page;
+        size_t n = std::min(per_page, dir_.size() - begin);
+        Page *page = buffer_pool_manager_->fetch_page(PageId{fd_, file_hdr_.dir_pages_[i]});
+        memcpy(dir_.data() + begin, page->get_data(), n * sizeof(page_id_t));
+        buffer_pool_manager_->unpin_page(page->get_page_id(), false);
+    }
+}
+
+/**
+ * @brief 计算key的哈希值。哈希值写入了目录的结构，必须与平台和标准库无关，因此使用FNV-1a，
+ * 再用MurmurHash3的finalizer打散低位。FLOAT字段的-0.0和0.0比较时相等，先统一为0.0
+ */
+uint64_t IxHashIndexHandle::hash(const char *key) const {
+    uint64_t h = 14695981039346656037ULL;
+    auto mix = [&h](const char *data, int len) {
+        for (int i = 0; i < len; i++) {
+            h ^= static_cast<unsigned char>(data[i]);
+            h *= 1099511628211ULL;
+        }
+    };
+    int offset = 0;
+    for (int i = 0; i < file_hdr_.col_num_; i++) {
+        int len = file_hdr_.col_lens_[i];
+        if (file_hdr_.col_types_[i] == TYPE_FLOAT) {
+            float f;
+            memcpy(&f, key + offset, sizeof(float));
+            if (f == 0.0f) f = 0.0f;
+            mix(reinterpret_cast<const char *>(&f), sizeof(float));
+        } else {
+            mix(key + offset, len);
+        }
+        offset += len;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+/**
+ * @brief 在一个桶页面中查找key
+ * @return 键值对在页面中的位置，找不到时返回-1
+ */
+int IxHashIndexHandle::find_in_bucket(Page *page, const char *key) const {
+    int n = bucket_hdr(page)->num_entries;
+    for (int i = 0; i < n; i++) {
+        if (file_hdr_.key_comparator_.compare(entry_at(page, i), key) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief 用于查找指定键对应的值，桶的溢出页受桶页面的锁保护。索引中的key唯一，找到一个键值对即可停止
+ * @return 是否找到
+ */
+bool IxHashIndexHandle::get_value(const char *key, std::vector<Rid> *result, Transaction *transaction) {
+    std::shared_lock<std::shared_mutex> lock(dir_latch_);
+    Page *bucket = buffer_pool_manager_->fetch_page(PageId{fd_, dir_[dir_index(hash(key))]});
+    bucket->r_latch();
+    bool found = false;
+    Page *page = bucket;
+    while (true) {
+        int idx = find_in_bucket(page, key);
+        if (idx >= 0) {
+            Rid rid;
+            memcpy(&rid, entry_at(page, idx) + file_hdr_.col_tot_len_, sizeof(Rid));
+            result->push_back(rid);
+            found = true;
+        }
+        page_id_t next = bucket_hdr(page)->overflow;
+        if (page != bucket) {
+            buffer_pool_manager_->unpin_page(page->get_page_id(), false);
+        }
+        if (found || next == IX_NO_PAGE) break;
+        page = buffer_pool_manager_->fetch_page(PageId{fd_, next});
+    }
+    bucket->r_unlatch();
+    buffer_pool_manager_->unpin_page(bucket->get_page_id(), false);
+    return found;
+}
+
+/**
+ * @brief 插入键值对，key已经存在时抛出IndexEntryExistsError，与B+树一致。桶满时独占目录，分裂桶或者链接溢出页之后重试
+ * @return page_id_t 插入到的桶页面的page_no
+ */
+page_id_t IxHashIndexHandle::insert_entry(const char *key, const Rid &value, Transaction *transaction) {
+    page_id_t page_no;
+    bool exists = false;
+    {
+        std::shared_lock<std::shared_mutex> lock(dir_latch_);
+        if (try_insert(key, value, &page_no, &exists)) {
+            return page_no;
+        }
+    }
+    if (exists) {
+        throw IndexEntryExistsError();
+    }
+    std::unique_lock<std::shared_mutex> lock(dir_latch_);
+    while (!try_insert(key, value, &page_no, &exists)) {
+        if (exists) {
+            throw IndexEntryExistsError();
+        }
+        size_t idx = dir_index(hash(key));
+        Page *bucket = buffer_pool_manager_->fetch_page(PageId{fd_, dir_[idx]});
+        int local_depth = bucket_hdr(bucket)->local_depth;
+        if (local_depth < file_hdr_.max_depth_) {
+            buffer_pool_manager_->unpin_page(bucket->get_page_id(), false);
+            split_bucket(idx);
+            continue;
+        }
+        // 目录不能再加倍，在桶的溢出页链表头部加入一个空的溢出页
+        Page *overflow = create_bucket(local_depth);
+        bucket_hdr(overflow)->overflow = bucket_hdr(bucket)->overflow;
+        bucket_hdr(bucket)->overflow = overflow->get_page_id().page_no;
+        buffer_pool_manager_->unpin_page(overflow->get_page_id(), true);
+        buffer_pool_manager_->unpin_page(bucket->get_page_id(), true);
+    }
+    return page_no;
+}
+
+/**
+ * @brief insert_entry的一次尝试，调用者持有dir_latch_。对桶页面加写锁后在整个溢出页链表中查找key，
+ * key不存在时插入到第一个有空位的页面
+ * @param[out] exists key已经存在时设为true，此时不插入
+ * @return 插入成功时返回true，key已经存在或者桶和所有溢出页都满时返回false
+ */
+bool IxHashIndexHandle::try_insert(const char *key, const Rid &value, page_id_t *page_no, bool *exists) {
+    Page *bucket = buffer_pool_manager_->fetch_page(PageId{fd_, dir_[dir_index(hash(key))]});
+    bucket->w_latch();
+    std::vector<Page *> chain = {bucket};
+    while (bucket_hdr(chain.back())->overflow != IX_NO_PAGE) {
+        chain.push_back(buffer_pool_manager_->fetch_page(PageId{fd_, bucket_hdr(chain.back())->overflow}));
+    }
+    Page *target = nullptr;
+    *exists = false;
+    for (Page *page : chain) {
+        if (find_in_bucket(page, key) >= 0) {
+            *exists = true;
+            break;
+        }
+        if (target == nullptr && bucket_hdr(page)->num_entries < file_hdr_.bucket_capacity_) {
+            target = page;
+        }
+    }
+    bool inserted = !*exists && target != nullptr;
+    if (inserted) {
+        IxHashBucketHdr *hdr = bucket_hdr(target);
+        char *entry = entry_at(target, hdr->num_entries);
+        memcpy(entry, key, file_hdr_.col_tot_len_);
+        memcpy(entry + file_hdr_.col_tot_len_, &value, sizeof(Rid));
+        hdr->num_entries++;
+        *page_no = target->get_page_id().page_no;
+    }
+    for (Page *page : chain) {
+        if (page == bucket) {
+            page->w_unlatch();
+        }
+        buffer_pool_manager_->unpin_page(page->get_page_id(), inserted && page == target);
+    }
+    return inserted;
+}
+
+/**
+ * @brief 分裂目录第idx项指向的桶，调用者独占dir_latch_。局部深度等于全局深度时先把目录加倍，
+ * 然后按哈希值的第local_depth位把键值对分到原来的桶和新桶，并修改目录中指向新桶的项
+ */
+void IxHashIndexHandle::split_bucket(size_t idx) {
+    page_id_t page_no = dir_[idx];
+    Page *page = buffer_pool_manager_->fetch_page(PageId{fd_, page_no});
+    IxHashBucketHdr *hdr = bucket_hdr(page);
+    assert(hdr->overflow == IX_NO_PAGE);
+    if (hdr->local_depth == file_hdr_.global_depth_) {
+        dir_.insert(dir_.end(), dir_.begin(), dir_.end());
+        file_hdr_.global_depth_++;
+    }
+    uint64_t bit = uint64_t{1} << hdr->local_depth;
+    hdr->local_depth++;
+    Page *new_page = create_bucket(hdr->local_depth);
+    IxHashBucketHdr *new_hdr = bucket_hdr(new_page);
+
+    size_t entry_size = file_hdr_.col_tot_len_ + sizeof(Rid);
+    int kept = 0;
+    for (int i = 0; i < hdr->num_entries; i++) {
+        char *entry = entry_at(page, i);
+        if (hash(entry) & bit) {
+            memcpy(entry_at(new_page, new_hdr->num_entries++), entry, entry_size);
+        } else {
+            if (kept != i) {
+                memcpy(entry_at(page, kept), entry, entry_size);
+            }
+            kept++;
+        }
+    }
+    hdr->num_entries = kept;
+
+    page_id_t new_page_no = new_page->get_page_id().page_no;
+    for (size_t i = 0; i < dir_.size(); i++) {
+        if (dir_[i] == page_no && (i & bit)) {
+            dir_[i] = new_page_no;
+        }
+    }
+    buffer_pool_manager_->unpin_page(new_page->get_page_id(), true);
+    buffer_pool_manager_->unpin_page(page->get_page_id(), true);
+}
+
+/**
+ * @brief 删除key对应的键值对，用桶中最后一个键值对填补空位。索引中的key唯一，与B+树一样只按key删除
+ * @return 是否删除成功
+ */
+bool IxHashIndexHandle::delete_entry(const char *key, Transaction *transaction) {
+    std::shared_lock<std::shared_mutex> lock(dir_latch_);
+    Page *bucket = buffer_pool_manager_->fetch_page(PageId{fd_, dir_[dir_index(hash(key))]});
+    bucket->w_latch();
+    bool deleted = false;
+    Page *page = bucket;
+    while (true) {
+        int idx = find_in_bucket(page, key);
+        if (idx >= 0) {
+            IxHashBucketHdr *hdr = bucket_hdr(page);
+            hdr->num_entries--;
+            if (idx != hdr->num_entries) {
+                memcpy(entry_at(page, idx), entry_at(page, hdr->num_entries), file_hdr_.col_tot_len_ + sizeof(Rid));
+            }
+            deleted = true;
+        }
+        page_id_t next = bucket_hdr(page)->overflow;
+        if (page != bucket) {
+            buffer_pool_manager_->unpin_page(page->get_page_id(), deleted);
+        }
+        if (deleted || next == IX_NO_PAGE) break;
+        page = buffer_pool_manager_->fetch_page(PageId{fd_, next});
+    }
+    bucket->w_unlatch();
+    buffer_pool_manager_->unpin_page(bucket->get_page_id(), deleted && page == bucket);
+    return deleted;
+}
+
+/**
+ * @brief 把目录写入目录页面，目录变大时分配新的目录页面，并更新文件头中的dir_pages_
+ * @note 目录页面经过缓冲池写回，调用者随后需要写文件头并刷新缓冲池中的页面
+ */
+void IxHashIndexHandle::flush_directory() {
+    std::unique_lock<std::shared_mutex> lock(dir_latch_);
+    size_t per_page = disk_manager_->get_page_size() / sizeof(page_id_t);
+    size_t num_dir_pages = (dir_.size() + per_page - 1) / per_page;
+    for (size_t i = 0; i < num_dir_pages; i++) {
+        Page *page;
+        if (i < file_hdr_.dir_pages_.size()) {
+            page = buffer_pool_manager_->fetch_page(PageId{fd_, file_hdr_.dir_pages_[i]});
+        } else {
+            PageId page_id = {.fd = fd_, .page_no = INVALID_PAGE_ID};
+            page = buffer_pool_manager_->new_page(&page_id);
+            if (page != nullptr) {
+                file_hdr_.num_pages_++;
+                file_hdr_.dir_pages_.push_back(page_id.page_no);
+            }
+        }
+        if (page == nullptr) {
+            throw InternalError("IxHashIndexHandle::flush_directory: no free frame for directory page");
+        }
+        size_t begin = i * per_page;
+        size_t n = std::min(per_page, dir_.size() - begin);
+        memcpy(page->get_data(), dir_.data() + begin, n * sizeof(page_id_t));
+        buffer_pool_manager_->unpin_page(page->get_page_id(), true);
+    }
+    file_hdr_.update_tot_len();
+}
+
+/**
+ * @brief 创建一个空的桶页面，调用者独占dir_latch_或者正在创建索引
+ * @note pin the page, remember to unpin it outside!
+ */
+Page *IxHashIndexHandle::create_bucket(int local_depth) {
+    PageId page_id = {.fd = fd_, .page_no = INVALID_PAGE_ID};
+    Page *page = buffer_pool_manager_->new_page(&page_id);
+    file_hdr_.num_pages_++;
+    *bucket_hdr(page) = {.local_depth = local_depth, .num_entries = 0, .overflow = IX_NO_PAGE};
+    return page;
+}
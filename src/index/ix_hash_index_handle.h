@@ -0,0 +1,170 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <shared_mutex>
+
+#include "ix_defs.h"
+#include "transaction/transaction.h"
+
+constexpr int IX_HASH_INIT_BUCKET_PAGE = 1;
+constexpr int IX_HASH_INIT_NUM_PAGES = 2;
+
+// 桶页面的页头，桶中的键值对紧跟在页头之后，没有顺序
+class IxHashBucketHdr {
+public:
+    int local_depth;                // 桶的局部深度，目录中低local_depth位相同的项指向这个桶
+    int num_entries;                // 桶中键值对的数量
+    page_id_t overflow;             // 溢出页，只在局部深度达到max_depth_后使用，没有时为IX_NO_PAGE
+};
+
+// 哈希索引的文件头，保存在第0页。目录在关闭索引时写入dir_pages_中的页面
+class IxHashFileHdr {
+public:
+    int tot_len_;                       // 文件头序列化后的长度
+    int num_pages_;                     // 磁盘文件中页面的数量
+    int global_depth_;                  // 目录的全局深度，目录有2^global_depth_项
+    int max_depth_;                     // 全局深度的上限，由第0页能记录的目录页面数决定
+    int col_num_;                       // 索引包含的字段数量
+    std::vector<ColType> col_types_;    // 字段的类型
+    std::vector<int> col_lens_;         // 字段的长度
+    int col_tot_len_;                   // 索引包含的字段的总长度
+    int bucket_capacity_;               // 每个桶页面最多可以保存的键值对数量
+    std::vector<page_id_t> dir_pages_;  // 保存目录的页面
+    IxKeyComparator key_comparator_;    // 按字段类型绑定的key比较函数，不写入磁盘，在deserialize时绑定
+
+    IxHashFileHdr() { tot_len_ = num_pages_ = global_depth_ = max_depth_ = col_num_ = col_tot_len_ = bucket_capacity_ = 0; }
+
+    /**
+     * @description: 由索引字段和页面大小初始化文件头：桶页面能放下的键值对数量，以及第0页
+     * 能记录的目录页面数所允许的最大全局深度
+     */
+    void init(const std::vector<ColType> &col_types, const std::vector<int> &col_lens, int page_size) {
+        col_types_ = col_types;
+        col_lens_ = col_lens;
+        col_num_ = col_types.size();
+        col_tot_len_ = 0;
+        for (int len : col_lens) col_tot_len_ += len;
+        num_pages_ = IX_HASH_INIT_NUM_PAGES;
+        global_depth_ = 0;
+        bucket_capacity_ = static_cast<int>((page_size - sizeof(IxHashBucketHdr)) / (col_tot_len_ + sizeof(Rid)));
+        dir_pages_.clear();
+        update_tot_len();
+        size_t max_dir_pages = (page_size - tot_len_) / sizeof(page_id_t);
+        size_t max_entries = max_dir_pages * (page_size / sizeof(page_id_t));
+        max_depth_ = 0;
+        while ((size_t{2} << max_depth_) <= max_entries) max_depth_++;
+        key_comparator_.bind(col_types_, col_lens_);
+    }
+
+    void update_tot_len() {
+        tot_len_ = sizeof(int) * 8 + (sizeof(ColType) + sizeof(int)) * col_num_ + sizeof(page_id_t) * dir_pages_.size();
+    }
+
+    void serialize(char *dest) const {
+        int offset = 0;
+        auto put = [&](const void *src, size_t len) {
+            memcpy(dest + offset, src, len);
+            offset += len;
+        };
+        int num_dir_pages = dir_pages_.size();
+        put(&tot_len_, sizeof(int));
+        put(&num_pages_, sizeof(int));
+        put(&global_depth_, sizeof(int));
+        put(&max_depth_, sizeof(int));
+        put(&col_num_, sizeof(int));
+        put(col_types_.data(), sizeof(ColType) * col_num_);
+        put(col_lens_.data(), sizeof(int) * col_num_);
+        put(&col_tot_len_, sizeof(int));
+        put(&bucket_capacity_, sizeof(int));
+        put(&num_dir_pages, sizeof(int));
+        put(dir_pages_.data(), sizeof(page_id_t) * num_dir_pages);
+        assert(offset == tot_len_);
+    }
+
+    void deserialize(const char *src) {
+        int offset = 0;
+        auto get = [&](void *dest, size_t len) {
+            memcpy(dest, src + offset, len);
+            offset += len;
+        };
+        int num_dir_pages;
+        get(&tot_len_, sizeof(int));
+        get(&num_pages_, sizeof(int));
+        get(&global_depth_, sizeof(int));
+        get(&max_depth_, sizeof(int));
+        get(&col_num_, sizeof(int));
+        col_types_.resize(col_num_);
+        col_lens_.resize(col_num_);
+        get(col_types_.data(), sizeof(ColType) * col_num_);
+        get(col_lens_.data(), sizeof(int) * col_num_);
+        get(&col_tot_len_, sizeof(int));
+        get(&bucket_capacity_, sizeof(int));
+        get(&num_dir_pages, sizeof(int));
+        dir_pages_.resize(num_dir_pages);
+        get(dir_pages_.data(), sizeof(page_id_t) * num_dir_pages);
+        assert(offset == tot_len_);
+        key_comparator_.bind(col_types_, col_lens_);
+    }
+};
+
+/**
+ * 可扩展哈希索引，只支持等值查找。目录常驻内存，桶页面通过缓冲池访问，一次查找只访问一个桶页面。
+ * 桶满时分裂：局部深度等于全局深度时先把目录加倍；全局深度达到max_depth_后不再分裂，改为链接溢出页。
+ * 和B+树一样key唯一，插入已经存在的key时抛出IndexEntryExistsError；删除只从桶中移除键值对，空桶不合并。
+ * 并发控制：查找、插入和删除持有dir_latch_的读锁，并对桶页面加读锁或写锁；
+ * 分裂和链接溢出页独占dir_latch_，此时不会有其他线程访问任何桶页面
+ */
+class IxHashIndexHandle {
+    friend class IxManager;
+
+   private:
+    DiskManager *disk_manager_;
+    BufferPoolManager *buffer_pool_manager_;
+    int fd_;                                    // 存储哈希索引的文件
+    IxHashFileHdr file_hdr_;
+    std::vector<page_id_t> dir_;                // 目录，第i项为低global_depth_位等于i的key所在的桶
+    std::shared_mutex dir_latch_;               // 保护dir_和file_hdr_，分裂时独占
+
+   public:
+    IxHashIndexHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd);
+
+    bool get_value(const char *key, std::vector<Rid> *result, Transaction *transaction);
+
+    page_id_t insert_entry(const char *key, const Rid &value, Transaction *transaction);
+
+    bool delete_entry(const char *key, Transaction *transaction);
+
+    void flush_directory();
+
+    int get_fd() const { return fd_; }
+
+    const IxHashFileHdr &get_file_hdr() const { return file_hdr_; }
+
+   private:
+    uint64_t hash(const char *key) const;
+
+    size_t dir_index(uint64_t hash) const { return hash & ((size_t{1} << file_hdr_.global_depth_) - 1); }
+
+    IxHashBucketHdr *bucket_hdr(Page *page) const { return reinterpret_cast<IxHashBucketHdr *>(page->get_data()); }
+
+    char *entry_at(Page *page, int idx) const {
+        return page->get_data() + sizeof(IxHashBucketHdr) + idx * (file_hdr_.col_tot_len_ + sizeof(Rid));
+    }
+
+    int find_in_bucket(Page *page, const char *key) const;
+
+    Page *create_bucket(int local_depth);
+
+    bool try_insert(const char *key, const Rid &value, page_id_t *page_no, bool *exists);
+
+    void split_bucket(size_t idx);
+};
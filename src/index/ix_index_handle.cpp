@@ -10,20 +10,28 @@ See the Mulan PSL v2 for more details. */
 
 #include "ix_index_handle.h"
 
+#include <algorithm>
+
+#include "ix_external_sort.h"
+#include "ix_node_search.h"
 #include "ix_scan.h"
 
 /**
  * @brief 在当前node中查找第一个>=target的key_idx
  *
  * @return key_idx，范围为[0,num_key)，如果返回的key_idx=num_key，则表示target大于最后一个key
- * @note 返回key index（同时也是rid index），作为slot no
+ * @note 返回key index（同时也是rid index），作为slot no。
+ * 单个INT或FLOAT字段的索引使用SIMD查找(见ix_node_search.h)，其余索引使用二分查找
  */
 int IxNodeHandle::lower_bound(const char *target) const {
-    // Todo:
-    // 查找当前节点中第一个大于等于target的key，并返回key的位置给上层
-    // 提示: 可以采用多种查找方式，如顺序遍历、二分查找等；使用ix_compare()函数进行比较
-
-    return -1;
+    int size = page_hdr->num_key;
+    if (file_hdr->col_num_ == 1 && file_hdr->col_types_[0] == TYPE_INT) {
+        return ix_lower_bound_int(keys, size, *(int *)target);
+    }
+    if (file_hdr->col_num_ == 1 && file_hdr->col_types_[0] == TYPE_FLOAT) {
+        return ix_lower_bound_float(keys, size, *(float *)target);
+    }
+    return search_keys(target, 0, size, false);
 }
 
 /**
@@ -33,11 +41,74 @@ int IxNodeHandle::lower_bound(const char *target) const {
  * @note 注意此处的范围从1开始
  */
 int IxNodeHandle::upper_bound(const char *target) const {
-    // Todo:
-    // 查找当前节点中第一个大于target的key，并返回key的位置给上层
-    // 提示: 可以采用多种查找方式：顺序遍历、二分查找等；使用ix_compare()函数进行比较
+    int size = page_hdr->num_key;
+    if (size <= 1) {
+        return 1;
+    }
+    if (file_hdr->col_num_ == 1 && file_hdr->col_types_[0] == TYPE_INT) {
+        return 1 + ix_upper_bound_int(get_key(1), size - 1, *(int *)target);
+    }
+    if (file_hdr->col_num_ == 1 && file_hdr->col_types_[0] == TYPE_FLOAT) {
+        return 1 + ix_upper_bound_float(get_key(1), size - 1, *(float *)target);
+    }
+    return search_keys(target, 1, size, true);
+}
 
-    return -1;
+/**
+ * @brief 在[left,right)中二分查找第一个>=target的key_idx，upper为true时查找第一个>target的key_idx
+ *
+ * @note 第一个字段为字符串时，记录target与左右边界上的key的公共前缀长度，区间内所有的key与target至少有
+ * 二者中较小的公共前缀，比较时跳过这部分；第一个字段比较出大小后不再比较其余字段。
+ * 内部结点的分隔key被截断时只比较前sep_len_个字节
+ */
+int IxNodeHandle::search_keys(const char *target, int left, int right, bool upper) const {
+    const bool truncated = !page_hdr->is_leaf && file_hdr->truncates_separators();
+    const int first_len = truncated ? file_hdr->sep_len_ : file_hdr->col_lens_[0];
+    const bool skip_prefix = file_hdr->col_types_[0] == TYPE_STRING;
+    int left_prefix = 0;   // target与第left-1个key的公共前缀长度
+    int right_prefix = 0;  // target与第right个key的公共前缀长度
+    while (left < right) {
+        int mid = left + (right - left) / 2;
+        const char *key = get_key(mid);
+        int cmp;
+        int prefix = 0;
+        if (skip_prefix) {
+            prefix = std::min(left_prefix, right_prefix);
+            while (prefix < first_len && key[prefix] == target[prefix]) {
+                prefix++;
+            }
+            cmp = 0;
+            if (prefix < first_len) {
+                cmp = static_cast<unsigned char>(key[prefix]) < static_cast<unsigned char>(target[prefix]) ? -1 : 1;
+            }
+            for (int i = 1, offset = first_len; cmp == 0 && !truncated && i < file_hdr->col_num_;
+                 offset += file_hdr->col_lens_[i++]) {
+                cmp = ix_compare(key + offset, target + offset, file_hdr->col_types_[i], file_hdr->col_lens_[i]);
+            }
+        } else {
+            cmp = file_hdr->key_comparator_.compare(key, target);
+        }
+        if (cmp < 0 || (upper && cmp == 0)) {
+            left = mid + 1;
+            left_prefix = prefix;
+        } else {
+            right = mid;
+            right_prefix = prefix;
+        }
+    }
+    return left;
+}
+
+/**
+ * @brief 比较结点中的第key_idx个key和target，内部结点的分隔key被截断时只比较其保存的前缀
+ *
+ * @return 返回值<0、=0、>0分别表示key<target、key=target(或前缀相等)、key>target
+ */
+int IxNodeHandle::compare_key(int key_idx, const char *target) const {
+    if (page_hdr->is_leaf) {
+        return file_hdr->key_comparator_.compare(get_key(key_idx), target);
+    }
+    return file_hdr->compare_separator(get_key(key_idx), target);
 }
 
 /**
@@ -49,13 +120,12 @@ int IxNodeHandle::upper_bound(const char *target) const {
  * @return 目标key是否存在
  */
 bool IxNodeHandle::leaf_lookup(const char *key, Rid **value) {
-    // Todo:
-    // 1. 在叶子节点中获取目标key所在位置
-    // 2. 判断目标key是否存在
-    // 3. 如果存在，获取key对应的Rid，并赋值给传出参数value
-    // 提示：可以调用lower_bound()和get_rid()函数。
-
-    return false;
+    int key_idx = lower_bound(key);
+    if (key_idx == get_size() || file_hdr->key_comparator_.compare(get_key(key_idx), key) != 0) {
+        return false;
+    }
+    *value = get_rid(key_idx);
+    return true;
 }
 
 /**
@@ -64,12 +134,9 @@ bool IxNodeHandle::leaf_lookup(const char *key, Rid **value) {
  * @return page_id_t 目标key所在的孩子节点（子树）的存储页面编号
  */
 page_id_t IxNodeHandle::internal_lookup(const char *key) {
-    // Todo:
-    // 1. 查找当前非叶子节点中目标key所在孩子节点（子树）的位置
-    // 2. 获取该孩子节点（子树）所在页面的编号
-    // 3. 返回页面编号
-
-    return -1;
+    // upper_bound的结果从1开始，其前一个孩子的第一个key<=目标key，key小于所有key时进入第0个孩子
+    int child_idx = upper_bound(key) - 1;
+    return value_at(child_idx);
 }
 
 /**
@@ -87,12 +154,14 @@ page_id_t IxNodeHandle::internal_lookup(const char *key) {
  *                      key           key_slot
  */
 void IxNodeHandle::insert_pairs(int pos, const char *key, const Rid *rid, int n) {
-    // Todo:
-    // 1. 判断pos的合法性
-    // 2. 通过key获取n个连续键值对的key值，并把n个key值插入到pos位置
-    // 3. 通过rid获取n个连续键值对的rid值，并把n个rid值插入到pos位置
-    // 4. 更新当前节点的键数量
-
+    int size = get_size();
+    assert(pos >= 0 && pos <= size && n >= 0);
+    int len = key_len();
+    memmove(get_key(pos + n), get_key(pos), (size - pos) * len);
+    memcpy(get_key(pos), key, n * len);
+    memmove(get_rid(pos + n), get_rid(pos), (size - pos) * sizeof(Rid));
+    memcpy(get_rid(pos), rid, n * sizeof(Rid));
+    set_size(size + n);
 }
 
 /**
@@ -103,13 +172,12 @@ void IxNodeHandle::insert_pairs(int pos, const char *key, const Rid *rid, int n)
  * @return int 键值对数量
  */
 int IxNodeHandle::insert(const char *key, const Rid &value) {
-    // Todo:
-    // 1. 查找要插入的键值对应该插入到当前节点的哪个位置
-    // 2. 如果key重复则不插入
-    // 3. 如果key不重复则插入键值对
-    // 4. 返回完成插入操作之后的键值对数量
-
-    return -1;
+    int key_idx = lower_bound(key);
+    if (key_idx < get_size() && file_hdr->key_comparator_.compare(get_key(key_idx), key) == 0) {
+        return get_size();
+    }
+    insert_pair(key_idx, key, value);
+    return get_size();
 }
 
 /**
@@ -118,11 +186,11 @@ int IxNodeHandle::insert(const char *key, const Rid &value) {
  * @param pos 要删除键值对的位置
  */
 void IxNodeHandle::erase_pair(int pos) {
-    // Todo:
-    // 1. 删除该位置的key
-    // 2. 删除该位置的rid
-    // 3. 更新结点的键值对数量
-
+    int size = get_size();
+    assert(pos >= 0 && pos < size);
+    memmove(get_key(pos), get_key(pos + 1), (size - pos - 1) * key_len());
+    memmove(get_rid(pos), get_rid(pos + 1), (size - pos - 1) * sizeof(Rid));
+    set_size(size - 1);
 }
 
 /**
@@ -132,23 +200,23 @@ void IxNodeHandle::erase_pair(int pos) {
  * @return 完成删除操作后的键值对数量
  */
 int IxNodeHandle::remove(const char *key) {
-    // Todo:
-    // 1. 查找要删除键值对的位置
-    // 2. 如果要删除的键值对存在，删除键值对
-    // 3. 返回完成删除操作后的键值对数量
-
-    return -1;
+    int key_idx = lower_bound(key);
+    if (key_idx < get_size() && file_hdr->key_comparator_.compare(get_key(key_idx), key) == 0) {
+        erase_pair(key_idx);
+    }
+    return get_size();
 }
 
 IxIndexHandle::IxIndexHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd)
     : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager), fd_(fd) {
     // init file_hdr_
     disk_manager_->read_page(fd, IX_FILE_HDR_PAGE, (char *)&file_hdr_, sizeof(file_hdr_));
-    char* buf = new char[PAGE_SIZE];
-    memset(buf, 0, PAGE_SIZE);
-    disk_manager_->read_page(fd, IX_FILE_HDR_PAGE, buf, PAGE_SIZE);
+    char* buf = new char[disk_manager_->get_page_size()];
+    memset(buf, 0, disk_manager_->get_page_size());
+    disk_manager_->read_page(fd, IX_FILE_HDR_PAGE, buf, disk_manager_->get_page_size());
     file_hdr_ = new IxFileHdr();
     file_hdr_->deserialize(buf);
+    truncates_separators_ = file_hdr_->truncates_separators();
     
     // disk_manager管理的fd对应的文件中，设置从file_hdr_->num_pages开始分配page_no
     int now_page_no = disk_manager_->get_fd2pageno(fd);
@@ -160,18 +228,122 @@ IxIndexHandle::IxIndexHandle(DiskManager *disk_manager, BufferPoolManager *buffe
  * @param key 要查找的目标key值
  * @param operation 查找到目标键值对后要进行的操作类型
  * @param transaction 事务参数，如果不需要则默认传入nullptr
+ * @param find_first 是否忽略key，查找最左边的叶子结点
  * @return [leaf node] and [root_is_latched] 返回目标叶子结点以及根结点是否加锁
  * @note need to Unlatch and unpin the leaf node outside!
  * 注意：用了FindLeafPage之后一定要unlatch叶结点，否则下次latch该结点会堵塞！
+ * 下降时逐层加读锁，获得孩子结点的锁之后释放父结点；FIND操作对叶子加读锁，INSERT和DELETE对叶子加写锁，
+ * 返回时不再持有root_latch_和任何内部结点的锁。
+ * 结点是否为叶子在创建后不再改变，因此可以在加锁前读取，决定对孩子加读锁还是写锁
  */
 std::pair<IxNodeHandle *, bool> IxIndexHandle::find_leaf_page(const char *key, Operation operation,
                                                             Transaction *transaction, bool find_first) {
-    // Todo:
-    // 1. 获取根节点
-    // 2. 从根节点开始不断向下查找目标key
-    // 3. 找到包含该key值的叶子结点停止查找，并返回叶子节点
+    root_latch_.lock_shared();
+    IxNodeHandle *node = fetch_node(file_hdr_->root_page_);
+    if (node->is_leaf_page() && operation != Operation::FIND) {
+        node->page->w_latch();
+    } else {
+        node->page->r_latch();
+    }
+    root_latch_.unlock_shared();
 
-    return std::make_pair(nullptr, false);
+    while (!node->is_leaf_page()) {
+        page_id_t child_page_no = find_first ? node->value_at(0) : node->internal_lookup(key);
+        IxNodeHandle *child = fetch_node(child_page_no);
+        if (child->is_leaf_page() && operation != Operation::FIND) {
+            child->page->w_latch();
+        } else {
+            child->page->r_latch();
+        }
+        node->page->r_unlatch();
+        buffer_pool_manager_->unpin_page(node->get_page_id(), false);
+        delete node;
+        node = child;
+    }
+    return std::make_pair(node, false);
+}
+
+/**
+ * @brief 悲观地查找指定键所在的叶子结点，用于乐观的插入或删除需要修改叶子之外的结点时
+ * @param key 要查找的目标key值
+ * @param operation INSERT或DELETE
+ * @param transaction 事务参数，持有的写锁记录在事务的index_latch_page_set_中
+ * @return [leaf node] and [root_is_latched] 返回目标叶子结点以及是否仍持有root_latch_
+ * @note 从根结点开始逐层加写锁，孩子结点插入或删除后不会分裂、合并时释放其上方的所有结点；
+ * 插入的key小于子树中所有key或删除子树中第一个key时，该结点的key需要通过maintain_parent更新，
+ * 从第一个这样的结点开始不再释放。叶子和所有仍持有的结点都需要在函数外面用release_latches释放
+ */
+std::pair<IxNodeHandle *, bool> IxIndexHandle::find_leaf_page_pessimistic(const char *key, Operation operation,
+                                                                        Transaction *transaction) {
+    auto latch_page_set = transaction->get_index_latch_page_set();
+    root_latch_.lock();
+    latch_page_set->push_back(nullptr);
+
+    IxNodeHandle *node = fetch_node(file_hdr_->root_page_);
+    node->page->w_latch();
+    bool is_root = true;
+    Page *keep = nullptr;  // 需要更新key的最上层结点
+    while (true) {
+        if (is_safe(node, operation, is_root)) {
+            release_latches(transaction, keep);
+        }
+        latch_page_set->push_back(node->page);
+        if (node->is_leaf_page()) {
+            break;
+        }
+        int child_idx = node->upper_bound(key) - 1;
+        int cmp = node->compare_key(child_idx, key);
+        bool update_key = operation == Operation::INSERT ? (child_idx == 0 && cmp > 0) : cmp == 0;
+        if (update_key && keep == nullptr) {
+            keep = node->page;
+        }
+        IxNodeHandle *child = fetch_node(node->value_at(child_idx));
+        child->page->w_latch();
+        delete node;
+        node = child;
+        is_root = false;
+    }
+    bool root_is_latched = !latch_page_set->empty() && latch_page_set->front() == nullptr;
+    return std::make_pair(node, root_is_latched);
+}
+
+/**
+ * @brief 判断结点在插入或删除一个键值对之后是否不需要分裂或合并
+ * @param node 已加锁的结点
+ * @param operation 操作类型
+ * @param is_root node是否为根结点
+ */
+bool IxIndexHandle::is_safe(IxNodeHandle *node, Operation operation, bool is_root) {
+    if (operation == Operation::INSERT) {
+        return node->get_size() + 1 < node->get_max_size();
+    }
+    if (operation == Operation::DELETE) {
+        if (is_root) {
+            // 叶子根结点即使为空也不删除；内部根结点只剩一个孩子时需要调用adjust_root
+            return node->is_leaf_page() || node->get_size() > 2;
+        }
+        return node->get_size() > node->get_min_size();
+    }
+    return true;
+}
+
+/**
+ * @brief 按加锁顺序释放事务持有的索引结点写锁并unpin，nullptr表示root_latch_
+ * @param transaction 事务参数
+ * @param keep 释放到该结点为止，该结点及其下方的结点继续持有；为nullptr时全部释放
+ */
+void IxIndexHandle::release_latches(Transaction *transaction, const Page *keep) {
+    auto latch_page_set = transaction->get_index_latch_page_set();
+    while (!latch_page_set->empty() && (keep == nullptr || latch_page_set->front() != keep)) {
+        Page *page = latch_page_set->front();
+        latch_page_set->pop_front();
+        if (page == nullptr) {
+            root_latch_.unlock();
+            continue;
+        }
+        page->w_unlatch();
+        buffer_pool_manager_->unpin_page(page->get_page_id(), true);
+    }
 }
 
 /**
@@ -183,13 +355,17 @@ std::pair<IxNodeHandle *, bool> IxIndexHandle::find_leaf_page(const char *key, O
  * @return bool 返回目标键值对是否存在
  */
 bool IxIndexHandle::get_value(const char *key, std::vector<Rid> *result, Transaction *transaction) {
-    // Todo:
-    // 1. 获取目标key值所在的叶子结点
-    // 2. 在叶子节点中查找目标key值的位置，并读取key对应的rid
-    // 3. 把rid存入result参数中
-    // 提示：使用完buffer_pool提供的page之后，记得unpin page；记得处理并发的上锁
-
-    return false;
+    auto tree_lock = lock_tree_shared();
+    IxNodeHandle *leaf = find_leaf_page(key, Operation::FIND, transaction).first;
+    Rid *rid;
+    bool found = leaf->leaf_lookup(key, &rid);
+    if (found) {
+        result->push_back(*rid);
+    }
+    leaf->page->r_unlatch();
+    buffer_pool_manager_->unpin_page(leaf->get_page_id(), false);
+    delete leaf;
+    return found;
 }
 
 /**
@@ -200,14 +376,68 @@ bool IxIndexHandle::get_value(const char *key, std::vector<Rid> *result, Transac
  * 注意：本函数执行完毕后，原node和new node都需要在函数外面进行unpin
  */
 IxNodeHandle *IxIndexHandle::split(IxNodeHandle *node) {
-    // Todo:
-    // 1. 将原结点的键值对平均分配，右半部分分裂为新的右兄弟结点
-    //    需要初始化新节点的page_hdr内容
-    // 2. 如果新的右兄弟结点是叶子结点，更新新旧节点的prev_leaf和next_leaf指针
-    //    为新节点分配键值对，更新旧节点的键值对数记录
-    // 3. 如果新的右兄弟结点不是叶子结点，更新该结点的所有孩子结点的父节点信息(使用IxIndexHandle::maintain_child())
+    IxNodeHandle *new_node = create_node();
+    new_node->page_hdr->next_free_page_no = IX_NO_PAGE;
+    new_node->set_leaf(node->is_leaf_page());
+    new_node->page_hdr->prev_leaf = IX_NO_PAGE;
+    new_node->page_hdr->next_leaf = IX_NO_PAGE;
+    new_node->set_parent_page_no(node->get_parent_page_no());
+    new_node->set_size(0);
+
+    int old_size = node->get_size();
+    int split_pos = node->is_leaf_page() ? leaf_split_pos(node) : old_size / 2;
+    assert(split_pos > 0);
+    new_node->insert_pairs(0, node->get_key(split_pos), node->get_rid(split_pos), old_size - split_pos);
+    node->set_size(split_pos);
+
+    if (new_node->is_leaf_page()) {
+        // 右边的叶子只固定不加锁：只有持有其前驱叶子写锁的线程才会修改它的prev_leaf
+        new_node->set_prev_leaf(node->get_page_no());
+        new_node->set_next_leaf(node->get_next_leaf());
+        IxNodeHandle *next = fetch_node(node->get_next_leaf());
+        next->set_prev_leaf(new_node->get_page_no());
+        buffer_pool_manager_->unpin_page(next->get_page_id(), true);
+        delete next;
+        node->set_next_leaf(new_node->get_page_no());
 
-    return nullptr;
+        std::lock_guard<std::mutex> lock(file_hdr_latch_);
+        if (file_hdr_->last_leaf_ == node->get_page_no()) {
+            file_hdr_->last_leaf_ = new_node->get_page_no();
+        }
+    } else {
+        for (int i = 0; i < new_node->get_size(); i++) {
+            maintain_child(new_node, i);
+        }
+    }
+    return new_node;
+}
+
+/**
+ * @brief 选择叶子分裂的位置。内部结点的分隔key被截断时，分裂后两个叶子的边界要能用截断的分隔key区分
+ *
+ * @param leaf 插入后已满的叶子
+ * @return 分裂后右边叶子的第一个键值对的位置，从中间向两边查找，只在中间一半的范围内选择；
+ * 找不到时返回-1，需要先加长分隔key
+ */
+int IxIndexHandle::leaf_split_pos(IxNodeHandle *leaf) {
+    int size = leaf->get_size();
+    int mid = size / 2;
+    int margin = std::max(size / 4, 1);
+    for (int d = 0; mid - d >= margin || mid + d <= size - margin; d++) {
+        for (int pos : {mid - d, mid + d}) {
+            if (pos >= margin && pos <= size - margin && separable(leaf->get_key(pos - 1), leaf->get_key(pos))) {
+                return pos;
+            }
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief 相邻的两个key a<b分别是两个叶子的最后一个和第一个key时，截断的分隔key能否区分它们
+ */
+bool IxIndexHandle::separable(const char *a, const char *b) const {
+    return !file_hdr_->truncates_separators() || memcmp(a, b, file_hdr_->sep_len_) != 0;
 }
 
 /**
@@ -225,12 +455,38 @@ IxNodeHandle *IxIndexHandle::split(IxNodeHandle *node) {
  */
 void IxIndexHandle::insert_into_parent(IxNodeHandle *old_node, const char *key, IxNodeHandle *new_node,
                                      Transaction *transaction) {
-    // Todo:
-    // 1. 分裂前的结点（原结点, old_node）是否为根结点，如果为根结点需要分配新的root
-    // 2. 获取原结点（old_node）的父亲结点
-    // 3. 获取key对应的rid，并将(key, rid)插入到父亲结点
-    // 4. 如果父亲结点仍需要继续分裂，则进行递归插入
-    // 提示：记得unpin page
+    if (old_node->is_root_page()) {
+        // 根结点分裂时持有root_latch_，可以直接修改root_page_
+        IxNodeHandle *root = create_node();
+        root->page_hdr->next_free_page_no = IX_NO_PAGE;
+        root->set_leaf(false);
+        root->page_hdr->prev_leaf = IX_NO_PAGE;
+        root->page_hdr->next_leaf = IX_NO_PAGE;
+        root->set_parent_page_no(IX_NO_PAGE);
+        root->set_size(0);
+        root->insert_pair(0, old_node->get_key(0), Rid{.page_no = old_node->get_page_no(), .slot_no = -1});
+        root->insert_pair(1, key, Rid{.page_no = new_node->get_page_no(), .slot_no = -1});
+        old_node->set_parent_page_no(root->get_page_no());
+        new_node->set_parent_page_no(root->get_page_no());
+        update_root_page_no(root->get_page_no());
+        buffer_pool_manager_->unpin_page(root->get_page_id(), true);
+        delete root;
+        return;
+    }
+
+    // 父结点不安全，已经由本线程加了写锁
+    IxNodeHandle *parent = fetch_node(old_node->get_parent_page_no());
+    int child_idx = parent->find_child(old_node);
+    parent->insert_pair(child_idx + 1, key, Rid{.page_no = new_node->get_page_no(), .slot_no = -1});
+    new_node->set_parent_page_no(parent->get_page_no());
+    if (parent->get_size() == parent->get_max_size()) {
+        IxNodeHandle *new_parent = split(parent);
+        insert_into_parent(parent, new_parent->get_key(0), new_parent, transaction);
+        buffer_pool_manager_->unpin_page(new_parent->get_page_id(), true);
+        delete new_parent;
+    }
+    buffer_pool_manager_->unpin_page(parent->get_page_id(), true);
+    delete parent;
 }
 
 /**
@@ -240,13 +496,87 @@ void IxIndexHandle::insert_into_parent(IxNodeHandle *old_node, const char *key,
  * @return page_id_t 插入到的叶结点的page_no
  */
 page_id_t IxIndexHandle::insert_entry(const char *key, const Rid &value, Transaction *transaction) {
-    // Todo:
-    // 1. 查找key值应该插入到哪个叶子节点
-    // 2. 在该叶子节点中插入键值对
-    // 3. 如果结点已满，分裂结点，并把新结点的相关信息插入父节点
-    // 提示：记得unpin page；若当前叶子节点是最右叶子节点，则需要更新file_hdr_.last_leaf；记得处理并发的上锁
+    Transaction local_txn(INVALID_TXN_ID);
+    if (transaction == nullptr) {
+        transaction = &local_txn;
+    }
 
-    return -1;
+    while (true) {
+        int sep_len = 0;
+        page_id_t page_no;
+        {
+            auto tree_lock = lock_tree_shared();
+            page_no = try_insert_entry(key, value, transaction, &sep_len);
+        }
+        if (sep_len == 0) {
+            return page_no;
+        }
+        // 叶子中没有可以分裂的位置，独占整棵树加长分隔key之后重新插入
+        std::unique_lock<std::shared_mutex> tree_lock(tree_latch_);
+        if (file_hdr_->sep_len_ < sep_len) {
+            rebuild_internal_levels(sep_len);
+        }
+    }
+}
+
+/**
+ * @brief insert_entry的一次尝试，调用者持有tree_latch_的读锁
+ * @param[out] sep_len 叶子需要分裂但截断的分隔key无法区分任何可选的边界时，设为需要的分隔key长度，
+ * 此时不插入，返回INVALID_PAGE_ID；否则不修改
+ * @return page_id_t 插入到的叶结点的page_no
+ */
+page_id_t IxIndexHandle::try_insert_entry(const char *key, const Rid &value, Transaction *transaction,
+                                          int *sep_len) {
+    // 乐观插入：叶子不分裂且不需要更新父结点的key时，只需要叶子的写锁
+    IxNodeHandle *leaf = find_leaf_page(key, Operation::INSERT, transaction).first;
+    int key_idx = leaf->lower_bound(key);
+    bool exists = key_idx < leaf->get_size() &&
+                  file_hdr_->key_comparator_.compare(leaf->get_key(key_idx), key) == 0;
+    if (exists || (is_safe(leaf, Operation::INSERT, leaf->is_root_page()) && (key_idx > 0 || leaf->is_root_page()))) {
+        if (!exists) {
+            leaf->insert_pair(key_idx, key, value);
+        }
+        page_id_t page_no = leaf->get_page_no();
+        leaf->page->w_unlatch();
+        buffer_pool_manager_->unpin_page(leaf->get_page_id(), !exists);
+        delete leaf;
+        return page_no;
+    }
+    leaf->page->w_unlatch();
+    buffer_pool_manager_->unpin_page(leaf->get_page_id(), false);
+    delete leaf;
+
+    leaf = find_leaf_page_pessimistic(key, Operation::INSERT, transaction).first;
+    key_idx = leaf->lower_bound(key);
+    exists = key_idx < leaf->get_size() && file_hdr_->key_comparator_.compare(leaf->get_key(key_idx), key) == 0;
+    if (!exists) {
+        // 父结点中的分隔key是叶子第一个key的前缀，前缀不变时不需要更新上层结点
+        bool first_changed =
+            key_idx == 0 && (leaf->get_size() == 0 || file_hdr_->compare_separator(leaf->get_key(0), key) != 0);
+        leaf->insert_pair(key_idx, key, value);
+        if (leaf->get_size() == leaf->get_max_size() && leaf_split_pos(leaf) < 0) {
+            int mid = leaf->get_size() / 2;
+            *sep_len = std::max(file_hdr_->separator_len_between(leaf->get_key(mid - 1), leaf->get_key(mid)),
+                                std::min(file_hdr_->sep_len_ * 2, file_hdr_->col_lens_[0]));
+            leaf->erase_pair(key_idx);
+            delete leaf;
+            release_latches(transaction);
+            return INVALID_PAGE_ID;
+        }
+        if (first_changed) {
+            maintain_parent(leaf);
+        }
+        if (leaf->get_size() == leaf->get_max_size()) {
+            IxNodeHandle *new_leaf = split(leaf);
+            insert_into_parent(leaf, new_leaf->get_key(0), new_leaf, transaction);
+            buffer_pool_manager_->unpin_page(new_leaf->get_page_id(), true);
+            delete new_leaf;
+        }
+    }
+    page_id_t page_no = leaf->get_page_no();
+    delete leaf;
+    release_latches(transaction);
+    return page_no;
 }
 
 /**
@@ -255,13 +585,56 @@ page_id_t IxIndexHandle::insert_entry(const char *key, const Rid &value, Transac
  * @param transaction 事务指针
  */
 bool IxIndexHandle::delete_entry(const char *key, Transaction *transaction) {
-    // Todo:
-    // 1. 获取该键值对所在的叶子结点
-    // 2. 在该叶子结点中删除键值对
-    // 3. 如果删除成功需要调用CoalesceOrRedistribute来进行合并或重分配操作，并根据函数返回结果判断是否有结点需要删除
-    // 4. 如果需要并发，并且需要删除叶子结点，则需要在事务的delete_page_set中添加删除结点的对应页面；记得处理并发的上锁
+    Transaction local_txn(INVALID_TXN_ID);
+    if (transaction == nullptr) {
+        transaction = &local_txn;
+    }
+    auto tree_lock = lock_tree_shared();
 
-    return false;
+    // 乐观删除：叶子不合并且删除的不是第一个key时，只需要叶子的写锁
+    IxNodeHandle *leaf = find_leaf_page(key, Operation::DELETE, transaction).first;
+    int key_idx = leaf->lower_bound(key);
+    bool exists = key_idx < leaf->get_size() &&
+                  file_hdr_->key_comparator_.compare(leaf->get_key(key_idx), key) == 0;
+    bool is_root = leaf->is_root_page();
+    if (!exists || is_root || (key_idx > 0 && is_safe(leaf, Operation::DELETE, false))) {
+        if (exists) {
+            leaf->erase_pair(key_idx);
+        }
+        leaf->page->w_unlatch();
+        buffer_pool_manager_->unpin_page(leaf->get_page_id(), exists);
+        delete leaf;
+        return exists;
+    }
+    leaf->page->w_unlatch();
+    buffer_pool_manager_->unpin_page(leaf->get_page_id(), false);
+    delete leaf;
+
+    bool root_is_latched;
+    std::tie(leaf, root_is_latched) = find_leaf_page_pessimistic(key, Operation::DELETE, transaction);
+    key_idx = leaf->lower_bound(key);
+    int old_size = leaf->get_size();
+    bool deleted = leaf->remove(key) != old_size;
+    if (deleted) {
+        if (key_idx == 0 && leaf->get_size() > 0) {
+            maintain_parent(leaf);
+        }
+        coalesce_or_redistribute(leaf, transaction, &root_is_latched);
+    }
+    delete leaf;
+
+    // 被删除的结点此时仍被本线程加锁和固定，释放所有写锁之后再从缓冲池删除
+    auto deleted_page_set = transaction->get_index_deleted_page_set();
+    std::vector<PageId> deleted_pages;
+    for (Page *page : *deleted_page_set) {
+        deleted_pages.push_back(page->get_page_id());
+    }
+    deleted_page_set->clear();
+    release_latches(transaction);
+    for (auto &page_id : deleted_pages) {
+        buffer_pool_manager_->delete_page(page_id);
+    }
+    return deleted;
 }
 
 /**
@@ -276,17 +649,39 @@ bool IxIndexHandle::delete_entry(const char *key, Transaction *transaction) {
  * Otherwise, merge(Coalesce).
  */
 bool IxIndexHandle::coalesce_or_redistribute(IxNodeHandle *node, Transaction *transaction, bool *root_is_latched) {
-    // Todo:
-    // 1. 判断node结点是否为根节点
-    //    1.1 如果是根节点，需要调用AdjustRoot() 函数来进行处理，返回根节点是否需要被删除
-    //    1.2 如果不是根节点，并且不需要执行合并或重分配操作，则直接返回false，否则执行2
-    // 2. 获取node结点的父亲结点
-    // 3. 寻找node结点的兄弟结点（优先选取前驱结点）
-    // 4. 如果node结点和兄弟结点的键值对数量之和，能够支撑两个B+树结点（即node.size+neighbor.size >=
-    // NodeMinSize*2)，则只需要重新分配键值对（调用Redistribute函数）
-    // 5. 如果不满足上述条件，则需要合并两个结点，将右边的结点合并到左边的结点（调用Coalesce函数）
+    if (node->is_root_page()) {
+        bool root_deleted = adjust_root(node);
+        if (root_deleted) {
+            transaction->append_index_deleted_page(node->page);
+        }
+        return root_deleted;
+    }
+    if (node->get_size() >= node->get_min_size()) {
+        return false;
+    }
 
-    return false;
+    // 父结点不安全，已经由本线程加了写锁；兄弟结点在持有父结点写锁时加锁，加入事务的latch集合一起释放
+    IxNodeHandle *parent = fetch_node(node->get_parent_page_no());
+    int index = parent->find_child(node);
+    IxNodeHandle *neighbor = fetch_node(parent->value_at(index > 0 ? index - 1 : index + 1));
+    neighbor->page->w_latch();
+    transaction->append_index_latch_page_set(neighbor->page);
+
+    bool node_deleted = false;
+    int total = node->get_size() + neighbor->get_size();
+    bool redistributed = total >= node->get_min_size() * 2 && redistribute(neighbor, node, parent, index);
+    if (!redistributed && total < node->get_max_size()) {
+        // 截断的分隔key不能区分重新分配后的边界时，两个结点放得下就合并，否则node暂时少于半满
+        IxNodeHandle *left = neighbor;
+        IxNodeHandle *right = node;
+        IxNodeHandle *parent_node = parent;
+        coalesce(&left, &right, &parent_node, index, transaction, root_is_latched);
+        node_deleted = index > 0;
+    }
+    buffer_pool_manager_->unpin_page(parent->get_page_id(), true);
+    delete parent;
+    delete neighbor;
+    return node_deleted;
 }
 
 /**
@@ -296,11 +691,18 @@ bool IxIndexHandle::coalesce_or_redistribute(IxNodeHandle *node, Transaction *tr
  * @note size of root page can be less than min size and this method is only called within coalesce_or_redistribute()
  */
 bool IxIndexHandle::adjust_root(IxNodeHandle *old_root_node) {
-    // Todo:
-    // 1. 如果old_root_node是内部结点，并且大小为1，则直接把它的孩子更新成新的根结点
-    // 2. 如果old_root_node是叶结点，且大小为0，则直接更新root page
-    // 3. 除了上述两种情况，不需要进行操作
-
+    if (!old_root_node->is_leaf_page() && old_root_node->get_size() == 1) {
+        // 只剩一个孩子的内部根结点，孩子成为新的根结点；此时持有root_latch_
+        page_id_t child_page_no = old_root_node->remove_and_return_only_child();
+        IxNodeHandle *child = fetch_node(child_page_no);
+        child->set_parent_page_no(IX_NO_PAGE);
+        buffer_pool_manager_->unpin_page(child->get_page_id(), true);
+        delete child;
+        update_root_page_no(child_page_no);
+        release_node_handle(*old_root_node);
+        return true;
+    }
+    // 叶子根结点即使为空也保留，使first_leaf_和last_leaf_始终有效
     return false;
 }
 
@@ -317,13 +719,33 @@ bool IxIndexHandle::adjust_root(IxNodeHandle *old_root_node) {
  * index=0，则neighbor是node后继结点，表示：node(left)      neighbor(right)
  * index>0，则neighbor是node前驱结点，表示：neighbor(left)  node(right)
  * 注意更新parent结点的相关kv对
+ * @return 是否重新分配。叶子之间新的边界不能用截断的分隔key区分时不移动，返回false
  */
-void IxIndexHandle::redistribute(IxNodeHandle *neighbor_node, IxNodeHandle *node, IxNodeHandle *parent, int index) {
-    // Todo:
-    // 1. 通过index判断neighbor_node是否为node的前驱结点
-    // 2. 从neighbor_node中移动一个键值对到node结点中
-    // 3. 更新父节点中的相关信息，并且修改移动键值对对应孩字结点的父结点信息（maintain_child函数）
-    // 注意：neighbor_node的位置不同，需要移动的键值对不同，需要分类讨论
+bool IxIndexHandle::redistribute(IxNodeHandle *neighbor_node, IxNodeHandle *node, IxNodeHandle *parent, int index) {
+    if (node->is_leaf_page()) {
+        int last = neighbor_node->get_size() - 1;
+        bool ok = index == 0 ? separable(neighbor_node->get_key(0), neighbor_node->get_key(1))
+                             : separable(neighbor_node->get_key(last - 1), neighbor_node->get_key(last));
+        if (!ok) {
+            return false;
+        }
+    }
+    if (index == 0) {
+        // node(left) neighbor(right)：把neighbor的第一个键值对移到node的末尾
+        int pos = node->get_size();
+        node->insert_pair(pos, neighbor_node->get_key(0), *neighbor_node->get_rid(0));
+        neighbor_node->erase_pair(0);
+        maintain_child(node, pos);
+        parent->set_key(index + 1, neighbor_node->get_key(0));
+    } else {
+        // neighbor(left) node(right)：把neighbor的最后一个键值对移到node的开头
+        int last = neighbor_node->get_size() - 1;
+        node->insert_pair(0, neighbor_node->get_key(last), *neighbor_node->get_rid(last));
+        neighbor_node->erase_pair(last);
+        maintain_child(node, 0);
+        parent->set_key(index, node->get_key(0));
+    }
+    return true;
 }
 
 /**
@@ -342,13 +764,30 @@ void IxIndexHandle::redistribute(IxNodeHandle *neighbor_node, IxNodeHandle *node
  */
 bool IxIndexHandle::coalesce(IxNodeHandle **neighbor_node, IxNodeHandle **node, IxNodeHandle **parent, int index,
                              Transaction *transaction, bool *root_is_latched) {
-    // Todo:
-    // 1. 用index判断neighbor_node是否为node的前驱结点，若不是则交换两个结点，让neighbor_node作为左结点，node作为右结点
-    // 2. 把node结点的键值对移动到neighbor_node中，并更新node结点孩子结点的父节点信息（调用maintain_child函数）
-    // 3. 释放和删除node结点，并删除parent中node结点的信息，返回parent是否需要被删除
-    // 提示：如果是叶子结点且为最右叶子结点，需要更新file_hdr_.last_leaf
+    if (index == 0) {
+        std::swap(*neighbor_node, *node);
+        index = 1;
+    }
+    IxNodeHandle *left = *neighbor_node;
+    IxNodeHandle *right = *node;
 
-    return false;
+    int pos = left->get_size();
+    left->insert_pairs(pos, right->get_key(0), right->get_rid(0), right->get_size());
+    for (int i = pos; i < left->get_size(); i++) {
+        maintain_child(left, i);
+    }
+    if (right->is_leaf_page()) {
+        erase_leaf(right);
+        std::lock_guard<std::mutex> lock(file_hdr_latch_);
+        if (file_hdr_->last_leaf_ == right->get_page_no()) {
+            file_hdr_->last_leaf_ = left->get_page_no();
+        }
+    }
+    release_node_handle(*right);
+    transaction->append_index_deleted_page(right->page);
+
+    (*parent)->erase_pair(index);
+    return coalesce_or_redistribute(*parent, transaction, root_is_latched);
 }
 
 /**
@@ -362,35 +801,296 @@ bool IxIndexHandle::coalesce(IxNodeHandle **neighbor_node, IxNodeHandle **node,
  */
 Rid IxIndexHandle::get_rid(const Iid &iid) const {
     IxNodeHandle *node = fetch_node(iid.page_no);
+    node->page->r_latch();
     if (iid.slot_no >= node->get_size()) {
+        node->page->r_unlatch();
+        buffer_pool_manager_->unpin_page(node->get_page_id(), false);
+        delete node;
         throw IndexEntryNotFoundError();
     }
+    Rid rid = *node->get_rid(iid.slot_no);
+    node->page->r_unlatch();
     buffer_pool_manager_->unpin_page(node->get_page_id(), false);  // unpin it!
-    return *node->get_rid(iid.slot_no);
+    delete node;
+    return rid;
+}
+
+/**
+ * @brief 由排好序的键值对自底向上构建B+树，用于在已有数据的表上创建索引
+ *
+ * @param sorter 已经调用过finish的外部排序器，索引中的key唯一，有重复的key时抛出IndexEntryExistsError
+ * @param fill_factor 每个结点填充的比例，限制在[0.5, 1]之间
+ * @note 只能在空的B+树上调用，调用期间不能有其他线程访问这棵树。叶子从左到右依次填满，第一个叶子使用原来的根结点；
+ * 每个结点填满后把它的第一个key和页号加入上一层，每层最多固定两个结点。最后每层最右边的结点可能不满，
+ * 此时从左边的兄弟结点移过来一部分键值对，使两个结点大小接近
+ */
+void IxIndexHandle::bulk_load(IxExternalSorter *sorter, double fill_factor) {
+    IxNodeHandle *root = fetch_node(file_hdr_->root_page_);
+    bool empty = root->get_size() == 0 && root->is_leaf_page();
+    buffer_pool_manager_->unpin_page(root->get_page_id(), false);
+    delete root;
+    if (!empty) {
+        throw InternalError("IxIndexHandle::bulk_load: index is not empty");
+    }
+
+    fill_factor = std::min(std::max(fill_factor, 0.5), 1.0);
+
+    std::vector<BulkLoadLevel> levels(1);
+    std::vector<char> last_key(file_hdr_->col_tot_len_);
+    bool has_last = false;
+    const char *key;
+    Rid rid;
+    while (sorter->next(&key, &rid)) {
+        if (has_last && file_hdr_->key_comparator_.compare(key, last_key.data()) == 0) {
+            // 取消固定每层还没有完成的结点，构建了一半的树由调用者删除
+            for (auto &level : levels) {
+                for (IxNodeHandle *node : {level.prev, level.cur}) {
+                    if (node != nullptr) {
+                        buffer_pool_manager_->unpin_page(node->get_page_id(), true);
+                        delete node;
+                    }
+                }
+            }
+            throw IndexEntryExistsError();
+        }
+        memcpy(last_key.data(), key, file_hdr_->col_tot_len_);
+        has_last = true;
+        bulk_load_append(levels, 0, key, rid, fill_factor);
+    }
+    if (levels[0].num_nodes == 0) {
+        return;
+    }
+    bulk_load_finish(levels, fill_factor);
+
+    // 更新leaf header的prev_leaf，使叶子链表首尾相连
+    IxNodeHandle *leaf_header = fetch_node(IX_LEAF_HEADER_PAGE);
+    leaf_header->set_prev_leaf(file_hdr_->last_leaf_);
+    buffer_pool_manager_->unpin_page(leaf_header->get_page_id(), true);
+    delete leaf_header;
+
+    // 内部结点是按原来的分隔key长度构建的，不能区分某些相邻的叶子时加长分隔key重新构建
+    if (levels[0].sep_len > file_hdr_->sep_len_) {
+        rebuild_internal_levels(levels[0].sep_len);
+    }
+}
+
+/**
+ * @brief 从下往上处理每层剩下的结点，只剩一个结点且上面没有其他层时它就是根结点
+ */
+void IxIndexHandle::bulk_load_finish(std::vector<BulkLoadLevel> &levels, double fill_factor) {
+    for (size_t level = 0; level < levels.size(); level++) {
+        IxNodeHandle *prev = levels[level].prev;
+        IxNodeHandle *cur = levels[level].cur;
+        levels[level].prev = levels[level].cur = nullptr;
+        if (prev == nullptr && cur == nullptr) {
+            continue;
+        }
+        if (prev != nullptr && cur != nullptr && cur->get_size() < cur->get_min_size()) {
+            int move = (prev->get_size() + cur->get_size()) / 2 - cur->get_size();
+            int start = prev->get_size() - move;
+            cur->insert_pairs(0, prev->get_key(start), prev->get_rid(start), move);
+            prev->set_size(start);
+            for (int i = 0; i < move; i++) {
+                maintain_child(cur, i);
+            }
+            if (level == 0 && file_hdr_->truncates_separators()) {
+                levels[0].sep_len = std::max(levels[0].sep_len,
+                                             file_hdr_->separator_len_between(prev->get_key(start - 1), cur->get_key(0)));
+            }
+        }
+        if (level + 1 == levels.size() && (prev == nullptr || cur == nullptr)) {
+            IxNodeHandle *node = prev != nullptr ? prev : cur;
+            node->set_parent_page_no(IX_NO_PAGE);
+            update_root_page_no(node->get_page_no());
+            buffer_pool_manager_->unpin_page(node->get_page_id(), true);
+            delete node;
+            break;
+        }
+        if (prev != nullptr) {
+            bulk_load_push_up(levels, level, prev, fill_factor);
+        }
+        if (cur != nullptr) {
+            bulk_load_push_up(levels, level, cur, fill_factor);
+        }
+    }
+}
+
+/**
+ * @brief 为第level层创建一个新结点，叶子结点链接到上一个叶子之后
+ *
+ * @return IxNodeHandle* 新结点，保持固定
+ * @note 第一个叶子使用空的根结点所在的页面
+ */
+IxNodeHandle *IxIndexHandle::bulk_load_create_node(std::vector<BulkLoadLevel> &levels, size_t level) {
+    bool is_leaf = level == 0;
+    IxNodeHandle *node = is_leaf && levels[0].num_nodes == 0 ? fetch_node(file_hdr_->root_page_) : create_node();
+    node->page_hdr->next_free_page_no = IX_NO_PAGE;
+    node->page_hdr->num_key = 0;
+    node->set_leaf(is_leaf);
+    node->set_parent_page_no(IX_NO_PAGE);
+    node->set_next_leaf(IX_NO_PAGE);
+    node->set_prev_leaf(IX_NO_PAGE);
+    if (is_leaf) {
+        // 新叶子创建时，上一个叶子一定是这一层的prev，仍然被固定
+        IxNodeHandle *prev_leaf = levels[0].prev;
+        node->set_prev_leaf(prev_leaf != nullptr ? prev_leaf->get_page_no() : IX_LEAF_HEADER_PAGE);
+        node->set_next_leaf(IX_LEAF_HEADER_PAGE);
+        if (prev_leaf != nullptr) {
+            prev_leaf->set_next_leaf(node->get_page_no());
+        }
+        file_hdr_->last_leaf_ = node->get_page_no();
+    }
+    levels[level].num_nodes++;
+    return node;
+}
+
+/**
+ * @brief 在第level层的最右边加入一个键值对，当前结点达到按fill_factor计算的大小时把上一个填满的结点加入上一层
+ */
+void IxIndexHandle::bulk_load_append(std::vector<BulkLoadLevel> &levels, size_t level, const char *key,
+                                     const Rid &rid, double fill_factor) {
+    if (levels.size() <= level) {
+        levels.resize(level + 1);
+    }
+    if (levels[level].cur == nullptr) {
+        levels[level].cur = bulk_load_create_node(levels, level);
+        // 新叶子的第一个key与上一个叶子的最后一个key之间是一条叶子边界
+        IxNodeHandle *prev = levels[level].prev;
+        if (level == 0 && prev != nullptr && file_hdr_->truncates_separators()) {
+            levels[0].sep_len = std::max(levels[0].sep_len,
+                                         file_hdr_->separator_len_between(prev->get_key(prev->get_size() - 1), key));
+        }
+    }
+    IxNodeHandle *cur = levels[level].cur;
+    cur->insert_pair(cur->get_size(), key, rid);
+    int order = cur->get_max_size() - 1;
+    if (cur->get_size() >= std::max(static_cast<int>(order * fill_factor), (order + 1) / 2)) {
+        IxNodeHandle *prev = levels[level].prev;
+        levels[level].prev = cur;
+        levels[level].cur = nullptr;
+        if (prev != nullptr) {
+            bulk_load_push_up(levels, level, prev, fill_factor);
+        }
+    }
+}
+
+/**
+ * @brief 把第level层的结点node加入上一层，设置它的父结点，然后解除固定
+ */
+void IxIndexHandle::bulk_load_push_up(std::vector<BulkLoadLevel> &levels, size_t level, IxNodeHandle *node,
+                                      double fill_factor) {
+    bulk_load_append(levels, level + 1, node->get_key(0), Rid{.page_no = node->get_page_no(), .slot_no = -1},
+                     fill_factor);
+    // 刚加入的键值对位于上一层正在填充的结点中，该结点恰好填满时它已经成为prev
+    IxNodeHandle *parent = levels[level + 1].cur != nullptr ? levels[level + 1].cur : levels[level + 1].prev;
+    node->set_parent_page_no(parent->get_page_no());
+    buffer_pool_manager_->unpin_page(node->get_page_id(), true);
+    delete node;
+}
+
+/**
+ * @brief 按新的分隔key长度重新构建所有内部结点：沿叶子链表把每个叶子的第一个key加入上一层，再自底向上构建，
+ * 叶子结点不变，原来的内部结点在新的内部结点建好之后删除
+ *
+ * @param sep_len 新的分隔key长度
+ * @note 调用者独占整棵树：持有tree_latch_的写锁，或者在bulk_load中
+ */
+void IxIndexHandle::rebuild_internal_levels(int sep_len) {
+    // 同一层的结点高度相同，某层的第一个结点的第一个孩子是叶子时，这一层是最下面的内部结点
+    std::vector<PageId> old_nodes;
+    std::vector<page_id_t> level_nodes = {file_hdr_->root_page_};
+    while (true) {
+        IxNodeHandle *first = fetch_node(level_nodes[0]);
+        bool is_leaf = first->is_leaf_page();
+        buffer_pool_manager_->unpin_page(first->get_page_id(), false);
+        delete first;
+        if (is_leaf) {
+            break;
+        }
+        std::vector<page_id_t> children;
+        for (page_id_t page_no : level_nodes) {
+            IxNodeHandle *node = fetch_node(page_no);
+            old_nodes.push_back(node->get_page_id());
+            for (int i = 0; i < node->get_size(); i++) {
+                children.push_back(node->value_at(i));
+            }
+            buffer_pool_manager_->unpin_page(node->get_page_id(), false);
+            delete node;
+        }
+        level_nodes = std::move(children);
+    }
+
+    file_hdr_->set_sep_len(sep_len, disk_manager_->get_page_size());
+    IxNodeHandle *leaf = fetch_node(file_hdr_->first_leaf_);
+    if (leaf->get_next_leaf() == IX_LEAF_HEADER_PAGE) {
+        leaf->set_parent_page_no(IX_NO_PAGE);
+        update_root_page_no(leaf->get_page_no());
+        buffer_pool_manager_->unpin_page(leaf->get_page_id(), true);
+        delete leaf;
+    } else {
+        std::vector<BulkLoadLevel> levels(1);
+        while (true) {
+            page_id_t next_leaf = leaf->get_next_leaf();
+            bulk_load_push_up(levels, 0, leaf, IX_BULK_LOAD_FILL_FACTOR);
+            if (next_leaf == IX_LEAF_HEADER_PAGE) {
+                break;
+            }
+            leaf = fetch_node(next_leaf);
+        }
+        bulk_load_finish(levels, IX_BULK_LOAD_FILL_FACTOR);
+    }
+
+    for (auto &page_id : old_nodes) {
+        buffer_pool_manager_->delete_page(page_id);
+    }
+    std::lock_guard<std::mutex> lock(file_hdr_latch_);
+    file_hdr_->num_pages_ -= static_cast<int>(old_nodes.size());
 }
 
 /**
  * @brief FindLeafPage + lower_bound
  *
  * @param key
- * @return Iid
+ * @return Iid 大于等于key的第一个位置，位于叶子末尾时指向下一个叶子的开头
  * @note 上层传入的key本来是int类型，通过(const char *)&key进行了转换
  * 可用*(int *)key转换回去
  */
 Iid IxIndexHandle::lower_bound(const char *key) {
-
-    return Iid{-1, -1};
+    auto tree_lock = lock_tree_shared();
+    IxNodeHandle *leaf = find_leaf_page(key, Operation::FIND, nullptr).first;
+    Iid iid = {.page_no = leaf->get_page_no(), .slot_no = leaf->lower_bound(key)};
+    if (iid.slot_no == leaf->get_size() && leaf->get_next_leaf() != IX_LEAF_HEADER_PAGE) {
+        iid = {.page_no = leaf->get_next_leaf(), .slot_no = 0};
+    }
+    leaf->page->r_unlatch();
+    buffer_pool_manager_->unpin_page(leaf->get_page_id(), false);
+    delete leaf;
+    return iid;
 }
 
 /**
  * @brief FindLeafPage + upper_bound
  *
  * @param key
- * @return Iid
+ * @return Iid 大于key的第一个位置，位于叶子末尾时指向下一个叶子的开头
  */
 Iid IxIndexHandle::upper_bound(const char *key) {
-    
-    return Iid{-1, -1};
+    auto tree_lock = lock_tree_shared();
+    IxNodeHandle *leaf = find_leaf_page(key, Operation::FIND, nullptr).first;
+    // 叶子的第0个key也要参与比较，不能使用从1开始的IxNodeHandle::upper_bound
+    int key_idx = leaf->lower_bound(key);
+    if (key_idx < leaf->get_size() &&
+        file_hdr_->key_comparator_.compare(leaf->get_key(key_idx), key) == 0) {
+        key_idx++;
+    }
+    Iid iid = {.page_no = leaf->get_page_no(), .slot_no = key_idx};
+    if (iid.slot_no == leaf->get_size() && leaf->get_next_leaf() != IX_LEAF_HEADER_PAGE) {
+        iid = {.page_no = leaf->get_next_leaf(), .slot_no = 0};
+    }
+    leaf->page->r_unlatch();
+    buffer_pool_manager_->unpin_page(leaf->get_page_id(), false);
+    delete leaf;
+    return iid;
 }
 
 /**
@@ -400,9 +1100,17 @@ Iid IxIndexHandle::upper_bound(const char *key) {
  * @return Iid
  */
 Iid IxIndexHandle::leaf_end() const {
-    IxNodeHandle *node = fetch_node(file_hdr_->last_leaf_);
-    Iid iid = {.page_no = file_hdr_->last_leaf_, .slot_no = node->get_size()};
+    page_id_t last_leaf;
+    {
+        std::lock_guard<std::mutex> lock(file_hdr_latch_);
+        last_leaf = file_hdr_->last_leaf_;
+    }
+    IxNodeHandle *node = fetch_node(last_leaf);
+    node->page->r_latch();
+    Iid iid = {.page_no = last_leaf, .slot_no = node->get_size()};
+    node->page->r_unlatch();
     buffer_pool_manager_->unpin_page(node->get_page_id(), false);  // unpin it!
+    delete node;
     return iid;
 }
 
@@ -417,6 +1125,16 @@ Iid IxIndexHandle::leaf_begin() const {
     return iid;
 }
 
+/**
+ * @brief 截断分隔key的索引在整个操作期间持有tree_latch_的读锁，加长分隔key时需要独占整棵树；其余索引不加锁
+ */
+std::shared_lock<std::shared_mutex> IxIndexHandle::lock_tree_shared() {
+    if (!truncates_separators_) {
+        return std::shared_lock<std::shared_mutex>();
+    }
+    return std::shared_lock<std::shared_mutex>(tree_latch_);
+}
+
 /**
  * @brief 获取一个指定结点
  *
@@ -443,7 +1161,10 @@ IxNodeHandle *IxIndexHandle::fetch_node(int page_no) const {
  */
 IxNodeHandle *IxIndexHandle::create_node() {
     IxNodeHandle *node;
-    file_hdr_->num_pages_++;
+    {
+        std::lock_guard<std::mutex> lock(file_hdr_latch_);
+        file_hdr_->num_pages_++;
+    }
 
     PageId new_page_id = {.fd = fd_, .page_no = INVALID_PAGE_ID};
     // 从3开始分配page_no，第一次分配之后，new_page_id.page_no=3，file_hdr_.num_pages=4
@@ -453,9 +1174,11 @@ IxNodeHandle *IxIndexHandle::create_node() {
 }
 
 /**
- * @brief 从node开始更新其父节点的第一个key，一直向上更新直到根节点
+ * @brief 从node开始更新其父节点中指向node的key，node是父结点的第一个孩子时继续向上更新
  *
  * @param node
+ * @note 每个结点的第i个key等于第i个孩子子树中最小的key，node不是第一个孩子时上层结点的key不会改变，
+ * 因此只会访问调用者已经加了写锁的结点
  */
 void IxIndexHandle::maintain_parent(IxNodeHandle *node) {
     IxNodeHandle *curr = node;
@@ -465,14 +1188,25 @@ void IxIndexHandle::maintain_parent(IxNodeHandle *node) {
         int rank = parent->find_child(curr);
         char *parent_key = parent->get_key(rank);
         char *child_first_key = curr->get_key(0);
-        if (memcmp(parent_key, child_first_key, file_hdr_->col_tot_len_) == 0) {
-            assert(buffer_pool_manager_->unpin_page(parent->get_page_id(), true));
+        // 父结点中的key可能是截断的分隔key，只比较和复制它保存的长度
+        int key_len = parent->key_len();
+        if (memcmp(parent_key, child_first_key, key_len) == 0) {
+            buffer_pool_manager_->unpin_page(parent->get_page_id(), true);
+            delete parent;
             break;
         }
-        memcpy(parent_key, child_first_key, file_hdr_->col_tot_len_);  // 修改了parent node
+        memcpy(parent_key, child_first_key, key_len);  // 修改了parent node
+        buffer_pool_manager_->unpin_page(parent->get_page_id(), true);
+        if (curr != node) {
+            delete curr;
+        }
         curr = parent;
-
-        assert(buffer_pool_manager_->unpin_page(parent->get_page_id(), true));
+        if (rank != 0) {
+            break;
+        }
+    }
+    if (curr != node) {
+        delete curr;
     }
 }
 
@@ -484,13 +1218,16 @@ void IxIndexHandle::maintain_parent(IxNodeHandle *node) {
 void IxIndexHandle::erase_leaf(IxNodeHandle *leaf) {
     assert(leaf->is_leaf_page());
 
+    // 前驱是合并后保留的左兄弟，已经加了写锁；后继只固定不加锁，见split
     IxNodeHandle *prev = fetch_node(leaf->get_prev_leaf());
     prev->set_next_leaf(leaf->get_next_leaf());
     buffer_pool_manager_->unpin_page(prev->get_page_id(), true);
+    delete prev;
 
     IxNodeHandle *next = fetch_node(leaf->get_next_leaf());
     next->set_prev_leaf(leaf->get_prev_leaf());  // 注意此处是SetPrevLeaf()
     buffer_pool_manager_->unpin_page(next->get_page_id(), true);
+    delete next;
 }
 
 /**
@@ -499,6 +1236,7 @@ void IxIndexHandle::erase_leaf(IxNodeHandle *leaf) {
  * @param node
  */
 void IxIndexHandle::release_node_handle(IxNodeHandle &node) {
+    std::lock_guard<std::mutex> lock(file_hdr_latch_);
     file_hdr_->num_pages_--;
 }
 
@@ -512,5 +1250,6 @@ void IxIndexHandle::maintain_child(IxNodeHandle *node, int child_idx) {
         IxNodeHandle *child = fetch_node(child_page_no);
         child->set_parent_page_no(node->get_page_no());
         buffer_pool_manager_->unpin_page(child->get_page_id(), true);
+        delete child;
     }
 }
\ No newline at end of file
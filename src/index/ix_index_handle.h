@@ -13,38 +13,9 @@ See the Mulan PSL v2 for more details. */
 #include "ix_defs.h"
 #include "transaction/transaction.h"
 
-enum class Operation { FIND = 0, INSERT, DELETE };  // 三种操作：查找、插入、删除
-
-static const bool binary_search = false;
+class IxExternalSorter;
 
-inline int ix_compare(const char *a, const char *b, ColType type, int col_len) {
-    switch (type) {
-        case TYPE_INT: {
-            int ia = *(int *)a;
-            int ib = *(int *)b;
-            return (ia < ib) ? -1 : ((ia > ib) ? 1 : 0);
-        }
-        case TYPE_FLOAT: {
-            float fa = *(float *)a;
-            float fb = *(float *)b;
-            return (fa < fb) ? -1 : ((fa > fb) ? 1 : 0);
-        }
-        case TYPE_STRING:
-            return memcmp(a, b, col_len);
-        default:
-            throw InternalError("Unexpected data type");
-    }
-}
-
-inline int ix_compare(const char* a, const char* b, const std::vector<ColType>& col_types, const std::vector<int>& col_lens) {
-    int offset = 0;
-    for(size_t i = 0; i < col_types.size(); ++i) {
-        int res = ix_compare(a + offset, b + offset, col_types[i], col_lens[i]);
-        if(res != 0) return res;
-        offset += col_lens[i];
-    }
-    return 0;
-}
+enum class Operation { FIND = 0, INSERT, DELETE };  // 三种操作：查找、插入、删除
 
 /* 管理B+树中的每个节点 */
 class IxNodeHandle {
@@ -64,14 +35,25 @@ class IxNodeHandle {
     IxNodeHandle(const IxFileHdr *file_hdr_, Page *page_) : file_hdr(file_hdr_), page(page_) {
         page_hdr = reinterpret_cast<IxPageHdr *>(page->get_data());
         keys = page->get_data() + sizeof(IxPageHdr);
-        rids = reinterpret_cast<Rid *>(keys + file_hdr->keys_size_);
+        init_rids();
+    }
+
+    /**
+     * @brief 设置结点是否为叶子。内部结点的key长度为file_hdr->sep_len_，与叶子的rids起始位置不同，需要重新计算
+     */
+    void set_leaf(bool is_leaf) {
+        page_hdr->is_leaf = is_leaf;
+        init_rids();
     }
 
     int get_size() { return page_hdr->num_key; }
 
     void set_size(int size) { page_hdr->num_key = size; }
 
-    int get_max_size() { return file_hdr->btree_order_ + 1; }
+    int get_max_size() { return (page_hdr->is_leaf ? file_hdr->btree_order_ : file_hdr->internal_order_) + 1; }
+
+    // 结点中每个key的长度，叶子为完整的key，内部结点为分隔key
+    int key_len() const { return page_hdr->is_leaf ? file_hdr->col_tot_len_ : file_hdr->sep_len_; }
 
     int get_min_size() { return get_max_size() / 2; }
 
@@ -86,9 +68,10 @@ class IxNodeHandle {
 
     page_id_t get_next_leaf() { return page_hdr->next_leaf; }
 
-    page_id_t get_prev_leaf() { return page_hdr->prev_leaf; }
+    // 右兄弟叶子的prev_leaf和孩子结点的parent会在不持有该结点latch的情况下被修改，因此用原子操作读写
+    page_id_t get_prev_leaf() { return __atomic_load_n(&page_hdr->prev_leaf, __ATOMIC_RELAXED); }
 
-    page_id_t get_parent_page_no() { return page_hdr->parent; }
+    page_id_t get_parent_page_no() { return __atomic_load_n(&page_hdr->parent, __ATOMIC_RELAXED); }
 
     bool is_leaf_page() { return page_hdr->is_leaf; }
 
@@ -96,15 +79,18 @@ class IxNodeHandle {
 
     void set_next_leaf(page_id_t page_no) { page_hdr->next_leaf = page_no; }
 
-    void set_prev_leaf(page_id_t page_no) { page_hdr->prev_leaf = page_no; }
+    void set_prev_leaf(page_id_t page_no) { __atomic_store_n(&page_hdr->prev_leaf, page_no, __ATOMIC_RELAXED); }
 
-    void set_parent_page_no(page_id_t parent) { page_hdr->parent = parent; }
+    void set_parent_page_no(page_id_t parent) { __atomic_store_n(&page_hdr->parent, parent, __ATOMIC_RELAXED); }
 
-    char *get_key(int key_idx) const { return keys + key_idx * file_hdr->col_tot_len_; }
+    char *get_key(int key_idx) const { return keys + key_idx * key_len(); }
 
     Rid *get_rid(int rid_idx) const { return &rids[rid_idx]; }
 
-    void set_key(int key_idx, const char *key) { memcpy(keys + key_idx * file_hdr->col_tot_len_, key, file_hdr->col_tot_len_); }
+    // 内部结点只复制key的前sep_len_个字节，即截断后的分隔key
+    void set_key(int key_idx, const char *key) { memcpy(keys + key_idx * key_len(), key, key_len()); }
+
+    int compare_key(int key_idx, const char *target) const;
 
     void set_rid(int rid_idx, const Rid &rid) { rids[rid_idx] = rid; }
 
@@ -112,6 +98,8 @@ class IxNodeHandle {
 
     int upper_bound(const char *target) const;
 
+    int search_keys(const char *target, int left, int right, bool upper) const;
+
     void insert_pairs(int pos, const char *key, const Rid *rid, int n);
 
     page_id_t internal_lookup(const char *key);
@@ -155,9 +143,23 @@ class IxNodeHandle {
         assert(rid_idx < page_hdr->num_key);
         return rid_idx;
     }
+
+   private:
+    void init_rids() {
+        int keys_size = page_hdr->is_leaf ? file_hdr->keys_size_ : (file_hdr->internal_order_ + 1) * file_hdr->sep_len_;
+        rids = reinterpret_cast<Rid *>(keys + keys_size);
+    }
 };
 
-/* B+树 */
+/**
+ * B+树
+ * 并发控制采用乐观的latch crabbing：查找时从根结点开始逐层加读锁，拿到孩子的锁后释放父结点；
+ * 插入和删除先按同样的方式下降，只对叶子加写锁，叶子不会分裂、合并且不改变第一个key时直接修改叶子；
+ * 否则释放后重新从根结点加写锁下降，孩子结点安全时释放其上方的所有结点，持有的写锁记录在事务的
+ * index_latch_page_set_中，其中的nullptr表示root_latch_，删除的结点在释放所有写锁之后才从缓冲池删除。
+ * 第一个字段为字符串的索引在内部结点中只保存key的前file_hdr_->sep_len_个字节，每个内部结点可以容纳更多孩子；
+ * 叶子分裂时选择能用截断的key区分的边界，找不到时独占整棵树，加长分隔key并重新构建内部结点
+ */
 class IxIndexHandle {
     friend class IxScan;
     friend class IxManager;
@@ -167,7 +169,10 @@ class IxIndexHandle {
     BufferPoolManager *buffer_pool_manager_;
     int fd_;                                    // 存储B+树的文件
     IxFileHdr* file_hdr_;                       // 存了root_page，但其初始化为2（第0页存FILE_HDR_PAGE，第1页存LEAF_HEADER_PAGE）
-    std::mutex root_latch_;
+    std::shared_mutex root_latch_;              // 保护file_hdr_->root_page_，在获得根结点的latch之后释放
+    mutable std::mutex file_hdr_latch_;         // 保护file_hdr_中的num_pages_和last_leaf_
+    std::shared_mutex tree_latch_;              // 加长分隔key时独占整棵树，只用于截断分隔key的索引
+    bool truncates_separators_;                 // 打开索引时内部结点是否截断分隔key，决定是否使用tree_latch_
 
    public:
     IxIndexHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd);
@@ -178,6 +183,9 @@ class IxIndexHandle {
     std::pair<IxNodeHandle *, bool> find_leaf_page(const char *key, Operation operation, Transaction *transaction,
                                                  bool find_first = false);
 
+    std::pair<IxNodeHandle *, bool> find_leaf_page_pessimistic(const char *key, Operation operation,
+                                                             Transaction *transaction);
+
     // for insert
     page_id_t insert_entry(const char *key, const Rid &value, Transaction *transaction);
 
@@ -192,11 +200,14 @@ class IxIndexHandle {
                                 bool *root_is_latched = nullptr);
     bool adjust_root(IxNodeHandle *old_root_node);
 
-    void redistribute(IxNodeHandle *neighbor_node, IxNodeHandle *node, IxNodeHandle *parent, int index);
+    bool redistribute(IxNodeHandle *neighbor_node, IxNodeHandle *node, IxNodeHandle *parent, int index);
 
     bool coalesce(IxNodeHandle **neighbor_node, IxNodeHandle **node, IxNodeHandle **parent, int index,
                   Transaction *transaction, bool *root_is_latched);
 
+    // for CREATE INDEX
+    void bulk_load(IxExternalSorter *sorter, double fill_factor = IX_BULK_LOAD_FILL_FACTOR);
+
     Iid lower_bound(const char *key);
 
     Iid upper_bound(const char *key);
@@ -206,16 +217,50 @@ class IxIndexHandle {
     Iid leaf_begin() const;
 
    private:
+    // 自底向上构建B+树时的一层
+    struct BulkLoadLevel {
+        IxNodeHandle *prev = nullptr;   // 已经填满、还没有加入上一层的结点
+        IxNodeHandle *cur = nullptr;    // 正在填充的结点
+        int num_nodes = 0;              // 这一层已经创建的结点数
+        int sep_len = 0;                // 只用于叶子层：区分所有相邻叶子需要的分隔key长度
+    };
+
     // 辅助函数
     void update_root_page_no(page_id_t root) { file_hdr_->root_page_ = root; }
 
     bool is_empty() const { return file_hdr_->root_page_ == IX_NO_PAGE; }
 
+    page_id_t try_insert_entry(const char *key, const Rid &value, Transaction *transaction, int *sep_len);
+
+    // for separator truncation
+    int leaf_split_pos(IxNodeHandle *leaf);
+
+    bool separable(const char *a, const char *b) const;
+
+    void rebuild_internal_levels(int sep_len);
+
+    std::shared_lock<std::shared_mutex> lock_tree_shared();
+
+    // for concurrency control
+    bool is_safe(IxNodeHandle *node, Operation operation, bool is_root);
+
+    void release_latches(Transaction *transaction, const Page *keep = nullptr);
+
     // for get/create node
     IxNodeHandle *fetch_node(int page_no) const;
 
     IxNodeHandle *create_node();
 
+    // for bulk load
+    IxNodeHandle *bulk_load_create_node(std::vector<BulkLoadLevel> &levels, size_t level);
+
+    void bulk_load_append(std::vector<BulkLoadLevel> &levels, size_t level, const char *key, const Rid &rid,
+                          double fill_factor);
+
+    void bulk_load_push_up(std::vector<BulkLoadLevel> &levels, size_t level, IxNodeHandle *node, double fill_factor);
+
+    void bulk_load_finish(std::vector<BulkLoadLevel> &levels, double fill_factor);
+
     // for maintain data structure
     void maintain_parent(IxNodeHandle *node);
 
@@ -16,6 +16,7 @@ See the Mulan PSL v2 for more details. */
 #include "system/sm_meta.h"
 #include "ix_defs.h"
 #include "ix_index_handle.h"
+#include "ix_hash_index_handle.h"
 
 class IxManager {
    private:
@@ -62,9 +63,11 @@ class IxManager {
         int fd = disk_manager_->open_file(ix_name);
 
         // Create file header and write to file
-        // Theoretically we have: |page_hdr| + (|attr| + |rid|) * n <= PAGE_SIZE
+        // Theoretically we have: |page_hdr| + (|attr| + |rid|) * n <= page_size
         // but we reserve one slot for convenient inserting and deleting, i.e.
-        // |page_hdr| + (|attr| + |rid|) * (n + 1) <= PAGE_SIZE
+        // |page_hdr| + (|attr| + |rid|) * (n + 1) <= page_size
+        // page_size为当前数据库的页面大小，在创建数据库时确定
+        int page_size = disk_manager_->get_page_size();
         int col_tot_len = 0;
         int col_num = index_cols.size();
         for(auto& col: index_cols) {
@@ -73,9 +76,9 @@ class IxManager {
         if (col_tot_len > IX_MAX_COL_LEN) {
             throw InvalidColLengthError(col_tot_len);
         }
-        // 根据 |page_hdr| + (|attr| + |rid|) * (n + 1) <= PAGE_SIZE 求得n的最大值btree_order
+        // 根据 |page_hdr| + (|attr| + |rid|) * (n + 1) <= page_size 求得n的最大值btree_order
         // 即 n <= btree_order，那么btree_order就是每个结点最多可插入的键值对数量（实际还多留了一个空位，但其不可插入）
-        int btree_order = static_cast<int>((PAGE_SIZE - sizeof(IxPageHdr)) / (col_tot_len + sizeof(Rid)) - 1);
+        int btree_order = static_cast<int>((page_size - sizeof(IxPageHdr)) / (col_tot_len + sizeof(Rid)) - 1);
         assert(btree_order > 2);
 
         // Create file header and write to file
@@ -86,6 +89,10 @@ class IxManager {
             fhdr->col_types_.push_back(index_cols[i].type);
             fhdr->col_lens_.push_back(index_cols[i].len);
         }
+        // 第一个字段为较长的字符串时，内部结点只保存它的前缀，分隔key不够区分相邻的叶子时再加长
+        if (fhdr->col_types_[0] == TYPE_STRING && fhdr->col_lens_[0] > IX_SEPARATOR_INIT_LEN) {
+            fhdr->set_sep_len(IX_SEPARATOR_INIT_LEN, page_size);
+        }
         fhdr->update_tot_len();
         
         char* data = new char[fhdr->tot_len_];
@@ -93,12 +100,12 @@ class IxManager {
 
         disk_manager_->write_page(fd, IX_FILE_HDR_PAGE, data, fhdr->tot_len_);
 
-        char page_buf[PAGE_SIZE];  // 在内存中初始化page_buf中的内容，然后将其写入磁盘
-        memset(page_buf, 0, PAGE_SIZE);
+        std::vector<char> page_buf_storage(page_size);  // 在内存中初始化page_buf中的内容，然后将其写入磁盘
+        char *page_buf = page_buf_storage.data();
         // 注意leaf header页号为1，也标记为叶子结点，其前一个/后一个叶子均指向root node
         // Create leaf list header page and write to file
         {
-            memset(page_buf, 0, PAGE_SIZE);
+            memset(page_buf, 0, page_size);
             auto phdr = reinterpret_cast<IxPageHdr *>(page_buf);
             *phdr = {
                 .next_free_page_no = IX_NO_PAGE,
@@ -108,12 +115,12 @@ class IxManager {
                 .prev_leaf = IX_INIT_ROOT_PAGE,
                 .next_leaf = IX_INIT_ROOT_PAGE,
             };
-            disk_manager_->write_page(fd, IX_LEAF_HEADER_PAGE, page_buf, PAGE_SIZE);
+            disk_manager_->write_page(fd, IX_LEAF_HEADER_PAGE, page_buf, page_size);
         }
         // 注意root node页号为2，也标记为叶子结点，其前一个/后一个叶子均指向leaf header
         // Create root node and write to file
         {
-            memset(page_buf, 0, PAGE_SIZE);
+            memset(page_buf, 0, page_size);
             auto phdr = reinterpret_cast<IxPageHdr *>(page_buf);
             *phdr = {
                 .next_free_page_no = IX_NO_PAGE,
@@ -123,8 +130,8 @@ class IxManager {
                 .prev_leaf = IX_LEAF_HEADER_PAGE,
                 .next_leaf = IX_LEAF_HEADER_PAGE,
             };
-            // Must write PAGE_SIZE here in case of future fetch_node()
-            disk_manager_->write_page(fd, IX_INIT_ROOT_PAGE, page_buf, PAGE_SIZE);
+            // Must write page_size here in case of future fetch_node()
+            disk_manager_->write_page(fd, IX_INIT_ROOT_PAGE, page_buf, page_size);
         }
 
         disk_manager_->set_fd2pageno(fd, IX_INIT_NUM_PAGES - 1);  // DEBUG
@@ -133,6 +140,40 @@ class IxManager {
         disk_manager_->close_file(fd);
     }
 
+    /**
+     * @description: 创建可扩展哈希索引：第0页为文件头，第1页为全局深度为0时唯一的桶
+     */
+    void create_hash_index(const std::string &filename, const std::vector<ColMeta>& index_cols) {
+        std::string ix_name = get_index_name(filename, index_cols);
+        disk_manager_->create_file(ix_name);
+        int fd = disk_manager_->open_file(ix_name);
+
+        int page_size = disk_manager_->get_page_size();
+        std::vector<ColType> col_types;
+        std::vector<int> col_lens;
+        int col_tot_len = 0;
+        for (auto &col : index_cols) {
+            col_types.push_back(col.type);
+            col_lens.push_back(col.len);
+            col_tot_len += col.len;
+        }
+        if (col_tot_len > IX_MAX_COL_LEN) {
+            throw InvalidColLengthError(col_tot_len);
+        }
+        IxHashFileHdr fhdr;
+        fhdr.init(col_types, col_lens, page_size);
+        assert(fhdr.bucket_capacity_ > 1);
+
+        std::vector<char> page_buf(page_size);
+        fhdr.serialize(page_buf.data());
+        disk_manager_->write_page(fd, IX_FILE_HDR_PAGE, page_buf.data(), page_size);
+
+        memset(page_buf.data(), 0, page_size);
+        *reinterpret_cast<IxHashBucketHdr *>(page_buf.data()) = {.local_depth = 0, .num_entries = 0, .overflow = IX_NO_PAGE};
+        disk_manager_->write_page(fd, IX_HASH_INIT_BUCKET_PAGE, page_buf.data(), page_size);
+        disk_manager_->close_file(fd);
+    }
+
     void destroy_index(const std::string &filename, const std::vector<ColMeta>& index_cols) {
         std::string ix_name = get_index_name(filename, index_cols);
         disk_manager_->destroy_file(ix_name);
@@ -156,12 +197,30 @@ class IxManager {
         return std::make_unique<IxIndexHandle>(disk_manager_, buffer_pool_manager_, fd);
     }
 
+    std::unique_ptr<IxHashIndexHandle> open_hash_index(const std::string &filename, const std::vector<ColMeta>& index_cols) {
+        std::string ix_name = get_index_name(filename, index_cols);
+        int fd = disk_manager_->open_file(ix_name);
+        return std::make_unique<IxHashIndexHandle>(disk_manager_, buffer_pool_manager_, fd);
+    }
+
+    void close_hash_index(IxHashIndexHandle *ih) {
+        ih->flush_directory();
+        std::vector<char> data(disk_manager_->get_page_size());
+        ih->file_hdr_.serialize(data.data());
+        disk_manager_->write_page(ih->fd_, IX_FILE_HDR_PAGE, data.data(), ih->file_hdr_.tot_len_);
+        buffer_pool_manager_->flush_all_pages(ih->fd_);
+        buffer_pool_manager_->delete_all_pages(ih->fd_);
+        disk_manager_->close_file(ih->fd_);
+    }
+
     void close_index(const IxIndexHandle *ih) {
         char* data = new char[ih->file_hdr_->tot_len_];
         ih->file_hdr_->serialize(data);
         disk_manager_->write_page(ih->fd_, IX_FILE_HDR_PAGE, data, ih->file_hdr_->tot_len_);
         // 缓冲区的所有页刷到磁盘，注意这句话必须写在close_file前面
         buffer_pool_manager_->flush_all_pages(ih->fd_);
+        // 索引文件可能被删除后重新创建并复用同一个fd，不能在缓冲池中留下它的页面
+        buffer_pool_manager_->delete_all_pages(ih->fd_);
         disk_manager_->close_file(ih->fd_);
     }
 };
\ No newline at end of file
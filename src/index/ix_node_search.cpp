@@ -0,0 +1,147 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "ix_node_search.h"
+
+#include <cstring>
+#include <string>
+
+#include "common/config.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define IX_SEARCH_X86
+#endif
+
+namespace {
+
+template <typename T>
+inline T load_key(const char *keys, int i) {
+    T key;
+    memcpy(&key, keys + i * sizeof(T), sizeof(T));
+    return key;
+}
+
+// lower_bound统计key < target的个数，upper_bound统计!(key > target)的个数，与ix_compare的结果<0、<=0一致
+template <typename T, bool Upper>
+inline bool before(T key, T target) {
+    return Upper ? !(key > target) : key < target;
+}
+
+template <typename T, bool Upper>
+int count_scalar(const char *keys, int n, T target) {
+    int count = 0;
+    for (int i = 0; i < n; i++) {
+        count += before<T, Upper>(load_key<T>(keys, i), target);
+    }
+    return count;
+}
+
+#ifdef IX_SEARCH_X86
+template <bool Upper>
+int count_sse2(const char *keys, int n, int target) {
+    __m128i vt = _mm_set1_epi32(target);
+    int count = 0;
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys + i * sizeof(int)));
+        if (Upper) {
+            count += 4 - __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(v, vt))));
+        } else {
+            count += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmplt_epi32(v, vt))));
+        }
+    }
+    return count + count_scalar<int, Upper>(keys + i * sizeof(int), n - i, target);
+}
+
+template <bool Upper>
+int count_sse2(const char *keys, int n, float target) {
+    __m128 vt = _mm_set1_ps(target);
+    int count = 0;
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 v = _mm_loadu_ps(reinterpret_cast<const float *>(keys + i * sizeof(float)));
+        count += __builtin_popcount(_mm_movemask_ps(Upper ? _mm_cmpngt_ps(v, vt) : _mm_cmplt_ps(v, vt)));
+    }
+    return count + count_scalar<float, Upper>(keys + i * sizeof(float), n - i, target);
+}
+
+template <bool Upper>
+__attribute__((target("avx2"))) int count_avx2(const char *keys, int n, int target) {
+    __m256i vt = _mm256_set1_epi32(target);
+    int count = 0;
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i * sizeof(int)));
+        if (Upper) {
+            count += 8 - __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(v, vt))));
+        } else {
+            count += __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(vt, v))));
+        }
+    }
+    return count + count_scalar<int, Upper>(keys + i * sizeof(int), n - i, target);
+}
+
+template <bool Upper>
+__attribute__((target("avx2"))) int count_avx2(const char *keys, int n, float target) {
+    __m256 vt = _mm256_set1_ps(target);
+    int count = 0;
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_loadu_ps(reinterpret_cast<const float *>(keys + i * sizeof(float)));
+        __m256 mask = Upper ? _mm256_cmp_ps(v, vt, _CMP_NGT_UQ) : _mm256_cmp_ps(v, vt, _CMP_LT_OQ);
+        count += __builtin_popcount(_mm256_movemask_ps(mask));
+    }
+    return count + count_scalar<float, Upper>(keys + i * sizeof(float), n - i, target);
+}
+
+bool cpu_has_avx2() {
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    return has_avx2;
+}
+#endif
+
+template <typename T, bool Upper>
+int count_window(const char *keys, int n, T target) {
+#ifdef IX_SEARCH_X86
+    if (USE_SIMD_KEY_SEARCH) {
+        return cpu_has_avx2() ? count_avx2<Upper>(keys, n, target) : count_sse2<Upper>(keys, n, target);
+    }
+#endif
+    return count_scalar<T, Upper>(keys, n, target);
+}
+
+/**
+ * @description: 在有序数组keys[0, n)中查找第一个不满足before的位置。
+ * 数组有序，满足before的key都在前面，因此窗口中满足before的key的个数就是结果在窗口中的偏移
+ */
+template <typename T, bool Upper>
+int search(const char *keys, int n, T target) {
+    int left = 0, right = n;
+    while (right - left > IX_SIMD_SEARCH_WINDOW) {
+        int mid = left + (right - left) / 2;
+        if (before<T, Upper>(load_key<T>(keys, mid), target)) {
+            left = mid + 1;
+        } else {
+            right = mid;
+        }
+    }
+    return left + count_window<T, Upper>(keys + left * sizeof(T), right - left, target);
+}
+
+}  // namespace
+
+int ix_lower_bound_int(const char *keys, int n, int target) { return search<int, false>(keys, n, target); }
+
+int ix_upper_bound_int(const char *keys, int n, int target) { return search<int, true>(keys, n, target); }
+
+int ix_lower_bound_float(const char *keys, int n, float target) { return search<float, false>(keys, n, target); }
+
+int ix_upper_bound_float(const char *keys, int n, float target) { return search<float, true>(keys, n, target); }
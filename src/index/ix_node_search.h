@@ -0,0 +1,27 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+/**
+ * 单个INT或FLOAT字段的索引结点中，key是连续存放的有序数组，可以用SIMD指令一次比较多个key。
+ * 先用二分查找把范围缩小到IX_SIMD_SEARCH_WINDOW个key以内，再用AVX2(运行时检测)或SSE2统计窗口中
+ * 满足条件的key的个数，非x86平台使用标量实现。比较的语义与ix_compare相同
+ */
+
+// keys[0, n)中第一个 >= target 的位置
+int ix_lower_bound_int(const char *keys, int n, int target);
+
+// keys[0, n)中第一个 > target 的位置
+int ix_upper_bound_int(const char *keys, int n, int target);
+
+int ix_lower_bound_float(const char *keys, int n, float target);
+
+int ix_upper_bound_float(const char *keys, int n, float target);
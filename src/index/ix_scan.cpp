@@ -10,24 +10,128 @@ See the Mulan PSL v2 for more details. */
 
 #include "ix_scan.h"
 
+#include <algorithm>
+
+/**
+ * @brief 创建范围扫描，定位到第一个位于范围内的键值对
+ * @param (lower, upper) 遍历的范围[lower, upper)，通常由IxIndexHandle::lower_bound/upper_bound得到
+ * @param reverse 是否从upper向lower反向遍历
+ * @param with_keys 是否同时复制key，为true时才能调用key()
+ */
+IxScan::IxScan(const IxIndexHandle *ih, const Iid &lower, const Iid &upper, BufferPoolManager *bpm, bool reverse,
+               bool with_keys)
+    : ih_(ih), lower_(lower), upper_(upper), bpm_(bpm), reverse_(reverse), with_keys_(with_keys) {
+    if (lower_ == upper_) {
+        return;
+    }
+    load_leaf(reverse_ ? upper_.page_no : lower_.page_no);
+    if (batch_.empty()) {
+        advance();
+    }
+}
+
+IxScan::~IxScan() { release_leaf(); }
+
 /**
- * @brief 
- * @todo 加上读锁（需要使用缓冲池得到page）
+ * @brief 移动到下一个键值对，当前叶子遍历完时进入下一个有键值对位于范围内的叶子
  */
 void IxScan::next() {
     assert(!is_end());
-    IxNodeHandle *node = ih_->fetch_node(iid_.page_no);
-    assert(node->is_leaf_page());
-    assert(iid_.slot_no < node->get_size());
-    // increment slot no
-    iid_.slot_no++;
-    if (iid_.page_no != ih_->file_hdr_->last_leaf_ && iid_.slot_no == node->get_size()) {
-        // go to next leaf
-        iid_.slot_no = 0;
-        iid_.page_no = node->get_next_leaf();
+    if (++pos_ == batch_.size()) {
+        advance();
+    }
+}
+
+/**
+ * @brief 按批读取：把当前叶子中剩下的Rid加入rids，然后进入下一个叶子
+ * @return 加入的Rid数量，为0表示遍历结束
+ */
+size_t IxScan::next_batch(std::vector<Rid> *rids) {
+    if (is_end()) {
+        return 0;
+    }
+    size_t n = batch_.size() - pos_;
+    rids->insert(rids->end(), batch_.begin() + pos_, batch_.end());
+    pos_ = batch_.size();
+    advance();
+    return n;
+}
+
+/**
+ * @brief 当前键值对的key，指向的内容在进入下一个叶子之前有效
+ */
+const char *IxScan::key() const {
+    assert(with_keys_ && !is_end());
+    size_t idx = reverse_ ? batch_.size() - 1 - pos_ : pos_;
+    return keys_.data() + idx * ih_->file_hdr_->col_tot_len_;
+}
+
+/**
+ * @brief 当前键值对在索引中的位置，遍历结束时正向返回upper，反向返回lower
+ */
+Iid IxScan::iid() const {
+    if (is_end()) {
+        return reverse_ ? lower_ : upper_;
+    }
+    int offset = static_cast<int>(reverse_ ? batch_.size() - 1 - pos_ : pos_);
+    return Iid{.page_no = node_->get_page_no(), .slot_no = first_slot_ + offset};
+}
+
+/**
+ * @brief 依次进入后面的叶子，直到某个叶子中有位于范围内的键值对或者遍历结束
+ */
+void IxScan::advance() {
+    batch_.clear();
+    pos_ = 0;
+    while (batch_.empty() && next_page_ != IX_NO_PAGE) {
+        load_leaf(next_page_);
+    }
+    if (batch_.empty()) {
+        release_leaf();
+    }
+}
+
+/**
+ * @brief 进入叶子page_no：固定该叶子后解除对上一个叶子的固定，在读锁下复制范围内的Rid并记录下一个叶子，
+ * 然后异步预读下一个叶子，使它在当前叶子的Rid被取完之前读入缓冲池
+ */
+void IxScan::load_leaf(page_id_t page_no) {
+    IxNodeHandle *node = ih_->fetch_node(page_no);
+    release_leaf();
+    node_ = node;
+
+    node_->page->r_latch();
+    assert(node_->is_leaf_page());
+    int size = node_->get_size();
+    int lo = page_no == lower_.page_no ? std::min(lower_.slot_no, size) : 0;
+    int hi = page_no == upper_.page_no ? std::min(upper_.slot_no, size) : size;
+    batch_.clear();
+    pos_ = 0;
+    first_slot_ = lo;
+    for (int i = lo; i < hi; i++) {
+        batch_.push_back(*node_->get_rid(i));
+    }
+    if (with_keys_) {
+        int key_len = ih_->file_hdr_->col_tot_len_;
+        keys_.assign(node_->get_key(lo), node_->get_key(lo) + std::max(hi - lo, 0) * key_len);
+    }
+    bool last = page_no == (reverse_ ? lower_.page_no : upper_.page_no);
+    page_id_t next = reverse_ ? node_->get_prev_leaf() : node_->get_next_leaf();
+    next_page_ = last || next == IX_LEAF_HEADER_PAGE ? IX_NO_PAGE : next;
+    node_->page->r_unlatch();
+
+    if (reverse_) {
+        std::reverse(batch_.begin(), batch_.end());
+    }
+    if (next_page_ != IX_NO_PAGE) {
+        bpm_->prefetch_page(PageId{.fd = ih_->fd_, .page_no = next_page_});
     }
 }
 
-Rid IxScan::rid() const {
-    return ih_->get_rid(iid_);
-}
\ No newline at end of file
+void IxScan::release_leaf() {
+    if (node_ != nullptr) {
+        bpm_->unpin_page(node_->get_page_id(), false);
+        delete node_;
+        node_ = nullptr;
+    }
+}
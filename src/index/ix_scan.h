@@ -16,23 +16,50 @@ See the Mulan PSL v2 for more details. */
 // class IxIndexHandle;
 
 // 用于遍历叶子结点
-// 用于直接遍历叶子结点，而不用findleafpage来得到叶子结点
-// TODO：对page遍历时，要加上读锁
+// 用于直接遍历叶子结点，而不用findleafpage来得到叶子结点。当前叶子一直保持固定，进入叶子时加读锁，
+// 把其中位于[lower, upper)的Rid一次复制出来作为一批，之后逐个返回时不再访问缓冲池；同时异步预读下一个叶子。
+// reverse为true时从upper的前一个位置开始沿prev_leaf反向遍历到lower，用于按索引逆序输出。
+// with_keys为true时同时复制key，供只读索引、不回表的扫描使用
 class IxScan : public RecScan {
     const IxIndexHandle *ih_;
-    Iid iid_;  // 初始为lower（用于遍历的指针）
-    Iid end_;  // 初始为upper
+    Iid lower_;
+    Iid upper_;
     BufferPoolManager *bpm_;
+    bool reverse_;
+    bool with_keys_;
+    IxNodeHandle *node_ = nullptr;          // 当前叶子，保持固定直到进入下一个叶子
+    std::vector<Rid> batch_;                // 当前叶子中位于范围内的Rid，反向遍历时按逆序存放
+    std::vector<char> keys_;                // with_keys_为true时batch_对应的key，按叶子中的顺序存放
+    size_t pos_ = 0;                        // 下一个返回的Rid在batch_中的位置，等于batch_.size()时遍历结束
+    int first_slot_ = 0;                    // 当前叶子中第一个位于范围内的slot_no
+    page_id_t next_page_ = IX_NO_PAGE;      // 当前叶子之后要遍历的叶子，没有时为IX_NO_PAGE
 
    public:
-    IxScan(const IxIndexHandle *ih, const Iid &lower, const Iid &upper, BufferPoolManager *bpm)
-        : ih_(ih), iid_(lower), end_(upper), bpm_(bpm) {}
+    IxScan(const IxIndexHandle *ih, const Iid &lower, const Iid &upper, BufferPoolManager *bpm, bool reverse = false,
+           bool with_keys = false);
+
+    ~IxScan() override;
+
+    IxScan(const IxScan &) = delete;
+
+    IxScan &operator=(const IxScan &) = delete;
 
     void next() override;
 
-    bool is_end() const override { return iid_ == end_; }
+    bool is_end() const override { return pos_ == batch_.size(); }
+
+    Rid rid() const override { return batch_[pos_]; }
+
+    const char *key() const;
+
+    size_t next_batch(std::vector<Rid> *rids);
+
+    Iid iid() const;
+
+   private:
+    void load_leaf(page_id_t page_no);
 
-    Rid rid() const override;
+    void advance();
 
-    const Iid &iid() const { return iid_; }
-};
\ No newline at end of file
+    void release_leaf();
+};
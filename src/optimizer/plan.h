@@ -23,6 +23,7 @@ typedef enum PlanTag{
     T_Invalid = 1,
     T_Help,
     T_ShowTable,
+    T_ShowBufferStats,
     T_DescTable,
     T_CreateTable,
     T_DropTable,
@@ -39,6 +40,9 @@ typedef enum PlanTag{
     T_SeqScan,
     T_IndexScan,
     T_NestLoop,
+    T_HashJoin,
+    T_IndexNestLoop,
+    T_MergeJoin,
     T_Sort,
     T_Projection
 } PlanTag;
@@ -54,7 +58,8 @@ public:
 class ScanPlan : public Plan
 {
     public:
-        ScanPlan(PlanTag tag, SmManager *sm_manager, std::string tab_name, std::vector<Condition> conds, std::vector<std::string> index_col_names)
+        ScanPlan(PlanTag tag, SmManager *sm_manager, std::string tab_name, std::vector<Condition> conds, std::vector<std::string> index_col_names,
+                 bool index_only = false)
         {
             Plan::tag = tag;
             tab_name_ = std::move(tab_name);
@@ -64,7 +69,7 @@ class ScanPlan : public Plan
             len_ = cols_.back().offset + cols_.back().len;
             fed_conds_ = conds_;
             index_col_names_ = index_col_names;
-        
+            index_only_ = index_only;
         }
         ~ScanPlan(){}
         // 以下变量同ScanExecutor中的变量
@@ -74,7 +79,8 @@ class ScanPlan : public Plan
         size_t len_;                               
         std::vector<Condition> fed_conds_;
         std::vector<std::string> index_col_names_;
-    
+        bool index_only_;                           // 索引包含查询用到的所有字段，直接从叶子的key生成记录，不回表
+        bool reverse_ = false;                      // 从扫描范围的末尾向前扫描B+树索引，按索引逆序输出(ORDER BY DESC)
 };
 
 class JoinPlan : public Plan
@@ -95,6 +101,8 @@ class JoinPlan : public Plan
         std::shared_ptr<Plan> right_;
         // 连接条件
         std::vector<Condition> conds_;
+        // T_IndexNestLoop时右节点为内表的扫描，连接时查找内表上由这些字段组成的索引
+        std::vector<std::string> index_col_names_;
         // future TODO: 后续可以支持的连接类型
         JoinType type;
         
@@ -159,17 +167,20 @@ class DMLPlan : public Plan
 class DDLPlan : public Plan
 {
     public:
-        DDLPlan(PlanTag tag, std::string tab_name, std::vector<std::string> col_names, std::vector<ColDef> cols)
+        DDLPlan(PlanTag tag, std::string tab_name, std::vector<std::string> col_names, std::vector<ColDef> cols,
+                IndexType index_type = INDEX_BTREE)
         {
             Plan::tag = tag;
             tab_name_ = std::move(tab_name);
             cols_ = std::move(cols);
             tab_col_names_ = std::move(col_names);
+            index_type_ = index_type;
         }
         ~DDLPlan(){}
         std::string tab_name_;
         std::vector<std::string> tab_col_names_;
         std::vector<ColDef> cols_;
+        IndexType index_type_;      // create index语句创建的索引的存储结构
 };
 
 // help; show tables; desc tables; begin; abort; commit; rollback语句对应的plan
@@ -11,6 +11,7 @@ See the Mulan PSL v2 for more details. */
 #include "planner.h"
 
 #include <memory>
+#include <set>
 
 #include "execution/executor_delete.h"
 #include "execution/executor_index_scan.h"
@@ -22,15 +23,147 @@ See the Mulan PSL v2 for more details. */
 #include "index/ix.h"
 #include "record_printer.h"
 
-// 目前的索引匹配规则为：完全匹配索引字段，且全部为单点查询，不会自动调整where条件的顺序
+// 目前的索引匹配规则为：索引的每个字段都有与常量比较的等值条件，不要求where条件的顺序与索引字段一致；
+// 有多个索引可用时选择字段最多的，字段数相同时优先选择哈希索引，等值查找只需要访问一个桶页面
 bool Planner::get_index_cols(std::string tab_name, std::vector<Condition> curr_conds, std::vector<std::string>& index_col_names) {
     index_col_names.clear();
+    std::set<std::string> eq_cols;
     for(auto& cond: curr_conds) {
         if(cond.is_rhs_val && cond.op == OP_EQ && cond.lhs_col.tab_name.compare(tab_name) == 0)
-            index_col_names.push_back(cond.lhs_col.col_name);
+            eq_cols.insert(cond.lhs_col.col_name);
     }
     TabMeta& tab = sm_manager_->db_.get_table(tab_name);
-    if(tab.is_index(index_col_names)) return true;
+    const IndexMeta *best = nullptr;
+    for (auto &index : tab.indexes) {
+        bool usable = std::all_of(index.cols.begin(), index.cols.end(),
+                                  [&](const ColMeta &col) { return eq_cols.count(col.name) > 0; });
+        if (!usable) continue;
+        if (best == nullptr || index.col_num > best->col_num ||
+            (index.col_num == best->col_num && index.type == INDEX_HASH)) {
+            best = &index;
+        }
+    }
+    if (best == nullptr) return false;
+    for (auto &col : best->cols) {
+        index_col_names.push_back(col.name);
+    }
+    return true;
+}
+
+/**
+ * @brief 判断索引是否覆盖select语句在表tab_name上用到的所有字段，即投影、条件(包括连接条件)和排序字段
+ *
+ * @param conds select语句的全部条件
+ * @return 为true时索引扫描可以直接从叶子的key生成记录，不需要回表
+ */
+bool Planner::is_covering_index(std::shared_ptr<Query> query, const std::vector<Condition> &conds,
+                                const std::string &tab_name, const std::vector<std::string> &index_col_names) {
+    auto covered = [&](const TabCol &col) {
+        return col.tab_name != tab_name ||
+               std::find(index_col_names.begin(), index_col_names.end(), col.col_name) != index_col_names.end();
+    };
+    for (auto &col : query->cols) {
+        if (!covered(col)) return false;
+    }
+    for (auto &cond : conds) {
+        if (!covered(cond.lhs_col) || (!cond.is_rhs_val && !covered(cond.rhs_col))) return false;
+    }
+    // 排序字段只按列名匹配，见generate_sort_plan
+    auto x = std::dynamic_pointer_cast<ast::SelectStmt>(query->parse);
+    if (x->has_sort && sm_manager_->db_.get_table(tab_name).is_col(x->order->cols->col_name) &&
+        !covered({.tab_name = tab_name, .col_name = x->order->cols->col_name})) {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 为连接选择内表tab_name上用于查找的索引。索引字段的取值来自与外表字段的等值连接条件(类型和长度相同)
+ * 或内表上的常量等值条件：B+树索引取最左边连续有取值的字段，哈希索引要求所有字段都有取值，
+ * 且至少有一个字段来自连接条件。有多个索引可用时的选择规则同get_index_cols
+ *
+ * @param scan_conds 内表扫描上的条件
+ * @param join_conds 连接条件
+ * @param outer_tables 外表一侧的所有表
+ */
+bool Planner::get_join_index_cols(std::string tab_name, const std::vector<Condition> &scan_conds,
+                                  const std::vector<Condition> &join_conds, const std::set<std::string> &outer_tables,
+                                  std::vector<std::string> &index_col_names) {
+    index_col_names.clear();
+    TabMeta &tab = sm_manager_->db_.get_table(tab_name);
+    std::set<std::string> eq_cols, join_cols;
+    for (auto &cond : scan_conds) {
+        if (cond.is_rhs_val && cond.op == OP_EQ && cond.lhs_col.tab_name == tab_name) eq_cols.insert(cond.lhs_col.col_name);
+    }
+    for (auto &cond : join_conds) {
+        if (cond.is_rhs_val || cond.op != OP_EQ) continue;
+        const TabCol *inner = &cond.lhs_col, *outer = &cond.rhs_col;
+        if (inner->tab_name != tab_name) std::swap(inner, outer);
+        if (inner->tab_name != tab_name || !outer_tables.count(outer->tab_name)) continue;
+        auto inner_col = tab.get_col(inner->col_name);
+        auto outer_col = sm_manager_->db_.get_table(outer->tab_name).get_col(outer->col_name);
+        if (inner_col->type == outer_col->type && inner_col->len == outer_col->len) join_cols.insert(inner->col_name);
+    }
+    const IndexMeta *best = nullptr;
+    size_t best_len = 0;
+    for (auto &index : tab.indexes) {
+        size_t len = 0;
+        bool has_join_col = false;
+        for (auto &col : index.cols) {
+            if (!join_cols.count(col.name) && !eq_cols.count(col.name)) break;
+            has_join_col |= join_cols.count(col.name) > 0;
+            len++;
+        }
+        if (!has_join_col || (index.type == INDEX_HASH && len != index.cols.size())) continue;
+        if (best == nullptr || len > best_len || (len == best_len && index.type == INDEX_HASH)) {
+            best = &index;
+            best_len = len;
+        }
+    }
+    if (best == nullptr) return false;
+    for (auto &col : best->cols) {
+        index_col_names.push_back(col.name);
+    }
+    return true;
+}
+
+/**
+ * @brief 判断扫描能否借助B+树索引按字段col_name有序输出(反向扫描索引时为降序)：索引中col_name之前的字段都有与常量比较的等值条件。
+ * 扫描已经使用某个索引时只考虑这个索引，不改变原来的选择；顺序扫描只考虑覆盖查询在这个表上所有字段的索引，
+ * 改为只读索引的扫描后不需要回表，按索引顺序逐条回表的随机读比顺序扫描的代价大得多
+ *
+ * @param conds select语句的全部条件
+ * @param index_col_names 可以时为索引包含的字段
+ */
+bool Planner::get_order_index_cols(std::shared_ptr<Query> query, const std::vector<Condition> &conds,
+                                   std::shared_ptr<ScanPlan> scan, const std::string &col_name,
+                                   std::vector<std::string> &index_col_names) {
+    index_col_names.clear();
+    std::set<std::string> eq_cols;
+    for (auto &cond : scan->conds_) {
+        if (cond.is_rhs_val && cond.op == OP_EQ && cond.lhs_col.tab_name == scan->tab_name_) {
+            eq_cols.insert(cond.lhs_col.col_name);
+        }
+    }
+    TabMeta &tab = sm_manager_->db_.get_table(scan->tab_name_);
+    for (auto &index : tab.indexes) {
+        if (index.type != INDEX_BTREE) continue;
+        std::vector<std::string> names;
+        for (auto &col : index.cols) {
+            names.push_back(col.name);
+        }
+        if (scan->tag == T_IndexScan ? names != scan->index_col_names_
+                                     : !is_covering_index(query, conds, scan->tab_name_, names)) {
+            continue;
+        }
+        for (auto &col : index.cols) {
+            if (col.name == col_name) {
+                index_col_names = names;
+                return true;
+            }
+            if (!eq_cols.count(col.name)) break;
+        }
+    }
     return false;
 }
 
@@ -117,6 +250,98 @@ std::shared_ptr<Plan> pop_scan(int *scantbl, std::string table, std::vector<std:
 }
 
 
+// 收集plan扫描的所有表
+void collect_tables(std::shared_ptr<Plan> plan, std::set<std::string> *tables)
+{
+    if (auto x = std::dynamic_pointer_cast<ScanPlan>(plan)) {
+        tables->insert(x->tab_name_);
+    } else if (auto x = std::dynamic_pointer_cast<JoinPlan>(plan)) {
+        collect_tables(x->left_, tables);
+        collect_tables(x->right_, tables);
+    }
+}
+
+/**
+ * @brief 为每个连接选择执行方式：两侧都是单表扫描、且都已经按某个等值连接条件的字段有序输出
+ * (已经选择的B+树索引扫描，或者可以改为只读覆盖索引的扫描)时，使用排序归并连接，
+ * 这个条件移到连接条件的最前面作为连接key；否则一侧是单表扫描且连接条件能确定它上面的索引时
+ * 使用索引嵌套循环连接，这一侧作为内表换到右边；否则连接条件中有左右两侧字段之间、类型相同的等值条件时
+ * 使用哈希连接，再否则使用嵌套循环连接。连接条件在make_one_rel的最后才全部下推完，所以在生成连接树之后再选择
+ *
+ * @param conds select语句的全部条件
+ */
+void Planner::choose_join_methods(std::shared_ptr<Plan> plan, std::shared_ptr<Query> query,
+                                  const std::vector<Condition> &conds)
+{
+    auto x = std::dynamic_pointer_cast<JoinPlan>(plan);
+    if (x == nullptr) {
+        return;
+    }
+    choose_join_methods(x->left_, query, conds);
+    choose_join_methods(x->right_, query, conds);
+    std::set<std::string> left_tables, right_tables;
+    collect_tables(x->left_, &left_tables);
+    collect_tables(x->right_, &right_tables);
+    auto left_scan = std::dynamic_pointer_cast<ScanPlan>(x->left_);
+    auto right_scan = std::dynamic_pointer_cast<ScanPlan>(x->right_);
+    for (size_t i = 0; left_scan != nullptr && right_scan != nullptr && i < x->conds_.size(); i++) {
+        auto &cond = x->conds_[i];
+        if (cond.is_rhs_val || cond.op != OP_EQ) {
+            continue;
+        }
+        const TabCol *left_col = &cond.lhs_col, *right_col = &cond.rhs_col;
+        if (left_col->tab_name != left_scan->tab_name_) std::swap(left_col, right_col);
+        if (left_col->tab_name != left_scan->tab_name_ || right_col->tab_name != right_scan->tab_name_) {
+            continue;
+        }
+        auto lhs = sm_manager_->db_.get_table(left_col->tab_name).get_col(left_col->col_name);
+        auto rhs = sm_manager_->db_.get_table(right_col->tab_name).get_col(right_col->col_name);
+        std::vector<std::string> left_index, right_index;
+        if (lhs->type != rhs->type || lhs->len != rhs->len ||
+            !get_order_index_cols(query, conds, left_scan, left_col->col_name, left_index) ||
+            !get_order_index_cols(query, conds, right_scan, right_col->col_name, right_index)) {
+            continue;
+        }
+        for (auto [scan, index] : {std::make_pair(left_scan, &left_index), std::make_pair(right_scan, &right_index)}) {
+            if (scan->tag != T_IndexScan) {
+                scan->tag = T_IndexScan;
+                scan->index_col_names_ = *index;
+                scan->index_only_ = true;
+            }
+        }
+        std::swap(x->conds_[0], x->conds_[i]);
+        x->tag = T_MergeJoin;
+        return;
+    }
+    for (bool inner_left : {false, true}) {
+        auto inner = std::dynamic_pointer_cast<ScanPlan>(inner_left ? x->left_ : x->right_);
+        if (inner != nullptr && get_join_index_cols(inner->tab_name_, inner->conds_, x->conds_,
+                                                    inner_left ? right_tables : left_tables, x->index_col_names_)) {
+            if (inner_left) {
+                std::swap(x->left_, x->right_);
+            }
+            x->tag = T_IndexNestLoop;
+            return;
+        }
+    }
+    for (auto &cond : x->conds_) {
+        if (cond.is_rhs_val || cond.op != OP_EQ) {
+            continue;
+        }
+        bool across = (left_tables.count(cond.lhs_col.tab_name) && right_tables.count(cond.rhs_col.tab_name)) ||
+                      (right_tables.count(cond.lhs_col.tab_name) && left_tables.count(cond.rhs_col.tab_name));
+        if (!across) {
+            continue;
+        }
+        auto lhs = sm_manager_->db_.get_table(cond.lhs_col.tab_name).get_col(cond.lhs_col.col_name);
+        auto rhs = sm_manager_->db_.get_table(cond.rhs_col.tab_name).get_col(cond.rhs_col.col_name);
+        if (lhs->type == rhs->type && lhs->len == rhs->len) {
+            x->tag = T_HashJoin;
+            return;
+        }
+    }
+}
+
 std::shared_ptr<Query> Planner::logical_optimization(std::shared_ptr<Query> query, Context *context)
 {
     
@@ -127,12 +352,14 @@ std::shared_ptr<Query> Planner::logical_optimization(std::shared_ptr<Query> quer
 
 std::shared_ptr<Plan> Planner::physical_optimization(std::shared_ptr<Query> query, Context *context)
 {
+    const std::vector<Condition> all_conds = query->conds;
     std::shared_ptr<Plan> plan = make_one_rel(query);
     
     // 其他物理优化
+    choose_join_methods(plan, query, all_conds);
 
     // 处理orderby
-    plan = generate_sort_plan(query, std::move(plan)); 
+    plan = generate_sort_plan(query, std::move(plan), all_conds);
 
     return plan;
 }
@@ -143,6 +370,7 @@ std::shared_ptr<Plan> Planner::make_one_rel(std::shared_ptr<Query> query)
 {
     auto x = std::dynamic_pointer_cast<ast::SelectStmt>(query->parse);
     std::vector<std::string> tables = query->tables;
+    const std::vector<Condition> all_conds = query->conds;
     // // Scan table , 生成表算子列表tab_nodes
     std::vector<std::shared_ptr<Plan>> table_scan_executors(tables.size());
     for (size_t i = 0; i < tables.size(); i++) {
@@ -155,8 +383,9 @@ std::shared_ptr<Plan> Planner::make_one_rel(std::shared_ptr<Query> query)
             table_scan_executors[i] = 
                 std::make_shared<ScanPlan>(T_SeqScan, sm_manager_, tables[i], curr_conds, index_col_names);
         } else {  // 存在索引
+            bool index_only = is_covering_index(query, all_conds, tables[i], index_col_names);
             table_scan_executors[i] =
-                std::make_shared<ScanPlan>(T_IndexScan, sm_manager_, tables[i], curr_conds, index_col_names);
+                std::make_shared<ScanPlan>(T_IndexScan, sm_manager_, tables[i], curr_conds, index_col_names, index_only);
         }
     }
     // 只有一个表，不需要join。
@@ -249,7 +478,14 @@ std::shared_ptr<Plan> Planner::make_one_rel(std::shared_ptr<Query> query)
 }
 
 
-std::shared_ptr<Plan> Planner::generate_sort_plan(std::shared_ptr<Query> query, std::shared_ptr<Plan> plan)
+/**
+ * @brief 为ORDER BY生成排序算子。单表查询的扫描可以借助B+树索引按排序字段有序输出时(见get_order_index_cols)，
+ * 改为这个索引上的扫描，降序时反向扫描索引，不再生成排序算子
+ *
+ * @param conds select语句的全部条件
+ */
+std::shared_ptr<Plan> Planner::generate_sort_plan(std::shared_ptr<Query> query, std::shared_ptr<Plan> plan,
+                                                  const std::vector<Condition> &conds)
 {
     auto x = std::dynamic_pointer_cast<ast::SelectStmt>(query->parse);
     if(!x->has_sort) {
@@ -267,8 +503,19 @@ std::shared_ptr<Plan> Planner::generate_sort_plan(std::shared_ptr<Query> query,
         if(col.name.compare(x->order->cols->col_name) == 0 )
         sel_col = {.tab_name = col.tab_name, .col_name = col.name};
     }
-    return std::make_shared<SortPlan>(T_Sort, std::move(plan), sel_col, 
-                                    x->order->orderby_dir == ast::OrderBy_DESC);
+    bool is_desc = x->order->orderby_dir == ast::OrderBy_DESC;
+    std::vector<std::string> index_col_names;
+    auto scan = std::dynamic_pointer_cast<ScanPlan>(plan);
+    if (scan != nullptr && get_order_index_cols(query, conds, scan, sel_col.col_name, index_col_names)) {
+        if (scan->tag != T_IndexScan) {
+            scan->tag = T_IndexScan;
+            scan->index_col_names_ = index_col_names;
+            scan->index_only_ = true;
+        }
+        scan->reverse_ = is_desc;
+        return plan;
+    }
+    return std::make_shared<SortPlan>(T_Sort, std::move(plan), sel_col, is_desc);
 }
 
 
@@ -315,7 +562,9 @@ std::shared_ptr<Plan> Planner::do_planner(std::shared_ptr<Query> query, Context
         plannerRoot = std::make_shared<DDLPlan>(T_DropTable, x->tab_name, std::vector<std::string>(), std::vector<ColDef>());
     } else if (auto x = std::dynamic_pointer_cast<ast::CreateIndex>(query->parse)) {
         // create index;
-        plannerRoot = std::make_shared<DDLPlan>(T_CreateIndex, x->tab_name, x->col_names, std::vector<ColDef>());
+        IndexType index_type = x->method == ast::INDEX_METHOD_HASH ? INDEX_HASH : INDEX_BTREE;
+        plannerRoot = std::make_shared<DDLPlan>(T_CreateIndex, x->tab_name, x->col_names, std::vector<ColDef>(),
+                                                index_type);
     } else if (auto x = std::dynamic_pointer_cast<ast::DropIndex>(query->parse)) {
         // drop index
         plannerRoot = std::make_shared<DDLPlan>(T_DropIndex, x->tab_name, x->col_names, std::vector<ColDef>());
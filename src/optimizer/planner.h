@@ -13,6 +13,7 @@ See the Mulan PSL v2 for more details. */
 #include <cassert>
 #include <cstring>
 #include <memory>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -42,7 +43,11 @@ class Planner {
 
     std::shared_ptr<Plan> make_one_rel(std::shared_ptr<Query> query);
 
-    std::shared_ptr<Plan> generate_sort_plan(std::shared_ptr<Query> query, std::shared_ptr<Plan> plan);
+    void choose_join_methods(std::shared_ptr<Plan> plan, std::shared_ptr<Query> query,
+                             const std::vector<Condition> &conds);
+
+    std::shared_ptr<Plan> generate_sort_plan(std::shared_ptr<Query> query, std::shared_ptr<Plan> plan,
+                                             const std::vector<Condition> &conds);
     
     std::shared_ptr<Plan> generate_select_plan(std::shared_ptr<Query> query, Context *context);
 
@@ -50,6 +55,17 @@ class Planner {
     // int get_indexNo(std::string tab_name, std::vector<Condition> curr_conds);
     bool get_index_cols(std::string tab_name, std::vector<Condition> curr_conds, std::vector<std::string>& index_col_names);
 
+    bool is_covering_index(std::shared_ptr<Query> query, const std::vector<Condition> &conds, const std::string &tab_name,
+                           const std::vector<std::string> &index_col_names);
+
+    bool get_join_index_cols(std::string tab_name, const std::vector<Condition> &scan_conds,
+                             const std::vector<Condition> &join_conds, const std::set<std::string> &outer_tables,
+                             std::vector<std::string> &index_col_names);
+
+    bool get_order_index_cols(std::shared_ptr<Query> query, const std::vector<Condition> &conds,
+                              std::shared_ptr<ScanPlan> scan, const std::string &col_name,
+                              std::vector<std::string> &index_col_names);
+
     ColType interp_sv_type(ast::SvType sv_type) {
         std::map<ast::SvType, ColType> m = {
             {ast::SV_TYPE_INT, TYPE_INT}, {ast::SV_TYPE_FLOAT, TYPE_FLOAT}, {ast::SV_TYPE_STRING, TYPE_STRING}};
@@ -22,6 +22,10 @@ enum SvType {
     SV_TYPE_INT, SV_TYPE_FLOAT, SV_TYPE_STRING
 };
 
+enum IndexMethod {
+    INDEX_METHOD_BTREE, INDEX_METHOD_HASH
+};
+
 enum SvCompOp {
     SV_OP_EQ, SV_OP_NE, SV_OP_LT, SV_OP_GT, SV_OP_LE, SV_OP_GE
 };
@@ -43,6 +47,9 @@ struct Help : public TreeNode {
 struct ShowTables : public TreeNode {
 };
 
+struct ShowBufferStats : public TreeNode {
+};
+
 struct TxnBegin : public TreeNode {
 };
 
@@ -96,9 +103,10 @@ struct DescTable : public TreeNode {
 struct CreateIndex : public TreeNode {
     std::string tab_name;
     std::vector<std::string> col_names;
+    IndexMethod method;
 
-    CreateIndex(std::string tab_name_, std::vector<std::string> col_names_) :
-            tab_name(std::move(tab_name_)), col_names(std::move(col_names_)) {}
+    CreateIndex(std::string tab_name_, std::vector<std::string> col_names_, IndexMethod method_ = INDEX_METHOD_BTREE) :
+            tab_name(std::move(tab_name_)), col_names(std::move(col_names_)), method(method_) {}
 };
 
 struct DropIndex : public TreeNode {
@@ -231,6 +239,7 @@ struct SemValue {
     float sv_float;
     std::string sv_str;
     OrderByDir sv_orderby_dir;
+    IndexMethod sv_index_method;
     std::vector<std::string> sv_strs;
 
     std::shared_ptr<TreeNode> sv_node;
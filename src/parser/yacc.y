@@ -23,6 +23,7 @@ using namespace ast;
 // keywords
 %token SHOW TABLES CREATE TABLE DROP DESC INSERT INTO VALUES DELETE FROM ASC ORDER BY
 WHERE UPDATE SET SELECT INT CHAR FLOAT INDEX AND JOIN EXIT HELP TXN_BEGIN TXN_COMMIT TXN_ABORT TXN_ROLLBACK ORDER_BY
+BUFFER STATS USING HASH BTREE
 // non-keywords
 %token LEQ NEQ GEQ T_EOF
 
@@ -50,6 +51,7 @@ WHERE UPDATE SET SELECT INT CHAR FLOAT INDEX AND JOIN EXIT HELP TXN_BEGIN TXN_CO
 %type <sv_conds> whereClause optWhereClause
 %type <sv_orderby>  order_clause opt_order_clause
 %type <sv_orderby_dir> opt_asc_desc
+%type <sv_index_method> opt_index_method
 
 %%
 start:
@@ -106,6 +108,10 @@ dbStmt:
     {
         $$ = std::make_shared<ShowTables>();
     }
+    |   SHOW BUFFER STATS
+    {
+        $$ = std::make_shared<ShowBufferStats>();
+    }
     ;
 
 ddl:
@@ -121,9 +127,9 @@ ddl:
     {
         $$ = std::make_shared<DescTable>($2);
     }
-    |   CREATE INDEX tbName '(' colNameList ')'
+    |   CREATE INDEX tbName '(' colNameList ')' opt_index_method
     {
-        $$ = std::make_shared<CreateIndex>($3, $5);
+        $$ = std::make_shared<CreateIndex>($3, $5, $7);
     }
     |   DROP INDEX tbName '(' colNameList ')'
     {
@@ -368,6 +374,12 @@ opt_asc_desc:
     |       { $$ = OrderBy_DEFAULT; }
     ;    
 
+opt_index_method:
+        USING BTREE  { $$ = INDEX_METHOD_BTREE; }
+    |   USING HASH   { $$ = INDEX_METHOD_HASH;  }
+    |                { $$ = INDEX_METHOD_BTREE; }
+    ;
+
 tbName: IDENTIFIER;
 
 colName: IDENTIFIER;
@@ -23,6 +23,9 @@ See the Mulan PSL v2 for more details. */
 #include "execution/executor_insert.h"
 #include "execution/executor_delete.h"
 #include "execution/execution_sort.h"
+#include "execution/executor_hash_join.h"
+#include "execution/executor_index_nestedloop_join.h"
+#include "execution/executor_merge_join.h"
 #include "common/common.h"
 
 typedef enum portalTag{
@@ -75,10 +78,7 @@ class Portal
                 case T_Update:
                 {
                     std::unique_ptr<AbstractExecutor> scan= convert_plan_executor(x->subplan_, context);
-                    std::vector<Rid> rids;
-                    for (scan->beginTuple(); !scan->is_end(); scan->nextTuple()) {
-                        rids.push_back(scan->rid());
-                    }
+                    std::vector<Rid> rids = collect_rids(scan.get());
                     std::unique_ptr<AbstractExecutor> root =std::make_unique<UpdateExecutor>(sm_manager_, 
                                                             x->tab_name_, x->set_clauses_, x->conds_, rids, context);
                     return std::make_shared<PortalStmt>(PORTAL_DML_WITHOUT_SELECT, std::vector<TabCol>(), std::move(root), plan);
@@ -86,10 +86,7 @@ class Portal
                 case T_Delete:
                 {
                     std::unique_ptr<AbstractExecutor> scan= convert_plan_executor(x->subplan_, context);
-                    std::vector<Rid> rids;
-                    for (scan->beginTuple(); !scan->is_end(); scan->nextTuple()) {
-                        rids.push_back(scan->rid());
-                    }
+                    std::vector<Rid> rids = collect_rids(scan.get());
 
                     std::unique_ptr<AbstractExecutor> root =
                         std::make_unique<DeleteExecutor>(sm_manager_, x->tab_name_, x->conds_, rids, context);
@@ -150,6 +147,18 @@ class Portal
     // 清空资源
     void drop(){}
 
+    // 按批读取扫描算子，收集满足条件的记录的位置
+    std::vector<Rid> collect_rids(AbstractExecutor *scan) {
+        std::vector<Rid> rids;
+        TupleBatch batch;
+        for (scan->beginTuple(); scan->NextBatch(&batch);) {
+            for (size_t i = 0; i < batch.size(); i++) {
+                rids.push_back(batch.rid(i));
+            }
+        }
+        return rids;
+    }
+
 
     std::unique_ptr<AbstractExecutor> convert_plan_executor(std::shared_ptr<Plan> plan, Context *context)
     {
@@ -161,11 +170,25 @@ class Portal
                 return std::make_unique<SeqScanExecutor>(sm_manager_, x->tab_name_, x->conds_, context);
             }
             else {
-                return std::make_unique<IndexScanExecutor>(sm_manager_, x->tab_name_, x->conds_, x->index_col_names_, context);
+                return std::make_unique<IndexScanExecutor>(sm_manager_, x->tab_name_, x->conds_, x->index_col_names_,
+                                                           x->index_only_, context, x->reverse_);
             } 
         } else if(auto x = std::dynamic_pointer_cast<JoinPlan>(plan)) {
             std::unique_ptr<AbstractExecutor> left = convert_plan_executor(x->left_, context);
+            if (x->tag == T_IndexNestLoop) {
+                // 右节点是内表的扫描，由连接算子直接查找内表的索引
+                auto inner = std::dynamic_pointer_cast<ScanPlan>(x->right_);
+                return std::make_unique<IndexNestedLoopJoinExecutor>(sm_manager_, std::move(left), inner->tab_name_,
+                                                                     inner->conds_, std::move(x->conds_),
+                                                                     x->index_col_names_, context);
+            }
             std::unique_ptr<AbstractExecutor> right = convert_plan_executor(x->right_, context);
+            if (x->tag == T_MergeJoin) {
+                return std::make_unique<MergeJoinExecutor>(std::move(left), std::move(right), std::move(x->conds_));
+            }
+            if (x->tag == T_HashJoin) {
+                return std::make_unique<HashJoinExecutor>(std::move(left), std::move(right), std::move(x->conds_));
+            }
             std::unique_ptr<AbstractExecutor> join = std::make_unique<NestedLoopJoinExecutor>(
                                 std::move(left), 
                                 std::move(right), std::move(x->conds_));
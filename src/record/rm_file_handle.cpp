@@ -21,16 +21,28 @@ std::unique_ptr<RmRecord> RmFileHandle::get_record(const Rid& rid, Context* cont
     // 1. 获取指定记录所在的page handle
     // 2. 初始化一个指向RmRecord的指针（赋值其内部的data和size）
     auto record = std::make_unique<RmRecord>(file_hdr_.record_size);
+    //初始化一个指向RmRecord的指针（赋值其内部的data和size）
+    record -> size = file_hdr_.record_size;
+    get_record(rid, record -> data, context);
+    return record;
+}
+
+/**
+ * @description: 把记录号为rid的记录复制到调用者提供的缓冲区，批量读取记录时避免为每条记录分配内存
+ * @param {Rid&} rid 记录号，指定记录的位置
+ * @param {char*} buf 至少file_hdr_.record_size字节的缓冲区
+ * @param {Context*} context
+ */
+void RmFileHandle::get_record(const Rid& rid, char* buf, Context* context) const {
     auto pageHandler = fetch_page_handle(rid.page_no);//获取指定记录所在的page handle
 
     if( !Bitmap::is_set(pageHandler.bitmap, rid.slot_no) ) {
+        buffer_pool_manager_ -> unpin_page(pageHandler.page -> get_page_id(), false);
         throw RecordNotFoundError(rid.page_no, rid.slot_no);
     }
-    //初始化一个指向RmRecord的指针（赋值其内部的data和size）
-    record -> size = file_hdr_.record_size;
     //把位于指定slot的record拷贝一份，然后返回给上层。
-    memcpy( record -> data, pageHandler.get_slot(rid.slot_no), file_hdr_.record_size );
-    return record;
+    memcpy( buf, pageHandler.get_slot(rid.slot_no), file_hdr_.record_size );
+    buffer_pool_manager_ -> unpin_page(pageHandler.page -> get_page_id(), false);
 }
 
 /**
@@ -56,7 +68,10 @@ Rid RmFileHandle::insert_record(char* buf, Context* context) {
         file_hdr_.first_free_page_no = pageHandler.page_hdr -> next_free_page_no;
     }
 
-    return Rid{pageHandler.page -> get_page_id().page_no, slot_no};
+    Rid rid{pageHandler.page -> get_page_id().page_no, slot_no};
+    log_insert(pageHandler, rid, buf, context);
+    buffer_pool_manager_ -> unpin_page(pageHandler.page -> get_page_id(), true);
+    return rid;
 }
 
 /**
@@ -94,6 +109,7 @@ void RmFileHandle::delete_record(const Rid& rid, Context* context) {
     auto pageHandler = fetch_page_handle(rid.page_no);//获取指定记录所在的page handle
     
     if( !Bitmap::is_set(pageHandler.bitmap, rid.slot_no) ) {//将page的bitmap中表示对应槽位的bit置0。
+        buffer_pool_manager_ -> unpin_page(pageHandler.page -> get_page_id(), false);
         throw RecordNotFoundError(rid.page_no, rid.slot_no);
     }
 
@@ -101,6 +117,7 @@ void RmFileHandle::delete_record(const Rid& rid, Context* context) {
     if( (pageHandler.page_hdr -> num_records ) -- == file_hdr_.num_records_per_page ) {
         release_page_handle(pageHandler);//如果删除操作导致该页面恰好从已满变为未满，那么需要调用release_page_handle()。
     }
+    buffer_pool_manager_ -> unpin_page(pageHandler.page -> get_page_id(), true);
 }
 
 
@@ -117,9 +134,11 @@ void RmFileHandle::update_record(const Rid& rid, char* buf, Context* context) {
     auto pageHandler = fetch_page_handle(rid.page_no);
 
     if( !Bitmap::is_set(pageHandler.bitmap, rid.slot_no) ) {
+        buffer_pool_manager_ -> unpin_page(pageHandler.page -> get_page_id(), false);
         throw RecordNotFoundError(rid.page_no, rid.slot_no);
     }
     memcpy( pageHandler.get_slot(rid.slot_no), buf, file_hdr_.record_size );
+    buffer_pool_manager_ -> unpin_page(pageHandler.page -> get_page_id(), true);
 }
 
 /**
@@ -128,16 +147,17 @@ void RmFileHandle::update_record(const Rid& rid, char* buf, Context* context) {
 /**
  * @description: 获取指定页面的页面句柄
  * @param {int} page_no 页面号
+ * @param {BufferAccessStrategy*} strategy 顺序扫描时使用的缓冲池访问策略，默认为空
  * @return {RmPageHandle} 指定页面的句柄
  */
-RmPageHandle RmFileHandle::fetch_page_handle(int page_no) const {
+RmPageHandle RmFileHandle::fetch_page_handle(int page_no, BufferAccessStrategy *strategy) const {
     // Todo:
     // 使用缓冲池获取指定页面，并生成page_handle返回给上层
     // if page_no is invalid, throw PageNotExistError exception
     if( page_no >= file_hdr_.num_pages ) {//page_no无效
         throw PageNotExistError(disk_manager_ -> get_file_name(fd_), page_no);
     }
-    return RmPageHandle(&file_hdr_, buffer_pool_manager_ -> fetch_page( {fd_, page_no} ));//获取RmPageHandle 返回给上层的page_handle
+    return RmPageHandle(&file_hdr_, buffer_pool_manager_ -> fetch_page( {fd_, page_no}, strategy ));//获取RmPageHandle 返回给上层的page_handle
     // return RmPageHandle(&file_hdr_, nullptr);
 }
 
@@ -192,4 +212,25 @@ void RmFileHandle::release_page_handle(RmPageHandle&page_handle) {
     // 2. file_hdr_.first_free_page_no
     page_handle.page_hdr -> next_free_page_no = file_hdr_.first_free_page_no;//更新page_hdr的下一个空闲页
     file_hdr_.first_free_page_no = page_handle.page -> get_page_id().page_no;//更新file_hdr的第一个空闲页    
+}
+
+/**
+ * @description: 在事务中插入记录时写一条insert日志，并把日志的lsn记为页面的page_lsn，
+ * 后台刷脏线程在这条日志落盘之前不会写回该页面(WAL)。没有日志管理器或事务时不写日志
+ * @param {RmPageHandle&} page_handle 插入记录的页面，调用者已经固定
+ * @param {Rid&} rid 插入记录的位置
+ * @param {char*} buf 插入的记录的数据
+ * @param {Context*} context
+ */
+void RmFileHandle::log_insert(const RmPageHandle &page_handle, const Rid &rid, char *buf, Context *context) {
+    if( context == nullptr || context -> log_mgr_ == nullptr || context -> txn_ == nullptr ) {
+        return;
+    }
+    RmRecord value(file_hdr_.record_size, buf);
+    Rid log_rid = rid;
+    InsertLogRecord log_record(context -> txn_ -> get_transaction_id(), value, log_rid, disk_manager_ -> get_file_name(fd_));
+    log_record.prev_lsn_ = context -> txn_ -> get_prev_lsn();
+    lsn_t lsn = context -> log_mgr_ -> add_log_to_buffer(&log_record);
+    context -> txn_ -> set_prev_lsn(lsn);
+    page_handle.page -> set_page_lsn(lsn);
 }
\ No newline at end of file
@@ -43,9 +43,10 @@ class RmManager {
         file_hdr.record_size = record_size;
         file_hdr.num_pages = 1;
         file_hdr.first_free_page_no = RM_NO_PAGE;
-        // We have: sizeof(hdr) + (n + 7) / 8 + n * record_size <= PAGE_SIZE
+        // We have: sizeof(hdr) + (n + 7) / 8 + n * record_size <= page_size，page_size为当前数据库的页面大小
+        int page_size = disk_manager_->get_page_size();
         file_hdr.num_records_per_page =
-            (BITMAP_WIDTH * (PAGE_SIZE - 1 - (int)sizeof(RmFileHdr)) + 1) / (1 + record_size * BITMAP_WIDTH);
+            (BITMAP_WIDTH * (page_size - 1 - (int)sizeof(RmFileHdr)) + 1) / (1 + record_size * BITMAP_WIDTH);
         file_hdr.bitmap_size = (file_hdr.num_records_per_page + BITMAP_WIDTH - 1) / BITMAP_WIDTH;
 
         // 将file header写入磁盘文件（名为file name，文件描述符为fd）中的第0页
@@ -68,6 +69,8 @@ class RmManager {
      */
     std::unique_ptr<RmFileHandle> open_file(const std::string& filename) {
         int fd = disk_manager_->open_file(filename);
+        // 数据页在页头偏移0处保存page_lsn，后台刷脏线程写回数据页时遵守WAL
+        buffer_pool_manager_->set_lsn_file(fd, true);
         return std::make_unique<RmFileHandle>(disk_manager_, buffer_pool_manager_, fd);
     }
     /**
@@ -79,6 +82,8 @@ class RmManager {
                                   sizeof(file_handle->file_hdr_));
         // 缓冲区的所有页刷到磁盘，注意这句话必须写在close_file前面
         buffer_pool_manager_->flush_all_pages(file_handle->fd_);
+        // fd关闭后可能被其他文件复用，需要先取消登记
+        buffer_pool_manager_->set_lsn_file(file_handle->fd_, false);
         disk_manager_->close_file(file_handle->fd_);
     }
 };
@@ -14,8 +14,10 @@ See the Mulan PSL v2 for more details. */
 /**
  * @brief 初始化file_handle和rid
  * @param file_handle
+ * @param strategy 缓冲池访问策略，扫描大表时传入以免冲刷缓冲池中的热点页
  */
-RmScan::RmScan(const RmFileHandle *file_handle) : file_handle_(file_handle) {
+RmScan::RmScan(const RmFileHandle *file_handle, BufferAccessStrategy *strategy)
+    : file_handle_(file_handle), strategy_(strategy), prefetched_until_(RM_FIRST_RECORD_PAGE) {
     // Todo:
     // 初始化file_handle和rid（指向第一个存放了记录的位置）
     rid_ = Rid{RM_FIRST_RECORD_PAGE, -1};//rid_指向第一个存放记录的位置
@@ -29,19 +31,54 @@ void RmScan::next() {
     // Todo:
     // 找到文件中下一个存放了记录的非空闲位置，用rid_来指向这个位置
     while( rid_.page_no < file_handle_ -> file_hdr_.num_pages ) {//遍历所有页面
-        auto page_handler = file_handle_ -> fetch_page_handle(rid_.page_no);//对于当前页面
+        read_ahead(rid_.page_no);
+        auto page_handler = file_handle_ -> fetch_page_handle(rid_.page_no, strategy_);//对于当前页面
         //用bitmap来找bit为1的slot_no即存放了记录的位置
         rid_.slot_no = Bitmap::next_bit( true, page_handler.bitmap, file_handle_->file_hdr_.num_records_per_page, rid_.slot_no );
+        file_handle_ -> buffer_pool_manager_ -> unpin_page(page_handler.page -> get_page_id(), false);
 
         if( rid_.slot_no < file_handle_ -> file_hdr_.num_records_per_page) {
             return;
         }//当前页面的所有slot都没有存放record，也就是当前页面没有没找过的记录了
         rid_ = Rid{ rid_.page_no + 1, -1 };//找下一个页面从头开始遍历
         if( rid_.page_no >= file_handle_ -> file_hdr_.num_pages ) {
-            rid_ = Rid{RM_NO_PAGE, -1};
             break;
         }//遍历完了
     }
+    rid_ = Rid{RM_NO_PAGE, -1};//表中没有数据页或者所有页面都已遍历完
+}
+
+/**
+ * @brief 定位到rid，调用者直接读取页面中的记录后用来同步扫描位置，不读取页面
+ * @param rid 调用者已经确认存放了记录的位置
+ */
+void RmScan::seek(const Rid &rid) {
+    rid_ = rid;
+}
+
+/**
+ * @brief 定位到page_no页面的开头(slot_no为-1)，不读取页面，调用者读完一个页面后用来跳到下一个页面。
+ * 页面中还没有找到第一条记录，rid()的slot_no为-1，之后由next()或调用者读取页面时查找；
+ * page_no超过文件的页面数时扫描结束
+ */
+void RmScan::seek_page(int page_no) {
+    if( page_no >= file_handle_ -> file_hdr_.num_pages ) {
+        rid_ = Rid{RM_NO_PAGE, -1};
+        return;
+    }
+    read_ahead(page_no);
+    rid_ = Rid{page_no, -1};
+}
+
+/**
+ * @brief 扫描到page_no时，异步预读其后PREFETCH_DEPTH个页面，已经提交过的页面不再重复提交
+ */
+void RmScan::read_ahead(int page_no) {
+    int last = std::min(page_no + PREFETCH_DEPTH, file_handle_ -> file_hdr_.num_pages - 1);
+    for( int i = std::max(prefetched_until_, page_no) + 1; i <= last; i++ ) {
+        file_handle_ -> buffer_pool_manager_ -> prefetch_page({file_handle_ -> fd_, i}, strategy_);
+    }
+    prefetched_until_ = std::max(prefetched_until_, last);
 }
 
 /**
@@ -17,12 +17,21 @@ class RmFileHandle;
 class RmScan : public RecScan {
     const RmFileHandle *file_handle_;
     Rid rid_;
+    BufferAccessStrategy *strategy_;    // 读取页面时使用的缓冲池访问策略，为空时直接使用整个缓冲池
+    int prefetched_until_;              // 已经提交预读的最大页号
 public:
-    RmScan(const RmFileHandle *file_handle);
+    RmScan(const RmFileHandle *file_handle, BufferAccessStrategy *strategy = nullptr);
 
     void next() override;
 
     bool is_end() const override;
 
     Rid rid() const override;
+
+    void seek(const Rid &rid);
+
+    void seek_page(int page_no);
+
+private:
+    void read_ahead(int page_no);
 };
@@ -135,6 +135,8 @@ public:
         log_tot_len_ += sizeof(size_t) + table_name_size_;
     }
 
+    ~InsertLogRecord() { delete[] table_name_; }
+
     // 把insert日志记录序列化到dest中
     void serialize(char* dest) const override {
         LogRecord::serialize(dest);
@@ -218,10 +220,16 @@ public:
 
     LogBuffer* get_log_buffer() { return &log_buffer_; }
 
+    // 已经持久化的最后一条日志的lsn，page_lsn不超过它的脏页才能写回磁盘(WAL)
+    lsn_t get_persist_lsn() const { return persist_lsn_; }
+
 private:    
-    std::atomic<lsn_t> global_lsn_{0};  // 全局lsn，递增，用于为每条记录分发lsn
+    void flush_log_buffer();
+
+    // lsn从1开始分配，page_lsn为0表示该页面从未被日志记录修改过
+    std::atomic<lsn_t> global_lsn_{1};  // 全局lsn，递增，用于为每条记录分发lsn
     std::mutex latch_;                  // 用于对log_buffer_的互斥访问
     LogBuffer log_buffer_;              // 日志缓冲区
-    lsn_t persist_lsn_;                 // 记录已经持久化到磁盘中的最后一条日志的日志号
+    std::atomic<lsn_t> persist_lsn_{0}; // 记录已经持久化到磁盘中的最后一条日志的日志号
     DiskManager* disk_manager_;
 }; 
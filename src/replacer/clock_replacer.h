@@ -0,0 +1,48 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <mutex>
+#include <vector>
+
+#include "common/config.h"
+#include "replacer/replacer.h"
+
+/*
+ClockReplacer实现了CLOCK(二次机会)替换策略，所有状态保存在按帧号索引的定长数组中，
+pin/unpin/victim都不申请内存
+*/
+class ClockReplacer : public Replacer {
+   public:
+    /**
+     * @description: 创建一个新的ClockReplacer
+     * @param {size_t} num_pages ClockReplacer最多需要存储的page数量
+     */
+    explicit ClockReplacer(size_t num_pages);
+
+    ~ClockReplacer();
+
+    bool victim(frame_id_t *frame_id);
+
+    void pin(frame_id_t frame_id);
+
+    void unpin(frame_id_t frame_id);
+
+    size_t Size();
+
+   private:
+    std::mutex latch_;                  // 互斥锁
+    std::vector<char> in_replacer_;     // 帧是否可以被淘汰
+    std::vector<char> ref_bit_;         // 访问位，时钟指针扫过时清零，为0时才淘汰
+    size_t hand_;                       // 时钟指针
+    size_t size_;                       // 可以被淘汰的帧的数量
+    size_t max_size_;                   // 最大容量（与缓冲池的容量相同）
+};
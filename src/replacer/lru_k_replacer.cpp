@@ -0,0 +1,208 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "lru_k_replacer.h"
+
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k)
+    : k_(k),
+      history_(num_pages * k, 0),
+      access_count_(num_pages, 0),
+      in_replacer_(num_pages, 0),
+      evict_key_(num_pages, 0),
+      heap_pos_(num_pages, 0),
+      current_timestamp_(0),
+      size_(0),
+      max_size_(num_pages) {
+    history_heap_.frames_.resize(num_pages);
+    cache_heap_.frames_.resize(num_pages);
+}
+
+LRUKReplacer::~LRUKReplacer() = default;
+
+/**
+ * @description: 记录一次对frame的访问，调用者需持有latch_。
+ * 中间没有访问过其他帧的连续访问(如逐条读取同一页上的记录)视为相关访问，只更新最近一次的时间戳
+ * @param {frame_id_t} frame_id 被访问的frame的id
+ */
+void LRUKReplacer::record_access(frame_id_t frame_id) {
+    if (access_count_[frame_id] > 0) {
+        uint64_t &last = history_[frame_id * k_ + (access_count_[frame_id] - 1) % k_];
+        if (last + 1 == current_timestamp_) {
+            last = current_timestamp_++;
+            return;
+        }
+    }
+    history_[frame_id * k_ + access_count_[frame_id] % k_] = current_timestamp_++;
+    access_count_[frame_id]++;
+}
+
+/**
+ * @description: 堆中的排序：时间戳小的在前，时间戳相同时按帧号排序
+ */
+bool LRUKReplacer::heap_less(frame_id_t a, frame_id_t b) const {
+    return evict_key_[a] < evict_key_[b] || (evict_key_[a] == evict_key_[b] && a < b);
+}
+
+/**
+ * @description: 把帧放到堆的pos位置并记录它的下标
+ */
+void LRUKReplacer::heap_place(FrameHeap &heap, size_t pos, frame_id_t frame_id) {
+    heap.frames_[pos] = frame_id;
+    heap_pos_[frame_id] = pos;
+}
+
+/**
+ * @description: 把pos位置的帧向堆顶方向调整
+ */
+void LRUKReplacer::heap_sift_up(FrameHeap &heap, size_t pos) {
+    frame_id_t frame_id = heap.frames_[pos];
+    while (pos > 0) {
+        size_t parent = (pos - 1) / 2;
+        if (!heap_less(frame_id, heap.frames_[parent])) break;
+        heap_place(heap, pos, heap.frames_[parent]);
+        pos = parent;
+    }
+    heap_place(heap, pos, frame_id);
+}
+
+/**
+ * @description: 把pos位置的帧向堆底方向调整
+ */
+void LRUKReplacer::heap_sift_down(FrameHeap &heap, size_t pos) {
+    frame_id_t frame_id = heap.frames_[pos];
+    while (true) {
+        size_t child = pos * 2 + 1;
+        if (child >= heap.size_) break;
+        if (child + 1 < heap.size_ && heap_less(heap.frames_[child + 1], heap.frames_[child])) child++;
+        if (!heap_less(heap.frames_[child], frame_id)) break;
+        heap_place(heap, pos, heap.frames_[child]);
+        pos = child;
+    }
+    heap_place(heap, pos, frame_id);
+}
+
+/**
+ * @description: 按evict_key_把帧加入堆，调用者需先设置好evict_key_
+ */
+void LRUKReplacer::heap_push(FrameHeap &heap, frame_id_t frame_id) {
+    heap_place(heap, heap.size_++, frame_id);
+    heap_sift_up(heap, heap.size_ - 1);
+}
+
+/**
+ * @description: 从堆中移除一个帧，用堆的最后一个元素填补它的位置
+ */
+void LRUKReplacer::heap_remove(FrameHeap &heap, frame_id_t frame_id) {
+    size_t pos = heap_pos_[frame_id];
+    frame_id_t last = heap.frames_[--heap.size_];
+    if (last == frame_id) return;
+    heap_place(heap, pos, last);
+    if (pos > 0 && heap_less(last, heap.frames_[(pos - 1) / 2])) {
+        heap_sift_up(heap, pos);
+    } else {
+        heap_sift_down(heap, pos);
+    }
+}
+
+/**
+ * @description: 把可以被淘汰的帧从所在的堆中移除，调用者需持有latch_
+ * @param {frame_id_t} frame_id 可以被淘汰的帧
+ */
+void LRUKReplacer::remove_evictable(frame_id_t frame_id) {
+    heap_remove(access_count_[frame_id] < k_ ? history_heap_ : cache_heap_, frame_id);
+    in_replacer_[frame_id] = 0;
+    size_--;
+}
+
+/**
+ * @description: 使用LRU-K策略删除一个victim frame，并返回该frame的id
+ * @param {frame_id_t*} frame_id 被移除的frame的id
+ * @return {bool} 如果成功淘汰了一个页面则返回true，否则返回false
+ */
+bool LRUKReplacer::victim(frame_id_t *frame_id) {
+    std::lock_guard<std::mutex> guard(latch_);
+
+    if (size_ == 0) return false;
+
+    // 优先淘汰访问次数不足K次的帧(K距离为无穷大)，其次淘汰倒数第K次访问最早的帧
+    frame_id_t best = history_heap_.size_ > 0 ? history_heap_.frames_[0] : cache_heap_.frames_[0];
+    remove_evictable(best);
+    access_count_[best] = 0;  // 帧中的页面被换出，访问历史随之失效
+    *frame_id = best;
+    return true;
+}
+
+/**
+ * @description: 固定指定的frame，即该页面无法被淘汰，并记录一次访问
+ * @param {frame_id_t} 需要固定的frame的id
+ */
+void LRUKReplacer::pin(frame_id_t frame_id) {
+    std::lock_guard<std::mutex> guard(latch_);
+
+    // 先移出堆再记录访问，访问会改变帧在堆中的排序时间戳
+    if (in_replacer_[frame_id]) remove_evictable(frame_id);
+    record_access(frame_id);
+}
+
+/**
+ * @description: 缓冲池内部固定frame(刷脏、预读、写回文件)，不记录访问
+ * @param {frame_id_t} 需要固定的frame的id
+ */
+void LRUKReplacer::pin_internal(frame_id_t frame_id) {
+    std::lock_guard<std::mutex> guard(latch_);
+
+    if (in_replacer_[frame_id]) remove_evictable(frame_id);
+}
+
+/**
+ * @description: 帧将要存放其他页面：移出replacer并清空访问历史，
+ * 避免在扫描的环中反复复用的帧累积访问次数而被当作热点页
+ * @param {frame_id_t} frame_id 被复用的frame的id
+ */
+void LRUKReplacer::remove(frame_id_t frame_id) {
+    std::lock_guard<std::mutex> guard(latch_);
+
+    if (in_replacer_[frame_id]) remove_evictable(frame_id);
+    access_count_[frame_id] = 0;
+}
+
+/**
+ * @description: 取消固定一个frame，代表该页面可以被淘汰
+ * @param {frame_id_t} frame_id 取消固定的frame的id
+ */
+void LRUKReplacer::unpin(frame_id_t frame_id) {
+    std::lock_guard<std::mutex> guard(latch_);
+
+    if (in_replacer_[frame_id]) return;
+    size_t count = access_count_[frame_id];
+    if (count == 0) {
+        // 没有访问过的帧(如预读的页面)不记录访问，按加入的时间和其他访问不足K次的帧排序
+        evict_key_[frame_id] = current_timestamp_++;
+        heap_push(history_heap_, frame_id);
+    } else if (count < k_) {
+        // 次数不足K次时环形数组还没有绕回，下标0即最早一次访问
+        evict_key_[frame_id] = history_[frame_id * k_];
+        heap_push(history_heap_, frame_id);
+    } else {
+        // 下一个写入位置即倒数第K次访问
+        evict_key_[frame_id] = history_[frame_id * k_ + count % k_];
+        heap_push(cache_heap_, frame_id);
+    }
+    in_replacer_[frame_id] = 1;
+    size_++;
+}
+
+/**
+ * @description: 获取当前replacer中可以被淘汰的页面数量
+ */
+size_t LRUKReplacer::Size() {
+    std::lock_guard<std::mutex> guard(latch_);
+    return size_;
+}
@@ -0,0 +1,87 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <mutex>
+#include <vector>
+
+#include "common/config.h"
+#include "replacer/replacer.h"
+
+/*
+LRUKReplacer实现了LRU-K替换策略：淘汰向后K距离(当前时间与倒数第K次访问时间之差)最大的帧，
+访问次数不足K次的帧的K距离视为无穷大，它们之间按最早一次访问的时间做LRU。
+大表顺序扫描读入的页面只被访问一次，会先于被反复访问的索引页被淘汰。
+每个帧最近K次访问的时间戳保存在定长的环形数组中；可以被淘汰的帧按K距离分别放在两个带位置索引的最小堆中，
+victim取堆顶，pin/unpin/victim都是O(log n)。所有数组在构造时按帧数分配，之后不再分配内存。
+刷脏、预读等缓冲池内部的固定通过pin_internal完成，不算作访问，不影响访问历史；
+帧改为存放其他页面(被淘汰、在扫描的环中复用、删除后放回free_list)时由remove清空访问历史
+*/
+class LRUKReplacer : public Replacer {
+   public:
+    /**
+     * @description: 创建一个新的LRUKReplacer
+     * @param {size_t} num_pages LRUKReplacer最多需要存储的page数量
+     * @param {size_t} k 记录的历史访问次数
+     */
+    explicit LRUKReplacer(size_t num_pages, size_t k = LRUK_REPLACER_K);
+
+    ~LRUKReplacer();
+
+    bool victim(frame_id_t *frame_id);
+
+    void pin(frame_id_t frame_id);
+
+    void pin_internal(frame_id_t frame_id);
+
+    void remove(frame_id_t frame_id);
+
+    void unpin(frame_id_t frame_id);
+
+    size_t Size();
+
+   private:
+    void record_access(frame_id_t frame_id);
+
+    void remove_evictable(frame_id_t frame_id);
+
+    // 按evict_key_排序的最小堆，frames_在构造时按帧数分配，size_之后的元素无效
+    struct FrameHeap {
+        std::vector<frame_id_t> frames_;
+        size_t size_ = 0;
+    };
+
+    bool heap_less(frame_id_t a, frame_id_t b) const;
+
+    void heap_place(FrameHeap &heap, size_t pos, frame_id_t frame_id);
+
+    void heap_sift_up(FrameHeap &heap, size_t pos);
+
+    void heap_sift_down(FrameHeap &heap, size_t pos);
+
+    void heap_push(FrameHeap &heap, frame_id_t frame_id);
+
+    void heap_remove(FrameHeap &heap, frame_id_t frame_id);
+
+    std::mutex latch_;                      // 互斥锁
+    size_t k_;                              // LRU-K中的K
+    std::vector<uint64_t> history_;         // 每个帧占k_个元素的环形数组，保存最近k_次访问的时间戳
+    std::vector<uint64_t> access_count_;    // 每个帧被记录的访问次数，帧被淘汰时清零
+    std::vector<char> in_replacer_;         // 帧是否可以被淘汰
+    std::vector<uint64_t> evict_key_;       // 可以被淘汰的帧在所在堆中的排序时间戳
+    std::vector<size_t> heap_pos_;          // 可以被淘汰的帧在所在堆中的下标
+    FrameHeap history_heap_;                // 访问不足K次的可淘汰帧，按最早一次访问排序，
+                                            // 没有访问过的帧按加入replacer的时间排序
+    FrameHeap cache_heap_;                  // 访问达到K次的可淘汰帧，按倒数第K次访问排序
+    uint64_t current_timestamp_;            // 逻辑时钟，每次访问加一
+    size_t size_;                           // 可以被淘汰的帧的数量
+    size_t max_size_;                       // 最大容量（与缓冲池的容量相同）
+};
@@ -33,6 +33,21 @@ class Replacer {
      */
     virtual void pin(frame_id_t frame_id) = 0;
 
+    /**
+     * Pins a frame for the buffer pool's own use (background flushing, read-ahead, writing back a file)
+     * without counting it as an access. Policies that keep no access history treat it as pin().
+     * @param frame_id the id of the frame to pin
+     */
+    virtual void pin_internal(frame_id_t frame_id) { pin(frame_id); }
+
+    /**
+     * Takes a frame out of the replacer because it is about to hold a different page (or none), and forgets the
+     * frame's access history so the new page starts fresh. Policies that keep no access history treat it as
+     * pin_internal().
+     * @param frame_id the id of the frame being reused
+     */
+    virtual void remove(frame_id_t frame_id) { pin_internal(frame_id); }
+
     /**
      * Unpins a frame, indicating that it can now be victimized.
      * @param frame_id the id of the frame to unpin
@@ -29,21 +29,42 @@ See the Mulan PSL v2 for more details. */
 
 static bool should_exit = false;
 
+// 全局所需的管理器对象，在main中解析完启动参数后构建。
+// 按声明的逆序析构，log_manager需要在buffer_pool_manager的后台刷脏线程停止之后析构
+std::unique_ptr<DiskManager> disk_manager;
+std::unique_ptr<LogManager> log_manager;
+std::unique_ptr<BufferPoolManager> buffer_pool_manager;
+std::unique_ptr<RmManager> rm_manager;
+std::unique_ptr<IxManager> ix_manager;
+std::unique_ptr<SmManager> sm_manager;
+std::unique_ptr<LockManager> lock_manager;
+std::unique_ptr<TransactionManager> txn_manager;
+std::unique_ptr<QlManager> ql_manager;
+std::unique_ptr<RecoveryManager> recovery;
+std::unique_ptr<Planner> planner;
+std::unique_ptr<Optimizer> optimizer;
+std::unique_ptr<Portal> portal;
+std::unique_ptr<Analyze> analyze;
+
 // 构建全局所需的管理器对象
-auto disk_manager = std::make_unique<DiskManager>();
-auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager.get());
-auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
-auto ix_manager = std::make_unique<IxManager>(disk_manager.get(), buffer_pool_manager.get());
-auto sm_manager = std::make_unique<SmManager>(disk_manager.get(), buffer_pool_manager.get(), rm_manager.get(), ix_manager.get());
-auto lock_manager = std::make_unique<LockManager>();
-auto txn_manager = std::make_unique<TransactionManager>(lock_manager.get(), sm_manager.get());
-auto ql_manager = std::make_unique<QlManager>(sm_manager.get(), txn_manager.get());
-auto log_manager = std::make_unique<LogManager>(disk_manager.get());
-auto recovery = std::make_unique<RecoveryManager>(disk_manager.get(), buffer_pool_manager.get(), sm_manager.get());
-auto planner = std::make_unique<Planner>(sm_manager.get());
-auto optimizer = std::make_unique<Optimizer>(sm_manager.get(), planner.get());
-auto portal = std::make_unique<Portal>(sm_manager.get());
-auto analyze = std::make_unique<Analyze>(sm_manager.get());
+void init_managers(const std::string &replacer_type, bool direct_io, size_t pool_size, int page_size) {
+    disk_manager = std::make_unique<DiskManager>(USE_IO_URING, direct_io, page_size);
+    buffer_pool_manager =
+        std::make_unique<BufferPoolManager>(pool_size, disk_manager.get(), BUFFER_POOL_INSTANCES, replacer_type);
+    rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+    ix_manager = std::make_unique<IxManager>(disk_manager.get(), buffer_pool_manager.get());
+    sm_manager = std::make_unique<SmManager>(disk_manager.get(), buffer_pool_manager.get(), rm_manager.get(), ix_manager.get());
+    lock_manager = std::make_unique<LockManager>();
+    txn_manager = std::make_unique<TransactionManager>(lock_manager.get(), sm_manager.get());
+    ql_manager = std::make_unique<QlManager>(sm_manager.get(), txn_manager.get());
+    log_manager = std::make_unique<LogManager>(disk_manager.get());
+    recovery = std::make_unique<RecoveryManager>(disk_manager.get(), buffer_pool_manager.get(), sm_manager.get());
+    planner = std::make_unique<Planner>(sm_manager.get());
+    optimizer = std::make_unique<Optimizer>(sm_manager.get(), planner.get());
+    portal = std::make_unique<Portal>(sm_manager.get());
+    analyze = std::make_unique<Analyze>(sm_manager.get());
+}
+
 pthread_mutex_t *buffer_mutex;
 pthread_mutex_t *sockfd_mutex;
 
@@ -258,20 +279,82 @@ void start_server() {
     int ret = shutdown(sockfd_server, SHUT_WR);  // shut down the all or part of a full-duplex connection.
     if(ret == -1) { printf("%s\n", strerror(errno)); }
 //    assert(ret != -1);
+    // 关闭文件之前停止预热、后台刷脏和定期快照，保存缓冲池中的页面供下次启动时预热
+    buffer_pool_manager->stop_warm_up();
+    buffer_pool_manager->stop_flusher();
+    buffer_pool_manager->stop_snapshot();
+    try {
+        buffer_pool_manager->save_snapshot(BUFFER_SNAPSHOT_FILE_NAME);
+    } catch (RMDBError &e) {
+        std::cerr << e.what() << std::endl;
+    }
     sm_manager->close_db();
     std::cout << " DB has been closed.\n";
     std::cout << "Server shuts down." << std::endl;
 }
 
+static void usage(const char *prog) {
+    std::cerr << "Usage: " << prog << " [-r LRU|CLOCK|LRU-K] [-d] [-b pool_frames] [-p page_size] [-s stats_interval] <database>"
+              << std::endl;
+    exit(1);
+}
+
 int main(int argc, char **argv) {
-    if (argc != 2) {
+    // 启动参数: -r 缓冲池置换策略(LRU, CLOCK, LRU-K)；-d 表和索引文件使用O_DIRECT；
+    // -b 缓冲池的帧数；-p 新建数据库的页面大小，已有的数据库使用创建时记录在db.meta中的页面大小；
+    // -s 每隔多少秒将缓冲池统计信息追加到数据库目录下的buffer_stats.log中，0表示不输出
+    std::string replacer_type = REPLACER_TYPE;
+    bool direct_io = USE_DIRECT_IO;
+    long pool_size = BUFFER_POOL_SIZE;
+    long page_size = PAGE_SIZE;
+    long stats_interval = BUFFER_STATS_DUMP_INTERVAL_S;
+    int opt;
+    while ((opt = getopt(argc, argv, "r:db:p:s:")) != -1) {
+        char *end = nullptr;
+        switch (opt) {
+            case 'r':
+                replacer_type = optarg;
+                break;
+            case 'd':
+                direct_io = true;
+                break;
+            case 'b':
+                pool_size = strtol(optarg, &end, 10);
+                if (*end != '\0' || pool_size < BUFFER_POOL_INSTANCES) {
+                    std::cerr << "Buffer pool size must be at least " << BUFFER_POOL_INSTANCES << " frames" << std::endl;
+                    exit(1);
+                }
+                break;
+            case 'p':
+                page_size = strtol(optarg, &end, 10);
+                if (*end != '\0' || !DiskManager::is_valid_page_size(static_cast<int>(page_size))) {
+                    std::cerr << "Page size must be a power of two between " << MIN_PAGE_SIZE << " and "
+                              << MAX_PAGE_SIZE << std::endl;
+                    exit(1);
+                }
+                break;
+            case 's':
+                stats_interval = strtol(optarg, &end, 10);
+                if (*end != '\0' || stats_interval < 0) {
+                    std::cerr << "Stats interval must be a non-negative number of seconds" << std::endl;
+                    exit(1);
+                }
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+    if (optind != argc - 1) {
         // 需要指定数据库名称
-        std::cerr << "Usage: " << argv[0] << " <database>" << std::endl;
-        exit(1);
+        usage(argv[0]);
     }
 
     signal(SIGINT, sigint_handler);
     try {
+        // Database name is passed by args
+        std::string db_name = argv[optind];
+        init_managers(replacer_type, direct_io, pool_size,
+                      SmManager::get_db_page_size(db_name, static_cast<int>(page_size)));
         std::cout << "\n"
                      "  _____  __  __ _____  ____  \n"
                      " |  __ \\|  \\/  |  __ \\|  _ \\ \n"
@@ -283,8 +366,6 @@ int main(int argc, char **argv) {
                      "Welcome to RMDB!\n"
                      "Type 'help;' for help.\n"
                      "\n";
-        // Database name is passed by args
-        std::string db_name = argv[1];
         if (!sm_manager->is_dir(db_name)) {
             // Database not found, create a new one
             sm_manager->create_db(db_name);
@@ -296,6 +377,25 @@ int main(int argc, char **argv) {
         recovery->analyze();
         recovery->redo();
         recovery->undo();
+
+        // 恢复完成后启动后台刷脏线程，只写回对应日志已经落盘的脏页
+        buffer_pool_manager->start_flusher([] { return log_manager->get_persist_lsn(); });
+        // 关闭数据库时会切换工作目录，后台线程使用绝对路径
+        char *cwd = getcwd(nullptr, 0);
+        std::string db_path(cwd);
+        free(cwd);
+        if (USE_WARM_UP) {
+            // 根据上次保存的快照在后台预热缓冲池，同时开始接受连接
+            buffer_pool_manager->start_warm_up(db_path + "/" + BUFFER_SNAPSHOT_FILE_NAME);
+        }
+        if (BUFFER_SNAPSHOT_INTERVAL_S > 0) {
+            buffer_pool_manager->start_snapshot(db_path + "/" + BUFFER_SNAPSHOT_FILE_NAME,
+                                                std::chrono::seconds(BUFFER_SNAPSHOT_INTERVAL_S));
+        }
+        if (stats_interval > 0) {
+            buffer_pool_manager->start_stats_dump(db_path + "/" + BUFFER_STATS_FILE_NAME,
+                                                  std::chrono::seconds(stats_interval));
+        }
         
         // 开启服务端，开始接受客户端连接
         start_server();
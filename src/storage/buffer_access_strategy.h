@@ -0,0 +1,85 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+#include "page.h"
+
+/**
+ * @description: 缓冲池访问策略。顺序扫描大表时使用一个很小的私有帧环(ring)：
+ * 扫描未命中时优先复用环中由本次扫描读入、且当前没有被固定的帧，而不是从整个分片中淘汰页面，
+ * 这样大表的页面只在环内互相替换，不会把B+树内部结点等热点页挤出缓冲池。
+ * 命中缓冲池的访问不受影响。一个策略对象只能被一个扫描使用，但可以同时被该扫描的后台预读使用
+ */
+class BufferAccessStrategy {
+    friend class BufferPoolManager;
+    friend class BufferPoolInstance;
+    friend class PagePrefetcher;
+
+   public:
+    /**
+     * @param {size_t} ring_size 环中帧的总数，平均分给缓冲池的各个分片
+     */
+    explicit BufferAccessStrategy(size_t ring_size = BULK_READ_RING_SIZE) : ring_size_(ring_size) {}
+
+    // 等待经由该策略提交的预读全部完成，之后预读线程不会再访问该对象
+    ~BufferAccessStrategy() {
+        std::unique_lock<std::mutex> lock(prefetch_latch_);
+        prefetch_cv_.wait(lock, [this] { return pending_prefetches_ == 0; });
+    }
+
+    size_t get_ring_size() const { return ring_size_; }
+
+   private:
+    // 一个分片上的环，frames[i]为环中第i个帧，page_ids[i]为本次扫描读入该帧的页面
+    struct Ring {
+        std::vector<frame_id_t> frames;
+        std::vector<PageId> page_ids;
+        size_t next = 0;  // 下一次复用的位置
+    };
+
+    /**
+     * @description: 获取第instance_no个分片上的环，第一次使用时按分片数量分配。
+     * 之后每个环只在对应分片的latch_保护下被访问
+     */
+    Ring *get_ring(size_t instance_no, size_t num_instances) {
+        std::call_once(rings_init_, [&] {
+            size_t slots = ring_size_ / num_instances > 0 ? ring_size_ / num_instances : 1;
+            rings_.resize(num_instances);
+            for (auto &ring : rings_) {
+                ring.frames.assign(slots, INVALID_FRAME_ID);
+                ring.page_ids.resize(slots);
+            }
+        });
+        return &rings_[instance_no];
+    }
+
+    void start_prefetch() {
+        std::lock_guard<std::mutex> guard(prefetch_latch_);
+        pending_prefetches_++;
+    }
+
+    void finish_prefetch() {
+        std::lock_guard<std::mutex> guard(prefetch_latch_);
+        if (--pending_prefetches_ == 0) prefetch_cv_.notify_all();
+    }
+
+    size_t ring_size_;
+    std::vector<Ring> rings_;
+    std::once_flag rings_init_;
+
+    std::mutex prefetch_latch_;
+    std::condition_variable prefetch_cv_;
+    size_t pending_prefetches_ = 0;     // 尚未完成的预读请求数量
+};
@@ -0,0 +1,445 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "buffer_pool_instance.h"
+
+/**
+ * @description: 获取latch_，需要等待时把等待的时间计入fd的统计。没有竞争时只有一次try_lock，不读取时钟
+ * @return {unique_lock<mutex>} 持有latch_的锁
+ * @param {int} fd 本次操作的页面所在的文件
+ */
+std::unique_lock<std::mutex> BufferPoolInstance::lock_latch(int fd) {
+    std::unique_lock<std::mutex> lock(latch_, std::try_to_lock);
+    if( !lock.owns_lock() ) {
+        auto start = std::chrono::steady_clock::now();
+        lock.lock();
+        stats_ -> record_latch_wait(fd, BufferPoolStats::elapsed_ns(start));
+    }
+    return lock;
+}
+
+/**
+ * @description: 从free_list或replacer中得到可淘汰帧页的 *frame_id，并将其pin_count_置为-1，
+ * 此后无锁路径不能再固定该帧。调用者需持有latch_
+ * @return {bool} true: 可替换帧查找成功 , false: 可替换帧查找失败
+ * @param {frame_id_t*} frame_id 帧页id指针,返回成功找到的可替换帧id
+ */
+bool BufferPoolInstance::find_victim_page(frame_id_t *frame_id) {
+    // 1 使用BufferPoolInstance::free_list_判断缓冲池是否已满需要淘汰页面
+    // 1.1 未满获得frame
+    // 1.2 已满使用lru_replacer中的方法选择淘汰页面
+    if( free_list_.size() != 0 ) {//判断缓冲池是否已满需要淘汰页面
+        //没满，空闲帧的pin_count_已经是-1
+        (*frame_id) = free_list_.front();//从free_list或replacer中得到可淘汰帧页的 *frame_id
+        free_list_.pop_front();
+        return true;//未满获得frame
+    }
+    //页面替换类
+    while( replacer_ -> victim( frame_id ) ) {//已满使用lru_replacer中的方法选择淘汰页面
+        int expected = 0;
+        if( pages_[*frame_id].pin_count_.compare_exchange_strong(expected, -1) ) {
+            stats_ -> record_eviction(pages_[*frame_id].id_.fd);
+            return true;
+        }
+        // 该帧在被选中后又被无锁路径固定了，它会在pin_count_归零时重新回到replacer中
+    }
+    return false;
+}
+
+/**
+ * @description: 为使用访问策略的扫描获取可淘汰帧：优先复用环中下一个位置上由本次扫描读入、且没有被固定的帧，
+ * 否则退回到find_victim_page并将得到的帧放入环中。调用者需持有latch_
+ * @return {bool} true: 可替换帧查找成功 , false: 可替换帧查找失败
+ * @param {Ring*} ring 当前分片上的环
+ * @param {PageId} page_id 将要读入的页面
+ * @param {frame_id_t*} frame_id 帧页id指针,返回成功找到的可替换帧id
+ */
+bool BufferPoolInstance::find_ring_victim_page(BufferAccessStrategy::Ring *ring, PageId page_id, frame_id_t *frame_id) {
+    size_t slot = ring -> next;
+    ring -> next = (ring -> next + 1) % ring -> frames.size();
+
+    frame_id_t ring_frame = ring -> frames[slot];
+    int expected = 0;
+    // 该帧可能已经被其他页面换出并复用，只有其中仍是本次扫描读入的页面时才能复用
+    if( ring_frame != INVALID_FRAME_ID && pages_[ring_frame].id_ == ring -> page_ids[slot] &&
+        pages_[ring_frame].pin_count_.compare_exchange_strong(expected, -1) ) {
+        *frame_id = ring_frame;
+        stats_ -> record_eviction(pages_[ring_frame].id_.fd);
+    } else if( !find_victim_page(frame_id) ) {
+        return false;
+    }
+    ring -> frames[slot] = *frame_id;
+    ring -> page_ids[slot] = page_id;
+    return true;
+}
+
+/**
+ * @description: 更新页面数据, 如果为脏页则需写入磁盘，再更新为新页面，更新page元数据(data, is_dirty, page_id)，
+ * 并将旧页面从page table中删除。新页面由调用者在设置pin_count_后插入page table
+ * @param {Page*} page 写回页指针
+ * @param {PageId} new_page_id 新的page_id
+ * @param {frame_id_t} new_frame_id 新的帧frame_id
+ */
+void BufferPoolInstance::update_page(Page *page, PageId new_page_id, frame_id_t new_frame_id) {
+    // 1 如果是脏页，写回磁盘，并且把dirty置为false
+    // 2 更新page table
+    // 3 重置page的data，更新page id
+    if( page -> is_dirty() ) {//是脏页写回磁盘
+        page->is_dirty_ = false;
+        disk_manager_ -> write_page(page->get_page_id().fd, page->get_page_id().page_no, page->get_data(), page_size_);
+        stats_ -> record_writeback(page->get_page_id().fd);
+    }
+    //page_table_用于根据PageId定位其在BufferPool中的frame_id_t
+    //更新页表
+    if( page -> id_.page_no != INVALID_PAGE_ID ) page_table_.erase(page -> id_);
+    //把脏页写回磁盘，要更新page元数据(data, is_dirty, page_id)和page table
+    //更新页面
+    page -> reset_memory(page_size_);
+    page -> id_ = new_page_id;
+    // 该帧可能在被选中前又短暂回到了replacer中，将其移出，并清空旧页面的访问历史；对新页面的访问由调用者记录
+    replacer_ -> remove(new_frame_id);
+
+    if( page -> id_ .page_no != INVALID_PAGE_ID ) {
+        try {
+            disk_manager_ -> read_page(page->get_page_id().fd, page->get_page_id().page_no, page->get_data(), page_size_);
+        } catch( RMDBError &e ) {
+            // 读取失败(如预读时文件已被关闭)，把帧还给free_list_，避免它永远处于-1状态
+            page -> id_.page_no = INVALID_PAGE_ID;
+            free_list_.push_back(new_frame_id);
+            throw;
+        }
+    }
+}
+
+/**
+ * @description: 不加锁地固定一个帧，并校验其中存放的仍是page_id
+ * @return {bool} 固定成功且帧中是目标页返回true
+ * @param {frame_id_t} frame_id 无锁页表查到的帧号，可能已经过期
+ * @param {PageId} page_id 目标页
+ * @param {bool} record_access 是否向replacer记录一次访问，缓冲池内部的固定为false
+ */
+bool BufferPoolInstance::try_pin_frame(frame_id_t frame_id, PageId page_id, bool record_access) {
+    Page *page = &pages_[frame_id];
+    int pin_count = page -> pin_count_.load();
+    do {
+        if( pin_count < 0 ) return false;//该帧空闲或正在换页
+    } while( !page -> pin_count_.compare_exchange_weak(pin_count, pin_count + 1) );
+    // 固定之后该帧不会被换出，id_不再变化，此时再校验查表和固定之间该帧是否已被换成别的页
+    if( !(page -> id_ == page_id) ) {
+        unpin_frame(frame_id);
+        return false;
+    }
+    if( pin_count == 0 ) {
+        if( record_access ) replacer_ -> pin(frame_id);
+        else replacer_ -> pin_internal(frame_id);
+    }
+    return true;
+}
+
+/**
+ * @description: 将帧的pin_count_减一，归零时交给replacer
+ * @return {bool} 若pin_count_已经<=0则返回false
+ * @param {frame_id_t} frame_id 目标帧
+ */
+bool BufferPoolInstance::unpin_frame(frame_id_t frame_id) {
+    Page *page = &pages_[frame_id];
+    int pin_count = page -> pin_count_.load();
+    do {
+        if( pin_count <= 0 ) return false;
+    } while( !page -> pin_count_.compare_exchange_weak(pin_count, pin_count - 1) );
+    if( pin_count == 1 ) replacer_ -> unpin(frame_id);//减少页面的一次引用次数
+    return true;
+}
+
+/**
+ * @description: 从当前分片获取需要的页。
+ *              如果页表中存在page_id（说明该page在缓冲池中），并且pin_count++。
+ *              如果页表不存在page_id（说明该page在磁盘中），则找缓冲池victim
+ * page，将其替换为磁盘中读取的page，pin_count置1。
+ * @return {Page*} 若获得了需要的页则将其返回，否则返回nullptr
+ * @param {PageId} page_id 需要获取的页的PageId
+ * @param {Ring*} ring 访问策略在当前分片上的环，不为空时未命中的页面读入环中的帧
+ */
+Page *BufferPoolInstance::fetch_page(PageId page_id, BufferAccessStrategy::Ring *ring) {
+    //  0.     无锁查找page_table_，命中时直接用CAS固定目标页并返回，不获取latch_
+    //  1.     加锁后从page_table_中重新搜寻目标页
+    //  1.1    若目标页有被page_table_记录，则将其所在frame固定(pin)，并返回目标页。
+    //  1.2    否则，尝试调用find_victim_page获得一个可用的frame，若失败则返回nullptr
+    //  2.     若获得的可用frame存储的为dirty page，则须调用updata_page将page写回到磁盘
+    //  3.     调用disk_manager_的read_page读取目标页到frame
+    //  4.     固定目标页，更新pin_count_
+    //  5.     返回目标页
+    frame_id_t frame_id;
+    if( page_table_.find(page_id, &frame_id) && try_pin_frame(frame_id, page_id, true) ) {
+        stats_ -> record_hit(page_id.fd);
+        return &pages_[frame_id];
+    }
+
+    std::unique_lock<std::mutex> lock = lock_latch(page_id.fd);
+    // 持有latch_时没有并发的换页，页表中的帧pin_count_只有在被reserve_page预留、正在批量读入时才为-1
+    while( page_table_.find(page_id, &frame_id) ) {//该page在缓冲池中
+        if( pages_[frame_id].pin_count_ < 0 ) {
+            stats_ -> record_pin_wait(page_id.fd);
+            io_cv_.wait(lock);//等待批量读入完成后重新查找
+            continue;
+        }
+        if( pages_[frame_id].pin_count_ ++ == 0 ) replacer_ -> pin(frame_id);//固定页面
+        stats_ -> record_hit(page_id.fd);
+        return &pages_[frame_id];
+    }
+    //该page不在缓冲池中
+    stats_ -> record_miss(page_id.fd);
+    bool found = ring != nullptr ? find_ring_victim_page(ring, page_id, &frame_id) : find_victim_page(&frame_id);
+    if( !found ) return nullptr;//用DiskManager从磁盘中读取。
+    update_page(&pages_[frame_id], page_id, frame_id);//找缓冲池的淘汰页，将其替换为磁盘中读取的page
+    //即把page从磁盘写入内存
+    replacer_ -> pin(frame_id);
+    pages_[frame_id].pin_count_ = 1;
+    page_table_.insert(page_id, frame_id);//页面内容就绪后再发布到页表
+
+    return &pages_[frame_id];
+}
+
+/**
+ * @description: 取消固定pin_count>0的在缓冲池中的page
+ * @return {bool} 如果目标页的pin_count<=0则返回false，否则返回true
+ * @param {PageId} page_id 目标page的page_id
+ * @param {bool} is_dirty 若目标page应该被标记为dirty则为true，否则为false
+ */
+bool BufferPoolInstance::unpin_page(PageId page_id, bool is_dirty) {
+    // 1. 尝试在page_table_中搜寻page_id对应的页P，无锁查找失败时加锁重试
+    // 1.1 P在页表中不存在 return false
+    // 1.2 P在页表中存在，获取其pin_count_
+    // 2. 根据参数is_dirty，更改P的is_dirty_；必须在pin_count_归零之前，否则换页时可能看不到脏标记
+    // 3.1 若pin_count_已经等于0，则返回false
+    // 3.2 若pin_count_大于0，则pin_count_自减一
+    // 3.2.1 若自减后等于0，则调用replacer_的Unpin
+    frame_id_t frame_id;
+    if( !page_table_.find(page_id, &frame_id) || !(pages_[frame_id].id_ == page_id) ) {
+        std::unique_lock<std::mutex> lock = lock_latch(page_id.fd);
+        if( !page_table_.find(page_id, &frame_id) ) return false;//没找到，P在页表中不存在 return false
+    }
+    //P在页表中存在
+    Page *page = &pages_[frame_id];
+    //参数is_dirty决定是否对页面置脏，如果上层修改了页面，就将该页面的脏标志置true。
+    if( is_dirty ) page -> is_dirty_ = true;//页面是否需要置脏
+
+    return unpin_frame(frame_id);
+}
+
+/**
+ * @description: 将目标页写回磁盘，不考虑当前页面是否正在被使用
+ * @return {bool} 成功则返回true，否则返回false(只有page_table_中没有目标页时)
+ * @param {PageId} page_id 目标页的page_id，不能为INVALID_PAGE_ID
+ */
+bool BufferPoolInstance::flush_page(PageId page_id) {
+    // 0. lock latch
+    // 1. 查找页表,尝试获取目标页P
+    // 1.1 目标页P没有被page_table_记录 ，返回false
+    // 2. 无论P是否为脏都将其写回磁盘。
+    // 3. 更新P的is_dirty_
+    std::unique_lock<std::mutex> lock = lock_latch(page_id.fd);
+    //从内存往磁盘上写
+
+    frame_id_t frame_id;
+    if( !page_table_.find(page_id, &frame_id) ) return false;//页表查找
+
+    Page *page = &pages_[frame_id];//存在时如何写回磁盘
+    if( page -> pin_count_ < 0 ) return true;//正在被批量读入的页面和磁盘上一致
+    // 先清除脏位再写回，写回期间其他线程重新置脏不会丢失
+    page -> is_dirty_ = false;
+    //调用类disk_manager
+    disk_manager_ -> write_page(page_id.fd, page_id.page_no, page->data_, page_size_);
+    stats_ -> record_writeback(page_id.fd);
+
+    return true;
+}
+
+/**
+ * @description: 为一个已经在磁盘上分配了页号的新page分配帧，即从磁盘中移动一个新建的空page到当前分片某个位置。
+ * @return {Page*} 返回新创建的page，若当前分片中没有可用的帧则返回nullptr
+ * @param {PageId} page_id 新page的page_id，由BufferPoolManager通过disk_manager_分配
+ */
+Page *BufferPoolInstance::new_page(PageId page_id) {
+    // 1.   获得一个可用的frame，若无法获得则返回nullptr
+    // 2.   将frame的数据写回磁盘
+    // 3.   固定frame，更新pin_count_
+    // 4.   返回获得的page
+    std::unique_lock<std::mutex> lock = lock_latch(page_id.fd);
+
+    frame_id_t frame_id;
+    if( !find_victim_page(&frame_id) ) return nullptr;//没有找到淘汰页（如果当前分片中的所有页面都被固定，则返回nullptr）
+    //找到淘汰页了
+    update_page(&pages_[frame_id], page_id, frame_id);//更新淘汰页的的元数据，清空内存
+
+    replacer_ -> pin(frame_id);
+    pages_[frame_id].pin_count_ = 1;//pin_count设置为1。
+    page_table_.insert(page_id, frame_id);//添加到页表中
+
+    return &pages_[frame_id];//返回一个指向P的指针。
+}
+
+/**
+ * @description: 从当前分片删除目标页
+ * @return {bool} 如果目标页不存在于当前分片或者成功被删除则返回true，若其存在于当前分片但无法删除则返回false
+ * @param {PageId} page_id 目标页
+ */
+bool BufferPoolInstance::delete_page(PageId page_id) {
+    // 1.   在page_table_中查找目标页，若不存在返回true
+    // 2.   若目标页的pin_count不为0，则返回false
+    // 3.   将目标页数据写回磁盘，从页表中删除目标页，重置其元数据，将其加入free_list_，返回true
+    std::unique_lock<std::mutex> lock = lock_latch(page_id.fd);
+    //在页表中搜索请求的页(P)。
+    frame_id_t frame_id;
+    if( !page_table_.find(page_id, &frame_id) ) return true;//如果P不存在，返回true。
+
+    Page *page = &pages_[frame_id];
+
+    int expected = 0;
+    // 如果P存在，但引脚计数非零，返回false。有人正在使用这个页面，即不能删除
+    // 置为-1后无锁路径不能再固定该帧，删除后它作为空闲帧保持-1
+    if( !page -> pin_count_.compare_exchange_strong(expected, -1) ) return false;
+
+    //否则可以被删除，释放磁盘上的页。
+    disk_manager_->deallocate_page(page_id.page_no);
+    //重置其元数据并将其返回给free
+    page_id.page_no =  INVALID_PAGE_ID;
+    update_page(page, page_id, frame_id);
+    free_list_.push_back(frame_id);
+
+    return true;
+}
+
+/**
+ * @description: 获取当前分片中属于文件fd的所有页的页号，由BufferPoolManager合并成连续的页面写回
+ * @param {int} fd 文件句柄
+ * @param {vector<page_id_t>*} page_nos 返回的页号
+ */
+void BufferPoolInstance::get_pages_of_file(int fd, std::vector<page_id_t> *page_nos) {
+    std::lock_guard<std::mutex> guard(latch_);  // 确保线程安全
+
+    for (size_t i = 0; i < pool_size_; i++) {//存在于缓冲池的所有页面都刷新到磁盘
+        Page *page = &pages_[i];//在磁盘上存储数据的结构
+        // pin_count_为-1的帧空闲或正在被批量读入，不需要写回
+        if (page->get_page_id().fd == fd && page->get_page_id().page_no != INVALID_PAGE_ID && page->pin_count_ >= 0) {
+            page_nos->push_back(page->get_page_id().page_no);
+        }
+    }
+}
+
+/**
+ * @description: 获取当前分片中所有页面的PageId，用于保存缓冲池快照
+ * @param {vector<PageId>*} page_ids 返回的PageId
+ */
+void BufferPoolInstance::get_resident_pages(std::vector<PageId> *page_ids) {
+    std::lock_guard<std::mutex> guard(latch_);
+
+    for (size_t i = 0; i < pool_size_; i++) {
+        Page *page = &pages_[i];
+        if (page->get_page_id().page_no != INVALID_PAGE_ID && page->pin_count_ >= 0) {
+            page_ids->push_back(page->get_page_id());
+        }
+    }
+}
+
+/**
+ * @description: 若目标页在当前分片中则固定并返回它，不从磁盘读取。用于写回文件，不向replacer记录访问
+ * @return {Page*} 目标页，不在缓冲池中或正在被批量读入时返回nullptr
+ * @param {PageId} page_id 目标页
+ */
+Page *BufferPoolInstance::fetch_resident_page(PageId page_id) {
+    frame_id_t frame_id;
+    if( page_table_.find(page_id, &frame_id) && try_pin_frame(frame_id, page_id, false) ) {
+        return &pages_[frame_id];
+    }
+    std::unique_lock<std::mutex> lock = lock_latch(page_id.fd);
+    if( !page_table_.find(page_id, &frame_id) || pages_[frame_id].pin_count_ < 0 ) return nullptr;
+    if( pages_[frame_id].pin_count_ ++ == 0 ) replacer_ -> pin_internal(frame_id);
+    return &pages_[frame_id];
+}
+
+/**
+ * @description: 为批量读入预留一个帧：换出victim页，将page_id登记到页表中，但pin_count_保持-1，
+ * 此时其他线程fetch该页会等待读入完成。读入由调用者在不持有latch_的情况下完成，之后必须调用finish_reserved_page
+ * @return {Page*} 预留的帧，若页面已经在缓冲池中或没有可用的帧则返回nullptr
+ * @param {PageId} page_id 需要读入的页面
+ * @param {Ring*} ring 访问策略在当前分片上的环，可以为空
+ */
+Page *BufferPoolInstance::reserve_page(PageId page_id, BufferAccessStrategy::Ring *ring) {
+    std::unique_lock<std::mutex> lock = lock_latch(page_id.fd);
+
+    frame_id_t frame_id;
+    if( page_table_.find(page_id, &frame_id) ) return nullptr;
+    bool found = ring != nullptr ? find_ring_victim_page(ring, page_id, &frame_id) : find_victim_page(&frame_id);
+    if( !found ) return nullptr;
+
+    Page *page = &pages_[frame_id];
+    // 写回victim并更新元数据，但不读取新页面
+    PageId invalid_id = {page_id.fd, INVALID_PAGE_ID};
+    update_page(page, invalid_id, frame_id);
+    page -> id_ = page_id;
+    page_table_.insert(page_id, frame_id);
+    return page;
+}
+
+/**
+ * @description: 结束reserve_page预留的帧的读入
+ * @param {Page*} page reserve_page返回的帧
+ * @param {bool} loaded 页面是否读入成功，失败时将帧从页表中移除并还给free_list_
+ */
+void BufferPoolInstance::finish_reserved_page(Page *page, bool loaded) {
+    {
+        std::unique_lock<std::mutex> lock = lock_latch(page -> id_.fd);
+        frame_id_t frame_id = static_cast<frame_id_t>(page - pages_);
+        if( loaded ) {
+            page -> pin_count_ = 0;
+            replacer_ -> unpin(frame_id);//读入后未被固定，可以被淘汰
+        } else {
+            page_table_.erase(page -> id_);
+            page -> id_.page_no = INVALID_PAGE_ID;
+            free_list_.push_back(frame_id);
+        }
+    }
+    io_cv_.notify_all();
+}
+
+/**
+ * @description: 统计当前分片中的脏页个数，不加锁，结果只是近似值，供后台刷脏线程判断水位
+ * @return {size_t} 脏页个数
+ */
+size_t BufferPoolInstance::get_num_dirty_pages() const {
+    size_t num_dirty = 0;
+    for (size_t i = 0; i < pool_size_; i++) {
+        if (pages_[i].pin_count_ >= 0 && pages_[i].is_dirty()) num_dirty++;
+    }
+    return num_dirty;
+}
+
+/**
+ * @description: 从flush_hand_开始循环扫描帧数组，固定至多max_pages个未被固定的脏页，交给后台刷脏线程写回。
+ * 正在被使用的页面不会被选中，它们在之后的轮次中再写回
+ * @param {size_t} max_pages 最多选取的页面个数
+ * @param {vector<Page*>*} pages 返回被固定的脏页，调用者写回后需要unpin_page
+ */
+void BufferPoolInstance::pin_dirty_pages(size_t max_pages, std::vector<Page *> *pages) {
+    std::lock_guard<std::mutex> guard(latch_);
+
+    size_t num_pinned = 0;
+    for (size_t k = 0; k < pool_size_ && num_pinned < max_pages; k++) {
+        frame_id_t frame_id = static_cast<frame_id_t>(flush_hand_);
+        flush_hand_ = (flush_hand_ + 1) % pool_size_;
+        Page *page = &pages_[frame_id];
+        int expected = 0;
+        if( !page -> is_dirty() || !page -> pin_count_.compare_exchange_strong(expected, 1) ) continue;
+        replacer_ -> pin_internal(frame_id);
+        pages -> push_back(page);
+        num_pinned++;
+    }
+}
@@ -0,0 +1,123 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <vector>
+
+#include "buffer_access_strategy.h"
+#include "buffer_pool_stats.h"
+#include "disk_manager.h"
+#include "errors.h"
+#include "page.h"
+#include "page_table.h"
+#include "replacer/clock_replacer.h"
+#include "replacer/lru_k_replacer.h"
+#include "replacer/lru_replacer.h"
+#include "replacer/replacer.h"
+
+/**
+ * @description: 缓冲池的一个分片，拥有独立的帧数组、页表、空闲链表、置换策略和互斥锁，
+ * 由BufferPoolManager根据PageId的哈希值将页面路由到对应的分片上。
+ * 命中缓冲池的fetch_page/unpin_page只读无锁页表并用CAS修改pin_count_，不获取latch_；
+ * 未命中、换页、删除和刷盘仍在latch_保护下进行
+ */
+class BufferPoolInstance {
+   private:
+    size_t pool_size_;      // 当前分片中可容纳页面的个数，即帧的个数
+    int page_size_;         // 每一帧的字节数，即数据库的页面大小
+    Page *pages_;           // 当前分片中的Page对象数组(只有元数据)，在构造函数中申请内存空间，在析构函数中释放
+    PageTable page_table_;  // 页面号到帧号的无锁映射表，用于根据页面的PageId定位该页面的帧编号
+    std::list<frame_id_t> free_list_;   // 空闲帧编号的链表
+    DiskManager *disk_manager_;
+    BufferPoolStats *stats_;    // 所属BufferPoolManager的统计信息，所有分片共用
+    Replacer *replacer_;    // 当前分片的置换策略，LRU、CLOCK或LRU-K
+    std::mutex latch_;      // 用于当前分片内共享数据结构的并发控制
+    std::condition_variable io_cv_;     // 等待reserve_page预留的页面读入完成
+    size_t flush_hand_ = 0; // 后台刷脏线程下一次开始扫描的帧
+
+   public:
+    BufferPoolInstance(size_t pool_size, char *frame_data, DiskManager *disk_manager, BufferPoolStats *stats,
+                       const std::string &replacer_type = REPLACER_TYPE)
+        : pool_size_(pool_size),
+          page_size_(disk_manager->get_page_size()),
+          page_table_(pool_size),
+          disk_manager_(disk_manager),
+          stats_(stats) {
+        // 可以被Replacer改变
+        if (replacer_type == "LRU")
+            replacer_ = new LRUReplacer(pool_size_);
+        else if (replacer_type == "CLOCK")
+            replacer_ = new ClockReplacer(pool_size_);
+        else if (replacer_type == "LRU-K")
+            replacer_ = new LRUKReplacer(pool_size_);
+        else {
+            throw InternalError("Unknown replacer type: " + replacer_type);
+        }
+        // 页面元数据单独分配，页面数据使用BufferPoolManager的FrameArena中从frame_data开始的pool_size_帧
+        pages_ = new Page[pool_size_];
+        // 初始化时，所有的page都在free_list_中，空闲帧的pin_count_为-1
+        for (size_t i = 0; i < pool_size_; ++i) {
+            pages_[i].data_ = frame_data + i * page_size_;
+            pages_[i].pin_count_ = -1;
+            free_list_.emplace_back(static_cast<frame_id_t>(i));  // static_cast转换数据类型
+        }
+    }
+
+    ~BufferPoolInstance() {
+        delete[] pages_;
+        delete replacer_;
+    }
+
+    size_t get_pool_size() const { return pool_size_; }
+
+    Page* fetch_page(PageId page_id, BufferAccessStrategy::Ring* ring = nullptr);
+
+    bool unpin_page(PageId page_id, bool is_dirty);
+
+    bool flush_page(PageId page_id);
+
+    Page* new_page(PageId page_id);
+
+    bool delete_page(PageId page_id);
+
+    Page* fetch_resident_page(PageId page_id);
+
+    void get_pages_of_file(int fd, std::vector<page_id_t>* page_nos);
+
+    void get_resident_pages(std::vector<PageId>* page_ids);
+
+    Page* reserve_page(PageId page_id, BufferAccessStrategy::Ring* ring = nullptr);
+
+    void finish_reserved_page(Page* page, bool loaded);
+
+    size_t get_num_dirty_pages() const;
+
+    void pin_dirty_pages(size_t max_pages, std::vector<Page*>* pages);
+
+   private:
+    std::unique_lock<std::mutex> lock_latch(int fd);
+
+    bool find_victim_page(frame_id_t* frame_id);
+
+    bool find_ring_victim_page(BufferAccessStrategy::Ring* ring, PageId page_id, frame_id_t* frame_id);
+
+    bool try_pin_frame(frame_id_t frame_id, PageId page_id, bool record_access);
+
+    bool unpin_frame(frame_id_t frame_id);
+
+    void update_page(Page* page, PageId new_page_id, frame_id_t new_frame_id);
+};
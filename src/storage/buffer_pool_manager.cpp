@@ -10,156 +10,36 @@ See the Mulan PSL v2 for more details. */
 
 #include "buffer_pool_manager.h"
 
-/**
- * @description: 从free_list或replacer中得到可淘汰帧页的 *frame_id
- * @return {bool} true: 可替换帧查找成功 , false: 可替换帧查找失败
- * @param {frame_id_t*} frame_id 帧页id指针,返回成功找到的可替换帧id
- */
-bool BufferPoolManager::find_victim_page(frame_id_t *frame_id) {
-    // Todo:
-    // 1 使用BufferPoolManager::free_list_判断缓冲池是否已满需要淘汰页面
-    // 1.1 未满获得frame
-    // 1.2 已满使用lru_replacer中的方法选择淘汰页面
-    
-    if( free_list_.size() != 0 ) {//判断缓冲池是否已满需要淘汰页面
-        //没满
-        (*frame_id) = free_list_.front();//从free_list或replacer中得到可淘汰帧页的 *frame_id
-        free_list_.pop_front();
-        return true;//未满获得frame
-    }
-    //页面替换类
-    return replacer_ -> victim( frame_id );//已满使用lru_replacer中的方法选择淘汰页面    
-}
-
+#include <algorithm>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
 
 /**
- * @description: 更新页面数据, 如果为脏页则需写入磁盘，再更新为新页面，更新page元数据(data, is_dirty, page_id)和page
- * table
- * @param {Page*} page 写回页指针
- * @param {PageId} new_page_id 新的page_id
- * @param {frame_id_t} new_frame_id 新的帧frame_id
+ * @description: 从buffer pool获取需要的页，由page_id所在的分片负责查找或从磁盘读取
+ * @return {Page*} 若获得了需要的页则将其返回，否则返回nullptr
+ * @param {PageId} page_id 需要获取的页的PageId
+ * @param {BufferAccessStrategy*} strategy 顺序扫描的访问策略，为空时使用整个缓冲池
  */
-void BufferPoolManager::update_page(Page *page, PageId new_page_id, frame_id_t new_frame_id) {
-    // Todo:
-    // 1 如果是脏页，写回磁盘，并且把dirty置为false
-    // 2 更新page table
-    // 3 重置page的data，更新page id
-    // std::lock_guard<std::mutex> guard(latch_);
-
-    // // 1. 如果是脏页，写回磁盘，并且把dirty置为false
-    // if (page->is_dirty()) {
-    //     int fd = page->get_page_id().fd;  // 获取文件描述符
-    //     if (fd != -1) {
-    //         disk_manager_->write_page(fd, page->get_page_id().page_no, page->get_data(), PAGE_SIZE);  // 写回磁盘
-    //     }
-    //     page->is_dirty_ = false;
-    // }
-
-    // // 2. 更新page table
-    // page_table_.erase(page->get_page_id());
-    // page_table_[new_page_id] = new_frame_id;
-
-    // // 3. 重置page的data，更新page id
-    // page->reset_memory();
-    // page->id_ = new_page_id;
-    // page->pin_count_ ++; // 假设更新后页面被固定在内存中
-    if( page -> is_dirty() ) {//是脏页写回磁盘
-        disk_manager_ -> write_page(page->get_page_id().fd, page->get_page_id().page_no, page->get_data(), PAGE_SIZE);
-        page->is_dirty_ = false;
-    }
-    //把脏页写回磁盘，要更新page元数据(data, is_dirty, page_id)和page table
-    //更新页面
-    page -> reset_memory();
-    //page_table_用于根据PageId定位其在BufferPool中的frame_id_t
-    //更新页表
-    auto it = page_table_.find(page -> id_);
-    if( it != page_table_.end() ) page_table_.erase(it);
-    page_table_[page -> id_ = new_page_id] = new_frame_id;
-
-    if( page -> id_ .page_no != INVALID_FRAME_ID ) {
-        disk_manager_ -> read_page(page->get_page_id().fd, page->get_page_id().page_no, page->get_data(), PAGE_SIZE);
-    }    
+Page *BufferPoolManager::fetch_page(PageId page_id, BufferAccessStrategy *strategy) {
+    auto start = std::chrono::steady_clock::now();
+    size_t instance_no = get_instance_no(page_id);
+    BufferAccessStrategy::Ring *ring = strategy == nullptr ? nullptr : strategy->get_ring(instance_no, instances_.size());
+    Page *page = instances_[instance_no]->fetch_page(page_id, ring);
+    stats_.record_latency(BUFFER_OP_FETCH, page_id.fd, BufferPoolStats::elapsed_ns(start));
+    return page;
 }
 
 /**
- * @description: 从buffer pool获取需要的页。
- *              如果页表中存在page_id（说明该page在缓冲池中），并且pin_count++。
- *              如果页表不存在page_id（说明该page在磁盘中），则找缓冲池victim
- * page，将其替换为磁盘中读取的page，pin_count置1。
- * @return {Page*} 若获得了需要的页则将其返回，否则返回nullptr
- * @param {PageId} page_id 需要获取的页的PageId
+ * @description: 异步地将页面读入缓冲池但不固定它，由后台预读线程完成，调用者不等待读取结束
+ * @param {PageId} page_id 需要预读的页的PageId
+ * @param {BufferAccessStrategy*} strategy 读入页面时使用的访问策略，为空时使用整个缓冲池
  */
-Page *BufferPoolManager::fetch_page(PageId page_id) {
-    // Todo:
-    //  1.     从page_table_中搜寻目标页
-    //  1.1    若目标页有被page_table_记录，则将其所在frame固定(pin)，并返回目标页。
-    //  1.2    否则，尝试调用find_victim_page获得一个可用的frame，若失败则返回nullptr
-    //  2.     若获得的可用frame存储的为dirty page，则须调用updata_page将page写回到磁盘
-    //  3.     调用disk_manager_的read_page读取目标页到frame
-    //  4.     固定目标页，更新pin_count_
-    //  5.     返回目标页
-    // std::lock_guard<std::mutex> guard(latch_);
-
-    // // 1. 从page_table_中搜寻目标页
-    // auto it = page_table_.find(page_id);
-    // if (it != page_table_.end()) {
-    //     // 1.1 若目标页有被page_table_记录，则将其所在frame固定(pin)，并返回目标页
-    //     frame_id_t frame_id = it->second;
-    //     Page *page = &pages_[frame_id];
-    //     page->pin_count_++;
-    //     replacer_->pin(frame_id);
-    //     return page;
-    // }
-
-    // // 1.2 否则，尝试调用find_victim_page获得一个可用的frame，若失败则返回nullptr
-    // frame_id_t victim_frame_id;
-    // if (!find_victim_page(&victim_frame_id)) {
-    //     return nullptr;
-    // }
-
-    // // 2. 若获得的可用frame存储的为dirty page，则须调用update_page将page写回到磁盘
-    // Page *victim_page = &pages_[victim_frame_id];
-    // if (victim_page->is_dirty()) {
-    //     // int fd = disk_manager_->get_file_fd(victim_page->get_page_id());
-    //     // if (fd != -1) {
-    //     //     disk_manager_->write_page(fd, victim_page->get_page_id(), victim_page->get_data(), PAGE_SIZE);
-    //     // }
-    //     // victim_page->is_dirty_ = false;
-    //     update_page(victim_page, page_id, victim_frame_id);
-    // }
-
-    // // 3. 调用disk_manager_的read_page读取目标页到frame
-    // page_table_.erase(victim_page->id_);
-    // page_table_[page_id] = victim_frame_id;
-    // Page *new_page = victim_page;
-    // disk_manager_->read_page(page_id.fd, page_id.page_no, new_page->data_, PAGE_SIZE);
-    // // 4. 固定目标页，更新pin_count_
-    // new_page->id_ = page_id;
-    // new_page->pin_count_ ++;
-    // new_page->is_dirty_ = false;
-    // replacer_->pin(victim_frame_id);
-
-    // // 5. 更新page table
-    // page_table_[new_page->id_] = victim_frame_id;
-
-    // // 6. 返回目标页
-    // return new_page;
-    std::lock_guard<std::mutex> guard(latch_);
-
-    frame_id_t frame_id;
-
-    if( page_table_.find(page_id) != page_table_.end() ) {//该page在缓冲池中
-        frame_id = page_table_[page_id];//更新页表
-    } else { //该page不在缓冲池中
-        if( !find_victim_page(&frame_id) ) return nullptr;//用DiskManager从磁盘中读取。
-        update_page(&pages_[frame_id], page_id, frame_id);//找缓冲池的淘汰页，将其替换为磁盘中读取的page
-        //即把page从磁盘写入内存
-    }
-
-    replacer_ -> pin(frame_id);//固定页面
-    pages_[frame_id].pin_count_ ++;//在缓冲池中，pin_count++
-
-    return &pages_[frame_id];
+void BufferPoolManager::prefetch_page(PageId page_id, BufferAccessStrategy *strategy) {
+    std::call_once(prefetcher_init_, [this] { prefetcher_ = std::make_unique<PagePrefetcher>(this, PREFETCH_WORKERS); });
+    prefetcher_->prefetch(page_id, strategy);
 }
 
 /**
@@ -169,62 +49,7 @@ Page *BufferPoolManager::fetch_page(PageId page_id) {
  * @param {bool} is_dirty 若目标page应该被标记为dirty则为true，否则为false
  */
 bool BufferPoolManager::unpin_page(PageId page_id, bool is_dirty) {
-    // Todo:
-    // 0. lock latch
-    // 1. 尝试在page_table_中搜寻page_id对应的页P
-    // 1.1 P在页表中不存在 return false
-    // 1.2 P在页表中存在，获取其pin_count_
-    // 2.1 若pin_count_已经等于0，则返回false
-    // 2.2 若pin_count_大于0，则pin_count_自减一
-    // 2.2.1 若自减后等于0，则调用replacer_的Unpin
-    // 3 根据参数is_dirty，更改P的is_dirty_
-    // std::lock_guard<std::mutex> guard(latch_);
-
-    // // 1. 尝试在page_table_中搜寻page_id对应的页P
-    // auto it = page_table_.find(page_id);
-    // if (it == page_table_.end()) {
-    //     // 1.1 P在页表中不存在 return false
-    //     return false;
-    // }
-
-    // // 1.2 P在页表中存在，获取其pin_count_
-    // frame_id_t frame_id = it->second;
-    // Page *page = &pages_[frame_id];
-    // int pin_count = page->pin_count_;
-
-    // // 2.1 若pin_count_已经等于0，则返回false
-    // if (pin_count <= 0) {
-    //     return false;
-    // }
-
-    // // 2.2 若pin_count_大于0，则pin_count_自减一
-    // page->pin_count_--;
-
-    // // 2.2.1 若自减后等于0，则调用replacer_的Unpin
-    // if (page->pin_count_ == 0) {
-    //     replacer_->unpin(frame_id);
-    // }
-
-    // // 3. 根据参数is_dirty，更改P的is_dirty_
-    // if (is_dirty) {
-    //     page->is_dirty_ = true;
-    // }
-    // return true;
-    std::lock_guard<std::mutex> guard(latch_);
-    //尝试在page_table_中搜索页P的page_id
-    if( page_table_.find(page_id) == page_table_.end() ) return false;//没找到，P在页表中不存在 return false
-    //P在页表中存在
-    frame_id_t frame_id = page_table_[page_id];
-
-    Page *page = &pages_[frame_id];
-
-    if( page -> pin_count_ <= 0 ) return false;
-    if( page -> pin_count_ > 0 ) replacer_ -> unpin(frame_id);//减少页面的一次引用次数
-    pages_[frame_id].pin_count_ --;
-    //参数is_dirty决定是否对页面置脏，如果上层修改了页面，就将该页面的脏标志置true。
-    page -> is_dirty_ |= is_dirty;//页面是否需要置脏
-
-    return true;
+    return get_instance(page_id)->unpin_page(page_id, is_dirty);
 }
 
 /**
@@ -233,111 +58,25 @@ bool BufferPoolManager::unpin_page(PageId page_id, bool is_dirty) {
  * @param {PageId} page_id 目标页的page_id，不能为INVALID_PAGE_ID
  */
 bool BufferPoolManager::flush_page(PageId page_id) {
-    // Todo:
-    // 0. lock latch
-    // 1. 查找页表,尝试获取目标页P
-    // 1.1 目标页P没有被page_table_记录 ，返回false
-    // 2. 无论P是否为脏都将其写回磁盘。
-    // 3. 更新P的is_dirty_
-    // std::lock_guard<std::mutex> guard(latch_);
-
-    // // 1. 查找页表,尝试获取目标页P
-    // auto it = page_table_.find(page_id);
-    // if (it == page_table_.end()|| page_id.page_no == INVALID_PAGE_ID) {
-    //     // 1.1 目标页P没有被page_table_记录 ，返回false
-    //     return false;
-    // }
-
-    // // 获取目标页的frame_id和page指针
-    // frame_id_t frame_id = it->second;
-    // Page *page = &pages_[frame_id];
-
-    // // 2. 无论P是否为脏都将其写回磁盘
-    // disk_manager_->write_page(page_id.fd, page_id.page_no, page->data_, PAGE_SIZE);
-
-    // // 3. 更新P的is_dirty_
-    // page->is_dirty_ = false;
-    // return true;
-    std::lock_guard<std::mutex> guard(latch_);
-    //从内存往磁盘上写
-
-    if( page_table_.find(page_id) == page_table_.end() ) return false;//页表查找
-
-    Page *page = &pages_[page_table_[page_id]];//存在时如何写回磁盘
-    //调用类disk_manager
-    disk_manager_ -> write_page(page_id.fd, page_id.page_no, page->data_, PAGE_SIZE);
-
-    page -> is_dirty_ = false;//写回后页面的脏位
-
-    return true;
+    auto start = std::chrono::steady_clock::now();
+    bool flushed = get_instance(page_id)->flush_page(page_id);
+    stats_.record_latency(BUFFER_OP_FLUSH, page_id.fd, BufferPoolStats::elapsed_ns(start));
+    return flushed;
 }
 
 /**
  * @description: 创建一个新的page，即从磁盘中移动一个新建的空page到缓冲池某个位置。
  * @return {Page*} 返回新创建的page，若创建失败则返回nullptr
  * @param {PageId*} page_id 当成功创建一个新的page时存储其page_id
+ * @note 新页面所在的分片由其页号决定，因此需要先在磁盘上分配页号，再交给对应的分片分配帧；
+ * 若该分片中所有的帧都被固定，则返回nullptr，此时已分配的页号不会被回收
  */
 Page *BufferPoolManager::new_page(PageId *page_id) {
-    // 1.   获得一个可用的frame，若无法获得则返回nullptr
-    // 2.   在fd对应的文件分配一个新的page_id
-    // 3.   将frame的数据写回磁盘
-    // 4.   固定frame，更新pin_count_
-    // 5.   返回获得的page
-    // std::lock_guard<std::mutex> guard(latch_);
-
-    // // 1. 获得一个可用的frame，若无法获得则返回nullptr
-    // bool is_all = true;
-    // for(int i = 0; i < static_cast<int>(pool_size_); i++)
-    // {
-    //     if(pages_[i].pin_count_ == 0)
-    //     {
-    //         is_all = false;
-    //         break;
-    //     }
-    // }
-    // if (is_all)
-    // {
-    //     return nullptr;
-    // }
-    
-    // frame_id_t frame_id;
-    // if (!find_victim_page(&frame_id)) {
-    //     throw InternalError("Failed to find a victim page.");
-    //     return nullptr;
-    // }
-
-    // // 2. 在fd对应的文件分配一个新的page_id
-    // page_id_t new_page_id = disk_manager_->allocate_page(page_id->fd);
-    // if (new_page_id == INVALID_PAGE_ID) {
-    //     throw InternalError("Failed to allocate a new page ID.");
-    //     return nullptr;
-    // }
-
-    // // 3. 将frame的数据写回磁盘
-    // Page *victim_page = &pages_[frame_id];
-    // victim_page->id_.page_no = new_page_id;
-    // victim_page->pin_count_++;
-    // replacer_->pin(frame_id);
-    // page_table_[victim_page->id_] = frame_id;
-    // victim_page->is_dirty_ = false;
-    // page_id->page_no = new_page_id;
-    // disk_manager_->write_page(victim_page->id_.fd, victim_page->id_.page_no, victim_page->data_, PAGE_SIZE);
-    // return victim_page;
-    std::lock_guard<std::mutex> guard(latch_);
-
-    frame_id_t frame_id;
-    if( !find_victim_page(&frame_id) ) return nullptr;//没有找到淘汰页（如果缓冲池中的所有页面都被固定，则返回nullptr）
-    //找到淘汰页了
-    //从空闲列表或替换页中选择一个淘汰页P
+    auto start = std::chrono::steady_clock::now();
     page_id -> page_no = disk_manager_ -> allocate_page( page_id -> fd );//在磁盘上分配一个页面
-    
-    //需要用DiskManager分配页面编号
-    update_page(&pages_[frame_id], *page_id, frame_id);//更新淘汰页的的元数据，清空内存并将其添加到页表中
-
-    replacer_ -> pin(frame_id);//固定页面
-    pages_[frame_id].pin_count_ = 1;//pin_count设置为1。
-
-    return &pages_[frame_id];//设置页面ID输出参数。返回一个指向P的指针。
+    Page *page = get_instance(*page_id)->new_page(*page_id);
+    stats_.record_latency(BUFFER_OP_NEW, page_id->fd, BufferPoolStats::elapsed_ns(start));
+    return page;
 }
 
 /**
@@ -346,87 +85,432 @@ Page *BufferPoolManager::new_page(PageId *page_id) {
  * @param {PageId} page_id 目标页
  */
 bool BufferPoolManager::delete_page(PageId page_id) {
-    // 1.   在page_table_中查找目标页，若不存在返回true
-    // 2.   若目标页的pin_count不为0，则返回false
-    // 3.   将目标页数据写回磁盘，从页表中删除目标页，重置其元数据，将其加入free_list_，返回true
-    // std::lock_guard<std::mutex> guard(latch_);
-
-    // // 1. 在page_table_中查找目标页，若不存在返回true
-    // auto it = page_table_.find(page_id);
-    // if (it == page_table_.end()) {
-    //     return true;
-    // }
-
-    // frame_id_t frame_id = it->second;
-    // Page *target_page = &pages_[frame_id];
-
-    // // 2. 若目标页的pin_count不为0，则返回false
-    // if (target_page->pin_count_ > 0) {
-    //     return false;
-    // }
-
-    // // 3. 将目标页数据写回磁盘
-    // if(target_page->is_dirty_)
-    // {
-    //     this->flush_page(page_id);
-    // }
-
-    // // 4. 从页表中删除目标页
-    // disk_manager_->deallocate_page(page_id.page_no);
-    // page_table_.erase(page_id);
-
-    // // 5. 重置其元数据
-    // target_page->id_.page_no = INVALID_PAGE_ID;
-    // target_page->reset_memory();
-    // target_page->pin_count_ = 0;
-    // target_page->is_dirty_ = false;
-
-    // // 6. 将其加入free_list_
-    // free_list_.push_back(frame_id);
-
-    // return true;
-    std::lock_guard<std::mutex> guard(latch_);
-    //在页表中搜索请求的页(P)。
-    if( page_table_.find(page_id) == page_table_.end() ) return true;//如果P不存在，返回true。
-    frame_id_t frame_id = page_table_[page_id];
-
-    Page *page = &pages_[frame_id];
-
-    if( page -> pin_count_ > 0 ) return false;//如果P存在，但引脚计数非零，返回false。有人正在使用这个页面。
-    //即不能删除
-    
-    //否则可以被删除，释放磁盘上的页。
-    disk_manager_->deallocate_page(page_id.page_no);
-	//重置其元数据并将其返回给free
-    page_id.page_no =  INVALID_PAGE_ID;
-	update_page(page, page_id, frame_id);
-	free_list_.push_back(frame_id);
-	
-    return true;
+    return get_instance(page_id)->delete_page(page_id);
 }
 
 /**
- * @description: 将buffer_pool中的所有页写回到磁盘
+ * @description: 将buffer_pool中属于文件fd的所有页写回到磁盘，页号连续的页面合并成一个写请求
  * @param {int} fd 文件句柄
  */
 void BufferPoolManager::flush_all_pages(int fd) {
-    std::lock_guard<std::mutex> guard(latch_);  // 确保线程安全
-
-    // // 遍历 buffer pool 中的所有页面
-    // for (size_t i = 0; i < pool_size_; ++i) {
-    //     // 获取当前页面
-    //     Page *page = &pages_[i];
-    //     if(!(page->id_.page_no == INVALID_PAGE_ID))
-    //     {
-    //         disk_manager_->write_page(page->id_.fd, page->id_.page_no, page->data_, PAGE_SIZE);
-    //         page->is_dirty_ = false;
-    //     }
-    // }
-    for (size_t i = 0; i < pool_size_; i++) {//存在于缓冲池的所有页面都刷新到磁盘
-        Page *page = &pages_[i];//在磁盘上存储数据的结构
-        if (page->get_page_id().fd == fd && page->get_page_id().page_no != INVALID_PAGE_ID) {
-            disk_manager_->write_page(page->get_page_id().fd, page->get_page_id().page_no, page->get_data(), PAGE_SIZE);
-            page->is_dirty_ = false;//淘汰脏页之前，都要将脏页写入磁盘。
+    // 1. 收集各个分片中属于fd的页号并排序
+    std::vector<page_id_t> page_nos;
+    for (auto &instance : instances_) {
+        instance->get_pages_of_file(fd, &page_nos);
+    }
+    std::sort(page_nos.begin(), page_nos.end());
+
+    // 2. 每次最多固定FLUSH_BATCH_SIZE个页面，按连续的页号分段写回。
+    //    收集页号之后被换出的页面已经在换出时写回，直接跳过
+    std::vector<Page *> pages;
+    for (size_t batch = 0; batch < page_nos.size(); batch += FLUSH_BATCH_SIZE) {
+        pages.clear();
+        for (size_t k = batch; k < std::min(page_nos.size(), batch + FLUSH_BATCH_SIZE); k++) {
+            PageId page_id = {fd, page_nos[k]};
+            Page *page = get_instance(page_id)->fetch_resident_page(page_id);
+            if (page != nullptr) pages.push_back(page);
+        }
+        write_back_pages(pages);
+    }
+}
+
+/**
+ * @description: 从buffer_pool删除属于文件fd的所有未被固定的页面，不写回。
+ * 在关闭文件时调用，避免之后打开的文件复用同一个fd时读到缓冲池中残留的页面
+ * @param {int} fd 文件句柄
+ */
+void BufferPoolManager::delete_all_pages(int fd) {
+    std::vector<page_id_t> page_nos;
+    for (auto &instance : instances_) {
+        instance->get_pages_of_file(fd, &page_nos);
+    }
+    for (page_id_t page_no : page_nos) {
+        delete_page(PageId{fd, page_no});
+    }
+}
+
+/**
+ * @description: 写回一批被固定的页面并取消固定，同一文件中页号连续的页面合并成一个写请求，
+ * 所有写请求放在同一个IoBatch中同时提交，写回时不持有任何分片的latch_
+ * @param {vector<Page*>&} pages 已经被固定的页面，按(fd, page_no)排好序
+ */
+void BufferPoolManager::write_back_pages(const std::vector<Page *> &pages) {
+    for (auto *page : pages) {
+        page->is_dirty_ = false;  // 先清除脏位再写回，写回期间其他线程重新置脏不会丢失
+    }
+    // bufs在wait_io之前不能重新分配，预留足够的空间
+    std::vector<const char *> bufs;
+    bufs.reserve(pages.size());
+    IoBatch batch;
+    size_t i = 0;
+    while (i < pages.size()) {
+        PageId first = pages[i]->get_page_id();
+        size_t j = i;
+        while (j < pages.size() && pages[j]->get_page_id().fd == first.fd &&
+               pages[j]->get_page_id().page_no == first.page_no + static_cast<int>(j - i)) {
+            bufs.push_back(pages[j]->get_data());
+            j++;
+        }
+        batch.add_write(first.fd, first.page_no, bufs.data() + i, static_cast<int>(j - i));
+        i = j;
+    }
+    disk_manager_->submit_io(&batch);
+    disk_manager_->wait_io(&batch);
+    // 写回失败时恢复脏位
+    bool ok = batch.all_succeeded();
+    for (auto *page : pages) {
+        if (ok) stats_.record_writeback(page->get_page_id().fd);
+        unpin_page(page->get_page_id(), !ok);
+    }
+    if (!ok) throw InternalError("BufferPoolManager::write_back_pages Error");
+}
+
+/**
+ * @description: 启动后台刷脏线程，重复调用时忽略
+ * @param {function<lsn_t()>} get_persist_lsn 返回已经持久化的日志的最大lsn，用于遵守WAL
+ * @param {milliseconds} interval 两轮写回之间的休眠时间
+ * @param {size_t} max_pages 每轮最多写回的页面个数
+ * @param {double} low_watermark 脏页比例低于该值时不写回
+ * @param {double} high_watermark 脏页比例高于该值时连续写回不休眠
+ */
+void BufferPoolManager::start_flusher(std::function<lsn_t()> get_persist_lsn, std::chrono::milliseconds interval,
+                                      size_t max_pages, double low_watermark, double high_watermark) {
+    if (flusher_ != nullptr) return;
+    flusher_ = std::make_unique<PageFlusher>(this, std::move(get_persist_lsn), interval, max_pages, low_watermark,
+                                             high_watermark);
+}
+
+/**
+ * @description: 缓冲池中脏页所占的比例，不加锁，只是近似值
+ * @return {double} 脏页个数除以缓冲池的帧数
+ */
+double BufferPoolManager::get_dirty_ratio() const {
+    size_t num_dirty = 0;
+    for (auto &instance : instances_) {
+        num_dirty += instance->get_num_dirty_pages();
+    }
+    return static_cast<double>(num_dirty) / pool_size_;
+}
+
+/**
+ * @description: 写回至多max_pages个未被固定的脏页，由后台刷脏线程调用，各个分片平均分摊。
+ * 对于用set_lsn_file登记过的文件，page_lsn大于persist_lsn的页面对应的日志还没有落盘，根据WAL原则暂不写回；
+ * 其他文件的页面格式在页头偏移0处保存的不是page_lsn，直接写回。每个文件的第0页是文件头，不保存page_lsn，也直接写回
+ * @return {size_t} 写回的页面个数
+ * @param {size_t} max_pages 最多写回的页面个数
+ * @param {lsn_t} persist_lsn 已经持久化的日志的最大lsn
+ */
+size_t BufferPoolManager::flush_dirty_pages(size_t max_pages, lsn_t persist_lsn) {
+    size_t pages_per_instance = std::max<size_t>(1, max_pages / instances_.size());
+    std::vector<Page *> pages;
+    for (auto &instance : instances_) {
+        instance->pin_dirty_pages(pages_per_instance, &pages);
+    }
+    std::vector<Page *> writable;
+    std::lock_guard<std::mutex> guard(lsn_fds_latch_);
+    for (auto *page : pages) {
+        PageId page_id = page->get_page_id();
+        if (page_id.page_no != HEADER_PAGE_ID && lsn_fds_.count(page_id.fd) && page->get_page_lsn() > persist_lsn) {
+            unpin_page(page->get_page_id(), false);
+        } else {
+            writable.push_back(page);
         }
     }
-}
\ No newline at end of file
+    // 排序后同一文件中页号连续的页面可以合并写回
+    std::sort(writable.begin(), writable.end(), [](Page *a, Page *b) {
+        PageId x = a->get_page_id(), y = b->get_page_id();
+        return x.fd != y.fd ? x.fd < y.fd : x.page_no < y.page_no;
+    });
+    write_back_pages(writable);
+    return writable.size();
+}
+
+/**
+ * @description: 登记或取消登记文件fd的页面格式在页头保存page_lsn，登记过的文件的脏页由后台刷脏线程写回时遵守WAL
+ * @param {int} fd 文件句柄
+ * @param {bool} has_lsn 文件的页面是否保存page_lsn
+ */
+void BufferPoolManager::set_lsn_file(int fd, bool has_lsn) {
+    std::lock_guard<std::mutex> guard(lsn_fds_latch_);
+    if (has_lsn) {
+        lsn_fds_.insert(fd);
+    } else {
+        lsn_fds_.erase(fd);
+    }
+}
+
+/**
+ * @description: 将文件fd中从start_page_no开始的num_pages个连续页面读入缓冲池但不固定它们，
+ * 已经在缓冲池中的页面跳过，其余页面按连续的页号分段用一次read_pages读入
+ * @param {int} fd 文件句柄
+ * @param {page_id_t} start_page_no 第一个页面的页号
+ * @param {int} num_pages 页面个数
+ * @param {BufferAccessStrategy*} strategy 读入页面时使用的访问策略，为空时使用整个缓冲池
+ */
+void BufferPoolManager::load_pages(int fd, page_id_t start_page_no, int num_pages, BufferAccessStrategy *strategy) {
+    // 1. 在各个分片中为不在缓冲池中的页面预留帧
+    std::vector<Page *> pages(num_pages, nullptr);
+    std::vector<char> loaded(num_pages, 0);
+    auto finish = [&]() {
+        for (int i = 0; i < num_pages; i++) {
+            if (pages[i] != nullptr) get_instance(pages[i]->get_page_id())->finish_reserved_page(pages[i], loaded[i]);
+        }
+    };
+    try {
+        for (int i = 0; i < num_pages; i++) {
+            PageId page_id = {fd, start_page_no + i};
+            size_t instance_no = get_instance_no(page_id);
+            BufferAccessStrategy::Ring *ring =
+                strategy == nullptr ? nullptr : strategy->get_ring(instance_no, instances_.size());
+            pages[i] = instances_[instance_no]->reserve_page(page_id, ring);
+        }
+    } catch (RMDBError &e) {
+        finish();
+        throw;
+    }
+
+    // 2. 不持有latch_，按连续的页号分段，所有分段放在同一个IoBatch中同时读入
+    std::vector<char *> bufs(num_pages, nullptr);
+    std::vector<std::pair<int, int>> runs;  // 每个分段的[起始下标, 结束下标)
+    IoBatch batch;
+    int i = 0;
+    while (i < num_pages) {
+        if (pages[i] == nullptr) {
+            i++;
+            continue;
+        }
+        int j = i;
+        while (j < num_pages && pages[j] != nullptr) {
+            bufs[j] = pages[j]->get_data();
+            j++;
+        }
+        batch.add_read(fd, start_page_no + i, bufs.data() + i, j - i);
+        runs.emplace_back(i, j);
+        i = j;
+    }
+    disk_manager_->submit_io(&batch);
+    disk_manager_->wait_io(&batch);
+    // 读取失败的帧在finish中被还给free_list_
+    for (size_t k = 0; k < runs.size(); k++) {
+        if (batch.succeeded(k)) std::fill(loaded.begin() + runs[k].first, loaded.begin() + runs[k].second, 1);
+    }
+
+    // 3. 发布读入的页面
+    finish();
+}
+
+/**
+ * @description: 启动定期输出统计信息的线程，重复调用时忽略
+ * @param {string&} path 输出文件的路径，统计信息追加在文件末尾
+ * @param {seconds} interval 两次输出之间的间隔
+ */
+void BufferPoolManager::start_stats_dump(const std::string &path, std::chrono::seconds interval) {
+    if (stats_dumper_ != nullptr) return;
+    stats_dumper_ = std::make_unique<PeriodicTask>(
+        [this, path] {
+            std::ofstream outfile(path, std::ios::out | std::ios::app);
+            std::time_t now = std::time(nullptr);
+            outfile << "==== " << std::put_time(std::localtime(&now), "%Y-%m-%d %H:%M:%S") << " ====\n";
+            print_stats(outfile);
+        },
+        interval);
+}
+
+/**
+ * @description: 统计信息中显示的文件名，文件已经关闭时显示其文件句柄
+ * @return {string} 文件名
+ * @param {int} fd 文件句柄，-1表示没有单独统计的文件
+ */
+std::string BufferPoolManager::get_file_label(int fd) {
+    if (fd == -1) return "(others)";
+    try {
+        return disk_manager_->get_file_name(fd);
+    } catch (FileNotOpenError &e) {
+        return "fd " + std::to_string(fd);
+    }
+}
+
+/**
+ * @description: 以文本形式输出缓冲池的概况、每个文件的统计和各操作的耗时直方图，供定期输出使用
+ * @param {ostream&} os 输出流
+ */
+void BufferPoolManager::print_stats(std::ostream &os) {
+    static const char *op_names[NUM_BUFFER_OPS] = {"fetch_page", "new_page", "flush_page"};
+    os << "pool_size " << pool_size_ << " instances " << instances_.size() << " dirty_ratio " << std::fixed
+       << std::setprecision(4) << get_dirty_ratio() << "\n";
+
+    auto print_row = [&os](const std::vector<std::string> &row) {
+        for (auto &col : row) os << "| " << col << " ";
+        os << "|\n";
+    };
+    print_row(BufferPoolStats::get_captions());
+    BufferFileStats total;
+    auto snapshot = stats_.snapshot();
+    for (auto &entry : snapshot) {
+        print_row(BufferPoolStats::format_row(get_file_label(entry.first), entry.second));
+        total.merge(entry.second);
+    }
+    print_row(BufferPoolStats::format_row("total", total));
+
+    // 直方图只输出非空的桶，每个桶以其上界表示
+    for (auto &entry : snapshot) {
+        for (int op = 0; op < NUM_BUFFER_OPS; op++) {
+            if (entry.second.op_count[op] == 0) continue;
+            os << get_file_label(entry.first) << " " << op_names[op] << " latency(ns):";
+            for (int i = 0; i < BUFFER_STATS_HISTOGRAM_BUCKETS; i++) {
+                uint64_t count = entry.second.op_histogram[op][i];
+                if (count == 0) continue;
+                if (i == 0) {
+                    os << " 0";
+                } else {
+                    os << (i == BUFFER_STATS_HISTOGRAM_BUCKETS - 1 ? " >=" : " <") << BufferFileStats::bucket_upper_ns(i);
+                }
+                os << ":" << count;
+            }
+            os << "\n";
+        }
+    }
+}
+
+/**
+ * @description: 保存缓冲池快照：每行记录一个文件的文件名、页面个数和按页号排序的页号。
+ * 使用文件名而不是文件句柄，重启后文件句柄可能不同。先写入临时文件再重命名，中途失败不会破坏旧的快照
+ * @param {string&} path 快照文件的路径
+ */
+void BufferPoolManager::save_snapshot(const std::string &path) {
+    std::vector<PageId> page_ids;
+    for (auto &instance : instances_) {
+        instance->get_resident_pages(&page_ids);
+    }
+    std::map<int, std::vector<page_id_t>> files;
+    for (auto &page_id : page_ids) {
+        files[page_id.fd].push_back(page_id.page_no);
+    }
+
+    std::string tmp_path = path + ".tmp";
+    std::ofstream outfile(tmp_path, std::ios::out | std::ios::trunc);
+    for (auto &entry : files) {
+        std::string file_name;
+        try {
+            file_name = disk_manager_->get_file_name(entry.first);
+        } catch (FileNotOpenError &e) {
+            continue;  // 文件在收集页号之后被关闭
+        }
+        std::sort(entry.second.begin(), entry.second.end());
+        outfile << file_name << " " << entry.second.size();
+        for (auto page_no : entry.second) outfile << " " << page_no;
+        outfile << "\n";
+    }
+    outfile.close();
+    if (!outfile || rename(tmp_path.c_str(), path.c_str()) < 0) {
+        throw InternalError("BufferPoolManager::save_snapshot Error");
+    }
+}
+
+/**
+ * @description: 启动定期保存缓冲池快照的线程，重复调用时忽略
+ * @param {string&} path 快照文件的路径
+ * @param {seconds} interval 两次保存之间的间隔
+ */
+void BufferPoolManager::start_snapshot(const std::string &path, std::chrono::seconds interval) {
+    if (snapshot_writer_ != nullptr) return;
+    snapshot_writer_ = std::make_unique<PeriodicTask>([this, path] { save_snapshot(path); }, interval);
+}
+
+/**
+ * @description: 停止定期保存快照的线程。关闭数据库之前调用，避免文件关闭后保存一个空的快照覆盖最后一次的快照
+ */
+void BufferPoolManager::stop_snapshot() { snapshot_writer_.reset(); }
+
+/**
+ * @description: 停止后台刷脏线程。关闭数据库之前调用，避免文件关闭后后台线程仍在写回其中的页面
+ */
+void BufferPoolManager::stop_flusher() { flusher_.reset(); }
+
+/**
+ * @description: 根据快照预热缓冲池：按文件和页号的顺序把快照中的页面切分成连续的分段，
+ * 由num_threads个线程并行地用load_pages读入，读入的页面不被固定。
+ * 快照中已经关闭的文件和超出文件大小的页面被跳过，至多读入缓冲池大小个页面
+ * @return {size_t} 读入的页面个数，没有快照时为0
+ * @param {string&} path 快照文件的路径
+ * @param {size_t} num_threads 读入页面的线程个数
+ */
+size_t BufferPoolManager::warm_up(const std::string &path, size_t num_threads) {
+    struct Run {
+        int fd;
+        page_id_t start_page_no;
+        int num_pages;
+    };
+    std::vector<Run> runs;
+    std::ifstream infile(path);
+    std::string line;
+    size_t num_pages = 0;
+    while (num_pages < pool_size_ && std::getline(infile, line)) {
+        std::stringstream ss(line);
+        std::string file_name;
+        size_t count;
+        if (!(ss >> file_name >> count)) continue;
+        int fd = disk_manager_->find_file_fd(file_name);
+        if (fd < 0) continue;
+        page_id_t file_pages = disk_manager_->get_file_size(file_name) / disk_manager_->get_page_size();
+        std::vector<page_id_t> page_nos;
+        page_id_t page_no;
+        while (page_nos.size() < count && ss >> page_no) {
+            if (page_no >= 0 && page_no < file_pages) page_nos.push_back(page_no);
+        }
+        // 页号已经排好序，合并成至多PREFETCH_MAX_RUN个页面的连续分段
+        size_t i = 0;
+        while (i < page_nos.size() && num_pages < pool_size_) {
+            size_t j = i + 1;
+            while (j < page_nos.size() && page_nos[j] == page_nos[j - 1] + 1 &&
+                   static_cast<int>(j - i) < PREFETCH_MAX_RUN && num_pages + (j - i) < pool_size_) {
+                j++;
+            }
+            runs.push_back({fd, page_nos[i], static_cast<int>(j - i)});
+            num_pages += j - i;
+            i = j;
+        }
+    }
+
+    std::atomic<size_t> next_run{0};
+    std::atomic<size_t> num_loaded{0};
+    auto worker = [&] {
+        size_t k;
+        while (!stop_warm_up_ && (k = next_run.fetch_add(1)) < runs.size()) {
+            try {
+                load_pages(runs[k].fd, runs[k].start_page_no, runs[k].num_pages);
+                num_loaded += runs[k].num_pages;
+            } catch (RMDBError &e) {
+                // 读入失败的分段跳过，之后由查询按需读入
+            }
+        }
+    };
+    std::vector<std::thread> workers;
+    for (size_t t = 1; t < std::min(num_threads, runs.size()); t++) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto &thread : workers) {
+        thread.join();
+    }
+    return num_loaded;
+}
+
+/**
+ * @description: 在后台线程中预热缓冲池，调用者不等待预热完成；预热期间查询访问正在读入的页面时等待其读入完成
+ * @param {string&} path 快照文件的路径
+ * @param {size_t} num_threads 读入页面的线程个数
+ */
+void BufferPoolManager::start_warm_up(const std::string &path, size_t num_threads) {
+    if (warm_up_thread_.joinable()) return;
+    stop_warm_up_ = false;
+    warm_up_thread_ = std::thread([this, path, num_threads] { warm_up(path, num_threads); });
+}
+
+/**
+ * @description: 停止后台预热并等待预热线程退出，正在读入的分段会先完成。关闭文件之前需要调用
+ */
+void BufferPoolManager::stop_warm_up() {
+    stop_warm_up_ = true;
+    if (warm_up_thread_.joinable()) warm_up_thread_.join();
+}
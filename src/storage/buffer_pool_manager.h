@@ -12,50 +12,65 @@ See the Mulan PSL v2 for more details. */
 #include <fcntl.h>
 #include <unistd.h>
 
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <functional>
 #include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
+#include "buffer_pool_instance.h"
+#include "buffer_pool_stats.h"
 #include "disk_manager.h"
 #include "errors.h"
+#include "frame_arena.h"
 #include "page.h"
-#include "replacer/lru_replacer.h"
-#include "replacer/replacer.h"
+#include "page_flusher.h"
+#include "page_prefetcher.h"
+#include "periodic_task.h"
 
+/**
+ * @description: 缓冲池管理器，由若干个独立加锁的BufferPoolInstance组成，
+ * 每个页面根据其PageId的哈希值固定地路由到其中一个分片上，不同分片上的页面访问互不阻塞
+ */
 class BufferPoolManager {
    private:
-    size_t pool_size_;      // buffer_pool中可容纳页面的个数，即帧的个数
-    Page *pages_;           // buffer_pool中的Page对象数组，在构造空间中申请内存空间，在析构函数中释放，大小为BUFFER_POOL_SIZE
-    std::unordered_map<PageId, frame_id_t, PageIdHash> page_table_; // 帧号和页面号的映射哈希表，用于根据页面的PageId定位该页面的帧编号
-    std::list<frame_id_t> free_list_;   // 空闲帧编号的链表
+    size_t pool_size_;      // buffer_pool中可容纳页面的个数，即所有分片的帧的个数之和
+    FrameArena arena_;      // 所有帧的页面数据，按帧号顺序分给各个分片；在instances_之后析构
+    BufferPoolStats stats_; // 所有分片共用的命中率、换出、写回和耗时统计
+    std::vector<std::unique_ptr<BufferPoolInstance>> instances_;    // buffer_pool的所有分片
     DiskManager *disk_manager_;
-    Replacer *replacer_;    // buffer_pool的置换策略，当前赛题中为LRU置换策略
-    std::mutex latch_;      // 用于共享数据结构的并发控制
+    std::unique_ptr<PagePrefetcher> prefetcher_;    // 后台预读线程，第一次预读时启动；在instances_之前析构
+    std::once_flag prefetcher_init_;
+    std::unique_ptr<PageFlusher> flusher_;          // 后台刷脏线程，由start_flusher启动；在instances_之前析构
+    std::unordered_set<int> lsn_fds_;               // 页面格式在页头保存page_lsn的文件，只有它们的脏页写回受WAL约束
+    std::mutex lsn_fds_latch_;                      // 保护lsn_fds_
+    std::unique_ptr<PeriodicTask> stats_dumper_;        // 定期输出统计信息的线程，由start_stats_dump启动
+    std::unique_ptr<PeriodicTask> snapshot_writer_;     // 定期保存缓冲池快照的线程，由start_snapshot启动
+    std::thread warm_up_thread_;                        // 后台预热线程，由start_warm_up启动
+    std::atomic<bool> stop_warm_up_{false};
 
    public:
-    BufferPoolManager(size_t pool_size, DiskManager *disk_manager)
-        : pool_size_(pool_size), disk_manager_(disk_manager) {
-        // 为buffer pool分配一块连续的内存空间
-        pages_ = new Page[pool_size_];
-        // 可以被Replacer改变
-        if (REPLACER_TYPE.compare("LRU"))
-            replacer_ = new LRUReplacer(pool_size_);
-        else if (REPLACER_TYPE.compare("CLOCK"))
-            replacer_ = new LRUReplacer(pool_size_);
-        else {
-            replacer_ = new LRUReplacer(pool_size_);
-        }
-        // 初始化时，所有的page都在free_list_中
-        for (size_t i = 0; i < pool_size_; ++i) {
-            free_list_.emplace_back(static_cast<frame_id_t>(i));  // static_cast转换数据类型
+    BufferPoolManager(size_t pool_size, DiskManager *disk_manager, size_t num_instances = 1,
+                      const std::string &replacer_type = REPLACER_TYPE)
+        : pool_size_(pool_size), arena_(pool_size, disk_manager->get_page_size()), disk_manager_(disk_manager) {
+        assert(num_instances > 0 && num_instances <= pool_size_);
+        // 将pool_size_个帧平均分配给各个分片，余数分给前面的分片
+        size_t frame_no = 0;
+        for (size_t i = 0; i < num_instances; ++i) {
+            size_t instance_size = pool_size_ / num_instances + (i < pool_size_ % num_instances ? 1 : 0);
+            instances_.emplace_back(std::make_unique<BufferPoolInstance>(instance_size, arena_.get_frame(frame_no),
+                                                                         disk_manager_, &stats_, replacer_type));
+            frame_no += instance_size;
         }
     }
 
-    ~BufferPoolManager() {
-        delete[] pages_;
-        delete replacer_;
-    }
+    ~BufferPoolManager() { stop_warm_up(); }
 
     /**
      * @description: 将目标页面标记为脏页
@@ -63,8 +78,16 @@ class BufferPoolManager {
      */
     static void mark_dirty(Page* page) { page->is_dirty_ = true; }
 
+    size_t get_pool_size() const { return pool_size_; }
+
+    size_t get_num_instances() const { return instances_.size(); }
+
+    BufferPoolStats *get_stats() { return &stats_; }
+
    public: 
-    Page* fetch_page(PageId page_id);
+    Page* fetch_page(PageId page_id, BufferAccessStrategy* strategy = nullptr);
+
+    void prefetch_page(PageId page_id, BufferAccessStrategy* strategy = nullptr);
 
     bool unpin_page(PageId page_id, bool is_dirty);
 
@@ -76,8 +99,50 @@ class BufferPoolManager {
 
     void flush_all_pages(int fd);
 
+    void delete_all_pages(int fd);
+
+    void load_pages(int fd, page_id_t start_page_no, int num_pages, BufferAccessStrategy* strategy = nullptr);
+
+    void start_flusher(std::function<lsn_t()> get_persist_lsn,
+                       std::chrono::milliseconds interval = std::chrono::milliseconds(FLUSHER_INTERVAL_MS),
+                       size_t max_pages = FLUSHER_MAX_PAGES, double low_watermark = FLUSHER_LOW_WATERMARK,
+                       double high_watermark = FLUSHER_HIGH_WATERMARK);
+
+    double get_dirty_ratio() const;
+
+    size_t flush_dirty_pages(size_t max_pages, lsn_t persist_lsn);
+
+    void set_lsn_file(int fd, bool has_lsn);
+
+    void start_stats_dump(const std::string& path, std::chrono::seconds interval);
+
+    std::string get_file_label(int fd);
+
+    void print_stats(std::ostream& os);
+
+    void save_snapshot(const std::string& path);
+
+    void start_snapshot(const std::string& path, std::chrono::seconds interval);
+
+    void stop_snapshot();
+
+    void stop_flusher();
+
+    size_t warm_up(const std::string& path, size_t num_threads = WARM_UP_THREADS);
+
+    void start_warm_up(const std::string& path, size_t num_threads = WARM_UP_THREADS);
+
+    void stop_warm_up();
+
    private:
-    bool find_victim_page(frame_id_t* frame_id);
+    void write_back_pages(const std::vector<Page*>& pages);
+
+    /**
+     * @description: 获取page_id所在的分片
+     */
+    BufferPoolInstance *get_instance(PageId page_id) {
+        return instances_[get_instance_no(page_id)].get();
+    }
 
-    void update_page(Page* page, PageId new_page_id, frame_id_t new_frame_id);
+    size_t get_instance_no(PageId page_id) const { return PageIdHash()(page_id) % instances_.size(); }
 };
\ No newline at end of file
@@ -0,0 +1,239 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "buffer_pool_stats.h"
+
+#include <iomanip>
+#include <sstream>
+
+/**
+ * @description: 将另一个快照累加到当前快照上
+ * @param {BufferFileStats&} other 被累加的快照
+ */
+void BufferFileStats::merge(const BufferFileStats &other) {
+    hits += other.hits;
+    misses += other.misses;
+    evictions += other.evictions;
+    writebacks += other.writebacks;
+    pin_waits += other.pin_waits;
+    latch_waits += other.latch_waits;
+    latch_wait_ns += other.latch_wait_ns;
+    for (int op = 0; op < NUM_BUFFER_OPS; op++) {
+        op_count[op] += other.op_count[op];
+        op_total_ns[op] += other.op_total_ns[op];
+        for (int i = 0; i < BUFFER_STATS_HISTOGRAM_BUCKETS; i++) {
+            op_histogram[op][i] += other.op_histogram[op][i];
+        }
+    }
+}
+
+/**
+ * @description: fetch_page的命中率，没有fetch_page时为0
+ */
+double BufferFileStats::hit_ratio() const {
+    uint64_t total = hits + misses;
+    return total == 0 ? 0 : static_cast<double>(hits) / total;
+}
+
+/**
+ * @description: 操作的平均耗时，没有该操作时为0
+ */
+uint64_t BufferFileStats::average_ns(BufferOp op) const {
+    return op_count[op] == 0 ? 0 : op_total_ns[op] / op_count[op];
+}
+
+/**
+ * @description: 根据直方图估计操作耗时的分位数，结果为所在桶的上界
+ * @return {uint64_t} 估计的耗时，没有该操作时为0
+ * @param {BufferOp} op 操作
+ * @param {double} percentile 分位数，在(0, 1]之间
+ */
+uint64_t BufferFileStats::percentile_ns(BufferOp op, double percentile) const {
+    uint64_t total = 0;
+    for (int i = 0; i < BUFFER_STATS_HISTOGRAM_BUCKETS; i++) total += op_histogram[op][i];
+    if (total == 0) return 0;
+    uint64_t target = static_cast<uint64_t>(percentile * total + 0.5);
+    if (target == 0) target = 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < BUFFER_STATS_HISTOGRAM_BUCKETS; i++) {
+        seen += op_histogram[op][i];
+        if (seen >= target) return bucket_upper_ns(i);
+    }
+    return bucket_upper_ns(BUFFER_STATS_HISTOGRAM_BUCKETS - 1);
+}
+
+/**
+ * @description: 直方图第bucket个桶的上界，最后一个桶没有上界，返回其下界
+ */
+uint64_t BufferFileStats::bucket_upper_ns(int bucket) {
+    if (bucket == 0) return 0;
+    if (bucket == BUFFER_STATS_HISTOGRAM_BUCKETS - 1) return uint64_t(1) << (bucket - 1);
+    return uint64_t(1) << bucket;
+}
+
+BufferPoolStats::BufferPoolStats() : shards_(new Shard[BUFFER_STATS_SHARDS]) {
+    for (size_t i = 0; i < BUFFER_STATS_SHARDS; i++) {
+        for (size_t slot = 0; slot < BUFFER_STATS_MAX_FILES; slot++) {
+            shards_[i].fds[slot].store(-1, std::memory_order_relaxed);
+        }
+    }
+}
+
+BufferPoolStats::~BufferPoolStats() = default;
+
+/**
+ * @description: 获取当前线程所在分片中文件fd的计数器，fd第一次出现时在文件句柄表中占用一个空位
+ * @return {Counters*} fd的计数器，文件句柄表已满时返回others
+ * @param {int} fd 文件句柄
+ */
+BufferPoolStats::Counters *BufferPoolStats::get_counters(int fd) {
+    static std::atomic<size_t> next_shard{0};
+    thread_local size_t shard_no = next_shard.fetch_add(1, std::memory_order_relaxed) % BUFFER_STATS_SHARDS;
+
+    Shard &shard = shards_[shard_no];
+    if (fd < 0) return &shard.others;
+    size_t start = static_cast<size_t>(fd) % BUFFER_STATS_MAX_FILES;
+    for (size_t k = 0; k < BUFFER_STATS_MAX_FILES; k++) {
+        size_t slot = (start + k) % BUFFER_STATS_MAX_FILES;
+        int cur = shard.fds[slot].load(std::memory_order_acquire);
+        if (cur == -1 && shard.fds[slot].compare_exchange_strong(cur, fd)) return &shard.files[slot];
+        // 空位被其他线程抢先占用时cur为占用者的fd
+        if (cur == fd) return &shard.files[slot];
+    }
+    return &shard.others;
+}
+
+/**
+ * @description: 记录一次获取分片latch_时的等待
+ * @param {int} fd 访问的页面所在的文件
+ * @param {uint64_t} wait_ns 等待的时间
+ */
+void BufferPoolStats::record_latch_wait(int fd, uint64_t wait_ns) {
+    Counters *counters = get_counters(fd);
+    add(&counters->latch_waits, 1);
+    add(&counters->latch_wait_ns, wait_ns);
+}
+
+/**
+ * @description: 记录一次操作的耗时
+ * @param {BufferOp} op 操作
+ * @param {int} fd 操作的页面所在的文件
+ * @param {uint64_t} latency_ns 耗时
+ */
+void BufferPoolStats::record_latency(BufferOp op, int fd, uint64_t latency_ns) {
+    int bucket = latency_ns == 0 ? 0 : 64 - __builtin_clzll(latency_ns);
+    if (bucket >= BUFFER_STATS_HISTOGRAM_BUCKETS) bucket = BUFFER_STATS_HISTOGRAM_BUCKETS - 1;
+    Counters *counters = get_counters(fd);
+    add(&counters->op_count[op], 1);
+    add(&counters->op_total_ns[op], latency_ns);
+    add(&counters->op_histogram[op][bucket], 1);
+}
+
+/**
+ * @description: 将计数器的当前值累加到快照中
+ */
+void BufferPoolStats::read_counters(const Counters &counters, BufferFileStats *stats) {
+    auto load = [](const std::atomic<uint64_t> &counter) { return counter.load(std::memory_order_relaxed); };
+    stats->hits += load(counters.hits);
+    stats->misses += load(counters.misses);
+    stats->evictions += load(counters.evictions);
+    stats->writebacks += load(counters.writebacks);
+    stats->pin_waits += load(counters.pin_waits);
+    stats->latch_waits += load(counters.latch_waits);
+    stats->latch_wait_ns += load(counters.latch_wait_ns);
+    for (int op = 0; op < NUM_BUFFER_OPS; op++) {
+        stats->op_count[op] += load(counters.op_count[op]);
+        stats->op_total_ns[op] += load(counters.op_total_ns[op]);
+        for (int i = 0; i < BUFFER_STATS_HISTOGRAM_BUCKETS; i++) {
+            stats->op_histogram[op][i] += load(counters.op_histogram[op][i]);
+        }
+    }
+}
+
+/**
+ * @description: 汇总所有分片的计数器。不加锁，各个计数器分别读取，结果只是近似一致的快照
+ * @return {map<int, BufferFileStats>} 每个文件句柄的统计，没有单独记录的文件汇总在-1中
+ */
+std::map<int, BufferFileStats> BufferPoolStats::snapshot() const {
+    std::map<int, BufferFileStats> result;
+    for (size_t i = 0; i < BUFFER_STATS_SHARDS; i++) {
+        const Shard &shard = shards_[i];
+        for (size_t slot = 0; slot < BUFFER_STATS_MAX_FILES; slot++) {
+            int fd = shard.fds[slot].load(std::memory_order_acquire);
+            if (fd != -1) read_counters(shard.files[slot], &result[fd]);
+        }
+        BufferFileStats others;
+        read_counters(shard.others, &others);
+        if (others.hits + others.misses + others.evictions + others.writebacks + others.op_count[BUFFER_OP_NEW] +
+                others.op_count[BUFFER_OP_FLUSH] > 0) {
+            result[-1].merge(others);
+        }
+    }
+    return result;
+}
+
+/**
+ * @description: 将所有计数器清零，与并发的记录之间不同步，清零期间的记录可能丢失
+ */
+void BufferPoolStats::reset() {
+    auto clear = [](Counters &counters) {
+        counters.hits = 0;
+        counters.misses = 0;
+        counters.evictions = 0;
+        counters.writebacks = 0;
+        counters.pin_waits = 0;
+        counters.latch_waits = 0;
+        counters.latch_wait_ns = 0;
+        for (int op = 0; op < NUM_BUFFER_OPS; op++) {
+            counters.op_count[op] = 0;
+            counters.op_total_ns[op] = 0;
+            for (int i = 0; i < BUFFER_STATS_HISTOGRAM_BUCKETS; i++) counters.op_histogram[op][i] = 0;
+        }
+    };
+    for (size_t i = 0; i < BUFFER_STATS_SHARDS; i++) {
+        for (size_t slot = 0; slot < BUFFER_STATS_MAX_FILES; slot++) clear(shards_[i].files[slot]);
+        clear(shards_[i].others);
+    }
+}
+
+/**
+ * @description: 统计表格的列名，与format_row的输出一一对应
+ */
+const std::vector<std::string> &BufferPoolStats::get_captions() {
+    static const std::vector<std::string> captions = {
+        "File",          "Hits",         "Misses",       "HitRatio",   "Evictions",
+        "WriteBacks",    "PinWaits",     "LatchWaits",   "LatchWait(us)",
+        "FetchAvg(ns)",  "FetchP99(ns)", "NewP99(ns)",   "FlushP99(ns)"};
+    return captions;
+}
+
+/**
+ * @description: 将一个文件的统计格式化为表格中的一行
+ * @return {vector<string>} 与get_captions对应的各列
+ * @param {string&} name 文件名
+ * @param {BufferFileStats&} stats 文件的统计
+ */
+std::vector<std::string> BufferPoolStats::format_row(const std::string &name, const BufferFileStats &stats) {
+    std::stringstream hit_ratio;
+    hit_ratio << std::fixed << std::setprecision(4) << stats.hit_ratio();
+    return {name,
+            std::to_string(stats.hits),
+            std::to_string(stats.misses),
+            hit_ratio.str(),
+            std::to_string(stats.evictions),
+            std::to_string(stats.writebacks),
+            std::to_string(stats.pin_waits),
+            std::to_string(stats.latch_waits),
+            std::to_string(stats.latch_wait_ns / 1000),
+            std::to_string(stats.average_ns(BUFFER_OP_FETCH)),
+            std::to_string(stats.percentile_ns(BUFFER_OP_FETCH, 0.99)),
+            std::to_string(stats.percentile_ns(BUFFER_OP_NEW, 0.99)),
+            std::to_string(stats.percentile_ns(BUFFER_OP_FLUSH, 0.99))};
+}
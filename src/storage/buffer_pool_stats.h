@@ -0,0 +1,125 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+
+/**
+ * @description: 需要统计耗时的缓冲池操作
+ */
+enum BufferOp { BUFFER_OP_FETCH = 0, BUFFER_OP_NEW, BUFFER_OP_FLUSH, NUM_BUFFER_OPS };
+
+/**
+ * @description: 一个文件(表或索引)在缓冲池中的统计信息快照。
+ * 耗时直方图的第0个桶记录耗时为0ns的操作，第i个桶记录耗时在[2^(i-1), 2^i)ns之间的操作，最后一个桶记录更慢的操作
+ */
+struct BufferFileStats {
+    uint64_t hits = 0;            // fetch_page命中缓冲池的次数
+    uint64_t misses = 0;          // fetch_page需要从磁盘读取的次数
+    uint64_t evictions = 0;       // 该文件的页面被换出的次数
+    uint64_t writebacks = 0;      // 该文件的页面被写回磁盘的次数
+    uint64_t pin_waits = 0;       // fetch_page等待页面被批量读入的次数
+    uint64_t latch_waits = 0;     // 获取分片latch_时需要等待的次数
+    uint64_t latch_wait_ns = 0;   // 等待分片latch_的总时间
+    uint64_t op_count[NUM_BUFFER_OPS] = {};
+    uint64_t op_total_ns[NUM_BUFFER_OPS] = {};
+    uint64_t op_histogram[NUM_BUFFER_OPS][BUFFER_STATS_HISTOGRAM_BUCKETS] = {};
+
+    void merge(const BufferFileStats &other);
+
+    double hit_ratio() const;
+
+    uint64_t average_ns(BufferOp op) const;
+
+    uint64_t percentile_ns(BufferOp op, double percentile) const;
+
+    static uint64_t bucket_upper_ns(int bucket);
+};
+
+/**
+ * @description: 缓冲池的命中、换出、写回、等待和操作耗时统计，按文件句柄分别记录。
+ * 计数器分为BUFFER_STATS_SHARDS个分片，每个线程第一次记录时固定分到其中一个，
+ * 线程数不超过分片数时各线程只修改自己的缓存行，计数器只用relaxed原子操作，不加锁。
+ * 每个分片最多单独记录BUFFER_STATS_MAX_FILES个文件，更多的文件合并记录在fd为-1的条目中；
+ * 统计按fd汇总，文件关闭后fd被复用时，新文件的统计会累加在旧文件之上
+ */
+class BufferPoolStats {
+   public:
+    BufferPoolStats();
+
+    ~BufferPoolStats();
+
+    void record_hit(int fd) { add(&get_counters(fd)->hits, 1); }
+
+    void record_miss(int fd) { add(&get_counters(fd)->misses, 1); }
+
+    void record_eviction(int fd) { add(&get_counters(fd)->evictions, 1); }
+
+    void record_writeback(int fd) { add(&get_counters(fd)->writebacks, 1); }
+
+    void record_pin_wait(int fd) { add(&get_counters(fd)->pin_waits, 1); }
+
+    void record_latch_wait(int fd, uint64_t wait_ns);
+
+    void record_latency(BufferOp op, int fd, uint64_t latency_ns);
+
+    std::map<int, BufferFileStats> snapshot() const;
+
+    void reset();
+
+    static const std::vector<std::string> &get_captions();
+
+    static std::vector<std::string> format_row(const std::string &name, const BufferFileStats &stats);
+
+    /**
+     * @description: 从start开始经过的纳秒数
+     */
+    static uint64_t elapsed_ns(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+
+   private:
+    struct alignas(64) Counters {
+        std::atomic<uint64_t> hits{0};
+        std::atomic<uint64_t> misses{0};
+        std::atomic<uint64_t> evictions{0};
+        std::atomic<uint64_t> writebacks{0};
+        std::atomic<uint64_t> pin_waits{0};
+        std::atomic<uint64_t> latch_waits{0};
+        std::atomic<uint64_t> latch_wait_ns{0};
+        std::atomic<uint64_t> op_count[NUM_BUFFER_OPS]{};
+        std::atomic<uint64_t> op_total_ns[NUM_BUFFER_OPS]{};
+        std::atomic<uint64_t> op_histogram[NUM_BUFFER_OPS][BUFFER_STATS_HISTOGRAM_BUCKETS]{};
+    };
+
+    struct Shard {
+        std::atomic<int> fds[BUFFER_STATS_MAX_FILES];      // 开放寻址的文件句柄表，-1表示空位
+        Counters files[BUFFER_STATS_MAX_FILES];
+        Counters others;                                   // 文件句柄表已满时其余文件的统计
+    };
+
+    static void add(std::atomic<uint64_t> *counter, uint64_t value) {
+        counter->fetch_add(value, std::memory_order_relaxed);
+    }
+
+    static void read_counters(const Counters &counters, BufferFileStats *stats);
+
+    Counters *get_counters(int fd);
+
+    std::unique_ptr<Shard[]> shards_;
+};
@@ -11,13 +11,84 @@ See the Mulan PSL v2 for more details. */
 #include "storage/disk_manager.h"
 
 #include <assert.h>    // for assert
+#include <limits.h>    // for IOV_MAX
+#include <stdint.h>    // for uintptr_t
+#include <stdlib.h>    // for aligned_alloc
 #include <string.h>    // for memset
 #include <sys/stat.h>  // for stat
-#include <unistd.h>    // for lseek
+#include <sys/uio.h>   // for preadv, pwritev
+#include <unistd.h>    // for pread, pwrite
+
+#include <algorithm>
+#include <vector>
 
 #include "defs.h"
 
-DiskManager::DiskManager() { memset(fd2pageno_, 0, MAX_FD * (sizeof(std::atomic<page_id_t>) / sizeof(char))); }
+/**
+ * @description: 从文件的offset处开始依次读写iov描述的内存。preadv()/pwritev()一次最多接受IOV_MAX个iovec，
+ * 并且可能只读写一部分，需要循环直到全部完成；读到文件末尾时停止，剩余的内存保持不变
+ * @return {ssize_t} 读写的总字节数，发生错误时返回-1
+ */
+static ssize_t transfer_iov(int fd, std::vector<iovec> iov, off_t offset, bool is_write) {
+    ssize_t total = 0;
+    size_t idx = 0;
+    while (idx < iov.size()) {
+        int cnt = static_cast<int>(std::min(iov.size() - idx, static_cast<size_t>(IOV_MAX)));
+        ssize_t bytes = is_write ? pwritev(fd, &iov[idx], cnt, offset) : preadv(fd, &iov[idx], cnt, offset);
+        if (bytes < 0 || (bytes == 0 && is_write)) return -1;
+        if (bytes == 0) break;  // 到达文件末尾
+        offset += bytes;
+        total += bytes;
+        while (bytes > 0) {
+            if (static_cast<size_t>(bytes) >= iov[idx].iov_len) {
+                bytes -= iov[idx].iov_len;
+                idx++;
+            } else {
+                iov[idx].iov_base = static_cast<char *>(iov[idx].iov_base) + bytes;
+                iov[idx].iov_len -= bytes;
+                bytes = 0;
+            }
+        }
+    }
+    return total;
+}
+
+static std::vector<iovec> make_page_iov(char *const *bufs, int num_pages, int page_size) {
+    std::vector<iovec> iov(num_pages);
+    for (int i = 0; i < num_pages; i++) {
+        iov[i].iov_base = bufs[i];
+        iov[i].iov_len = page_size;
+    }
+    return iov;
+}
+
+/**
+ * @description: O_DIRECT要求内存地址、长度和文件偏移都按块对齐，缓冲池的帧满足MIN_PAGE_SIZE对齐
+ */
+static bool is_aligned(const std::vector<iovec> &iov, off_t offset) {
+    if (offset % MIN_PAGE_SIZE != 0) return false;
+    for (auto &vec : iov) {
+        if (reinterpret_cast<uintptr_t>(vec.iov_base) % MIN_PAGE_SIZE != 0 || vec.iov_len % MIN_PAGE_SIZE != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+DiskManager::DiskManager(bool use_io_uring, bool use_direct_io, int page_size)
+    : page_size_(page_size), use_direct_io_(use_direct_io), use_io_uring_(use_io_uring) {
+    if (!is_valid_page_size(page_size_)) throw InternalError("Invalid page size: " + std::to_string(page_size_));
+    memset(fd2pageno_, 0, MAX_FD * (sizeof(std::atomic<page_id_t>) / sizeof(char)));
+    // 预先创建一个io_uring，失败说明内核或编译环境不支持，此后IoBatch都使用同步读写
+    if (use_io_uring_) {
+        try {
+            io_queues_.emplace_back(std::make_unique<IoUringQueue>(IO_URING_QUEUE_DEPTH));
+            free_io_queues_.push_back(io_queues_.back().get());
+        } catch (RMDBError &e) {
+            use_io_uring_ = false;
+        }
+    }
+}
 
 /**
  * @description: 将数据写入文件的指定磁盘页面中
@@ -27,12 +98,16 @@ DiskManager::DiskManager() { memset(fd2pageno_, 0, MAX_FD * (sizeof(std::atomic<
  * @param {int} num_bytes 要写入磁盘的数据大小
  */
 void DiskManager::write_page(int fd, page_id_t page_no, const char *offset, int num_bytes) {
-    // Todo:
-    // 1.lseek()定位到文件头，通过(fd,page_no)可以定位指定页面及其在磁盘文件中的偏移量
-    // 2.调用write()函数
+    // 通过(fd,page_no)可以定位指定页面在磁盘文件中的偏移量
+    // 不同缓冲池分片上的页面可能被多个线程同时读写，因此使用pwrite()，不依赖fd共享的文件偏移量
     // 注意write返回值与num_bytes不等时 throw InternalError("DiskManager::write_page Error");
-    lseek(fd,page_no*PAGE_SIZE,SEEK_SET);
-    int write_bytes = write(fd,offset,num_bytes);
+    if (direct_io_fds_[fd]) {
+        // O_DIRECT文件可能需要经由对齐的临时缓冲区中转
+        std::vector<iovec> iov = {{const_cast<char *>(offset), static_cast<size_t>(num_bytes)}};
+        if (!transfer(fd, iov, static_cast<off_t>(page_no) * page_size_, true)) throw InternalError("DiskManager::write_page Error");
+        return;
+    }
+    int write_bytes = pwrite(fd, offset, num_bytes, static_cast<off_t>(page_no) * page_size_);
     if(write_bytes<0) throw InternalError("DiskManager::write_page Error");
 }
 
@@ -44,15 +119,233 @@ void DiskManager::write_page(int fd, page_id_t page_no, const char *offset, int
  * @param {int} num_bytes 读取的数据量大小
  */
 void DiskManager::read_page(int fd, page_id_t page_no, char *offset, int num_bytes) {
-    // Todo:
-    // 1.lseek()定位到文件头，通过(fd,page_no)可以定位指定页面及其在磁盘文件中的偏移量
-    // 2.调用read()函数
+    // 通过(fd,page_no)可以定位指定页面在磁盘文件中的偏移量
+    // 同write_page，使用pread()避免多个线程通过lseek()修改同一个文件偏移量
     // 注意read返回值与num_bytes不等时，throw InternalError("DiskManager::read_page Error");
-    lseek(fd,page_no*PAGE_SIZE,SEEK_SET);
-    int read_bytes = read(fd,offset,num_bytes);
+    if (direct_io_fds_[fd]) {
+        std::vector<iovec> iov = {{offset, static_cast<size_t>(num_bytes)}};
+        if (!transfer(fd, iov, static_cast<off_t>(page_no) * page_size_, false)) throw InternalError("DiskManager::read_page Error");
+        return;
+    }
+    int read_bytes = pread(fd, offset, num_bytes, static_cast<off_t>(page_no) * page_size_);
     if(read_bytes<0) throw InternalError("DiskManager::read_page Error");
 }
 
+/**
+ * @description: 将连续的num_pages个页面一次写入文件，第i个页面的数据在bufs[i]中
+ * @param {int} fd 磁盘文件的文件句柄
+ * @param {page_id_t} start_page_no 第一个页面的编号
+ * @param {char*const*} bufs 每个页面的数据，长度均为页面大小，不要求在内存中连续
+ * @param {int} num_pages 页面个数
+ */
+void DiskManager::write_pages(int fd, page_id_t start_page_no, const char *const *bufs, int num_pages) {
+    if (!transfer(fd, make_page_iov(const_cast<char *const *>(bufs), num_pages, page_size_),
+                  static_cast<off_t>(start_page_no) * page_size_, true)) {
+        throw InternalError("DiskManager::write_pages Error");
+    }
+}
+
+/**
+ * @description: 一次读取文件中连续的num_pages个页面，第i个页面读入bufs[i]，超出文件末尾的部分保持不变
+ * @param {int} fd 磁盘文件的文件句柄
+ * @param {page_id_t} start_page_no 第一个页面的编号
+ * @param {char*const*} bufs 每个页面的读取位置，长度均为页面大小，不要求在内存中连续
+ * @param {int} num_pages 页面个数
+ */
+void DiskManager::read_pages(int fd, page_id_t start_page_no, char *const *bufs, int num_pages) {
+    if (!transfer(fd, make_page_iov(bufs, num_pages, page_size_), static_cast<off_t>(start_page_no) * page_size_,
+                  false)) {
+        throw InternalError("DiskManager::read_pages Error");
+    }
+}
+
+/**
+ * @description: 读写iov描述的内存。以O_DIRECT打开的文件遇到没有对齐的内存或长度时(如文件头)，
+ * 经由按MIN_PAGE_SIZE对齐的临时缓冲区中转，写入不足一页的部分时先读出原有的内容
+ * @return {bool} 发生错误时返回false
+ */
+bool DiskManager::transfer(int fd, const std::vector<iovec> &iov, off_t offset, bool is_write) {
+    if (!direct_io_fds_[fd] || is_aligned(iov, offset)) return transfer_iov(fd, iov, offset, is_write) >= 0;
+    assert(offset % MIN_PAGE_SIZE == 0);
+    size_t num_bytes = 0;
+    for (auto &vec : iov) num_bytes += vec.iov_len;
+    size_t aligned_bytes = (num_bytes + MIN_PAGE_SIZE - 1) / MIN_PAGE_SIZE * MIN_PAGE_SIZE;
+    std::unique_ptr<char, decltype(&free)> bounce(static_cast<char *>(aligned_alloc(MIN_PAGE_SIZE, aligned_bytes)),
+                                                  &free);
+    if (bounce == nullptr) return false;
+    memset(bounce.get(), 0, aligned_bytes);
+    std::vector<iovec> bounce_iov = {{bounce.get(), aligned_bytes}};
+    if (is_write) {
+        if (aligned_bytes != num_bytes && transfer_iov(fd, bounce_iov, offset, false) < 0) return false;
+        size_t pos = 0;
+        for (auto &vec : iov) {
+            memcpy(bounce.get() + pos, vec.iov_base, vec.iov_len);
+            pos += vec.iov_len;
+        }
+        return transfer_iov(fd, bounce_iov, offset, true) >= 0;
+    }
+    ssize_t read_bytes = transfer_iov(fd, bounce_iov, offset, false);
+    if (read_bytes < 0) return false;
+    // 只拷贝读到的部分，超出文件末尾的内存保持不变
+    size_t pos = 0;
+    for (auto &vec : iov) {
+        if (pos >= static_cast<size_t>(read_bytes)) break;
+        size_t len = std::min(vec.iov_len, static_cast<size_t>(read_bytes) - pos);
+        memcpy(vec.iov_base, bounce.get() + pos, len);
+        pos += len;
+    }
+    return true;
+}
+
+/**
+ * @description: 提交一批读写请求，不等待完成。之后必须调用wait_io，在此之前请求中的内存不能被释放或修改。
+ * 支持io_uring时从队列池中取一个io_uring独占使用，至多IO_URING_QUEUE_DEPTH个请求同时在队列中；
+ * 不支持或队列池已经用完时在这里同步完成所有请求
+ * @param {IoBatch*} batch 需要提交的请求
+ */
+void DiskManager::submit_io(IoBatch *batch) {
+    assert(batch->queue_ == nullptr);
+    batch->disk_manager_ = this;
+    batch->next_ = 0;
+    batch->num_inflight_ = 0;
+    for (auto &request : batch->requests_) {
+        if (request.start_page_no == INVALID_PAGE_ID) continue;
+        request.offset = static_cast<off_t>(request.start_page_no) * page_size_;
+        for (auto &vec : request.iov) vec.iov_len = page_size_;
+        request.num_bytes = request.iov.size() * page_size_;
+    }
+    IoUringQueue *queue = use_io_uring_ && !batch->requests_.empty() ? acquire_io_queue() : nullptr;
+    if (queue == nullptr) {
+        for (auto &request : batch->requests_) {
+            request.ok = transfer(request.fd, request.iov, request.offset, request.is_write);
+        }
+        batch->next_ = batch->requests_.size();
+        return;
+    }
+    batch->queue_ = queue;
+    fill_io_queue(batch);
+    queue->submit(0);
+}
+
+/**
+ * @description: 等待submit_io提交的一批请求全部完成，只完成了一部分的请求(如读到文件末尾)改为同步读写剩余部分
+ * @param {IoBatch*} batch 已经提交的请求
+ */
+void DiskManager::wait_io(IoBatch *batch) {
+    IoUringQueue *queue = batch->queue_;
+    if (queue == nullptr) return;
+    while (batch->num_inflight_ > 0) {
+        queue->submit(1);
+        uint64_t user_data;
+        int res;
+        while (queue->pop(&user_data, &res)) {
+            auto &request = batch->requests_[user_data];
+            batch->num_inflight_--;
+            if (res >= 0 && static_cast<size_t>(res) == request.num_bytes) {
+                request.ok = true;
+            } else {
+                request.ok = transfer(request.fd, request.iov, request.offset, request.is_write);
+            }
+        }
+        // 队列中空出的位置留给剩余的请求
+        fill_io_queue(batch);
+    }
+    batch->queue_ = nullptr;
+    release_io_queue(queue);
+}
+
+/**
+ * @description: 把batch中还没有提交的请求放入它占用的io_uring，直到队列满
+ */
+void DiskManager::fill_io_queue(IoBatch *batch) {
+    IoUringQueue *queue = batch->queue_;
+    while (batch->next_ < batch->requests_.size() && batch->num_inflight_ < queue->get_entries()) {
+        auto &request = batch->requests_[batch->next_];
+        // io_uring的readv/writev同样最多接受IOV_MAX个iovec，更长的请求以及需要经由临时缓冲区中转的O_DIRECT请求直接同步完成
+        if (request.iov.size() > static_cast<size_t>(IOV_MAX) ||
+            (direct_io_fds_[request.fd] && !is_aligned(request.iov, request.offset))) {
+            request.ok = transfer(request.fd, request.iov, request.offset, request.is_write);
+        } else {
+            queue->push(request.is_write, request.fd, request.iov.data(), static_cast<unsigned>(request.iov.size()),
+                        request.offset, batch->next_);
+            batch->num_inflight_++;
+        }
+        batch->next_++;
+    }
+}
+
+/**
+ * @description: 从队列池中取一个空闲的io_uring，没有时在不超过IO_URING_MAX_QUEUES的前提下新建一个
+ * @return {IoUringQueue*} 取得的io_uring，队列池已经用完或创建失败时返回nullptr
+ */
+IoUringQueue *DiskManager::acquire_io_queue() {
+    std::lock_guard<std::mutex> guard(io_queues_latch_);
+    if (!free_io_queues_.empty()) {
+        IoUringQueue *queue = free_io_queues_.back();
+        free_io_queues_.pop_back();
+        return queue;
+    }
+    if (io_queues_.size() >= IO_URING_MAX_QUEUES) return nullptr;
+    try {
+        io_queues_.emplace_back(std::make_unique<IoUringQueue>(IO_URING_QUEUE_DEPTH));
+    } catch (RMDBError &e) {
+        return nullptr;
+    }
+    return io_queues_.back().get();
+}
+
+void DiskManager::release_io_queue(IoUringQueue *queue) {
+    std::lock_guard<std::mutex> guard(io_queues_latch_);
+    free_io_queues_.push_back(queue);
+}
+
+IoBatch::~IoBatch() {
+    // 请求还在进行时不能释放iovec
+    if (queue_ != nullptr) {
+        try {
+            disk_manager_->wait_io(this);
+        } catch (RMDBError &e) {
+        }
+    }
+}
+
+/**
+ * @description: 添加一个读请求，读取文件中从start_page_no开始的num_pages个连续页面，第i个页面读入bufs[i]
+ * @return {size_t} 请求的编号，用于succeeded()
+ */
+size_t IoBatch::add_read(int fd, page_id_t start_page_no, char *const *bufs, int num_pages) {
+    requests_.push_back({false, fd, start_page_no, 0, make_page_iov(bufs, num_pages, 0), 0});
+    return requests_.size() - 1;
+}
+
+/**
+ * @description: 添加一个写请求，把bufs中的num_pages个页面写入文件中从start_page_no开始的连续页面
+ * @return {size_t} 请求的编号，用于succeeded()
+ */
+size_t IoBatch::add_write(int fd, page_id_t start_page_no, const char *const *bufs, int num_pages) {
+    requests_.push_back({true, fd, start_page_no, 0, make_page_iov(const_cast<char *const *>(bufs), num_pages, 0), 0});
+    return requests_.size() - 1;
+}
+
+/**
+ * @description: 添加一个写请求，把buf中的num_bytes个字节写入文件的offset处，用于写日志
+ * @return {size_t} 请求的编号，用于succeeded()
+ */
+size_t IoBatch::add_write(int fd, off_t offset, const char *buf, int num_bytes) {
+    iovec iov;
+    iov.iov_base = const_cast<char *>(buf);
+    iov.iov_len = num_bytes;
+    requests_.push_back({true, fd, INVALID_PAGE_ID, offset, {iov}, static_cast<size_t>(num_bytes)});
+    return requests_.size() - 1;
+}
+
+bool IoBatch::all_succeeded() const {
+    for (auto &request : requests_) {
+        if (!request.ok) return false;
+    }
+    return true;
+}
+
 /**
  * @description: 分配一个新的页号
  * @return {page_id_t} 分配的新页号
@@ -120,6 +413,7 @@ void DiskManager::destroy_file(const std::string &path) {
     // 调用unlink()函数
     // 注意不能删除未关闭的文件
     if(!is_file(path)) throw FileNotFoundError(path);
+    std::lock_guard<std::mutex> guard(files_latch_);
     if(path2fd_.count(path)) throw FileNotClosedError(path);//文件未关闭
     unlink(path.c_str());
 }
@@ -135,8 +429,18 @@ int DiskManager::open_file(const std::string &path) {
     // 调用open()函数，使用O_RDWR模式
     // 注意不能重复打开相同文件，并且需要更新文件打开列表
     if(!is_file(path)) throw FileNotFoundError(path);
+    std::lock_guard<std::mutex> guard(files_latch_);
     if(path2fd_.count(path)) throw FileNotClosedError(path);
-    int fd = open(path.c_str(),O_RDWR);
+    // 开启O_DIRECT时表和索引文件绕过页缓存，日志文件的写入没有按块对齐，仍然使用页缓存；
+    // 文件系统不支持O_DIRECT(如tmpfs)时退回到普通的打开方式
+    bool direct_io = use_direct_io_ && path != LOG_FILE_NAME;
+    int fd = direct_io ? open(path.c_str(), O_RDWR | O_DIRECT) : -1;
+    if (fd < 0) {
+        direct_io = false;
+        fd = open(path.c_str(), O_RDWR);
+    }
+    if (fd < 0) throw UnixError();
+    direct_io_fds_[fd] = direct_io;
     //更新文件打开列表操作
     fd2path_[fd] = path;
     path2fd_[path] = fd;
@@ -151,10 +455,12 @@ void DiskManager::close_file(int fd) {
     // Todo:
     // 调用close()函数
     // 注意不能关闭未打开的文件，并且需要更新文件打开列表
+    std::lock_guard<std::mutex> guard(files_latch_);
     if(!fd2path_.count(fd)){//该文件未打开
         throw FileNotOpenError(fd);
     }
     close(fd);
+    direct_io_fds_[fd] = false;
     path2fd_.erase(fd2path_[fd]);
     fd2path_.erase(fd);
 }
@@ -177,22 +483,32 @@ int DiskManager::get_file_size(const std::string &file_name) {
  * @param {int} fd 文件句柄
  */
 std::string DiskManager::get_file_name(int fd) {
+    std::lock_guard<std::mutex> guard(files_latch_);
     if (!fd2path_.count(fd)) {
         throw FileNotOpenError(fd);
     }
     return fd2path_[fd];
 }
 
+/**
+ * @description: 查找已经打开的文件的文件句柄，不打开文件
+ * @return {int} 文件句柄，文件没有被打开时返回-1
+ * @param {string} &file_name 文件名
+ */
+int DiskManager::find_file_fd(const std::string &file_name) {
+    std::lock_guard<std::mutex> guard(files_latch_);
+    auto it = path2fd_.find(file_name);
+    return it == path2fd_.end() ? -1 : it->second;
+}
+
 /**
  * @description:  获得文件名对应的文件句柄
  * @return {int} 文件句柄
  * @param {string} &file_name 文件名
  */
 int DiskManager::get_file_fd(const std::string &file_name) {
-    if (!path2fd_.count(file_name)) {
-        return open_file(file_name);
-    }
-    return path2fd_[file_name];
+    int fd = find_file_fd(file_name);
+    return fd >= 0 ? fd : open_file(file_name);
 }
 
 
@@ -215,8 +531,7 @@ int DiskManager::read_log(char *log_data, int size, int offset) {
 
     size = std::min(size, file_size - offset);
     if(size == 0) return 0;
-    lseek(log_fd_, offset, SEEK_SET);
-    ssize_t bytes_read = read(log_fd_, log_data, size);
+    ssize_t bytes_read = pread(log_fd_, log_data, size, offset);
     assert(bytes_read == size);
     return bytes_read;
 }
@@ -232,10 +547,14 @@ void DiskManager::write_log(char *log_data, int size) {
         log_fd_ = open_file(LOG_FILE_NAME);
     }
 
-    // write from the file_end
-    lseek(log_fd_, 0, SEEK_END);
-    ssize_t bytes_write = write(log_fd_, log_data, size);
-    if (bytes_write != size) {
+    // write from the file_end，日志写入同样经由IoBatch，支持时通过io_uring提交
+    off_t offset = lseek(log_fd_, 0, SEEK_END);
+    if (offset < 0) throw UnixError();
+    IoBatch batch;
+    batch.add_write(log_fd_, offset, log_data, size);
+    submit_io(&batch);
+    wait_io(&batch);
+    if (!batch.succeeded(0)) {
         throw UnixError();
     }
-}
\ No newline at end of file
+}
\ No newline at end of file
@@ -12,30 +12,107 @@ See the Mulan PSL v2 for more details. */
 
 #include <fcntl.h>     
 #include <sys/stat.h>  
+#include <sys/uio.h>
 #include <unistd.h>    
 
 #include <atomic>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "common/config.h"
 #include "errors.h"  
+#include "io_uring_queue.h"
+
+class DiskManager;
+
+/**
+ * @description: 一批可以同时执行的读写请求。通过DiskManager::submit_io提交后立即返回，
+ * 调用者可以在I/O进行期间做其他工作，再用DiskManager::wait_io等待全部完成并用succeeded()检查每个请求的结果。
+ * 支持io_uring时一批请求同时在队列中，否则在submit_io中依次同步完成
+ */
+class IoBatch {
+    friend class DiskManager;
+
+   public:
+    IoBatch() = default;
+
+    ~IoBatch();
+
+    IoBatch(const IoBatch &) = delete;
+    IoBatch &operator=(const IoBatch &) = delete;
+
+    size_t add_read(int fd, page_id_t start_page_no, char *const *bufs, int num_pages);
+
+    size_t add_write(int fd, page_id_t start_page_no, const char *const *bufs, int num_pages);
+
+    size_t add_write(int fd, off_t offset, const char *buf, int num_bytes);
+
+    size_t size() const { return requests_.size(); }
+
+    /**
+     * @description: 第i个请求是否成功，wait_io返回之后才有意义。读请求遇到文件末尾时，超出的部分保持不变，仍视为成功
+     */
+    bool succeeded(size_t i) const { return requests_[i].ok; }
+
+    bool all_succeeded() const;
+
+   private:
+    struct Request {
+        bool is_write;
+        int fd;
+        page_id_t start_page_no;    // 页面请求的第一个页号，按字节偏移的请求为INVALID_PAGE_ID
+        off_t offset;               // 页面请求的偏移量和iov的长度在submit_io时根据DiskManager的页面大小确定
+        std::vector<iovec> iov;
+        size_t num_bytes;
+        bool ok = false;
+    };
+
+    std::vector<Request> requests_;
+    DiskManager *disk_manager_ = nullptr;   // 提交这一批请求的DiskManager
+    IoUringQueue *queue_ = nullptr;         // 提交到wait_io结束期间独占的io_uring，为空时表示没有未完成的请求
+    size_t next_ = 0;                       // 下一个需要提交的请求
+    size_t num_inflight_ = 0;               // 已提交但还没有完成的请求个数
+};
 
 /**
  * @description: DiskManager的作用主要是根据上层的需要对磁盘文件进行操作
  */
 class DiskManager {
    public:
-    explicit DiskManager();
+    explicit DiskManager(bool use_io_uring = USE_IO_URING, bool use_direct_io = USE_DIRECT_IO, int page_size = PAGE_SIZE);
 
     ~DiskManager() = default;
 
+    /**
+     * @description: 当前数据库的页面大小，在创建数据库时确定并记录在db.meta中
+     */
+    int get_page_size() const { return page_size_; }
+
+    static bool is_valid_page_size(int page_size) {
+        return page_size >= MIN_PAGE_SIZE && page_size <= MAX_PAGE_SIZE && (page_size & (page_size - 1)) == 0;
+    }
+
     void write_page(int fd, page_id_t page_no, const char *offset, int num_bytes);
 
     void read_page(int fd, page_id_t page_no, char *offset, int num_bytes);
 
+    void write_pages(int fd, page_id_t start_page_no, const char *const *bufs, int num_pages);
+
+    void read_pages(int fd, page_id_t start_page_no, char *const *bufs, int num_pages);
+
+    void submit_io(IoBatch *batch);
+
+    void wait_io(IoBatch *batch);
+
+    bool is_io_uring_enabled() const { return use_io_uring_; }
+
+    bool is_direct_io(int fd) const { return direct_io_fds_[fd]; }
+
     page_id_t allocate_page(int fd);
 
     void deallocate_page(page_id_t page_id);
@@ -64,6 +141,8 @@ class DiskManager {
 
     int get_file_fd(const std::string &file_name);
 
+    int find_file_fd(const std::string &file_name);
+
     /*日志操作*/
     int read_log(char *log_data, int size, int offset);
 
@@ -90,10 +169,27 @@ class DiskManager {
     static constexpr int MAX_FD = 8192;
 
    private:
-    // 文件打开列表，用于记录文件是否被打开
+    bool transfer(int fd, const std::vector<iovec> &iov, off_t offset, bool is_write);
+
+    IoUringQueue *acquire_io_queue();
+
+    void release_io_queue(IoUringQueue *queue);
+
+    void fill_io_queue(IoBatch *batch);
+
+    // 文件打开列表，用于记录文件是否被打开，由files_latch_保护
+    std::mutex files_latch_;
     std::unordered_map<std::string, int> path2fd_;  //<Page文件磁盘路径,Page fd>哈希表
     std::unordered_map<int, std::string> fd2path_;  //<Page fd,Page文件磁盘路径>哈希表
 
     int log_fd_ = -1;                             // WAL日志文件的文件句柄，默认为-1，代表未打开日志文件
     std::atomic<page_id_t> fd2pageno_[MAX_FD]{};  // 文件中已经分配的页面个数，初始值为0
+    std::atomic<bool> direct_io_fds_[MAX_FD]{};   // 文件是否以O_DIRECT打开
+
+    int page_size_;                                             // 页面大小，MIN_PAGE_SIZE到MAX_PAGE_SIZE之间的2的幂
+    bool use_direct_io_;                                        // 表和索引文件是否以O_DIRECT打开，绕过操作系统的页缓存
+    bool use_io_uring_;                                         // 是否通过io_uring提交IoBatch，不支持时为false
+    std::mutex io_queues_latch_;                                // 保护io_queues_和free_io_queues_
+    std::vector<std::unique_ptr<IoUringQueue>> io_queues_;      // 已经创建的io_uring，至多IO_URING_MAX_QUEUES个
+    std::vector<IoUringQueue *> free_io_queues_;                // 当前没有被IoBatch占用的io_uring
 };
\ No newline at end of file
@@ -0,0 +1,62 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <sys/mman.h>
+
+#include <cstddef>
+
+#include "common/config.h"
+#include "errors.h"
+
+/**
+ * @description: 缓冲池所有帧的页面数据所在的一整块内存。由mmap分配，起始地址按系统页对齐，
+ * 每一帧占page_size字节，page_size是MIN_PAGE_SIZE的整数倍，因此每一帧都满足O_DIRECT的对齐要求。
+ * 开启USE_HUGE_PAGES时优先使用预留的大页(MAP_HUGETLB)，没有预留大页时退回到普通页并建议内核使用透明大页
+ */
+class FrameArena {
+   public:
+    FrameArena(size_t num_frames, int page_size) : page_size_(page_size), size_(num_frames * page_size) {
+        if (USE_HUGE_PAGES && size_ >= HUGE_PAGE_SIZE) {
+            size_t huge_size = (size_ + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+            void *data = mmap(nullptr, huge_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+                              -1, 0);
+            if (data != MAP_FAILED) {
+                data_ = static_cast<char *>(data);
+                size_ = huge_size;
+                huge_pages_ = true;
+                return;
+            }
+        }
+        void *data = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (data == MAP_FAILED) throw InternalError("FrameArena: mmap failed");
+        data_ = static_cast<char *>(data);
+#ifdef MADV_HUGEPAGE
+        if (USE_HUGE_PAGES && size_ >= HUGE_PAGE_SIZE) madvise(data_, size_, MADV_HUGEPAGE);
+#endif
+    }
+
+    ~FrameArena() { munmap(data_, size_); }
+
+    FrameArena(const FrameArena &) = delete;
+    FrameArena &operator=(const FrameArena &) = delete;
+
+    // 第frame_no帧的页面数据，mmap分配的内存初始全为0
+    char *get_frame(size_t frame_no) const { return data_ + frame_no * page_size_; }
+
+    bool uses_huge_pages() const { return huge_pages_; }
+
+   private:
+    char *data_ = nullptr;
+    size_t page_size_;          // 每一帧的字节数
+    size_t size_;               // 映射的字节数，使用大页时向上取整到大页大小
+    bool huge_pages_ = false;   // 是否使用了预留的大页
+};
@@ -0,0 +1,148 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "io_uring_queue.h"
+
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "errors.h"
+
+#ifdef RMDB_HAVE_IO_URING
+#include <linux/io_uring.h>
+
+IoUringQueue::IoUringQueue(unsigned entries) {
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    ring_fd_ = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (ring_fd_ < 0) throw InternalError("IoUringQueue: io_uring_setup failed");
+    entries_ = params.sq_entries;
+
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap) sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+
+    sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                    IORING_OFF_SQ_RING);
+    cq_ring_ = single_mmap ? sq_ring_
+                           : mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                                  IORING_OFF_CQ_RING);
+    sqes_ = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+    if (sq_ring_ == MAP_FAILED || cq_ring_ == MAP_FAILED || sqes_ == MAP_FAILED) {
+        if (sq_ring_ != MAP_FAILED) munmap(sq_ring_, sq_ring_size_);
+        if (!single_mmap && cq_ring_ != MAP_FAILED) munmap(cq_ring_, cq_ring_size_);
+        if (sqes_ != MAP_FAILED) munmap(sqes_, sqes_size_);
+        close(ring_fd_);
+        throw InternalError("IoUringQueue: mmap failed");
+    }
+
+    char *sq = static_cast<char *>(sq_ring_);
+    sq_head_ = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+    sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    sq_mask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    char *cq = static_cast<char *>(cq_ring_);
+    cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    cq_mask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    cqes_ = cq + params.cq_off.cqes;
+}
+
+IoUringQueue::~IoUringQueue() {
+    munmap(sqes_, sqes_size_);
+    if (cq_ring_ != sq_ring_) munmap(cq_ring_, cq_ring_size_);
+    munmap(sq_ring_, sq_ring_size_);
+    close(ring_fd_);
+}
+
+/**
+ * @description: 把一个readv/writev请求放入提交队列，不提交给内核
+ * @return {bool} 提交队列已满时返回false
+ * @param {bool} is_write 写请求为true，读请求为false
+ * @param {int} fd 文件句柄
+ * @param {iovec*} iov 读写的内存，在请求完成之前必须保持有效
+ * @param {unsigned} num_iov iov的个数
+ * @param {off_t} offset 文件中的偏移量
+ * @param {uint64_t} user_data 原样出现在对应的完成事件中
+ */
+bool IoUringQueue::push(bool is_write, int fd, const iovec *iov, unsigned num_iov, off_t offset, uint64_t user_data) {
+    unsigned tail = *sq_tail_;
+    if (tail - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) >= entries_) return false;
+    unsigned index = tail & *sq_mask_;
+    io_uring_sqe *sqe = static_cast<io_uring_sqe *>(sqes_) + index;
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = is_write ? IORING_OP_WRITEV : IORING_OP_READV;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(iov);
+    sqe->len = num_iov;
+    sqe->off = static_cast<uint64_t>(offset);
+    sqe->user_data = user_data;
+    sq_array_[index] = index;
+    // 内核看到新的tail时sqe必须已经写好
+    __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+    to_submit_++;
+    return true;
+}
+
+/**
+ * @description: 提交队列中的所有请求，并等待至少wait_nr个完成事件
+ * @param {unsigned} wait_nr 需要等待的完成事件个数，为0时只提交不等待
+ */
+void IoUringQueue::submit(unsigned wait_nr) {
+    unsigned flags = wait_nr > 0 ? IORING_ENTER_GETEVENTS : 0;
+    while (to_submit_ > 0 || wait_nr > 0) {
+        int ret = static_cast<int>(syscall(__NR_io_uring_enter, ring_fd_, to_submit_, wait_nr, flags, nullptr, 0));
+        if (ret < 0) {
+            if (errno == EINTR) continue;
+            throw InternalError("IoUringQueue: io_uring_enter failed");
+        }
+        to_submit_ -= static_cast<unsigned>(ret);
+        if (to_submit_ == 0) break;
+    }
+}
+
+/**
+ * @description: 取出一个完成事件
+ * @return {bool} 完成队列为空时返回false
+ * @param {uint64_t*} user_data 对应请求的user_data
+ * @param {int*} res 请求的结果，成功时为读写的字节数，失败时为-errno
+ */
+bool IoUringQueue::pop(uint64_t *user_data, int *res) {
+    unsigned head = *cq_head_;
+    if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) return false;
+    io_uring_cqe *cqe = static_cast<io_uring_cqe *>(cqes_) + (head & *cq_mask_);
+    *user_data = cqe->user_data;
+    *res = cqe->res;
+    __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+#else
+
+IoUringQueue::IoUringQueue(unsigned entries) { throw InternalError("IoUringQueue: io_uring is not supported"); }
+
+IoUringQueue::~IoUringQueue() = default;
+
+bool IoUringQueue::push(bool is_write, int fd, const iovec *iov, unsigned num_iov, off_t offset, uint64_t user_data) {
+    return false;
+}
+
+void IoUringQueue::submit(unsigned wait_nr) {}
+
+bool IoUringQueue::pop(uint64_t *user_data, int *res) { return false; }
+
+#endif
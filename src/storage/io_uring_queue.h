@@ -0,0 +1,65 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#include <cstdint>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define RMDB_HAVE_IO_URING 1
+#endif
+
+/**
+ * @description: 直接通过io_uring_setup/io_uring_enter系统调用使用的一个io_uring实例，不依赖liburing。
+ * 同一时刻只能由一个线程使用：push()把读写请求放入提交队列，submit()提交并等待完成，pop()取出完成事件。
+ * 内核或编译环境不支持io_uring时构造函数抛出InternalError，由DiskManager退回到同步读写
+ */
+class IoUringQueue {
+   public:
+    explicit IoUringQueue(unsigned entries);
+
+    ~IoUringQueue();
+
+    IoUringQueue(const IoUringQueue &) = delete;
+    IoUringQueue &operator=(const IoUringQueue &) = delete;
+
+    unsigned get_entries() const { return entries_; }
+
+    bool push(bool is_write, int fd, const iovec *iov, unsigned num_iov, off_t offset, uint64_t user_data);
+
+    void submit(unsigned wait_nr);
+
+    bool pop(uint64_t *user_data, int *res);
+
+   private:
+    int ring_fd_ = -1;
+    unsigned entries_ = 0;
+    unsigned to_submit_ = 0;    // 已经放入提交队列但还没有提交给内核的请求个数
+
+    // 提交队列(SQ)和完成队列(CQ)映射到用户态的内存
+    void *sq_ring_ = nullptr;
+    size_t sq_ring_size_ = 0;
+    void *cq_ring_ = nullptr;
+    size_t cq_ring_size_ = 0;
+    void *sqes_ = nullptr;
+    size_t sqes_size_ = 0;
+
+    unsigned *sq_head_ = nullptr;
+    unsigned *sq_tail_ = nullptr;
+    unsigned *sq_mask_ = nullptr;
+    unsigned *sq_array_ = nullptr;
+    unsigned *cq_head_ = nullptr;
+    unsigned *cq_tail_ = nullptr;
+    unsigned *cq_mask_ = nullptr;
+    void *cqes_ = nullptr;
+};
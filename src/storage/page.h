@@ -10,6 +10,10 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <atomic>
+#include <cstring>
+#include <shared_mutex>
+
 #include "common/config.h"
 
 /**
@@ -50,10 +54,12 @@ struct std::hash<PageId> {
  */
 class Page {
     friend class BufferPoolManager;
+    friend class BufferPoolInstance;
 
    public:
     
-    Page() { reset_memory(); }
+    // 页面数据由缓冲池分片从对齐的帧内存区(FrameArena)中分配，构造时还没有数据
+    Page() = default;
 
     ~Page() = default;
 
@@ -71,20 +77,34 @@ class Page {
 
     inline void set_page_lsn(lsn_t page_lsn) { memcpy(get_data() + OFFSET_LSN, &page_lsn, sizeof(lsn_t)); }
 
+    // 页面读写锁，由使用页面内容的上层模块(如B+树索引)加锁，缓冲池本身不使用
+    inline void w_latch() { rwlatch_.lock(); }
+
+    inline void w_unlatch() { rwlatch_.unlock(); }
+
+    inline void r_latch() { rwlatch_.lock_shared(); }
+
+    inline void r_unlatch() { rwlatch_.unlock_shared(); }
+
    private:
-    void reset_memory() { memset(data_, OFFSET_PAGE_START, PAGE_SIZE); }  // 将data_的PAGE_SIZE个字节填充为0
+    void reset_memory(int page_size) { memset(data_, OFFSET_PAGE_START, page_size); }  // 将data_的page_size个字节填充为0
 
     /** page的唯一标识符 */
     PageId id_;
 
     /** The actual data that is stored within a page.
-     *  该页面在bufferPool中的偏移地址
+     *  该页面在bufferPool中的偏移地址，指向FrameArena中按MIN_PAGE_SIZE对齐的一帧，满足O_DIRECT的对齐要求；
+     *  页面的元数据单独存放，不和页面数据混在一起
      */
-    char data_[PAGE_SIZE] = {};
+    char *data_ = nullptr;
+
+    /** 脏页判断, 命中页的unpin不持有分片latch_, 因此为原子变量 */
+    std::atomic<bool> is_dirty_{false};
 
-    /** 脏页判断 */
-    bool is_dirty_ = false;
+    /** The pin count of this page.
+     *  为-1时表示该帧空闲或正在被换页，无锁的fetch_page路径不能固定该帧 */
+    std::atomic<int> pin_count_{0};
 
-    /** The pin count of this page. */
-    int pin_count_ = 0;
+    /** 页面内容的读写锁，持有者必须同时固定该页面 */
+    std::shared_mutex rwlatch_;
 };
\ No newline at end of file
@@ -0,0 +1,57 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "page_flusher.h"
+
+#include "buffer_pool_manager.h"
+
+PageFlusher::PageFlusher(BufferPoolManager *buffer_pool_manager, std::function<lsn_t()> get_persist_lsn,
+                         std::chrono::milliseconds interval, size_t max_pages, double low_watermark,
+                         double high_watermark)
+    : buffer_pool_manager_(buffer_pool_manager),
+      get_persist_lsn_(std::move(get_persist_lsn)),
+      interval_(interval),
+      max_pages_(max_pages),
+      low_watermark_(low_watermark),
+      high_watermark_(high_watermark) {
+    thread_ = std::thread(&PageFlusher::run, this);
+}
+
+PageFlusher::~PageFlusher() {
+    {
+        std::lock_guard<std::mutex> guard(latch_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+}
+
+/**
+ * @description: 后台刷脏线程，每轮根据脏页比例决定是否写回以及是否休眠
+ */
+void PageFlusher::run() {
+    std::unique_lock<std::mutex> lock(latch_);
+    while (!stop_) {
+        lock.unlock();
+        bool busy = false;
+        try {
+            double dirty_ratio = buffer_pool_manager_->get_dirty_ratio();
+            if (dirty_ratio >= low_watermark_) {
+                size_t num_written = buffer_pool_manager_->flush_dirty_pages(max_pages_, get_persist_lsn_());
+                // 高于高水位且本轮有进展时立即进入下一轮；受WAL限制写不出去时仍然休眠，等待日志落盘
+                busy = dirty_ratio >= high_watermark_ && num_written > 0;
+            }
+        } catch (RMDBError &e) {
+            // 写回失败的页面保持为脏页，由下一轮或换页时重试
+        }
+        lock.lock();
+        if (!busy) cv_.wait_for(lock, interval_, [this] { return stop_; });
+    }
+}
@@ -0,0 +1,48 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "common/config.h"
+
+class BufferPoolManager;
+
+/**
+ * @description: 后台刷脏。后台线程周期性地把未被固定的脏页写回磁盘，使前台换页时大多能找到干净的victim，
+ * 不必在持有分片latch_时替其他线程写回脏页。脏页比例低于低水位时不写回，高于高水位时连续写回不休眠。
+ * 为遵守WAL，页面格式保存page_lsn的文件(见BufferPoolManager::set_lsn_file)中page_lsn大于已持久化日志lsn的脏页不会被写回
+ */
+class PageFlusher {
+   public:
+    PageFlusher(BufferPoolManager *buffer_pool_manager, std::function<lsn_t()> get_persist_lsn,
+                std::chrono::milliseconds interval, size_t max_pages, double low_watermark, double high_watermark);
+
+    ~PageFlusher();
+
+   private:
+    void run();
+
+    BufferPoolManager *buffer_pool_manager_;
+    std::function<lsn_t()> get_persist_lsn_;    // 返回已经持久化的日志的最大lsn
+    std::chrono::milliseconds interval_;        // 两轮写回之间的休眠时间
+    size_t max_pages_;                          // 每轮最多写回的页面个数
+    double low_watermark_;
+    double high_watermark_;
+    std::mutex latch_;                          // 保护stop_
+    std::condition_variable cv_;
+    bool stop_ = false;
+    std::thread thread_;
+};
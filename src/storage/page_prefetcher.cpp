@@ -0,0 +1,82 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "page_prefetcher.h"
+
+#include "buffer_pool_manager.h"
+
+PagePrefetcher::PagePrefetcher(BufferPoolManager *buffer_pool_manager, size_t num_workers)
+    : buffer_pool_manager_(buffer_pool_manager) {
+    for (size_t i = 0; i < num_workers; i++) {
+        workers_.emplace_back(&PagePrefetcher::worker, this);
+    }
+}
+
+PagePrefetcher::~PagePrefetcher() {
+    {
+        std::lock_guard<std::mutex> guard(latch_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto &worker : workers_) {
+        worker.join();
+    }
+    // 丢弃未处理的请求，释放访问策略上的计数
+    for (auto &request : requests_) {
+        if (request.strategy != nullptr) request.strategy->finish_prefetch();
+    }
+}
+
+/**
+ * @description: 提交一个预读请求，不等待其完成
+ * @param {PageId} page_id 需要预读的页面
+ * @param {BufferAccessStrategy*} strategy 读入页面时使用的访问策略，可以为空
+ */
+void PagePrefetcher::prefetch(PageId page_id, BufferAccessStrategy *strategy) {
+    {
+        std::lock_guard<std::mutex> guard(latch_);
+        if (stop_ || requests_.size() >= PREFETCH_QUEUE_SIZE) return;
+        // 访问策略在析构时会等待所有经由它提交的预读完成
+        if (strategy != nullptr) strategy->start_prefetch();
+        requests_.push_back({page_id, strategy});
+    }
+    cv_.notify_one();
+}
+
+/**
+ * @description: 后台预读线程。队列中同一文件、同一访问策略下页号连续的请求被合并成一次load_pages
+ */
+void PagePrefetcher::worker() {
+    while (true) {
+        Request request;
+        int num_pages = 1;
+        {
+            std::unique_lock<std::mutex> lock(latch_);
+            cv_.wait(lock, [this] { return stop_ || !requests_.empty(); });
+            if (stop_) return;
+            request = requests_.front();
+            requests_.pop_front();
+            while (!requests_.empty() && num_pages < PREFETCH_MAX_RUN && requests_.front().strategy == request.strategy &&
+                   requests_.front().page_id.fd == request.page_id.fd &&
+                   requests_.front().page_id.page_no == request.page_id.page_no + num_pages) {
+                requests_.pop_front();
+                num_pages++;
+            }
+        }
+        try {
+            buffer_pool_manager_->load_pages(request.page_id.fd, request.page_id.page_no, num_pages, request.strategy);
+        } catch (RMDBError &e) {
+            // 预读失败(如文件已经被关闭)不影响前台，前台读取时会重新报错
+        }
+        if (request.strategy != nullptr) {
+            for (int i = 0; i < num_pages; i++) request.strategy->finish_prefetch();
+        }
+    }
+}
@@ -0,0 +1,50 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "buffer_access_strategy.h"
+#include "page.h"
+
+class BufferPoolManager;
+
+/**
+ * @description: 异步预读。由若干后台线程从请求队列中取出PageId，通过BufferPoolManager::load_pages把页面读入缓冲池但不固定，
+ * 顺序扫描在处理当前页面时，后面的页面已经在缓冲池中了。预读只是提示，队列已满时直接丢弃请求
+ */
+class PagePrefetcher {
+   public:
+    PagePrefetcher(BufferPoolManager *buffer_pool_manager, size_t num_workers);
+
+    ~PagePrefetcher();
+
+    void prefetch(PageId page_id, BufferAccessStrategy *strategy);
+
+   private:
+    struct Request {
+        PageId page_id;
+        BufferAccessStrategy *strategy;
+    };
+
+    void worker();
+
+    BufferPoolManager *buffer_pool_manager_;
+    std::deque<Request> requests_;      // 等待预读的页面
+    std::mutex latch_;                  // 保护requests_和stop_
+    std::condition_variable cv_;
+    bool stop_ = false;
+    std::vector<std::thread> workers_;
+};
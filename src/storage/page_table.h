@@ -0,0 +1,132 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "page.h"
+
+/**
+ * @description: 缓冲池分片使用的定长开放寻址页表(线性探测)，将PageId映射到frame_id。
+ * find()不加锁，可以和写操作并发执行；insert()和erase()必须在分片的latch_保护下串行调用。
+ * 并发读可能因为写操作正在移动槽位而漏查(返回false)或读到过期的frame_id，
+ * 调用者需要在固定(pin)该帧之后再次校验帧中的PageId，漏查时退回到加锁的慢路径。
+ */
+class PageTable {
+   public:
+    // 容量取不小于帧数两倍的2的幂，保证装载因子不超过0.5
+    explicit PageTable(size_t num_frames) {
+        capacity_ = 1;
+        while (capacity_ < num_frames * 2) capacity_ <<= 1;
+        mask_ = capacity_ - 1;
+        keys_.reset(new std::atomic<uint64_t>[capacity_]);
+        values_.reset(new std::atomic<frame_id_t>[capacity_]);
+        for (size_t i = 0; i < capacity_; i++) {
+            keys_[i].store(EMPTY_KEY, std::memory_order_relaxed);
+            values_[i].store(INVALID_FRAME_ID, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @description: 无锁查找page_id所在的帧
+     * @return {bool} 找到返回true
+     * @param {PageId} page_id 目标页
+     * @param {frame_id_t*} frame_id 返回找到的帧号
+     */
+    bool find(PageId page_id, frame_id_t *frame_id) const {
+        uint64_t key = make_key(page_id);
+        size_t pos = hash(key);
+        for (size_t i = 0; i < capacity_; i++, pos = (pos + 1) & mask_) {
+            uint64_t cur = keys_[pos].load(std::memory_order_acquire);
+            if (cur == EMPTY_KEY) return false;
+            if (cur == key) {
+                *frame_id = values_[pos].load(std::memory_order_acquire);
+                return *frame_id != INVALID_FRAME_ID;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @description: 插入或覆盖page_id到frame_id的映射，调用者需持有分片的latch_
+     */
+    void insert(PageId page_id, frame_id_t frame_id) {
+        uint64_t key = make_key(page_id);
+        size_t pos = hash(key);
+        while (true) {
+            uint64_t cur = keys_[pos].load(std::memory_order_relaxed);
+            if (cur == key || cur == EMPTY_KEY) {
+                // 先写value再发布key，读者看到key时value已经可见
+                values_[pos].store(frame_id, std::memory_order_release);
+                keys_[pos].store(key, std::memory_order_release);
+                return;
+            }
+            pos = (pos + 1) & mask_;
+        }
+    }
+
+    /**
+     * @description: 删除page_id的映射，调用者需持有分片的latch_。
+     * 使用后移删除(backward shift)代替墓碑，表中不会因为频繁换页而堆积墓碑
+     */
+    void erase(PageId page_id) {
+        uint64_t key = make_key(page_id);
+        size_t pos = hash(key);
+        while (true) {
+            uint64_t cur = keys_[pos].load(std::memory_order_relaxed);
+            if (cur == EMPTY_KEY) return;
+            if (cur == key) break;
+            pos = (pos + 1) & mask_;
+        }
+        // 把探测链上后续的表项前移到空出来的槽位
+        size_t hole = pos;
+        size_t next = (hole + 1) & mask_;
+        while (true) {
+            uint64_t cur = keys_[next].load(std::memory_order_relaxed);
+            if (cur == EMPTY_KEY) break;
+            size_t home = hash(cur);
+            // home不在(hole, next]之间时，该表项可以移动到hole
+            if (((next - home) & mask_) >= ((next - hole) & mask_)) {
+                values_[hole].store(values_[next].load(std::memory_order_relaxed), std::memory_order_release);
+                keys_[hole].store(cur, std::memory_order_release);
+                hole = next;
+            }
+            next = (next + 1) & mask_;
+        }
+        keys_[hole].store(EMPTY_KEY, std::memory_order_release);
+        values_[hole].store(INVALID_FRAME_ID, std::memory_order_release);
+    }
+
+   private:
+    static constexpr uint64_t EMPTY_KEY = UINT64_MAX;
+
+    static uint64_t make_key(PageId page_id) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(page_id.fd)) << 32) |
+               static_cast<uint32_t>(page_id.page_no);
+    }
+
+    // 64位混合函数(murmur3 finalizer)，避免相邻页号聚集在相邻槽位
+    size_t hash(uint64_t key) const {
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdULL;
+        key ^= key >> 33;
+        key *= 0xc4ceb9fe1a85ec53ULL;
+        key ^= key >> 33;
+        return static_cast<size_t>(key) & mask_;
+    }
+
+    size_t capacity_;
+    size_t mask_;
+    std::unique_ptr<std::atomic<uint64_t>[]> keys_;
+    std::unique_ptr<std::atomic<frame_id_t>[]> values_;
+};
@@ -0,0 +1,45 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "periodic_task.h"
+
+#include <iostream>
+
+#include "errors.h"
+
+PeriodicTask::PeriodicTask(std::function<void()> task, std::chrono::milliseconds interval)
+    : task_(std::move(task)), interval_(interval) {
+    thread_ = std::thread(&PeriodicTask::run, this);
+}
+
+PeriodicTask::~PeriodicTask() {
+    {
+        std::lock_guard<std::mutex> guard(latch_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+}
+
+/**
+ * @description: 每隔interval_执行一次task_，任务失败时等到下一次重试
+ */
+void PeriodicTask::run() {
+    std::unique_lock<std::mutex> lock(latch_);
+    while (!cv_.wait_for(lock, interval_, [this] { return stop_; })) {
+        lock.unlock();
+        try {
+            task_();
+        } catch (RMDBError &e) {
+            std::cerr << e.what() << std::endl;
+        }
+        lock.lock();
+    }
+}
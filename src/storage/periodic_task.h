@@ -0,0 +1,38 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/**
+ * @description: 后台线程每隔固定的时间执行一次任务，析构时停止线程。
+ * 用于定期输出缓冲池统计信息和保存缓冲池快照
+ */
+class PeriodicTask {
+   public:
+    PeriodicTask(std::function<void()> task, std::chrono::milliseconds interval);
+
+    ~PeriodicTask();
+
+   private:
+    void run();
+
+    std::function<void()> task_;
+    std::chrono::milliseconds interval_;    // 两次执行之间的间隔
+    std::mutex latch_;                      // 保护stop_
+    std::condition_variable cv_;
+    bool stop_ = false;
+    std::thread thread_;
+};
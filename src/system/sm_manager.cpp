@@ -14,8 +14,10 @@ See the Mulan PSL v2 for more details. */
 #include <unistd.h>
 
 #include <fstream>
+#include <optional>
 
 #include "index/ix.h"
+#include "index/ix_external_sort.h"
 #include "record/rm.h"
 #include "record_printer.h"
 
@@ -48,6 +50,7 @@ void SmManager::create_db(const std::string& db_name) {
     //创建系统目录
     DbMeta *new_db = new DbMeta();
     new_db->name_ = db_name;
+    new_db->page_size_ = disk_manager_->get_page_size();  // 数据库的页面大小由DiskManager的页面大小决定
 
     // 注意，此处ofstream会在当前目录创建(如果没有此文件先创建)和打开一个名为DB_META_NAME的文件
     std::ofstream ofs(DB_META_NAME);
@@ -66,6 +69,20 @@ void SmManager::create_db(const std::string& db_name) {
     }
 }
 
+/**
+ * @description: 读取数据库的页面大小，在构建DiskManager和BufferPoolManager之前调用
+ * @return {int} db.meta中记录的页面大小，数据库不存在时返回default_page_size
+ * @param {string&} db_name 数据库名称
+ * @param {int} default_page_size 新建数据库时使用的页面大小
+ */
+int SmManager::get_db_page_size(const std::string& db_name, int default_page_size) {
+    std::ifstream ifs(db_name + "/" + DB_META_NAME);
+    if (!ifs.is_open()) return default_page_size;
+    DbMeta db;
+    ifs >> db;
+    return db.get_page_size();
+}
+
 /**
  * @description: 删除数据库，同时需要清空相关文件以及数据库同名文件夹
  * @param {string&} db_name 数据库名称，与文件夹同名
@@ -85,7 +102,33 @@ void SmManager::drop_db(const std::string& db_name) {
  * @param {string&} db_name 数据库名称，与文件夹同名
  */
 void SmManager::open_db(const std::string& db_name) {
-    
+    if (!is_dir(db_name)) {
+        throw DatabaseNotFoundError(db_name);
+    }
+    if (chdir(db_name.c_str()) < 0) {
+        throw UnixError();
+    }
+    std::ifstream ifs(DB_META_NAME);
+    ifs >> db_;
+    // 表和索引文件按创建数据库时的页面大小组织，DiskManager必须使用相同的页面大小
+    if (db_.get_page_size() != disk_manager_->get_page_size()) {
+        throw InternalError("Database " + db_name + " uses page size " + std::to_string(db_.get_page_size()) +
+                            ", but the storage layer was started with " +
+                            std::to_string(disk_manager_->get_page_size()));
+    }
+    // 打开所有表的数据文件和索引文件
+    for (auto &entry : db_.tabs_) {
+        auto &tab = entry.second;
+        fhs_.emplace(tab.name, rm_manager_->open_file(tab.name));
+        for (auto &index : tab.indexes) {
+            std::string ix_name = ix_manager_->get_index_name(tab.name, index.cols);
+            if (index.type == INDEX_HASH) {
+                hash_ihs_.emplace(ix_name, ix_manager_->open_hash_index(tab.name, index.cols));
+            } else {
+                ihs_.emplace(ix_name, ix_manager_->open_index(tab.name, index.cols));
+            }
+        }
+    }
 }
 
 /**
@@ -101,7 +144,24 @@ void SmManager::flush_meta() {
  * @description: 关闭数据库并把数据落盘
  */
 void SmManager::close_db() {
-    
+    flush_meta();
+    for (auto &entry : fhs_) {
+        rm_manager_->close_file(entry.second.get());
+    }
+    for (auto &entry : ihs_) {
+        ix_manager_->close_index(entry.second.get());
+    }
+    for (auto &entry : hash_ihs_) {
+        ix_manager_->close_hash_index(entry.second.get());
+    }
+    fhs_.clear();
+    ihs_.clear();
+    hash_ihs_.clear();
+    db_.name_.clear();
+    db_.tabs_.clear();
+    if (chdir("..") < 0) {
+        throw UnixError();
+    }
 }
 
 /**
@@ -125,6 +185,27 @@ void SmManager::show_tables(Context* context) {
     outfile.close();
 }
 
+/**
+ * @description: 显示缓冲池中每个文件(表或索引)的命中、换出、写回、等待次数和操作耗时，最后一行为所有文件的合计。
+ * 统计信息随运行状态变化，不写入output.txt
+ * @param {Context*} context 
+ */
+void SmManager::show_buffer_stats(Context* context) {
+    const std::vector<std::string>& captions = BufferPoolStats::get_captions();
+    RecordPrinter printer(captions.size());
+    printer.print_separator(context);
+    printer.print_record(captions, context);
+    printer.print_separator(context);
+    BufferFileStats total;
+    for (auto& entry : buffer_pool_manager_->get_stats()->snapshot()) {
+        printer.print_record(BufferPoolStats::format_row(buffer_pool_manager_->get_file_label(entry.first), entry.second),
+                             context);
+        total.merge(entry.second);
+    }
+    printer.print_record(BufferPoolStats::format_row("total", total), context);
+    printer.print_separator(context);
+}
+
 /**
  * @description: 显示表的元数据
  * @param {string&} tab_name 表名称
@@ -192,13 +273,105 @@ void SmManager::drop_table(const std::string& tab_name, Context* context) {
 }
 
 /**
- * @description: 创建索引
+ * @description: 顺序扫描表中的记录，按索引字段拼接出每条记录的key，和记录的位置一起交给emit。
+ * 扫描使用私有的环形缓冲区，不会把缓冲池中的热点页面换出
+ * @param {vector<ColMeta>&} cols 索引包含的字段
+ */
+void SmManager::scan_index_keys(const std::string& tab_name, const std::vector<ColMeta>& cols,
+                                const std::function<void(const char*, const Rid&)>& emit) {
+    RmFileHandle *fh = fhs_.at(tab_name).get();
+    BufferAccessStrategy strategy;
+    int col_tot_len = 0;
+    for (auto &col : cols) {
+        col_tot_len += col.len;
+    }
+    std::vector<char> key(col_tot_len);
+    // 同一页面上的记录只固定一次页面
+    std::optional<RmPageHandle> page_handle;
+    for (RmScan scan(fh, &strategy); !scan.is_end(); scan.next()) {
+        Rid rid = scan.rid();
+        if (!page_handle || page_handle->page->get_page_id().page_no != rid.page_no) {
+            if (page_handle) {
+                buffer_pool_manager_->unpin_page(page_handle->page->get_page_id(), false);
+            }
+            page_handle.emplace(fh->fetch_page_handle(rid.page_no, &strategy));
+        }
+        char *record = page_handle->get_slot(rid.slot_no);
+        int offset = 0;
+        for (auto &col : cols) {
+            memcpy(key.data() + offset, record + col.offset, col.len);
+            offset += col.len;
+        }
+        emit(key.data(), rid);
+    }
+    if (page_handle) {
+        buffer_pool_manager_->unpin_page(page_handle->page->get_page_id(), false);
+    }
+}
+
+/**
+ * @description: 创建索引。B+树索引对(key, rid)进行外部排序后自底向上批量构建，不逐条调用insert_entry；
+ * 哈希索引没有顺序，扫描时直接逐条插入。索引中的key唯一，表中已有重复的key时不创建索引，抛出IndexEntryExistsError
  * @param {string&} tab_name 表的名称
  * @param {vector<string>&} col_names 索引包含的字段名称
  * @param {Context*} context
+ * @param {IndexType} type 索引的存储结构
  */
-void SmManager::create_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context) {
-    
+void SmManager::create_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context,
+                             IndexType type) {
+    TabMeta &tab = db_.get_table(tab_name);
+    if (tab.is_index(col_names)) {
+        throw IndexExistsError(tab_name, col_names);
+    }
+    std::vector<ColMeta> cols;
+    int col_tot_len = 0;
+    for (auto &col_name : col_names) {
+        cols.push_back(*tab.get_col(col_name));
+        cols.back().index = true;
+        col_tot_len += cols.back().len;
+    }
+    std::string ix_name = ix_manager_->get_index_name(tab_name, cols);
+    if (type == INDEX_HASH) {
+        ix_manager_->create_hash_index(tab_name, cols);
+        auto ih = ix_manager_->open_hash_index(tab_name, cols);
+        try {
+            scan_index_keys(tab_name, cols,
+                            [&](const char *key, const Rid &rid) { ih->insert_entry(key, rid, nullptr); });
+        } catch (RMDBError &) {
+            ix_manager_->close_hash_index(ih.get());
+            ix_manager_->destroy_index(tab_name, cols);
+            throw;
+        }
+        hash_ihs_.emplace(ix_name, std::move(ih));
+    } else {
+        ix_manager_->create_index(tab_name, cols);
+        auto ih = ix_manager_->open_index(tab_name, cols);
+        std::vector<ColType> col_types;
+        std::vector<int> col_lens;
+        for (auto &col : cols) {
+            col_types.push_back(col.type);
+            col_lens.push_back(col.len);
+        }
+        try {
+            IxExternalSorter sorter(col_types, col_lens, ix_name);
+            scan_index_keys(tab_name, cols, [&](const char *key, const Rid &rid) { sorter.add(key, rid); });
+            sorter.finish();
+            ih->bulk_load(&sorter);
+        } catch (RMDBError &) {
+            // 表中已有重复的key等原因导致构建失败时删除建了一半的索引文件
+            ix_manager_->close_index(ih.get());
+            ix_manager_->destroy_index(tab_name, cols);
+            throw;
+        }
+        ihs_.emplace(ix_name, std::move(ih));
+    }
+
+    for (auto &col_name : col_names) {
+        tab.get_col(col_name)->index = true;
+    }
+    tab.indexes.push_back(IndexMeta{.tab_name = tab_name, .col_tot_len = col_tot_len,
+                                    .col_num = static_cast<int>(cols.size()), .cols = cols, .type = type});
+    flush_meta();
 }
 
 /**
@@ -208,7 +381,33 @@ void SmManager::create_index(const std::string& tab_name, const std::vector<std:
  * @param {Context*} context
  */
 void SmManager::drop_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context) {
-    
+    TabMeta &tab = db_.get_table(tab_name);
+    if (!tab.is_index(col_names)) {
+        throw IndexNotFoundError(tab_name, col_names);
+    }
+    std::string ix_name = ix_manager_->get_index_name(tab_name, col_names);
+    auto it = ihs_.find(ix_name);
+    if (it != ihs_.end()) {
+        ix_manager_->close_index(it->second.get());
+        ihs_.erase(it);
+    }
+    auto hash_it = hash_ihs_.find(ix_name);
+    if (hash_it != hash_ihs_.end()) {
+        ix_manager_->close_hash_index(hash_it->second.get());
+        hash_ihs_.erase(hash_it);
+    }
+    ix_manager_->destroy_index(tab_name, col_names);
+    tab.indexes.erase(tab.get_index_meta(col_names));
+    // 字段不再被任何索引包含时清除其索引标记
+    for (auto &col : tab.cols) {
+        col.index = false;
+        for (auto &index : tab.indexes) {
+            for (auto &index_col : index.cols) {
+                if (index_col.name == col.name) col.index = true;
+            }
+        }
+    }
+    flush_meta();
 }
 
 /**
@@ -218,5 +417,9 @@ void SmManager::drop_index(const std::string& tab_name, const std::vector<std::s
  * @param {Context*} context
  */
 void SmManager::drop_index(const std::string& tab_name, const std::vector<ColMeta>& cols, Context* context) {
-    
+    std::vector<std::string> col_names;
+    for (auto &col : cols) {
+        col_names.push_back(col.name);
+    }
+    drop_index(tab_name, col_names, context);
 }
\ No newline at end of file
@@ -10,6 +10,8 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <functional>
+
 #include "index/ix.h"
 #include "record/rm_file_handle.h"
 #include "sm_defs.h"
@@ -29,7 +31,8 @@ class SmManager {
    public:
     DbMeta db_;             // 当前打开的数据库的元数据
     std::unordered_map<std::string, std::unique_ptr<RmFileHandle>> fhs_;    // file name -> record file handle, 当前数据库中每张表的数据文件
-    std::unordered_map<std::string, std::unique_ptr<IxIndexHandle>> ihs_;   // file name -> index file handle, 当前数据库中每个索引的文件
+    std::unordered_map<std::string, std::unique_ptr<IxIndexHandle>> ihs_;   // file name -> index file handle, 当前数据库中每个B+树索引的文件
+    std::unordered_map<std::string, std::unique_ptr<IxHashIndexHandle>> hash_ihs_;  // file name -> 哈希索引的文件
    private:
     DiskManager* disk_manager_;
     BufferPoolManager* buffer_pool_manager_;
@@ -56,6 +59,8 @@ class SmManager {
 
     void create_db(const std::string& db_name);
 
+    static int get_db_page_size(const std::string& db_name, int default_page_size);
+
     void drop_db(const std::string& db_name);
 
     void open_db(const std::string& db_name);
@@ -66,15 +71,22 @@ class SmManager {
 
     void show_tables(Context* context);
 
+    void show_buffer_stats(Context* context);
+
     void desc_table(const std::string& tab_name, Context* context);
 
     void create_table(const std::string& tab_name, const std::vector<ColDef>& col_defs, Context* context);
 
     void drop_table(const std::string& tab_name, Context* context);
 
-    void create_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context);
+    void create_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context,
+                      IndexType type = INDEX_BTREE);
 
     void drop_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context);
     
     void drop_index(const std::string& tab_name, const std::vector<ColMeta>& col_names, Context* context);
+
+   private:
+    void scan_index_keys(const std::string& tab_name, const std::vector<ColMeta>& cols,
+                         const std::function<void(const char*, const Rid&)>& emit);
 };
\ No newline at end of file
@@ -45,9 +45,10 @@ struct IndexMeta {
     int col_tot_len;                // 索引字段长度总和
     int col_num;                    // 索引字段数量
     std::vector<ColMeta> cols;      // 索引包含的字段
+    IndexType type = INDEX_BTREE;   // 索引的存储结构
 
     friend std::ostream &operator<<(std::ostream &os, const IndexMeta &index) {
-        os << index.tab_name << " " << index.col_tot_len << " " << index.col_num;
+        os << index.tab_name << " using " << indextype2str(index.type) << " " << index.col_tot_len << " " << index.col_num;
         for(auto& col: index.cols) {
             os << "\n" << col;
         }
@@ -55,7 +56,17 @@ struct IndexMeta {
     }
 
     friend std::istream &operator>>(std::istream &is, IndexMeta &index) {
-        is >> index.tab_name >> index.col_tot_len >> index.col_num;
+        std::string token;
+        is >> index.tab_name >> token;
+        // 没有记录存储结构的db.meta中只有B+树索引
+        if (token == "using") {
+            is >> token >> index.col_tot_len;
+            index.type = token == indextype2str(INDEX_HASH) ? INDEX_HASH : INDEX_BTREE;
+        } else {
+            index.type = INDEX_BTREE;
+            index.col_tot_len = std::stoi(token);
+        }
+        is >> index.col_num;
         for(int i = 0; i < index.col_num; ++i) {
             ColMeta col;
             is >> col;
@@ -161,11 +172,14 @@ class DbMeta {
 
    private:
     std::string name_;                      // 数据库名称
+    int page_size_ = PAGE_SIZE;             // 数据库的页面大小，创建数据库时确定，之后不能修改
     std::map<std::string, TabMeta> tabs_;   // 数据库中包含的表
 
    public:
     // DbMeta(std::string name) : name_(name) {}
 
+    int get_page_size() const { return page_size_; }
+
     /* 判断数据库中是否存在指定名称的表 */
     bool is_table(const std::string &tab_name) const { return tabs_.find(tab_name) != tabs_.end(); }
 
@@ -185,7 +199,7 @@ class DbMeta {
 
     // 重载操作符 <<
     friend std::ostream &operator<<(std::ostream &os, const DbMeta &db_meta) {
-        os << db_meta.name_ << '\n' << db_meta.tabs_.size() << '\n';
+        os << db_meta.name_ << '\n' << "page_size " << db_meta.page_size_ << '\n' << db_meta.tabs_.size() << '\n';
         for (auto &entry : db_meta.tabs_) {
             os << entry.second << '\n';
         }
@@ -194,7 +208,15 @@ class DbMeta {
 
     friend std::istream &operator>>(std::istream &is, DbMeta &db_meta) {
         size_t n;
-        is >> db_meta.name_ >> n;
+        std::string token;
+        is >> db_meta.name_ >> token;
+        // 没有记录页面大小的db.meta是按默认的PAGE_SIZE创建的
+        if (token == "page_size") {
+            is >> db_meta.page_size_ >> n;
+        } else {
+            db_meta.page_size_ = PAGE_SIZE;
+            n = std::stoul(token);
+        }
         for (size_t i = 0; i < n; i++) {
             TabMeta tab;
             is >> tab;
@@ -0,0 +1,335 @@
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "execution/execution_sort.h"
+#include "execution/executor_delete.h"
+#include "execution/executor_index_scan.h"
+#include "execution/executor_insert.h"
+#include "execution/executor_nestedloop_join.h"
+#include "execution/executor_projection.h"
+#include "execution/executor_seq_scan.h"
+#include "execution/executor_update.h"
+
+const std::string TEST_DB_NAME = "ExecutorTest_db";
+
+class ExecutorTests : public ::testing::Test {
+   public:
+    std::unique_ptr<DiskManager> disk_manager_;
+    std::unique_ptr<BufferPoolManager> buffer_pool_manager_;
+    std::unique_ptr<IxManager> ix_manager_;
+    std::unique_ptr<RmManager> rm_manager_;
+    std::unique_ptr<SmManager> sm_manager_;
+    std::unique_ptr<Transaction> txn_;
+    std::unique_ptr<Context> context_;
+
+    void SetUp() override {
+        ::testing::Test::SetUp();
+        disk_manager_ = std::make_unique<DiskManager>();
+        buffer_pool_manager_ = std::make_unique<BufferPoolManager>(1000, disk_manager_.get());
+        ix_manager_ = std::make_unique<IxManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        rm_manager_ = std::make_unique<RmManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        sm_manager_ = std::make_unique<SmManager>(disk_manager_.get(), buffer_pool_manager_.get(), rm_manager_.get(),
+                                                  ix_manager_.get());
+        if (disk_manager_->is_dir(TEST_DB_NAME)) {
+            std::string cmd = "rm -rf " + TEST_DB_NAME;
+            if (system(cmd.c_str()) < 0) {
+                throw UnixError();
+            }
+        }
+        sm_manager_->create_db(TEST_DB_NAME);
+        sm_manager_->open_db(TEST_DB_NAME);
+        txn_ = std::make_unique<Transaction>(1);
+        context_ = std::make_unique<Context>(nullptr, nullptr, txn_.get());
+
+        // t(id, v, name)：id上建B+树索引，v上建哈希索引，两列的取值都不重复
+        sm_manager_->create_table("t", {{"id", TYPE_INT, 4}, {"v", TYPE_INT, 4}, {"name", TYPE_STRING, 8}}, nullptr);
+        for (int i = 0; i < 3000; i++) {
+            insert("t", i, (i * 7) % 3000, "n" + std::to_string(i % 13));
+        }
+        sm_manager_->create_index("t", {"id"}, nullptr);
+        sm_manager_->create_index("t", {"v"}, nullptr, INDEX_HASH);
+        // s(k, w)：k有重复，没有索引
+        sm_manager_->create_table("s", {{"k", TYPE_INT, 4}, {"w", TYPE_INT, 4}}, nullptr);
+        for (int i = 0; i < 500; i++) {
+            char rec[8];
+            int k = (i * 11) % 400, w = i;
+            memcpy(rec, &k, 4);
+            memcpy(rec + 4, &w, 4);
+            sm_manager_->fhs_.at("s")->insert_record(rec, nullptr);
+        }
+    }
+
+    void TearDown() override {
+        sm_manager_->close_db();
+    }
+
+    void insert(const std::string &tab_name, int id, int v, const std::string &name) {
+        std::vector<Value> values(3);
+        values[0].set_int(id);
+        values[1].set_int(v);
+        values[2].set_str(name);
+        InsertExecutor(sm_manager_.get(), tab_name, values, context_.get()).Next();
+    }
+
+    static Condition value_cond(const std::string &tab_name, const std::string &col_name, CompOp op, int val) {
+        Condition cond;
+        cond.lhs_col = {tab_name, col_name};
+        cond.op = op;
+        cond.is_rhs_val = true;
+        cond.rhs_val.set_int(val);
+        cond.rhs_val.init_raw(sizeof(int));
+        return cond;
+    }
+
+    static Condition col_cond(const std::string &lhs_tab, const std::string &lhs_col, CompOp op,
+                              const std::string &rhs_tab, const std::string &rhs_col) {
+        Condition cond;
+        cond.lhs_col = {lhs_tab, lhs_col};
+        cond.op = op;
+        cond.is_rhs_val = false;
+        cond.rhs_col = {rhs_tab, rhs_col};
+        return cond;
+    }
+
+    std::unique_ptr<AbstractExecutor> seq_scan(const std::string &tab_name, std::vector<Condition> conds = {}) {
+        return std::make_unique<SeqScanExecutor>(sm_manager_.get(), tab_name, std::move(conds), context_.get());
+    }
+
+    // 逐条读出exec的所有元组
+    static std::vector<std::string> read_tuples(AbstractExecutor *exec) {
+        std::vector<std::string> tuples;
+        for (exec->beginTuple(); !exec->is_end(); exec->nextTuple()) {
+            auto rec = exec->Next();
+            tuples.emplace_back(rec->data, exec->tupleLen());
+        }
+        return tuples;
+    }
+
+    // 按每批最多capacity条元组读出exec的所有元组
+    static std::vector<std::string> read_batches(AbstractExecutor *exec, size_t capacity) {
+        std::vector<std::string> tuples;
+        TupleBatch batch(capacity);
+        exec->beginTuple();
+        while (exec->NextBatch(&batch)) {
+            EXPECT_LE(batch.size(), capacity);
+            for (size_t i = 0; i < batch.size(); i++) {
+                tuples.emplace_back(batch.get(i), exec->tupleLen());
+            }
+        }
+        return tuples;
+    }
+
+    // 逐条读取和按不同大小的批读取得到的元组及其顺序都相同，重新beginTuple()后结果不变
+    static void check_batches(AbstractExecutor *exec, size_t expected_size) {
+        auto expected = read_tuples(exec);
+        EXPECT_EQ(expected.size(), expected_size);
+        for (size_t capacity : {size_t{1}, size_t{7}, size_t{BATCH_SIZE}}) {
+            EXPECT_EQ(read_batches(exec, capacity), expected) << exec->getType() << " capacity " << capacity;
+        }
+        EXPECT_EQ(read_tuples(exec), expected) << exec->getType();
+    }
+
+    // 在表tab_name的索引index_cols上查找一个int key
+    bool index_lookup(const std::string &tab_name, const std::vector<std::string> &index_cols, int key, Rid *rid) {
+        auto &index = *sm_manager_->db_.get_table(tab_name).get_index_meta(index_cols);
+        return AbstractExecutor::lookup_index_key(sm_manager_.get(), tab_name, index, reinterpret_cast<char *>(&key),
+                                                  rid, txn_.get());
+    }
+
+    size_t count_rows(const std::string &tab_name) { return read_tuples(seq_scan(tab_name).get()).size(); }
+
+    // 读出rid处记录的一个int字段
+    int read_int(const std::string &tab_name, const Rid &rid, const std::string &col_name) {
+        auto rec = sm_manager_->fhs_.at(tab_name)->get_record(rid, context_.get());
+        int val;
+        memcpy(&val, rec->data + sm_manager_->db_.get_table(tab_name).get_col(col_name)->offset, sizeof(int));
+        return val;
+    }
+};
+
+/**
+ * @brief 扫描算子逐条读取和按批读取的结果相同
+ */
+TEST_F(ExecutorTests, ScanNextBatchMatchesNext) {
+    check_batches(seq_scan("t").get(), 3000);
+    check_batches(seq_scan("t", {value_cond("t", "v", OP_LT, 1000)}).get(), 1000);
+    check_batches(seq_scan("t", {value_cond("t", "id", OP_GT, 5000)}).get(), 0);
+
+    std::vector<Condition> range = {value_cond("t", "id", OP_GE, 100), value_cond("t", "id", OP_LT, 2500),
+                                    value_cond("t", "v", OP_NE, 707)};
+    IndexScanExecutor index_scan(sm_manager_.get(), "t", range, {"id"}, false, context_.get());
+    check_batches(&index_scan, 2399);
+    IndexScanExecutor index_only_scan(sm_manager_.get(), "t", {range[0], range[1]}, {"id"}, true, context_.get());
+    check_batches(&index_only_scan, 2400);
+    IndexScanExecutor hash_scan(sm_manager_.get(), "t", {value_cond("t", "v", OP_EQ, 707)}, {"v"}, false,
+                                context_.get());
+    check_batches(&hash_scan, 1);
+}
+
+/**
+ * @brief 顺序扫描按批读取时每个页面只固定一次。只有两次固定和页数无关：构造RmScan时定位第一条记录，
+ * beginTuple停在第一条满足条件的记录上后第一次NextBatch重新读取它所在的页面
+ */
+TEST_F(ExecutorTests, SeqScanBatchFetchesEachPageOnce) {
+    RmFileHandle *fh = sm_manager_->fhs_.at("t").get();
+    int num_record_pages = fh->get_file_hdr().num_pages - RM_FIRST_RECORD_PAGE;
+    auto fetches = [&]() {
+        auto stats = buffer_pool_manager_->get_stats()->snapshot();
+        auto it = stats.find(fh->GetFd());
+        return it == stats.end() ? uint64_t{0} : it->second.hits + it->second.misses;
+    };
+
+    for (auto conds : {std::vector<Condition>{}, std::vector<Condition>{value_cond("t", "v", OP_LT, 10)}}) {
+        auto scan = seq_scan("t", conds);
+        // 批的容量大于表中的记录数，扫描不会停在页面中间
+        TupleBatch batch(4096);
+        uint64_t before = fetches();
+        scan->beginTuple();
+        size_t rows = 0;
+        while (scan->NextBatch(&batch)) rows += batch.size();
+        EXPECT_EQ(rows, conds.empty() ? 3000u : 10u);
+        EXPECT_EQ(fetches() - before, static_cast<uint64_t>(num_record_pages + 2));
+    }
+}
+
+/**
+ * @brief 投影、连接和排序算子逐条读取和按批读取的结果相同
+ */
+TEST_F(ExecutorTests, OperatorNextBatchMatchesNext) {
+    ProjectionExecutor projection(seq_scan("t", {value_cond("t", "id", OP_LT, 2000)}),
+                                  {{"t", "name"}, {"t", "id"}});
+    check_batches(&projection, 2000);
+
+    // 右侧需要按左侧的每批元组重新扫描
+    NestedLoopJoinExecutor join(seq_scan("t", {value_cond("t", "id", OP_LT, 400)}), seq_scan("s"),
+                                {col_cond("t", "id", OP_EQ, "s", "k")});
+    check_batches(&join, 500);
+
+    SortExecutor sort(seq_scan("s"), {"s", "k"}, true);
+    auto sorted = read_tuples(&sort);
+    for (size_t i = 1; i < sorted.size(); i++) {
+        EXPECT_GE(*reinterpret_cast<const int *>(sorted[i - 1].data()), *reinterpret_cast<const int *>(sorted[i].data()));
+    }
+    check_batches(&sort, 500);
+}
+
+/**
+ * @brief 插入已经存在的key时报错，表和索引都不变
+ */
+TEST_F(ExecutorTests, InsertRejectsExistingKey) {
+    EXPECT_THROW(insert("t", 5, 100000, "dup"), IndexEntryExistsError);
+    EXPECT_THROW(insert("t", 100000, 35, "dup"), IndexEntryExistsError);
+    EXPECT_EQ(count_rows("t"), 3000);
+    Rid rid;
+    EXPECT_FALSE(index_lookup("t", {"v"}, 100000, &rid));
+    EXPECT_FALSE(index_lookup("t", {"id"}, 100000, &rid));
+
+    insert("t", 100000, 100000, "new");
+    EXPECT_EQ(count_rows("t"), 3001);
+    ASSERT_TRUE(index_lookup("t", {"id"}, 100000, &rid));
+    Rid hash_rid;
+    ASSERT_TRUE(index_lookup("t", {"v"}, 100000, &hash_rid));
+    EXPECT_EQ(rid, hash_rid);
+}
+
+/**
+ * @brief 修改索引字段时索引项随之移动；新key属于别的记录或多条记录被改成同一个key时报错，记录和索引都保持原样
+ */
+TEST_F(ExecutorTests, UpdateMovesIndexEntries) {
+    auto rids_of = [&](std::vector<Condition> conds) {
+        std::vector<Rid> rids;
+        auto scan = seq_scan("t", std::move(conds));
+        for (scan->beginTuple(); !scan->is_end(); scan->nextTuple()) {
+            rids.push_back(scan->rid());
+        }
+        return rids;
+    };
+    auto set_clause = [](const std::string &col_name, int val) {
+        SetClause clause;
+        clause.lhs = {"t", col_name};
+        clause.rhs.set_int(val);
+        return clause;
+    };
+
+    Rid rid, owner;
+    ASSERT_TRUE(index_lookup("t", {"id"}, 10, &rid));
+    std::vector<Condition> where = {value_cond("t", "id", OP_EQ, 10)};
+    // v = 7 * 20属于id为20的记录
+    UpdateExecutor conflict(sm_manager_.get(), "t", {set_clause("id", 20000), set_clause("v", 140)}, where,
+                            rids_of(where), context_.get());
+    EXPECT_THROW(conflict.Next(), IndexEntryExistsError);
+    EXPECT_EQ(read_int("t", rid, "id"), 10);
+    EXPECT_EQ(read_int("t", rid, "v"), 70);
+    ASSERT_TRUE(index_lookup("t", {"id"}, 10, &owner));
+    EXPECT_EQ(owner, rid);
+    EXPECT_FALSE(index_lookup("t", {"id"}, 20000, &owner));
+    ASSERT_TRUE(index_lookup("t", {"v"}, 70, &owner));
+    EXPECT_EQ(owner, rid);
+
+    // 两条记录被设成同一个新key：第二条会和第一条冲突，整条语句被拒绝，两条记录都不变
+    std::vector<Condition> two_rows = {value_cond("t", "id", OP_GE, 30), value_cond("t", "id", OP_LT, 32)};
+    UpdateExecutor same_new_key(sm_manager_.get(), "t", {set_clause("v", 500000)}, two_rows, rids_of(two_rows),
+                                context_.get());
+    EXPECT_THROW(same_new_key.Next(), IndexEntryExistsError);
+    for (int id : {30, 31}) {
+        Rid row;
+        ASSERT_TRUE(index_lookup("t", {"id"}, id, &row));
+        EXPECT_EQ(read_int("t", row, "v"), id * 7);
+        ASSERT_TRUE(index_lookup("t", {"v"}, id * 7, &owner));
+        EXPECT_EQ(owner, row);
+    }
+    EXPECT_FALSE(index_lookup("t", {"v"}, 500000, &owner));
+
+    // 只修改非索引字段和key不变的索引字段
+    UpdateExecutor same_key(sm_manager_.get(), "t", {set_clause("v", 70)}, where, rids_of(where), context_.get());
+    same_key.Next();
+    ASSERT_TRUE(index_lookup("t", {"v"}, 70, &owner));
+    EXPECT_EQ(owner, rid);
+
+    UpdateExecutor move(sm_manager_.get(), "t", {set_clause("id", 20000), set_clause("v", 20000)}, where,
+                        rids_of(where), context_.get());
+    move.Next();
+    EXPECT_EQ(read_int("t", rid, "id"), 20000);
+    EXPECT_FALSE(index_lookup("t", {"id"}, 10, &owner));
+    EXPECT_FALSE(index_lookup("t", {"v"}, 70, &owner));
+    ASSERT_TRUE(index_lookup("t", {"id"}, 20000, &owner));
+    EXPECT_EQ(owner, rid);
+    ASSERT_TRUE(index_lookup("t", {"v"}, 20000, &owner));
+    EXPECT_EQ(owner, rid);
+    EXPECT_EQ(count_rows("t"), 3000);
+}
+
+/**
+ * @brief 删除记录时只删除指向这条记录的索引项
+ */
+TEST_F(ExecutorTests, DeleteRemovesOwnIndexEntries) {
+    std::vector<Condition> where = {value_cond("t", "id", OP_LT, 100)};
+    std::vector<Rid> rids;
+    auto scan = seq_scan("t", where);
+    for (scan->beginTuple(); !scan->is_end(); scan->nextTuple()) {
+        rids.push_back(scan->rid());
+    }
+    ASSERT_EQ(rids.size(), 100);
+    DeleteExecutor(sm_manager_.get(), "t", where, rids, context_.get()).Next();
+    EXPECT_EQ(count_rows("t"), 2900);
+    Rid owner;
+    for (int id = 0; id < 100; id++) {
+        EXPECT_FALSE(index_lookup("t", {"id"}, id, &owner));
+        EXPECT_FALSE(index_lookup("t", {"v"}, (id * 7) % 3000, &owner));
+    }
+    ASSERT_TRUE(index_lookup("t", {"id"}, 100, &owner));
+
+    // 绕过索引直接写入一条和id为100的记录key相同的记录，删除它不影响索引中id为100的记录
+    Rid id100 = owner;
+    char rec[16] = {0};
+    int id = 100, v = 100000;
+    memcpy(rec, &id, 4);
+    memcpy(rec + 4, &v, 4);
+    Rid stray = sm_manager_->fhs_.at("t")->insert_record(rec, nullptr);
+    DeleteExecutor(sm_manager_.get(), "t", {}, {stray}, context_.get()).Next();
+    ASSERT_TRUE(index_lookup("t", {"id"}, 100, &owner));
+    EXPECT_EQ(owner, id100);
+    EXPECT_EQ(count_rows("t"), 2900);
+}
@@ -0,0 +1,301 @@
+#include <dirent.h>
+
+#include <functional>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "execution/execution_sort.h"
+#include "execution/executor_hash_join.h"
+#include "execution/executor_index_nestedloop_join.h"
+#include "execution/executor_merge_join.h"
+#include "execution/executor_nestedloop_join.h"
+#include "execution/executor_seq_scan.h"
+
+const std::string TEST_DB_NAME = "JoinExecutorTest_db";
+
+class JoinExecutorTests : public ::testing::Test {
+   public:
+    std::unique_ptr<DiskManager> disk_manager_;
+    std::unique_ptr<BufferPoolManager> buffer_pool_manager_;
+    std::unique_ptr<IxManager> ix_manager_;
+    std::unique_ptr<RmManager> rm_manager_;
+    std::unique_ptr<SmManager> sm_manager_;
+    std::unique_ptr<Transaction> txn_;
+    std::unique_ptr<Context> context_;
+
+    void SetUp() override {
+        ::testing::Test::SetUp();
+        disk_manager_ = std::make_unique<DiskManager>();
+        buffer_pool_manager_ = std::make_unique<BufferPoolManager>(1000, disk_manager_.get());
+        ix_manager_ = std::make_unique<IxManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        rm_manager_ = std::make_unique<RmManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        sm_manager_ = std::make_unique<SmManager>(disk_manager_.get(), buffer_pool_manager_.get(), rm_manager_.get(),
+                                                  ix_manager_.get());
+        if (disk_manager_->is_dir(TEST_DB_NAME)) {
+            std::string cmd = "rm -rf " + TEST_DB_NAME;
+            if (system(cmd.c_str()) < 0) {
+                throw UnixError();
+            }
+        }
+        sm_manager_->create_db(TEST_DB_NAME);
+        sm_manager_->open_db(TEST_DB_NAME);
+        txn_ = std::make_unique<Transaction>(1);
+        context_ = std::make_unique<Context>(nullptr, nullptr, txn_.get());
+
+        // a(k, f, v, pad)和b(k, f, w)：k两侧都有重复，b中k = 42的元组特别多；f中有-0.0和0.0
+        sm_manager_->create_table("a", {{"k", TYPE_INT, 4}, {"f", TYPE_FLOAT, 4}, {"v", TYPE_INT, 4},
+                                        {"pad", TYPE_STRING, 20}}, nullptr);
+        sm_manager_->create_table("b", {{"k", TYPE_INT, 4}, {"f", TYPE_FLOAT, 4}, {"w", TYPE_INT, 4}}, nullptr);
+        for (int i = 0; i < 3000; i++) {
+            insert("a", {i % 700, 0, (i * 7919) % 3000}, i % 3 == 0 ? -0.0f : float(i % 5));
+        }
+        for (int i = 0; i < 1500; i++) {
+            insert("b", {i % 10 == 0 ? 42 : (i * 7) % 1000, 0, (i * 13) % 1500 * 2}, i % 4 == 0 ? 0.0f : float(i % 5));
+        }
+    }
+
+    void TearDown() override {
+        sm_manager_->close_db();
+    }
+
+    // 向数据文件写入一条记录：vals依次为各个int字段的值，第2个字段为float字段f
+    void insert(const std::string &tab_name, std::vector<int> vals, float f) {
+        std::vector<char> rec(sm_manager_->fhs_.at(tab_name)->get_file_hdr().record_size, 0);
+        memcpy(rec.data(), vals.data(), vals.size() * sizeof(int));
+        memcpy(rec.data() + sizeof(int), &f, sizeof(float));
+        sm_manager_->fhs_.at(tab_name)->insert_record(rec.data(), nullptr);
+    }
+
+    static Condition value_cond(const std::string &tab_name, const std::string &col_name, CompOp op, int val) {
+        Condition cond;
+        cond.lhs_col = {tab_name, col_name};
+        cond.op = op;
+        cond.is_rhs_val = true;
+        cond.rhs_val.set_int(val);
+        cond.rhs_val.init_raw(sizeof(int));
+        return cond;
+    }
+
+    static Condition col_cond(const std::string &lhs_tab, const std::string &lhs_col, CompOp op,
+                              const std::string &rhs_tab, const std::string &rhs_col) {
+        Condition cond;
+        cond.lhs_col = {lhs_tab, lhs_col};
+        cond.op = op;
+        cond.is_rhs_val = false;
+        cond.rhs_col = {rhs_tab, rhs_col};
+        return cond;
+    }
+
+    std::unique_ptr<AbstractExecutor> seq_scan(const std::string &tab_name, std::vector<Condition> conds = {}) {
+        return std::make_unique<SeqScanExecutor>(sm_manager_.get(), tab_name, std::move(conds), context_.get());
+    }
+
+    // 按每批最多capacity条元组读出exec的所有元组，capacity为0时逐条读取
+    static std::multiset<std::string> read_tuples(AbstractExecutor *exec, size_t capacity) {
+        std::multiset<std::string> tuples;
+        exec->beginTuple();
+        if (capacity == 0) {
+            for (; !exec->is_end(); exec->nextTuple()) {
+                auto rec = exec->Next();
+                tuples.emplace(rec->data, exec->tupleLen());
+            }
+            return tuples;
+        }
+        TupleBatch batch(capacity);
+        while (exec->NextBatch(&batch)) {
+            for (size_t i = 0; i < batch.size(); i++) {
+                tuples.emplace(batch.get(i), exec->tupleLen());
+            }
+        }
+        return tuples;
+    }
+
+    // 两个表所有元组的笛卡尔积中满足pred的组合
+    std::multiset<std::string> reference_join(const std::string &left, const std::string &right,
+                                              const std::function<bool(const char *, const char *)> &pred) {
+        auto left_rows = read_tuples(seq_scan(left).get(), 0);
+        auto right_rows = read_tuples(seq_scan(right).get(), 0);
+        std::multiset<std::string> tuples;
+        for (auto &l : left_rows) {
+            for (auto &r : right_rows) {
+                if (pred(l.data(), r.data())) {
+                    tuples.insert(l + r);
+                }
+            }
+        }
+        return tuples;
+    }
+
+    static int int_at(const char *row, int offset) { return *reinterpret_cast<const int *>(row + offset); }
+
+    static float float_at(const char *row, int offset) { return *reinterpret_cast<const float *>(row + offset); }
+
+    // 当前目录下哈希连接的分区文件数
+    static size_t count_spill_files() {
+        size_t count = 0;
+        DIR *dir = opendir(".");
+        for (dirent *entry = readdir(dir); entry != nullptr; entry = readdir(dir)) {
+            count += std::string(entry->d_name).rfind("hash_join", 0) == 0;
+        }
+        closedir(dir);
+        return count;
+    }
+};
+
+/**
+ * @brief 内存预算很小时哈希连接把两侧分区写入文件，结果与预算足够时相同，读完和析构后分区文件都被删除
+ */
+TEST_F(JoinExecutorTests, HashJoinSpill) {
+    auto expected = reference_join("a", "b", [](const char *l, const char *r) {
+        return int_at(l, 0) == int_at(r, 0) && float_at(l, 4) == float_at(r, 4);
+    });
+    ASSERT_GT(expected.size(), 0);
+    std::vector<Condition> conds = {col_cond("a", "k", OP_EQ, "b", "k"), col_cond("b", "f", OP_EQ, "a", "f")};
+    for (size_t budget : {HASH_JOIN_MEMORY, size_t{20000}, size_t{100}}) {
+        HashJoinExecutor join(seq_scan("a"), seq_scan("b"), conds, budget);
+        for (size_t capacity : {size_t{0}, size_t{7}, size_t{BATCH_SIZE}}) {
+            EXPECT_EQ(read_tuples(&join, capacity), expected) << "budget " << budget << " capacity " << capacity;
+            EXPECT_EQ(count_spill_files(), 0);
+        }
+        if (budget == HASH_JOIN_MEMORY) {
+            EXPECT_EQ(join.num_spill_files(), 0);
+        } else {
+            EXPECT_GT(join.num_spill_files(), 0);
+        }
+    }
+
+    // 没有读完就析构时删除已经创建的分区文件
+    {
+        HashJoinExecutor join(seq_scan("a"), seq_scan("b"), conds, 100);
+        join.beginTuple();
+        ASSERT_FALSE(join.is_end());
+        EXPECT_GT(count_spill_files(), 0);
+    }
+    EXPECT_EQ(count_spill_files(), 0);
+}
+
+/**
+ * @brief 哈希连接的其余条件在连接后的记录上判断，右侧带过滤条件
+ */
+TEST_F(JoinExecutorTests, HashJoinResidualConds) {
+    auto expected = reference_join("a", "b", [](const char *l, const char *r) {
+        return int_at(l, 0) == int_at(r, 0) && int_at(l, 8) < int_at(r, 8) && int_at(r, 0) < 300;
+    });
+    for (size_t budget : {HASH_JOIN_MEMORY, size_t{5000}}) {
+        HashJoinExecutor join(seq_scan("a"), seq_scan("b", {value_cond("b", "k", OP_LT, 300)}),
+                              {col_cond("a", "k", OP_EQ, "b", "k"), col_cond("a", "v", OP_LT, "b", "w")}, budget);
+        EXPECT_EQ(read_tuples(&join, BATCH_SIZE), expected);
+        EXPECT_EQ(read_tuples(&join, 0), expected);
+    }
+}
+
+/**
+ * @brief 块嵌套循环连接：块的大小与批的大小不同时，块在一批的中间结束或者跨越多批，结果都不变
+ */
+TEST_F(JoinExecutorTests, BlockNestedLoopJoinBlockSizes) {
+    auto expected = reference_join("a", "b", [](const char *l, const char *r) {
+        return int_at(l, 0) < int_at(r, 0) && int_at(r, 0) < 30 && float_at(l, 4) == float_at(r, 4);
+    });
+    ASSERT_GT(expected.size(), 0);
+    size_t left_len = seq_scan("a")->tupleLen();
+    for (size_t block : {size_t{1}, left_len * 7, left_len * 1000 + 5, size_t{NESTED_LOOP_BLOCK_MEMORY}}) {
+        NestedLoopJoinExecutor join(seq_scan("a"), seq_scan("b", {value_cond("b", "k", OP_LT, 30)}),
+                                    {col_cond("a", "k", OP_LT, "b", "k"), col_cond("a", "f", OP_EQ, "b", "f")},
+                                    block);
+        for (size_t capacity : {size_t{0}, size_t{1}, size_t{13}, size_t{BATCH_SIZE}}) {
+            EXPECT_EQ(read_tuples(&join, capacity), expected) << "block " << block << " capacity " << capacity;
+        }
+    }
+}
+
+/**
+ * @brief 索引嵌套循环连接：内表索引的字段由连接条件(两种写法)或内表上的常量等值条件确定，
+ * 只确定最左边一部分字段时按范围查找
+ */
+TEST_F(JoinExecutorTests, IndexNestedLoopJoin) {
+    // c(x, y)：x上建哈希索引，(y, x)上建B+树索引；b的w上建B+树索引
+    sm_manager_->create_table("c", {{"x", TYPE_INT, 4}, {"y", TYPE_INT, 4}}, nullptr);
+    for (int i = 0; i < 2000; i++) {
+        std::vector<char> rec(8);
+        int x = i * 3 % 6000, y = i % 50;
+        memcpy(rec.data(), &x, 4);
+        memcpy(rec.data() + 4, &y, 4);
+        sm_manager_->fhs_.at("c")->insert_record(rec.data(), nullptr);
+    }
+    sm_manager_->create_index("c", {"x"}, nullptr, INDEX_HASH);
+    sm_manager_->create_index("c", {"y", "x"}, nullptr);
+    sm_manager_->create_index("b", {"w"}, nullptr);
+
+    struct Case {
+        std::string inner;
+        std::vector<Condition> inner_conds, join_conds;
+        std::vector<std::string> index;
+        std::function<bool(const char *, const char *)> pred;
+    };
+    std::vector<Case> cases = {
+        {"b", {}, {col_cond("a", "v", OP_EQ, "b", "w")}, {"w"},
+         [](const char *l, const char *r) { return int_at(l, 8) == int_at(r, 8); }},
+        // 连接条件的左侧为内表字段，另有连接后判断的条件
+        {"b", {value_cond("b", "k", OP_GT, 100)}, {col_cond("b", "w", OP_EQ, "a", "v"), col_cond("a", "k", OP_LT, "b", "k")},
+         {"w"}, [](const char *l, const char *r) {
+             return int_at(l, 8) == int_at(r, 8) && int_at(r, 0) > 100 && int_at(l, 0) < int_at(r, 0);
+         }},
+        {"c", {}, {col_cond("c", "x", OP_EQ, "a", "v")}, {"x"},
+         [](const char *l, const char *r) { return int_at(l, 8) == int_at(r, 0); }},
+        // 第一个字段由常量确定，第二个字段由连接条件确定
+        {"c", {value_cond("c", "y", OP_EQ, 3)}, {col_cond("a", "v", OP_EQ, "c", "x")}, {"y", "x"},
+         [](const char *l, const char *r) { return int_at(r, 4) == 3 && int_at(l, 8) == int_at(r, 0); }},
+        // 只确定第一个字段，按范围查找；左侧探测key有重复
+        {"c", {}, {col_cond("a", "k", OP_EQ, "c", "y")}, {"y", "x"},
+         [](const char *l, const char *r) { return int_at(l, 0) == int_at(r, 4); }},
+        // 第一个字段由连接条件确定，第二个字段由常量确定
+        {"c", {value_cond("c", "x", OP_EQ, 9)}, {col_cond("c", "y", OP_EQ, "a", "k")}, {"y", "x"},
+         [](const char *l, const char *r) { return int_at(r, 0) == 9 && int_at(l, 0) == int_at(r, 4); }},
+    };
+    for (auto &c : cases) {
+        auto expected = reference_join("a", c.inner, c.pred);
+        ASSERT_GT(expected.size(), 0) << &c - cases.data();
+        IndexNestedLoopJoinExecutor join(sm_manager_.get(), seq_scan("a"), c.inner, c.inner_conds, c.join_conds,
+                                         c.index, context_.get());
+        for (size_t capacity : {size_t{0}, size_t{7}, size_t{BATCH_SIZE}}) {
+            EXPECT_EQ(read_tuples(&join, capacity), expected) << "case " << &c - cases.data() << " capacity " << capacity;
+        }
+    }
+
+    // 哈希索引的字段没有全部确定，或者没有字段来自连接条件时不能用于连接
+    EXPECT_THROW(IndexNestedLoopJoinExecutor(sm_manager_.get(), seq_scan("a"), "c", {value_cond("c", "x", OP_EQ, 9)},
+                                             {col_cond("a", "k", OP_LT, "c", "y")}, {"x"}, context_.get()),
+                 InternalError);
+}
+
+/**
+ * @brief 排序归并连接：两侧的连接key都有很长的重复段，重复段跨越多批时每组仍然完整组合
+ */
+TEST_F(JoinExecutorTests, MergeJoinDuplicateRuns) {
+    auto sorted = [&](const std::string &tab_name, std::vector<Condition> conds = {}) {
+        return std::make_unique<SortExecutor>(seq_scan(tab_name, std::move(conds)), TabCol{tab_name, "k"}, false);
+    };
+    auto expected = reference_join("a", "b", [](const char *l, const char *r) { return int_at(l, 0) == int_at(r, 0); });
+    ASSERT_GT(expected.size(), 0);
+    MergeJoinExecutor join(sorted("a"), sorted("b"), {col_cond("b", "k", OP_EQ, "a", "k")});
+    for (size_t capacity : {size_t{0}, size_t{1}, size_t{7}, size_t{BATCH_SIZE}}) {
+        EXPECT_EQ(read_tuples(&join, capacity), expected) << "capacity " << capacity;
+    }
+
+    // 其余条件在组合后判断；一侧为空时没有结果
+    expected = reference_join("a", "b", [](const char *l, const char *r) {
+        return int_at(l, 0) == int_at(r, 0) && float_at(l, 4) == float_at(r, 4) && int_at(l, 8) < int_at(r, 8);
+    });
+    ASSERT_GT(expected.size(), 0);
+    MergeJoinExecutor residual(sorted("a"), sorted("b"), {col_cond("a", "v", OP_LT, "b", "w"),
+                                                          col_cond("a", "k", OP_EQ, "b", "k"),
+                                                          col_cond("a", "f", OP_EQ, "b", "f")});
+    EXPECT_EQ(read_tuples(&residual, BATCH_SIZE), expected);
+    EXPECT_EQ(read_tuples(&residual, 0), expected);
+    MergeJoinExecutor empty(sorted("a"), sorted("b", {value_cond("b", "k", OP_LT, 0)}),
+                            {col_cond("a", "k", OP_EQ, "b", "k")});
+    EXPECT_TRUE(read_tuples(&empty, BATCH_SIZE).empty());
+}
@@ -69,8 +69,10 @@ class BPlusTreeConcurrentTest : public ::testing::Test {
         sm_->create_table(TEST_FILE_NAME, coldef, nullptr);
         sm_->create_index(TEST_FILE_NAME, TEST_COL, nullptr);
         assert(ix_manager_->exists(TEST_FILE_NAME, TEST_COL));
-        // 打开测试文件
-        ih_ = ix_manager_->open_index(TEST_FILE_NAME, TEST_COL);
+        // 使用SmManager创建索引时打开的索引文件，索引文件不能重复打开
+        std::string ix_name = ix_manager_->get_index_name(TEST_FILE_NAME, TEST_COL);
+        ih_ = std::move(sm_->ihs_.at(ix_name));
+        sm_->ihs_.erase(ix_name);
         assert(ih_ != nullptr);
     }
 
@@ -388,6 +390,7 @@ TEST_F(BPlusTreeConcurrentTest, InsertScaleTest) {
 
     assert(order > 2 && order <= ih_->file_hdr_->btree_order_);
     ih_->file_hdr_->btree_order_ = order;
+    ih_->file_hdr_->internal_order_ = order;
 
     // keys to Insert
     std::vector<int64_t> keys;
@@ -430,6 +433,7 @@ TEST_F(BPlusTreeConcurrentTest, MixScaleTest) {
 
     assert(order > 2 && order <= ih_->file_hdr_->btree_order_);
     ih_->file_hdr_->btree_order_ = order;
+    ih_->file_hdr_->internal_order_ = order;
 
     // keys to Insert
     std::vector<int64_t> keys;
@@ -462,4 +466,56 @@ TEST_F(BPlusTreeConcurrentTest, MixScaleTest) {
         scan.next();
     }
     EXPECT_EQ(size, keys.size() - delete_keys.size());
-}
\ No newline at end of file
+}
+/**
+ * @brief 小阶数下并发插入奇数key、删除预先插入的偶数key并查找，频繁触发分裂、合并和重分配
+ */
+TEST_F(BPlusTreeConcurrentTest, InsertDeleteMixTest) {
+    const int64_t scale = 4000;
+    const int thread_num = 8;
+    const int order = 5;
+
+    assert(order > 2 && order <= ih_->file_hdr_->btree_order_);
+    ih_->file_hdr_->btree_order_ = order;
+    ih_->file_hdr_->internal_order_ = order;
+
+    std::vector<int64_t> even_keys;
+    std::vector<int64_t> odd_keys;
+    for (int64_t key = 1; key <= scale; key++) {
+        (key % 2 == 0 ? even_keys : odd_keys).push_back(key);
+    }
+    auto rng = std::default_random_engine{};
+    std::shuffle(even_keys.begin(), even_keys.end(), rng);
+    std::shuffle(odd_keys.begin(), odd_keys.end(), rng);
+    InsertHelper(ih_.get(), even_keys);
+
+    // 每个线程插入一部分奇数key，同时删除一部分偶数key
+    auto worker = [&](uint64_t thread_itr) {
+        std::vector<int64_t> insert_keys;
+        std::vector<int64_t> delete_keys;
+        for (size_t i = thread_itr; i < odd_keys.size(); i += thread_num) insert_keys.push_back(odd_keys[i]);
+        for (size_t i = thread_itr; i < even_keys.size(); i += thread_num) delete_keys.push_back(even_keys[i]);
+        Transaction transaction(0);
+        std::vector<Rid> rids;
+        for (size_t i = 0; i < insert_keys.size() || i < delete_keys.size(); i++) {
+            if (i < insert_keys.size()) {
+                int64_t key = insert_keys[i];
+                Rid rid = {.page_no = 0, .slot_no = static_cast<int32_t>(key)};
+                ih_->insert_entry((const char *)&key, rid, &transaction);
+                rids.clear();
+                EXPECT_TRUE(ih_->get_value((const char *)&key, &rids, &transaction));
+            }
+            if (i < delete_keys.size()) {
+                int64_t key = delete_keys[i];
+                EXPECT_TRUE(ih_->delete_entry((const char *)&key, &transaction));
+            }
+        }
+    };
+    LaunchParallelTest(thread_num, worker);
+
+    std::multimap<int, Rid> mock;
+    for (auto key : odd_keys) {
+        mock.insert({static_cast<int>(key), Rid{.page_no = 0, .slot_no = static_cast<int32_t>(key)}});
+    }
+    check_all(ih_.get(), mock);
+}
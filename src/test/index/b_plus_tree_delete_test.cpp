@@ -67,8 +67,10 @@ class BPlusTreeTests : public ::testing::Test {
         sm_->create_table(TEST_FILE_NAME, coldef, nullptr);
         sm_->create_index(TEST_FILE_NAME, TEST_COL, nullptr);
         assert(ix_manager_->exists(TEST_FILE_NAME, TEST_COL));
-        // 打开测试文件
-        ih_ = ix_manager_->open_index(TEST_FILE_NAME, TEST_COL);
+        // 使用SmManager创建索引时打开的索引文件，索引文件不能重复打开
+        std::string ix_name = ix_manager_->get_index_name(TEST_FILE_NAME, TEST_COL);
+        ih_ = std::move(sm_->ihs_.at(ix_name));
+        sm_->ihs_.erase(ix_name);
         assert(ih_ != nullptr);
     }
 
@@ -317,6 +319,7 @@ TEST_F(BPlusTreeTests, InsertAndDeleteTest1) {
 
     assert(order > 2 && order <= ih_->file_hdr_->btree_order_);
     ih_->file_hdr_->btree_order_ = order;
+    ih_->file_hdr_->internal_order_ = order;
 
     std::vector<int64_t> keys;
     for (int64_t key = 1; key <= scale; key++) {
@@ -388,6 +391,7 @@ TEST_F(BPlusTreeTests, InsertAndDeleteTest2) {
 
     assert(order > 2 && order <= ih_->file_hdr_->btree_order_);
     ih_->file_hdr_->btree_order_ = order;
+    ih_->file_hdr_->internal_order_ = order;
 
     std::vector<int64_t> keys;
     for (int64_t key = 1; key <= scale; key++) {
@@ -440,6 +444,7 @@ TEST_F(BPlusTreeTests, LargeScaleTest) {
 
     if (order >= 2 && order <= ih_->file_hdr_->btree_order_) {
         ih_->file_hdr_->btree_order_ = order;
+        ih_->file_hdr_->internal_order_ = order;
     }
     int add_cnt = 0;
     int del_cnt = 0;
@@ -6,6 +6,7 @@
 
 #define private public
 #include "index/ix.h"
+#include "index/ix_external_sort.h"
 #undef private  // for use private variables in "ix.h"
 
 #include "storage/buffer_pool_manager.h"
@@ -67,8 +68,10 @@ class BPlusTreeTests : public ::testing::Test {
         sm_->create_table(TEST_FILE_NAME, coldef, nullptr);
         sm_->create_index(TEST_FILE_NAME, TEST_COL, nullptr);
         assert(ix_manager_->exists(TEST_FILE_NAME, TEST_COL));
-        // 打开测试文件
-        ih_ = ix_manager_->open_index(TEST_FILE_NAME, TEST_COL);
+        // 使用SmManager创建索引时打开的索引文件，索引文件不能重复打开
+        std::string ix_name = ix_manager_->get_index_name(TEST_FILE_NAME, TEST_COL);
+        ih_ = std::move(sm_->ihs_.at(ix_name));
+        sm_->ihs_.erase(ix_name);
         assert(ih_ != nullptr);
     }
 
@@ -317,6 +320,7 @@ TEST_F(BPlusTreeTests, InsertTest) {
 
     assert(order > 2 && order <= ih_->file_hdr_->btree_order_);
     ih_->file_hdr_->btree_order_ = order;
+    ih_->file_hdr_->internal_order_ = order;
 
     std::vector<int64_t> keys;
     for (int64_t key = 1; key <= scale; key++) {
@@ -366,6 +370,7 @@ TEST_F(BPlusTreeTests, LargeScaleTest) {
 
     assert(order > 2 && order <= ih_->file_hdr_->btree_order_);
     ih_->file_hdr_->btree_order_ = order;
+    ih_->file_hdr_->internal_order_ = order;
 
     std::vector<int64_t> keys;
     for (int64_t key = 1; key <= scale; key++) {
@@ -412,4 +417,171 @@ TEST_F(BPlusTreeTests, LargeScaleTest) {
         scan.next();
     }
     EXPECT_EQ(current_key, keys.size() + 1);
-}
\ No newline at end of file
+}
+
+/**
+ * @brief 范围扫描：正向、反向、按批读取，以及空范围
+ */
+TEST_F(BPlusTreeTests, RangeScanTest) {
+    const int order = 8;
+    ih_->file_hdr_->btree_order_ = order;
+    ih_->file_hdr_->internal_order_ = order;
+
+    std::vector<int> keys;
+    for (int key = 2; key <= 2000; key += 2) {
+        keys.push_back(key);
+    }
+    std::shuffle(keys.begin(), keys.end(), std::default_random_engine(7));
+    for (int key : keys) {
+        ih_->insert_entry((const char *)&key, Rid{.page_no = 0, .slot_no = key}, txn_.get());
+    }
+
+    int low = 101, high = 1501;
+    Iid lower = ih_->lower_bound((const char *)&low);
+    Iid upper = ih_->upper_bound((const char *)&high);
+    std::vector<int> expected;
+    for (int key = 102; key <= 1500; key += 2) {
+        expected.push_back(key);
+    }
+
+    std::vector<int> forward;
+    for (IxScan scan(ih_.get(), lower, upper, buffer_pool_manager_.get()); !scan.is_end(); scan.next()) {
+        ASSERT_EQ(ih_->get_rid(scan.iid()), scan.rid());
+        forward.push_back(scan.rid().slot_no);
+    }
+    EXPECT_EQ(forward, expected);
+
+    // 反向遍历时同时读出key，key与Rid一一对应
+    std::vector<int> backward;
+    for (IxScan scan(ih_.get(), lower, upper, buffer_pool_manager_.get(), true, true); !scan.is_end(); scan.next()) {
+        ASSERT_EQ(ih_->get_rid(scan.iid()), scan.rid());
+        ASSERT_EQ(*reinterpret_cast<const int *>(scan.key()), scan.rid().slot_no);
+        backward.push_back(scan.rid().slot_no);
+    }
+    std::reverse(expected.begin(), expected.end());
+    EXPECT_EQ(backward, expected);
+
+    // 按批读取整个索引，每批不超过一个叶子
+    std::vector<Rid> batch;
+    size_t num_batches = 0;
+    IxScan batch_scan(ih_.get(), ih_->leaf_begin(), ih_->leaf_end(), buffer_pool_manager_.get(), true);
+    while (size_t n = batch_scan.next_batch(&batch)) {
+        EXPECT_LE(n, static_cast<size_t>(order));
+        num_batches++;
+    }
+    ASSERT_EQ(batch.size(), keys.size());
+    EXPECT_GT(num_batches, keys.size() / order);
+    for (size_t i = 0; i < batch.size(); i++) {
+        EXPECT_EQ(batch[i].slot_no, 2000 - 2 * static_cast<int>(i));
+    }
+
+    int missing = 3001;
+    Iid end = ih_->lower_bound((const char *)&missing);
+    EXPECT_TRUE(IxScan(ih_.get(), end, ih_->upper_bound((const char *)&missing), buffer_pool_manager_.get()).is_end());
+    EXPECT_TRUE(IxScan(ih_.get(), end, end, buffer_pool_manager_.get(), true).is_end());
+}
+
+/**
+ * @brief 向表中插入记录后再创建索引，索引由排序后的键值对批量构建，之后继续插入和删除
+ */
+TEST_F(BPlusTreeTests, BulkLoadTest) {
+    const int scale = 20000;
+    const std::vector<std::string> index_col = {"col2"};
+
+    std::vector<int> keys;
+    for (int key = 1; key <= scale; key++) {
+        keys.push_back(key);
+    }
+    auto rng = std::default_random_engine{};
+    std::shuffle(keys.begin(), keys.end(), rng);
+
+    // col1为插入顺序，col2为打乱的key
+    RmFileHandle *fh = sm_->fhs_.at(TEST_FILE_NAME).get();
+    std::multimap<int, Rid> mock;
+    for (int i = 0; i < scale; i++) {
+        int record[2] = {i, keys[i]};
+        Rid rid = fh->insert_record(reinterpret_cast<char *>(record), nullptr);
+        mock.insert({keys[i], rid});
+    }
+
+    sm_->create_index(TEST_FILE_NAME, index_col, nullptr);
+    ASSERT_TRUE(sm_->db_.get_table(TEST_FILE_NAME).is_index(index_col));
+    IxIndexHandle *ih = sm_->ihs_.at(ix_manager_->get_index_name(TEST_FILE_NAME, index_col)).get();
+    // 叶子层有多个结点，且除了最后一个叶子都按填充因子填充
+    ASSERT_NE(ih->file_hdr_->root_page_, IX_INIT_ROOT_PAGE);
+    check_all(ih, mock);
+
+    // 批量构建的树可以继续插入和删除
+    for (int key = scale + 1; key <= scale + 1000; key++) {
+        Rid rid = {.page_no = key, .slot_no = key};
+        ih->insert_entry(reinterpret_cast<const char *>(&key), rid, txn_.get());
+        mock.insert({key, rid});
+    }
+    for (int key = 1; key <= scale; key += 2) {
+        ASSERT_TRUE(ih->delete_entry(reinterpret_cast<const char *>(&key), txn_.get()));
+        mock.erase(key);
+    }
+    check_all(ih, mock);
+
+    sm_->drop_index(TEST_FILE_NAME, index_col, nullptr);
+    ASSERT_FALSE(ix_manager_->exists(TEST_FILE_NAME, index_col));
+}
+
+/**
+ * @brief 表中已有重复的key时创建B+树或哈希索引失败，不留下索引文件和元数据
+ */
+TEST_F(BPlusTreeTests, BulkLoadDuplicateTest) {
+    const std::vector<std::string> index_col = {"col2"};
+    RmFileHandle *fh = sm_->fhs_.at(TEST_FILE_NAME).get();
+    Rid dup_rid;
+    for (int i = 0; i < 1000; i++) {
+        int record[2] = {i, i == 999 ? 500 : i};
+        dup_rid = fh->insert_record(reinterpret_cast<char *>(record), nullptr);
+    }
+
+    EXPECT_THROW(sm_->create_index(TEST_FILE_NAME, index_col, nullptr), IndexEntryExistsError);
+    EXPECT_FALSE(sm_->db_.get_table(TEST_FILE_NAME).is_index(index_col));
+    EXPECT_FALSE(ix_manager_->exists(TEST_FILE_NAME, index_col));
+    EXPECT_EQ(sm_->ihs_.count(ix_manager_->get_index_name(TEST_FILE_NAME, index_col)), 0);
+    // 哈希索引同样拒绝重复的key
+    EXPECT_THROW(sm_->create_index(TEST_FILE_NAME, index_col, nullptr, INDEX_HASH), IndexEntryExistsError);
+    EXPECT_FALSE(sm_->db_.get_table(TEST_FILE_NAME).is_index(index_col));
+    EXPECT_FALSE(ix_manager_->exists(TEST_FILE_NAME, index_col));
+
+    // 删除重复的记录后可以创建索引
+    fh->delete_record(dup_rid, nullptr);
+    sm_->create_index(TEST_FILE_NAME, index_col, nullptr);
+    EXPECT_TRUE(sm_->db_.get_table(TEST_FILE_NAME).is_index(index_col));
+    sm_->drop_index(TEST_FILE_NAME, index_col, nullptr);
+}
+
+/**
+ * @brief 内存不足以容纳所有键值对时，外部排序写出多个有序段并多趟归并，输出按(key, rid)有序
+ */
+TEST_F(BPlusTreeTests, ExternalSortTest) {
+    const int scale = 200000;
+    // 内存只能容纳约2048个键值对，会写出约100个有序段，多于IX_SORT_MERGE_FANIN，需要两趟归并
+    IxExternalSorter sorter({TYPE_INT}, {4}, "sort_test", 2048 * (sizeof(int) + sizeof(Rid) + sizeof(size_t)));
+
+    std::vector<std::pair<int, int>> entries;
+    std::mt19937 rng(0);
+    for (int i = 0; i < scale; i++) {
+        entries.push_back({static_cast<int>(rng() % (scale / 4)), i});  // 有重复的key
+    }
+    for (auto &entry : entries) {
+        sorter.add(reinterpret_cast<const char *>(&entry.first), Rid{.page_no = 0, .slot_no = entry.second});
+    }
+    sorter.finish();
+    ASSERT_EQ(sorter.size(), scale);
+    ASSERT_GT(sorter.num_runs_written(), 1);
+
+    std::sort(entries.begin(), entries.end());
+    const char *key;
+    Rid rid;
+    for (auto &entry : entries) {
+        ASSERT_TRUE(sorter.next(&key, &rid));
+        ASSERT_EQ(*reinterpret_cast<const int *>(key), entry.first);
+        ASSERT_EQ(rid.slot_no, entry.second);
+    }
+    ASSERT_FALSE(sorter.next(&key, &rid));
+}
@@ -0,0 +1,253 @@
+#include <algorithm>
+#include <random>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#define private public
+#include "index/ix.h"
+#include "index/ix_external_sort.h"
+#undef private
+
+#include "storage/buffer_pool_manager.h"
+
+const std::string TEST_DB_NAME = "BPlusTreeSeparatorTest_db";
+const std::string TEST_FILE_NAME = "table1";
+
+/**
+ * 第一个字段为字符串的索引在内部结点中只保存key的前缀(分隔key)，测试分隔key的截断和加长
+ */
+class BPlusTreeSeparatorTests : public ::testing::Test {
+   public:
+    std::unique_ptr<DiskManager> disk_manager_;
+    std::unique_ptr<BufferPoolManager> buffer_pool_manager_;
+    std::unique_ptr<IxManager> ix_manager_;
+    std::unique_ptr<IxIndexHandle> ih_;
+    std::vector<ColMeta> index_cols_;
+
+    void SetUp() override {
+        ::testing::Test::SetUp();
+        disk_manager_ = std::make_unique<DiskManager>();
+        buffer_pool_manager_ = std::make_unique<BufferPoolManager>(1000, disk_manager_.get());
+        ix_manager_ = std::make_unique<IxManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        if (disk_manager_->is_dir(TEST_DB_NAME)) {
+            std::string cmd = "rm -rf " + TEST_DB_NAME;
+            if (system(cmd.c_str()) < 0) {
+                throw UnixError();
+            }
+        }
+        disk_manager_->create_dir(TEST_DB_NAME);
+        if (chdir(TEST_DB_NAME.c_str()) < 0) {
+            throw UnixError();
+        }
+    }
+
+    void TearDown() override {
+        if (ih_ != nullptr) {
+            ix_manager_->close_index(ih_.get());
+        }
+        if (chdir("..") < 0) {
+            throw UnixError();
+        }
+    }
+
+    void create_index(const std::vector<ColMeta> &index_cols) {
+        index_cols_ = index_cols;
+        ix_manager_->create_index(TEST_FILE_NAME, index_cols_);
+        ih_ = ix_manager_->open_index(TEST_FILE_NAME, index_cols_);
+    }
+
+    std::string make_key(const std::string &str) const {
+        std::string key(ih_->file_hdr_->col_tot_len_, '\0');
+        memcpy(key.data(), str.data(), std::min<size_t>(str.size(), ih_->file_hdr_->col_lens_[0]));
+        return key;
+    }
+
+    /**
+     * @brief 检查以node为根的子树：key有序，内部结点的第i个key等于第i个孩子子树中最小key的前缀，
+     * 相邻孩子的边界能用分隔key区分，孩子的父结点正确
+     * @return 子树中最小的key
+     */
+    std::string check_subtree(page_id_t page_no, page_id_t parent, std::string *max_key) {
+        IxNodeHandle *node = ih_->fetch_node(page_no);
+        const IxFileHdr *hdr = ih_->file_hdr_;
+        EXPECT_EQ(node->get_parent_page_no(), parent);
+        EXPECT_GT(node->get_size(), 0);
+        std::string min_key;
+        if (node->is_leaf_page()) {
+            for (int i = 1; i < node->get_size(); i++) {
+                EXPECT_LT(hdr->key_comparator_.compare(node->get_key(i - 1), node->get_key(i)), 0);
+            }
+            min_key.assign(node->get_key(0), hdr->col_tot_len_);
+            max_key->assign(node->get_key(node->get_size() - 1), hdr->col_tot_len_);
+        } else {
+            std::string prev_max;
+            for (int i = 0; i < node->get_size(); i++) {
+                std::string child_max;
+                std::string child_min = check_subtree(node->value_at(i), page_no, &child_max);
+                EXPECT_EQ(memcmp(node->get_key(i), child_min.data(), hdr->sep_len_), 0);
+                if (i > 0) {
+                    EXPECT_TRUE(ih_->separable(prev_max.data(), child_min.data()));
+                } else {
+                    min_key = child_min;
+                }
+                prev_max = child_max;
+            }
+            *max_key = prev_max;
+        }
+        buffer_pool_manager_->unpin_page(node->get_page_id(), false);
+        delete node;
+        return min_key;
+    }
+
+    // 检查树的结构，并且沿叶子链表读出的key恰好是expected中的key
+    void check_tree(std::vector<std::string> expected) {
+        std::string max_key;
+        check_subtree(ih_->file_hdr_->root_page_, IX_NO_PAGE, &max_key);
+
+        std::sort(expected.begin(), expected.end(), [this](const std::string &a, const std::string &b) {
+            return ih_->file_hdr_->key_comparator_.compare(a.data(), b.data()) < 0;
+        });
+        std::vector<std::string> actual;
+        page_id_t page_no = ih_->file_hdr_->first_leaf_;
+        while (page_no != IX_LEAF_HEADER_PAGE) {
+            IxNodeHandle *leaf = ih_->fetch_node(page_no);
+            for (int i = 0; i < leaf->get_size(); i++) {
+                actual.emplace_back(leaf->get_key(i), ih_->file_hdr_->col_tot_len_);
+            }
+            page_no = leaf->get_next_leaf();
+            buffer_pool_manager_->unpin_page(leaf->get_page_id(), false);
+            delete leaf;
+        }
+        ASSERT_EQ(actual, expected);
+        for (auto &key : expected) {
+            std::vector<Rid> result;
+            ASSERT_TRUE(ih_->get_value(key.data(), &result, nullptr));
+        }
+    }
+};
+
+/**
+ * @brief 随机插入、删除前缀长短不一的字符串，共同前缀超过分隔key长度时分隔key自动加长
+ */
+TEST_F(BPlusTreeSeparatorTests, InsertAndDelete) {
+    create_index({ColMeta{.tab_name = TEST_FILE_NAME, .name = "name", .type = TYPE_STRING, .len = 200, .offset = 0}});
+    ASSERT_EQ(ih_->file_hdr_->sep_len_, IX_SEPARATOR_INIT_LEN);
+    // 内部结点可以容纳的孩子数远多于叶子
+    ASSERT_GT(ih_->file_hdr_->internal_order_, ih_->file_hdr_->btree_order_ * 5);
+
+    std::vector<std::string> keys;
+    for (int i = 0; i < 3000; i++) {
+        keys.push_back(make_key("user" + std::to_string(i * 7919 % 100000)));
+    }
+    // 前缀分别为30和70个字节的两组key，需要两次加长分隔key
+    for (int i = 0; i < 300; i++) {
+        keys.push_back(make_key("https://example.com/some/path/" + std::to_string(i)));
+        keys.push_back(make_key(std::string(70, 'x') + std::to_string(i)));
+    }
+    std::mt19937 rng(3);
+    std::shuffle(keys.begin(), keys.end(), rng);
+    for (size_t i = 0; i < keys.size(); i++) {
+        ih_->insert_entry(keys[i].data(), Rid{.page_no = 1, .slot_no = static_cast<int>(i)}, nullptr);
+    }
+    EXPECT_GT(ih_->file_hdr_->sep_len_, 70);
+    EXPECT_LT(ih_->file_hdr_->sep_len_, ih_->file_hdr_->col_tot_len_);
+    check_tree(keys);
+
+    std::shuffle(keys.begin(), keys.end(), rng);
+    size_t half = keys.size() / 2;
+    for (size_t i = 0; i < half; i++) {
+        ASSERT_TRUE(ih_->delete_entry(keys[i].data(), nullptr));
+    }
+    keys.erase(keys.begin(), keys.begin() + half);
+    check_tree(keys);
+}
+
+/**
+ * @brief 组合索引中第一个字段相同的key超过一个叶子时，分隔key改为保存完整的key
+ */
+TEST_F(BPlusTreeSeparatorTests, CompositeKeyFallsBackToFullKeys) {
+    create_index({ColMeta{.tab_name = TEST_FILE_NAME, .name = "name", .type = TYPE_STRING, .len = 64, .offset = 0},
+                  ColMeta{.tab_name = TEST_FILE_NAME, .name = "id", .type = TYPE_INT, .len = 4, .offset = 64}});
+    ASSERT_TRUE(ih_->file_hdr_->truncates_separators());
+    std::vector<std::string> keys;
+    for (int i = 0; i < 1000; i++) {
+        std::string key = make_key(i % 2 == 0 ? "same" : "name" + std::to_string(i));
+        memcpy(key.data() + 64, &i, sizeof(int));
+        keys.push_back(key);
+    }
+    for (size_t i = 0; i < keys.size(); i++) {
+        ih_->insert_entry(keys[i].data(), Rid{.page_no = 1, .slot_no = static_cast<int>(i)}, nullptr);
+    }
+    EXPECT_FALSE(ih_->file_hdr_->truncates_separators());
+    check_tree(keys);
+}
+
+/**
+ * @brief 批量构建时按叶子边界选择分隔key长度；版本1的文件头读出后内部结点保存完整的key
+ */
+TEST_F(BPlusTreeSeparatorTests, BulkLoadAndHeaderVersion) {
+    create_index({ColMeta{.tab_name = TEST_FILE_NAME, .name = "name", .type = TYPE_STRING, .len = 100, .offset = 0}});
+    IxExternalSorter sorter(ih_->file_hdr_->col_types_, ih_->file_hdr_->col_lens_, "bulk_load_sort");
+    std::vector<std::string> keys;
+    for (int i = 0; i < 5000; i++) {
+        keys.push_back(make_key(std::string(40, 'p') + std::to_string(i)));
+        sorter.add(keys.back().data(), Rid{.page_no = 1, .slot_no = i});
+    }
+    sorter.finish();
+    ih_->bulk_load(&sorter);
+    EXPECT_GT(ih_->file_hdr_->sep_len_, 40);
+    check_tree(keys);
+
+    IxFileHdr hdr = *ih_->file_hdr_;
+    hdr.update_tot_len();
+    std::vector<char> buf(hdr.tot_len_);
+    hdr.serialize(buf.data());
+    // 版本1的文件头没有最后三项
+    int v1_len = hdr.tot_len_ - 3 * sizeof(int);
+    memcpy(buf.data(), &v1_len, sizeof(int));
+    IxFileHdr old_hdr;
+    old_hdr.deserialize(buf.data());
+    EXPECT_EQ(old_hdr.version_, IX_FORMAT_VERSION);
+    EXPECT_EQ(old_hdr.sep_len_, old_hdr.col_tot_len_);
+    EXPECT_EQ(old_hdr.internal_order_, old_hdr.btree_order_);
+    EXPECT_EQ(old_hdr.tot_len_, hdr.tot_len_);
+}
+
+/**
+ * @brief 多个线程同时插入和删除，其中一些插入需要加长分隔key并重新构建内部结点
+ */
+TEST_F(BPlusTreeSeparatorTests, ConcurrentInsertDelete) {
+    create_index({ColMeta{.tab_name = TEST_FILE_NAME, .name = "name", .type = TYPE_STRING, .len = 128, .offset = 0}});
+    const int num_threads = 4;
+    const int per_thread = 1500;
+    std::vector<std::vector<std::string>> remaining(num_threads);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&, t]() {
+            Transaction txn(t);
+            std::mt19937 rng(t);
+            std::vector<std::string> keys;
+            for (int i = 0; i < per_thread; i++) {
+                // 每个线程的key有不同长度的公共前缀
+                keys.push_back(make_key(std::string(10 + t * 25, 'a' + t) + std::to_string(i)));
+                ih_->insert_entry(keys.back().data(), Rid{.page_no = t, .slot_no = i}, &txn);
+                if (i % 3 == 2) {
+                    size_t victim = rng() % keys.size();
+                    EXPECT_TRUE(ih_->delete_entry(keys[victim].data(), &txn));
+                    keys.erase(keys.begin() + victim);
+                }
+            }
+            remaining[t] = keys;
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    std::vector<std::string> all;
+    for (auto &keys : remaining) {
+        all.insert(all.end(), keys.begin(), keys.end());
+    }
+    EXPECT_GT(ih_->file_hdr_->sep_len_, IX_SEPARATOR_INIT_LEN);
+    check_tree(all);
+}
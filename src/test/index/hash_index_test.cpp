@@ -0,0 +1,180 @@
+#include <algorithm>
+#include <map>
+#include <numeric>
+#include <random>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#define private public
+#include "index/ix.h"
+#undef private
+
+#include "storage/buffer_pool_manager.h"
+
+const std::string TEST_DB_NAME = "HashIndexTest_db";
+const std::string TEST_FILE_NAME = "table1";
+
+class HashIndexTests : public ::testing::Test {
+   public:
+    std::unique_ptr<DiskManager> disk_manager_;
+    std::unique_ptr<BufferPoolManager> buffer_pool_manager_;
+    std::unique_ptr<IxManager> ix_manager_;
+    std::unique_ptr<IxHashIndexHandle> ih_;
+    std::vector<ColMeta> index_cols_;
+
+    void SetUp() override {
+        ::testing::Test::SetUp();
+        disk_manager_ = std::make_unique<DiskManager>();
+        buffer_pool_manager_ = std::make_unique<BufferPoolManager>(200, disk_manager_.get());
+        ix_manager_ = std::make_unique<IxManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        if (disk_manager_->is_dir(TEST_DB_NAME)) {
+            std::string cmd = "rm -rf " + TEST_DB_NAME;
+            if (system(cmd.c_str()) < 0) {
+                throw UnixError();
+            }
+        }
+        disk_manager_->create_dir(TEST_DB_NAME);
+        if (chdir(TEST_DB_NAME.c_str()) < 0) {
+            throw UnixError();
+        }
+        // (INT, STRING)组合索引
+        index_cols_ = {ColMeta{.tab_name = TEST_FILE_NAME, .name = "id", .type = TYPE_INT, .len = 4, .offset = 0},
+                       ColMeta{.tab_name = TEST_FILE_NAME, .name = "name", .type = TYPE_STRING, .len = 12, .offset = 4}};
+        ix_manager_->create_hash_index(TEST_FILE_NAME, index_cols_);
+        ih_ = ix_manager_->open_hash_index(TEST_FILE_NAME, index_cols_);
+    }
+
+    void TearDown() override {
+        if (ih_ != nullptr) {
+            ix_manager_->close_hash_index(ih_.get());
+        }
+        if (chdir("..") < 0) {
+            throw UnixError();
+        }
+    }
+
+    static std::string make_key(int id) {
+        std::string key(16, '\0');
+        memcpy(key.data(), &id, sizeof(int));
+        std::string name = "name" + std::to_string(id % 97);
+        memcpy(key.data() + 4, name.data(), name.size());
+        return key;
+    }
+
+    void reopen() {
+        ix_manager_->close_hash_index(ih_.get());
+        ih_ = ix_manager_->open_hash_index(TEST_FILE_NAME, index_cols_);
+    }
+
+    // 检查目录：指向同一个桶的项数等于2^(global_depth - local_depth)，桶中的key都落在这个桶
+    void check_directory() {
+        const IxHashFileHdr &hdr = ih_->file_hdr_;
+        ASSERT_EQ(ih_->dir_.size(), size_t{1} << hdr.global_depth_);
+        std::map<page_id_t, size_t> refs;
+        for (page_id_t page_no : ih_->dir_) refs[page_no]++;
+        for (auto &[page_no, count] : refs) {
+            Page *page = buffer_pool_manager_->fetch_page(PageId{ih_->fd_, page_no});
+            IxHashBucketHdr *bucket = ih_->bucket_hdr(page);
+            EXPECT_EQ(count, size_t{1} << (hdr.global_depth_ - bucket->local_depth));
+            for (int i = 0; i < bucket->num_entries; i++) {
+                EXPECT_EQ(ih_->dir_[ih_->dir_index(ih_->hash(ih_->entry_at(page, i)))], page_no);
+            }
+            buffer_pool_manager_->unpin_page(page->get_page_id(), false);
+        }
+    }
+};
+
+/**
+ * @brief 插入、查找、删除，关闭后重新打开时从目录页面读回目录
+ */
+TEST_F(HashIndexTests, InsertLookupDelete) {
+    const int scale = 20000;
+    std::vector<int> ids(scale);
+    std::iota(ids.begin(), ids.end(), 0);
+    std::mt19937 rng(0);
+    std::shuffle(ids.begin(), ids.end(), rng);
+    for (int id : ids) {
+        ih_->insert_entry(make_key(id).data(), Rid{.page_no = id, .slot_no = id}, nullptr);
+    }
+    // 重复的key不插入
+    EXPECT_THROW(ih_->insert_entry(make_key(ids[0]).data(), Rid{.page_no = -1, .slot_no = -1}, nullptr),
+                 IndexEntryExistsError);
+    EXPECT_GT(ih_->file_hdr_.global_depth_, 5);
+    check_directory();
+
+    reopen();
+    check_directory();
+    for (int id = 0; id < scale; id++) {
+        std::vector<Rid> result;
+        ASSERT_TRUE(ih_->get_value(make_key(id).data(), &result, nullptr));
+        ASSERT_EQ(result.size(), 1);
+        ASSERT_EQ(result[0], (Rid{.page_no = id, .slot_no = id}));
+    }
+    std::vector<Rid> result;
+    EXPECT_FALSE(ih_->get_value(make_key(scale).data(), &result, nullptr));
+
+    for (int id = 0; id < scale; id += 2) {
+        ASSERT_TRUE(ih_->delete_entry(make_key(id).data(), nullptr));
+    }
+    EXPECT_FALSE(ih_->delete_entry(make_key(0).data(), nullptr));
+    for (int id = 0; id < scale; id++) {
+        result.clear();
+        ASSERT_EQ(ih_->get_value(make_key(id).data(), &result, nullptr), id % 2 == 1);
+    }
+}
+
+/**
+ * @brief 全局深度达到上限后桶不再分裂，插入的键值对放入溢出页
+ */
+TEST_F(HashIndexTests, OverflowPages) {
+    ih_->file_hdr_.max_depth_ = 2;
+    const int scale = ih_->file_hdr_.bucket_capacity_ * 12;
+    for (int id = 0; id < scale; id++) {
+        ih_->insert_entry(make_key(id).data(), Rid{.page_no = 0, .slot_no = id}, nullptr);
+    }
+    EXPECT_EQ(ih_->file_hdr_.global_depth_, 2);
+    reopen();
+    for (int id = 0; id < scale; id++) {
+        std::vector<Rid> result;
+        ASSERT_TRUE(ih_->get_value(make_key(id).data(), &result, nullptr));
+        ASSERT_EQ(result[0].slot_no, id);
+    }
+    for (int id = 0; id < scale; id += 3) {
+        ASSERT_TRUE(ih_->delete_entry(make_key(id).data(), nullptr));
+    }
+    for (int id = 0; id < scale; id++) {
+        std::vector<Rid> result;
+        ASSERT_EQ(ih_->get_value(make_key(id).data(), &result, nullptr), id % 3 != 0);
+    }
+}
+
+/**
+ * @brief 多个线程同时插入、查找和删除，其中一些插入会分裂桶并加倍目录
+ */
+TEST_F(HashIndexTests, ConcurrentInsertDelete) {
+    const int num_threads = 4;
+    const int per_thread = 5000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < per_thread; i++) {
+                int id = i * num_threads + t;
+                ih_->insert_entry(make_key(id).data(), Rid{.page_no = t, .slot_no = id}, nullptr);
+                std::vector<Rid> result;
+                EXPECT_TRUE(ih_->get_value(make_key(id).data(), &result, nullptr));
+                if (i % 4 == 3) {
+                    EXPECT_TRUE(ih_->delete_entry(make_key(id).data(), nullptr));
+                }
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    check_directory();
+    for (int id = 0; id < num_threads * per_thread; id++) {
+        std::vector<Rid> result;
+        ASSERT_EQ(ih_->get_value(make_key(id).data(), &result, nullptr), (id / num_threads) % 4 != 3);
+    }
+}
@@ -0,0 +1,147 @@
+#include <algorithm>
+#include <climits>
+#include <random>
+
+#include "gtest/gtest.h"
+
+#define private public
+#include "index/ix_index_handle.h"
+#undef private
+#include "index/ix_node_search.h"
+
+/**
+ * @brief 单字段INT、FLOAT索引的SIMD查找与std::lower_bound/upper_bound的结果一致，
+ * 覆盖SIMD窗口内外的各种长度、重复的key以及边界值
+ */
+TEST(IxNodeSearchTest, IntAndFloatKernels) {
+    std::mt19937 rng(0);
+    std::vector<int> sizes = {0, 1, 3, 4, 7, 8, 9, 15, 16, 17, 63, 64, 65, 100, 339, 5000};
+    for (int n : sizes) {
+        std::vector<int> ints(n);
+        std::vector<float> floats(n);
+        for (int i = 0; i < n; i++) {
+            ints[i] = static_cast<int>(rng() % (n + 1)) - n / 2;  // 有重复的key
+            floats[i] = ints[i] * 0.5f;
+        }
+        std::sort(ints.begin(), ints.end());
+        std::sort(floats.begin(), floats.end());
+        if (n > 2) {
+            ints.front() = INT_MIN;
+            ints.back() = INT_MAX;
+        }
+
+        std::vector<int> targets = {INT_MIN, INT_MAX, 0, -n, n};
+        for (int i = 0; i < 50; i++) targets.push_back(static_cast<int>(rng() % (n + 3)) - n / 2 - 1);
+        for (int target : targets) {
+            const char *keys = reinterpret_cast<const char *>(ints.data());
+            ASSERT_EQ(ix_lower_bound_int(keys, n, target), std::lower_bound(ints.begin(), ints.end(), target) - ints.begin());
+            ASSERT_EQ(ix_upper_bound_int(keys, n, target), std::upper_bound(ints.begin(), ints.end(), target) - ints.begin());
+
+            float ftarget = target * 0.5f;
+            const char *fkeys = reinterpret_cast<const char *>(floats.data());
+            ASSERT_EQ(ix_lower_bound_float(fkeys, n, ftarget),
+                      std::lower_bound(floats.begin(), floats.end(), ftarget) - floats.begin());
+            ASSERT_EQ(ix_upper_bound_float(fkeys, n, ftarget),
+                      std::upper_bound(floats.begin(), floats.end(), ftarget) - floats.begin());
+        }
+    }
+}
+
+/**
+ * @brief (STRING, INT)组合索引的结点内二分查找跳过公共前缀，结果与逐个比较一致
+ */
+TEST(IxNodeSearchTest, CompositeKeyBinarySearch) {
+    const int str_len = 8;
+    IxFileHdr file_hdr;
+    file_hdr.col_num_ = 2;
+    file_hdr.col_types_ = {TYPE_STRING, TYPE_INT};
+    file_hdr.col_lens_ = {str_len, sizeof(int)};
+    file_hdr.col_tot_len_ = str_len + sizeof(int);
+    file_hdr.btree_order_ = (PAGE_SIZE - sizeof(IxPageHdr)) / (file_hdr.col_tot_len_ + sizeof(Rid)) - 1;
+    file_hdr.keys_size_ = (file_hdr.btree_order_ + 1) * file_hdr.col_tot_len_;
+    file_hdr.set_sep_len(file_hdr.col_tot_len_, PAGE_SIZE);
+    file_hdr.key_comparator_.bind(file_hdr.col_types_, file_hdr.col_lens_);
+
+    std::vector<char> data(PAGE_SIZE);
+    Page page;
+    page.data_ = data.data();
+    IxNodeHandle node(&file_hdr, &page);
+
+    // 前缀相同、只在后几个字节或第二个字段上不同的key
+    std::mt19937 rng(1);
+    auto make_key = [&](std::vector<char> &key) {
+        key.assign(file_hdr.col_tot_len_, 0);
+        memcpy(key.data(), "prefix", 6);
+        key[6] = static_cast<char>('a' + rng() % 3);
+        key[7] = static_cast<char>(rng() % 256);  // 包括大于127的字节
+        int second = static_cast<int>(rng() % 5) - 2;
+        memcpy(key.data() + str_len, &second, sizeof(int));
+    };
+    auto less = [&](const std::vector<char> &a, const std::vector<char> &b) {
+        return ix_compare(a.data(), b.data(), file_hdr.col_types_, file_hdr.col_lens_) < 0;
+    };
+    std::vector<std::vector<char>> keys(200);
+    for (auto &key : keys) make_key(key);
+    std::sort(keys.begin(), keys.end(), less);
+    node.set_size(0);
+    for (size_t i = 0; i < keys.size(); i++) {
+        node.insert_pair(i, keys[i].data(), Rid{.page_no = 0, .slot_no = static_cast<int>(i)});
+    }
+
+    for (int t = 0; t < 500; t++) {
+        std::vector<char> target;
+        make_key(target);
+        int lower = 0;
+        while (lower < node.get_size() &&
+               ix_compare(node.get_key(lower), target.data(), file_hdr.col_types_, file_hdr.col_lens_) < 0) {
+            lower++;
+        }
+        int upper = 1;
+        while (upper < node.get_size() &&
+               ix_compare(node.get_key(upper), target.data(), file_hdr.col_types_, file_hdr.col_lens_) <= 0) {
+            upper++;
+        }
+        ASSERT_EQ(node.lower_bound(target.data()), lower);
+        ASSERT_EQ(node.upper_bound(target.data()), upper);
+    }
+}
+
+/**
+ * @brief 按字段类型展开的比较函数与通用的ix_compare结果一致
+ */
+TEST(IxNodeSearchTest, TypedComparators) {
+    std::vector<std::vector<ColType>> shapes = {
+        {TYPE_INT}, {TYPE_FLOAT}, {TYPE_STRING}, {TYPE_INT, TYPE_INT}, {TYPE_INT, TYPE_FLOAT},
+        {TYPE_INT, TYPE_STRING}, {TYPE_STRING, TYPE_INT}, {TYPE_STRING, TYPE_STRING}, {TYPE_INT, TYPE_INT, TYPE_INT},
+        {TYPE_FLOAT, TYPE_STRING, TYPE_INT}};
+    std::mt19937 rng(2);
+    for (auto &col_types : shapes) {
+        std::vector<int> col_lens;
+        int tot_len = 0;
+        for (auto type : col_types) {
+            col_lens.push_back(type == TYPE_STRING ? 5 : 4);
+            tot_len += col_lens.back();
+        }
+        IxKeyComparator comparator(col_types, col_lens);
+        for (int t = 0; t < 2000; t++) {
+            // 取值范围很小，使前面的字段经常相等
+            std::vector<char> a(tot_len), b(tot_len);
+            for (int offset = 0, i = 0; i < static_cast<int>(col_types.size()); offset += col_lens[i++]) {
+                for (auto *key : {&a, &b}) {
+                    if (col_types[i] == TYPE_INT) {
+                        int v = static_cast<int>(rng() % 3) - 1;
+                        memcpy(key->data() + offset, &v, sizeof(int));
+                    } else if (col_types[i] == TYPE_FLOAT) {
+                        float v = static_cast<float>(rng() % 3) - 1.5f;
+                        memcpy(key->data() + offset, &v, sizeof(float));
+                    } else {
+                        for (int j = 0; j < col_lens[i]; j++) (*key)[offset + j] = static_cast<char>(rng() % 2 ? 'a' : 0xf0);
+                    }
+                }
+            }
+            int expected = ix_compare(a.data(), b.data(), col_types, col_lens);
+            int actual = comparator.compare(a.data(), b.data());
+            ASSERT_EQ((expected > 0) - (expected < 0), (actual > 0) - (actual < 0));
+        }
+    }
+}
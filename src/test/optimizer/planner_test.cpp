@@ -0,0 +1,299 @@
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "analyze/analyze.h"
+#include "optimizer/planner.h"
+#include "parser/parser.h"
+#include "portal.h"
+
+const std::string TEST_DB_NAME = "PlannerTest_db";
+
+class PlannerTests : public ::testing::Test {
+   public:
+    std::unique_ptr<DiskManager> disk_manager_;
+    std::unique_ptr<BufferPoolManager> buffer_pool_manager_;
+    std::unique_ptr<IxManager> ix_manager_;
+    std::unique_ptr<RmManager> rm_manager_;
+    std::unique_ptr<SmManager> sm_manager_;
+    std::unique_ptr<Planner> planner_;
+    std::unique_ptr<Analyze> analyze_;
+    std::unique_ptr<Portal> portal_;
+    std::unique_ptr<Transaction> txn_;
+    std::unique_ptr<Context> context_;
+
+    void SetUp() override {
+        ::testing::Test::SetUp();
+        disk_manager_ = std::make_unique<DiskManager>();
+        buffer_pool_manager_ = std::make_unique<BufferPoolManager>(1000, disk_manager_.get());
+        ix_manager_ = std::make_unique<IxManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        rm_manager_ = std::make_unique<RmManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        sm_manager_ = std::make_unique<SmManager>(disk_manager_.get(), buffer_pool_manager_.get(), rm_manager_.get(),
+                                                  ix_manager_.get());
+        planner_ = std::make_unique<Planner>(sm_manager_.get());
+        analyze_ = std::make_unique<Analyze>(sm_manager_.get());
+        portal_ = std::make_unique<Portal>(sm_manager_.get());
+        if (disk_manager_->is_dir(TEST_DB_NAME)) {
+            std::string cmd = "rm -rf " + TEST_DB_NAME;
+            if (system(cmd.c_str()) < 0) {
+                throw UnixError();
+            }
+        }
+        sm_manager_->create_db(TEST_DB_NAME);
+        sm_manager_->open_db(TEST_DB_NAME);
+        txn_ = std::make_unique<Transaction>(1);
+        context_ = std::make_unique<Context>(nullptr, nullptr, txn_.get());
+
+        // t(a, b, c, d)：(a, b)上建B+树索引，c上建哈希索引
+        sm_manager_->create_table("t", {{"a", TYPE_INT, 4}, {"b", TYPE_INT, 4}, {"c", TYPE_INT, 4}, {"d", TYPE_STRING, 8}},
+                                  nullptr);
+        for (int i = 0; i < 1000; i++) {
+            insert_ints("t", {i % 50, i, i * 3, 0});
+        }
+        sm_manager_->create_index("t", {"a", "b"}, nullptr);
+        sm_manager_->create_index("t", {"c"}, nullptr, INDEX_HASH);
+    }
+
+    void TearDown() override {
+        sm_manager_->close_db();
+    }
+
+    // 直接向数据文件写入一条记录，vals依次为各个int字段的值，其余字节为0
+    void insert_ints(const std::string &tab_name, const std::vector<int> &vals) {
+        std::vector<char> rec(sm_manager_->fhs_.at(tab_name)->get_file_hdr().record_size, 0);
+        memcpy(rec.data(), vals.data(), std::min(rec.size(), vals.size() * sizeof(int)));
+        sm_manager_->fhs_.at(tab_name)->insert_record(rec.data(), nullptr);
+    }
+
+    // 解析sql并生成查询计划
+    std::shared_ptr<Plan> plan(const std::string &sql) {
+        YY_BUFFER_STATE buf = yy_scan_string(sql.c_str());
+        int res = yyparse();
+        yy_delete_buffer(buf);
+        EXPECT_EQ(res, 0) << sql;
+        std::shared_ptr<Query> query = analyze_->do_analyze(ast::parse_tree);
+        return planner_->do_planner(query, context_.get());
+    }
+
+    // 查询计划中扫描表tab_name的节点
+    static std::shared_ptr<ScanPlan> find_scan(const std::shared_ptr<Plan> &plan, const std::string &tab_name) {
+        if (auto x = std::dynamic_pointer_cast<ScanPlan>(plan)) {
+            return x->tab_name_ == tab_name ? x : nullptr;
+        } else if (auto x = std::dynamic_pointer_cast<JoinPlan>(plan)) {
+            auto scan = find_scan(x->left_, tab_name);
+            return scan != nullptr ? scan : find_scan(x->right_, tab_name);
+        } else if (auto x = std::dynamic_pointer_cast<ProjectionPlan>(plan)) {
+            return find_scan(x->subplan_, tab_name);
+        } else if (auto x = std::dynamic_pointer_cast<SortPlan>(plan)) {
+            return find_scan(x->subplan_, tab_name);
+        } else if (auto x = std::dynamic_pointer_cast<DMLPlan>(plan)) {
+            return find_scan(x->subplan_, tab_name);
+        }
+        return nullptr;
+    }
+
+    // 查询计划中最上面的连接节点
+    static std::shared_ptr<Plan> find_join(const std::shared_ptr<Plan> &plan) {
+        if (std::dynamic_pointer_cast<JoinPlan>(plan) != nullptr) {
+            return plan;
+        } else if (auto x = std::dynamic_pointer_cast<ProjectionPlan>(plan)) {
+            return find_join(x->subplan_);
+        } else if (auto x = std::dynamic_pointer_cast<SortPlan>(plan)) {
+            return find_join(x->subplan_);
+        } else if (auto x = std::dynamic_pointer_cast<DMLPlan>(plan)) {
+            return find_join(x->subplan_);
+        }
+        return nullptr;
+    }
+
+    // 执行select语句，每条结果为按输出字段顺序排列的int值，跳过非int字段
+    std::vector<std::vector<int>> run(const std::string &sql) {
+        auto stmt = portal_->start(plan(sql), context_.get());
+        auto &root = stmt->root;
+        std::vector<std::vector<int>> rows;
+        for (root->beginTuple(); !root->is_end(); root->nextTuple()) {
+            auto rec = root->Next();
+            std::vector<int> row;
+            for (auto &col : root->cols()) {
+                if (col.type == TYPE_INT) {
+                    row.push_back(*reinterpret_cast<int *>(rec->data + col.offset));
+                }
+            }
+            rows.push_back(row);
+        }
+        return rows;
+    }
+
+    // 查询在表t上是否只读索引index_cols
+    bool is_index_only(const std::string &sql, const std::vector<std::string> &index_cols) {
+        auto scan = find_scan(plan(sql), "t");
+        EXPECT_NE(scan, nullptr) << sql;
+        EXPECT_EQ(scan->tag, T_IndexScan) << sql;
+        EXPECT_EQ(scan->index_col_names_, index_cols) << sql;
+        return scan->index_only_;
+    }
+};
+
+/**
+ * @brief 索引包含查询在表上用到的所有字段时只读索引
+ */
+TEST_F(PlannerTests, IndexOnlyScanForCoveringIndex) {
+    EXPECT_TRUE(is_index_only("select a, b from t where a = 3 and b = 53;", {"a", "b"}));
+    EXPECT_TRUE(is_index_only("select b from t where b = 53 and a = 3;", {"a", "b"}));
+    EXPECT_TRUE(is_index_only("select a, b from t where a = 3 and b = 53 order by b;", {"a", "b"}));
+    EXPECT_TRUE(is_index_only("select c from t where c = 21;", {"c"}));
+
+    // 投影、条件或排序用到索引之外的字段时回表
+    EXPECT_FALSE(is_index_only("select * from t where a = 3 and b = 53;", {"a", "b"}));
+    EXPECT_FALSE(is_index_only("select a, c from t where a = 3 and b = 53;", {"a", "b"}));
+    EXPECT_FALSE(is_index_only("select a from t where a = 3 and b = 53 and c > 0;", {"a", "b"}));
+    EXPECT_FALSE(is_index_only("select a, b from t where a = 3 and b = 53 order by c;", {"a", "b"}));
+    EXPECT_FALSE(is_index_only("select a, d from t where c = 21;", {"c"}));
+}
+
+/**
+ * @brief 只读索引的扫描按索引字段的顺序输出key，投影在这个布局上取字段
+ */
+TEST_F(PlannerTests, IndexOnlyScanLayout) {
+    auto scan = find_scan(plan("select b, a from t where a = 3 and b = 53;"), "t");
+    ASSERT_TRUE(scan->index_only_);
+    auto exec = portal_->convert_plan_executor(scan, context_.get());
+    EXPECT_EQ(exec->getType(), "IndexOnlyScanExecutor");
+    ASSERT_EQ(exec->cols().size(), 2);
+    EXPECT_EQ(exec->cols()[0].name, "a");
+    EXPECT_EQ(exec->cols()[0].offset, 0);
+    EXPECT_EQ(exec->cols()[1].name, "b");
+    EXPECT_EQ(exec->cols()[1].offset, 4);
+    EXPECT_EQ(exec->tupleLen(), 8);
+
+    EXPECT_EQ(run("select b, a from t where a = 3 and b = 53;"), (std::vector<std::vector<int>>{{53, 3}}));
+    EXPECT_EQ(run("select a, b from t where b = 53 and a = 3;"), (std::vector<std::vector<int>>{{3, 53}}));
+    EXPECT_EQ(run("select b from t where a = 3 and b = 54;"), (std::vector<std::vector<int>>{}));
+    EXPECT_EQ(run("select c from t where c = 21;"), (std::vector<std::vector<int>>{{21}}));
+    // 回表的扫描输出整条记录
+    EXPECT_EQ(run("select c, a from t where a = 3 and b = 53;"), (std::vector<std::vector<int>>{{159, 3}}));
+}
+
+/**
+ * @brief 连接方式的选择：两侧都已经有序时用排序归并连接，内表上有可用的索引时用索引嵌套循环连接，
+ * 有等值连接条件时用哈希连接，否则用嵌套循环连接
+ */
+TEST_F(PlannerTests, JoinMethodChoice) {
+    sm_manager_->create_table("r", {{"x", TYPE_INT, 4}, {"y", TYPE_INT, 4}}, nullptr);
+    sm_manager_->create_table("u", {{"x", TYPE_INT, 4}, {"z", TYPE_INT, 4}}, nullptr);
+    for (int i = 0; i < 300; i++) {
+        insert_ints("r", {i, i % 7});
+        insert_ints("u", {2 * i, i});
+    }
+    auto join_of = [&](const std::string &sql) {
+        auto root = std::dynamic_pointer_cast<ProjectionPlan>(std::dynamic_pointer_cast<DMLPlan>(plan(sql))->subplan_);
+        auto join = std::dynamic_pointer_cast<JoinPlan>(root->subplan_);
+        EXPECT_NE(join, nullptr) << sql;
+        return join;
+    };
+
+    EXPECT_EQ(join_of("select * from r, u where r.x = u.x;")->tag, T_HashJoin);
+    EXPECT_EQ(join_of("select * from r, u where r.x < u.x;")->tag, T_NestLoop);
+    // t上c的哈希索引可以由连接条件确定，t作为内表换到右边
+    auto join = join_of("select * from r, t where t.c = r.x;");
+    EXPECT_EQ(join->tag, T_IndexNestLoop);
+    EXPECT_EQ(std::dynamic_pointer_cast<ScanPlan>(join->right_)->tab_name_, "t");
+    EXPECT_EQ(join->index_col_names_, std::vector<std::string>{"c"});
+    EXPECT_EQ(run("select r.x, t.a from r, t where t.c = r.x;").size(), 100);
+
+    sm_manager_->create_index("r", {"x"}, nullptr);
+    sm_manager_->create_index("u", {"x"}, nullptr);
+    // 索引覆盖两侧用到的字段时，两侧改为只读索引的扫描，按连接key有序
+    join = join_of("select r.x, u.x from r, u where r.x = u.x;");
+    EXPECT_EQ(join->tag, T_MergeJoin);
+    for (auto &child : {join->left_, join->right_}) {
+        auto scan = std::dynamic_pointer_cast<ScanPlan>(child);
+        EXPECT_EQ(scan->tag, T_IndexScan);
+        EXPECT_TRUE(scan->index_only_);
+        EXPECT_EQ(scan->index_col_names_, std::vector<std::string>{"x"});
+    }
+    auto rows = run("select r.x, u.x from r, u where r.x = u.x;");
+    ASSERT_EQ(rows.size(), 150);
+    for (size_t i = 0; i < rows.size(); i++) {
+        EXPECT_EQ(rows[i], (std::vector<int>{int(2 * i), int(2 * i)}));
+    }
+    // 需要回表时不把顺序扫描改为按索引扫描，改用索引嵌套循环连接
+    join = join_of("select * from r, u where r.x = u.x;");
+    EXPECT_EQ(join->tag, T_IndexNestLoop);
+    EXPECT_EQ(std::dynamic_pointer_cast<ScanPlan>(join->left_)->tag, T_SeqScan);
+    EXPECT_EQ(run("select * from r, u where r.x = u.x;").size(), 150);
+    join = join_of("select r.x, u.z from r, u where r.x = u.x;");
+    EXPECT_NE(join->tag, T_MergeJoin);
+    EXPECT_EQ(run("select r.x, u.z from r, u where r.x = u.x;").size(), 150);
+}
+
+/**
+ * @brief 左侧的单表扫描可以用索引查找时，作为内表换到右边；内表索引最左边的字段可以由常量等值条件确定
+ */
+TEST_F(PlannerTests, IndexNestedLoopJoinChoice) {
+    sm_manager_->create_table("r", {{"x", TYPE_INT, 4}, {"y", TYPE_INT, 4}}, nullptr);
+    for (int i = 0; i < 300; i++) {
+        insert_ints("r", {i, i % 7});
+    }
+    auto join = std::dynamic_pointer_cast<JoinPlan>(find_join(plan("select * from t, r where t.c = r.x;")));
+    ASSERT_NE(join, nullptr);
+    EXPECT_EQ(join->tag, T_IndexNestLoop);
+    EXPECT_EQ(std::dynamic_pointer_cast<ScanPlan>(join->left_)->tab_name_, "r");
+    EXPECT_EQ(std::dynamic_pointer_cast<ScanPlan>(join->right_)->tab_name_, "t");
+    EXPECT_EQ(join->index_col_names_, std::vector<std::string>{"c"});
+    EXPECT_EQ(run("select * from t, r where t.c = r.x;").size(), 100);
+
+    join = std::dynamic_pointer_cast<JoinPlan>(find_join(plan("select t.b, r.y from r, t where t.a = 3 and t.b = r.x;")));
+    ASSERT_NE(join, nullptr);
+    EXPECT_EQ(join->tag, T_IndexNestLoop);
+    EXPECT_EQ(std::dynamic_pointer_cast<ScanPlan>(join->right_)->tab_name_, "t");
+    EXPECT_EQ(join->index_col_names_, (std::vector<std::string>{"a", "b"}));
+    auto rows = run("select t.b, r.y from r, t where t.a = 3 and t.b = r.x;");
+    std::sort(rows.begin(), rows.end());
+    EXPECT_EQ(rows, (std::vector<std::vector<int>>{{3, 3}, {53, 4}, {103, 5}, {153, 6}, {203, 0}, {253, 1}}));
+}
+
+/**
+ * @brief 单表扫描可以借助B+树索引按排序字段有序输出时不生成排序算子，ORDER BY DESC反向扫描索引
+ */
+TEST_F(PlannerTests, OrderByFromIndex) {
+    auto has_sort = [&](const std::string &sql) {
+        auto dml = std::dynamic_pointer_cast<DMLPlan>(plan(sql));
+        EXPECT_NE(dml, nullptr) << sql;
+        auto projection = std::dynamic_pointer_cast<ProjectionPlan>(dml->subplan_);
+        EXPECT_NE(projection, nullptr) << sql;
+        return std::dynamic_pointer_cast<SortPlan>(projection->subplan_) != nullptr;
+    };
+    std::vector<std::vector<int>> expected;
+    for (int b = 7; b < 1000; b += 50) {
+        expected.push_back({7, b});
+    }
+
+    std::string sql = "select a, b from t where a = 7 order by b;";
+    EXPECT_FALSE(has_sort(sql));
+    EXPECT_FALSE(find_scan(plan(sql), "t")->reverse_);
+    EXPECT_EQ(run(sql), expected);
+
+    sql = "select a, b from t where a = 7 order by b desc;";
+    EXPECT_FALSE(has_sort(sql));
+    auto scan = find_scan(plan(sql), "t");
+    EXPECT_EQ(scan->tag, T_IndexScan);
+    EXPECT_EQ(scan->index_col_names_, (std::vector<std::string>{"a", "b"}));
+    EXPECT_TRUE(scan->reverse_);
+    std::reverse(expected.begin(), expected.end());
+    EXPECT_EQ(run(sql), expected);
+
+    // 顺序扫描改为只读覆盖索引的反向扫描
+    sql = "select a, b from t order by a desc;";
+    EXPECT_FALSE(has_sort(sql));
+    auto rows = run(sql);
+    EXPECT_EQ(rows.size(), 1000);
+    EXPECT_TRUE(std::is_sorted(rows.begin(), rows.end(), std::greater<std::vector<int>>()));
+
+    // 排序字段之前的索引字段没有等值条件，或者索引不覆盖查询时仍然排序
+    EXPECT_TRUE(has_sort("select a, b from t order by b desc;"));
+    EXPECT_TRUE(has_sort("select * from t order by a desc;"));
+    EXPECT_TRUE(has_sort("select c from t where c = 21 order by c desc;"));
+}
@@ -3,6 +3,7 @@
 #include <cassert>
 #include <cstring>
 #include <ctime>
+#include <set>
 #include <string>
 #include <thread>
 #include <unordered_map>
@@ -427,3 +428,617 @@ TEST_F(BufferPoolManagerTest, ConcurrencyTest) {
 
     disk_manager_->close_file(fd);
 }
+
+/**
+ * @brief 多分片缓冲池测试（单文件），多个线程并发读写落在不同分片上的页面
+ * @note 生成测试文件multiple_instances_test
+ */
+TEST_F(BufferPoolManagerTest, MultipleInstancesTest) {
+    const int num_threads = 8;
+    const int pages_per_thread = 64;
+    const size_t num_instances = 4;
+    const size_t buffer_pool_size = 64;
+
+    const std::string filename = "multiple_instances_test";
+    auto disk_manager = BufferPoolManagerTest::disk_manager_.get();
+    disk_manager_->create_file(filename);
+    int fd = disk_manager_->open_file(filename);
+
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager, num_instances);
+    EXPECT_EQ(bpm->get_num_instances(), num_instances);
+    EXPECT_EQ(bpm->get_pool_size(), buffer_pool_size);
+
+    // 先顺序创建所有页面，页面内容为其页号
+    std::vector<PageId> page_ids;
+    for (int i = 0; i < num_threads * pages_per_thread; i++) {
+        PageId tmp_page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        auto *page = bpm->new_page(&tmp_page_id);
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ(i, tmp_page_id.page_no);
+        strcpy(page->get_data(), std::to_string(tmp_page_id.page_no).c_str());
+        page_ids.push_back(tmp_page_id);
+        EXPECT_EQ(true, bpm->unpin_page(tmp_page_id, true));
+    }
+
+    // 每个线程反复读写自己负责的页面，页面会在各个分片中被反复淘汰和读入
+    std::vector<std::thread> threads;
+    for (int tid = 0; tid < num_threads; tid++) {
+        threads.push_back(std::thread([&bpm, &page_ids, tid]() {
+            for (int round = 0; round < 4; round++) {
+                for (int i = tid * pages_per_thread; i < (tid + 1) * pages_per_thread; i++) {
+                    auto *page = bpm->fetch_page(page_ids[i]);
+                    while (page == nullptr) {
+                        page = bpm->fetch_page(page_ids[i]);
+                    }
+                    std::string expected = std::to_string(page_ids[i].page_no) + std::string(round, '#');
+                    EXPECT_EQ(0, std::strcmp(expected.c_str(), page->get_data()));
+                    strcat(page->get_data(), "#");
+                    EXPECT_EQ(true, bpm->unpin_page(page_ids[i], true));
+                }
+            }
+        }));
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    // 刷盘后从磁盘检查所有页面
+    bpm->flush_all_pages(fd);
+    char buf[PAGE_SIZE];
+    for (auto &page_id : page_ids) {
+        disk_manager_->read_page(fd, page_id.page_no, buf, PAGE_SIZE);
+        EXPECT_EQ(0, std::strcmp((std::to_string(page_id.page_no) + "####").c_str(), buf));
+    }
+
+    disk_manager_->close_file(fd);
+}
+
+/**
+ * @brief 多个线程并发读取同一批热点页(走无锁命中路径)，同时读取冷页面迫使热点页所在分片不断换页
+ *
+ * @note lab1 计分：5 points
+ */
+TEST_F(BufferPoolManagerTest, SharedHotPagesTest) {
+    const int num_threads = 8;
+    const int num_hot_pages = 8;
+    const int num_cold_pages = 64;
+    const int num_iterations = 2000;
+    const size_t buffer_pool_size = 16;
+
+    const std::string filename = "shared_hot_pages_test";
+    auto disk_manager = BufferPoolManagerTest::disk_manager_.get();
+    disk_manager_->create_file(filename);
+    int fd = disk_manager_->open_file(filename);
+
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager);
+
+    // 页面内容为其页号，前num_hot_pages个为热点页
+    std::vector<PageId> page_ids;
+    for (int i = 0; i < num_hot_pages + num_cold_pages; i++) {
+        PageId tmp_page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        auto *page = bpm->new_page(&tmp_page_id);
+        ASSERT_NE(nullptr, page);
+        strcpy(page->get_data(), std::to_string(tmp_page_id.page_no).c_str());
+        page_ids.push_back(tmp_page_id);
+        EXPECT_EQ(true, bpm->unpin_page(tmp_page_id, true));
+    }
+
+    auto check_page = [&bpm](PageId page_id) {
+        auto *page = bpm->fetch_page(page_id);
+        while (page == nullptr) {
+            page = bpm->fetch_page(page_id);
+        }
+        EXPECT_EQ(page_id, page->get_page_id());
+        EXPECT_EQ(0, std::strcmp(std::to_string(page_id.page_no).c_str(), page->get_data()));
+        EXPECT_EQ(true, bpm->unpin_page(page_id, false));
+    };
+
+    std::vector<std::thread> threads;
+    for (int tid = 0; tid < num_threads; tid++) {
+        threads.push_back(std::thread([&, tid]() {
+            for (int i = 0; i < num_iterations; i++) {
+                check_page(page_ids[(tid + i) % num_hot_pages]);
+                if (i % 4 == 0) {
+                    check_page(page_ids[num_hot_pages + (tid * num_iterations + i) % num_cold_pages]);
+                }
+            }
+        }));
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    // 所有页面都已unpin，再次unpin应当失败
+    for (auto &page_id : page_ids) {
+        EXPECT_EQ(false, bpm->unpin_page(page_id, false));
+    }
+
+    disk_manager_->close_file(fd);
+}
+
+/**
+ * @brief 使用不同的置换策略时，缓冲池换页后读到的页面内容都应正确
+ *
+ * @note lab1 计分：5 points
+ */
+TEST_F(BufferPoolManagerTest, ReplacerTypesTest) {
+    const int num_pages = 200;
+    const size_t buffer_pool_size = 20;
+
+    for (std::string replacer_type : {"LRU", "CLOCK", "LRU-K"}) {
+        const std::string filename = "replacer_types_test_" + replacer_type;
+        auto disk_manager = BufferPoolManagerTest::disk_manager_.get();
+        disk_manager_->create_file(filename);
+        int fd = disk_manager_->open_file(filename);
+
+        auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager, 2, replacer_type);
+
+        std::vector<PageId> page_ids;
+        for (int i = 0; i < num_pages; i++) {
+            PageId tmp_page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+            auto *page = bpm->new_page(&tmp_page_id);
+            ASSERT_NE(nullptr, page);
+            strcpy(page->get_data(), std::to_string(tmp_page_id.page_no).c_str());
+            page_ids.push_back(tmp_page_id);
+            EXPECT_EQ(true, bpm->unpin_page(tmp_page_id, true));
+        }
+
+        // 反复访问前几个页面，并穿插访问其余页面
+        for (int round = 0; round < 3; round++) {
+            for (int i = 0; i < num_pages; i++) {
+                for (auto &page_id : {page_ids[i % 4], page_ids[i]}) {
+                    auto *page = bpm->fetch_page(page_id);
+                    ASSERT_NE(nullptr, page);
+                    EXPECT_EQ(0, std::strcmp(std::to_string(page_id.page_no).c_str(), page->get_data()));
+                    EXPECT_EQ(true, bpm->unpin_page(page_id, false));
+                }
+            }
+        }
+
+        disk_manager_->close_file(fd);
+    }
+
+    EXPECT_THROW(BufferPoolManager(buffer_pool_size, BufferPoolManagerTest::disk_manager_.get(), 1, "FIFO"),
+                 InternalError);
+}
+
+/**
+ * @brief 使用BufferAccessStrategy顺序读取大量页面时，只在私有帧环内换页，不淘汰其他页面
+ *
+ * @note lab1 计分：5 points
+ */
+TEST_F(BufferPoolManagerTest, BufferAccessStrategyTest) {
+    const int num_hot_pages = 8;
+    const int num_scan_pages = 200;
+    const size_t ring_size = 4;
+    const size_t buffer_pool_size = 32;
+
+    const std::string filename = "buffer_access_strategy_test";
+    auto disk_manager = BufferPoolManagerTest::disk_manager_.get();
+    disk_manager_->create_file(filename);
+    int fd = disk_manager_->open_file(filename);
+
+    // 先把扫描页写到磁盘上，再读入热点页
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager);
+    std::vector<PageId> page_ids;
+    for (int i = 0; i < num_hot_pages + num_scan_pages; i++) {
+        PageId tmp_page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        auto *page = bpm->new_page(&tmp_page_id);
+        ASSERT_NE(nullptr, page);
+        strcpy(page->get_data(), std::to_string(tmp_page_id.page_no).c_str());
+        page_ids.push_back(tmp_page_id);
+        EXPECT_EQ(true, bpm->unpin_page(tmp_page_id, true));
+    }
+    bpm->flush_all_pages(fd);
+    bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager);
+
+    std::set<Page *> hot_frames;
+    for (int i = 0; i < num_hot_pages; i++) {
+        auto *page = bpm->fetch_page(page_ids[i]);
+        ASSERT_NE(nullptr, page);
+        hot_frames.insert(page);
+        EXPECT_EQ(true, bpm->unpin_page(page_ids[i], false));
+    }
+
+    // 扫描页只使用环中的ring_size个帧
+    BufferAccessStrategy strategy(ring_size);
+    std::set<Page *> scan_frames;
+    for (int i = num_hot_pages; i < num_hot_pages + num_scan_pages; i++) {
+        auto *page = bpm->fetch_page(page_ids[i], &strategy);
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ(0, std::strcmp(std::to_string(page_ids[i].page_no).c_str(), page->get_data()));
+        scan_frames.insert(page);
+        EXPECT_EQ(true, bpm->unpin_page(page_ids[i], false));
+    }
+    EXPECT_EQ(ring_size, scan_frames.size());
+
+    // 热点页仍然在原来的帧中
+    for (int i = 0; i < num_hot_pages; i++) {
+        auto *page = bpm->fetch_page(page_ids[i]);
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ(1, hot_frames.count(page));
+        EXPECT_EQ(0, scan_frames.count(page));
+        EXPECT_EQ(true, bpm->unpin_page(page_ids[i], false));
+    }
+
+    disk_manager_->close_file(fd);
+}
+
+/**
+ * @brief 预读的页面在后台被读入缓冲池，之后的fetch_page直接命中
+ *
+ * @note lab1 计分：5 points
+ */
+TEST_F(BufferPoolManagerTest, PrefetchTest) {
+    const int num_pages = 32;
+    const size_t buffer_pool_size = 64;
+
+    const std::string filename = "prefetch_test";
+    auto disk_manager = BufferPoolManagerTest::disk_manager_.get();
+    disk_manager_->create_file(filename);
+    int fd = disk_manager_->open_file(filename);
+
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager, 4);
+    std::vector<PageId> page_ids;
+    for (int i = 0; i < num_pages; i++) {
+        PageId tmp_page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        auto *page = bpm->new_page(&tmp_page_id);
+        ASSERT_NE(nullptr, page);
+        strcpy(page->get_data(), std::to_string(tmp_page_id.page_no).c_str());
+        page_ids.push_back(tmp_page_id);
+        EXPECT_EQ(true, bpm->unpin_page(tmp_page_id, true));
+    }
+    bpm->flush_all_pages(fd);
+    bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager, 4);
+
+    {
+        // 访问策略析构时等待经由它提交的预读全部完成
+        BufferAccessStrategy strategy(buffer_pool_size);
+        for (auto &page_id : page_ids) {
+            bpm->prefetch_page(page_id, &strategy);
+        }
+    }
+
+    // 直接改写磁盘上的页面，已经预读进缓冲池的页面仍然是旧内容
+    char buf[PAGE_SIZE] = "overwritten";
+    for (auto &page_id : page_ids) {
+        disk_manager_->write_page(fd, page_id.page_no, buf, PAGE_SIZE);
+    }
+    for (auto &page_id : page_ids) {
+        auto *page = bpm->fetch_page(page_id);
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ(0, std::strcmp(std::to_string(page_id.page_no).c_str(), page->get_data()));
+        EXPECT_EQ(true, bpm->unpin_page(page_id, false));
+    }
+
+    disk_manager_->close_file(fd);
+}
+
+/**
+ * @brief 批量读入连续页面时，其他线程同时fetch这些页面，应等待读入完成后得到正确的内容
+ *
+ * @note lab1 计分：5 points
+ */
+TEST_F(BufferPoolManagerTest, LoadPagesTest) {
+    const int num_threads = 4;
+    const int num_pages = 256;
+    const int run_length = 32;
+    const size_t buffer_pool_size = 512;
+
+    const std::string filename = "load_pages_test";
+    auto disk_manager = BufferPoolManagerTest::disk_manager_.get();
+    disk_manager_->create_file(filename);
+    int fd = disk_manager_->open_file(filename);
+
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager, 4);
+    std::vector<PageId> page_ids;
+    for (int i = 0; i < num_pages; i++) {
+        PageId tmp_page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        auto *page = bpm->new_page(&tmp_page_id);
+        ASSERT_NE(nullptr, page);
+        strcpy(page->get_data(), std::to_string(tmp_page_id.page_no).c_str());
+        page_ids.push_back(tmp_page_id);
+        EXPECT_EQ(true, bpm->unpin_page(tmp_page_id, true));
+    }
+    bpm->flush_all_pages(fd);
+    bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager, 4);
+
+    std::vector<std::thread> threads;
+    threads.push_back(std::thread([&]() {
+        for (int start = 0; start < num_pages; start += run_length) {
+            bpm->load_pages(fd, start, run_length);
+        }
+    }));
+    for (int tid = 0; tid < num_threads; tid++) {
+        threads.push_back(std::thread([&, tid]() {
+            for (int i = 0; i < num_pages; i++) {
+                auto &page_id = page_ids[(i + tid * run_length) % num_pages];
+                auto *page = bpm->fetch_page(page_id);
+                ASSERT_NE(nullptr, page);
+                EXPECT_EQ(0, std::strcmp(std::to_string(page_id.page_no).c_str(), page->get_data()));
+                EXPECT_EQ(true, bpm->unpin_page(page_id, false));
+            }
+        }));
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    // 所有页面都已读入且未被固定
+    for (auto &page_id : page_ids) {
+        EXPECT_EQ(false, bpm->unpin_page(page_id, false));
+    }
+
+    disk_manager_->close_file(fd);
+}
+
+/**
+ * @brief 测试后台刷脏线程：只写回page_lsn不超过已持久化lsn的脏页，日志落盘后其余脏页也被写回
+ */
+TEST_F(BufferPoolManagerTest, BackgroundFlusherTest) {
+    const int num_pages = 64;
+    const size_t buffer_pool_size = 128;
+
+    const std::string filename = "background_flusher_test";
+    auto disk_manager = BufferPoolManagerTest::disk_manager_.get();
+    disk_manager_->create_file(filename);
+    int fd = disk_manager_->open_file(filename);
+
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager, 4);
+    bpm->set_lsn_file(fd, true);
+    std::vector<PageId> page_ids;
+    for (int i = 0; i < num_pages; i++) {
+        PageId tmp_page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        auto *page = bpm->new_page(&tmp_page_id);
+        ASSERT_NE(nullptr, page);
+        page->set_page_lsn(i + 1);
+        strcpy(page->get_data() + Page::OFFSET_PAGE_HDR, std::to_string(tmp_page_id.page_no).c_str());
+        page_ids.push_back(tmp_page_id);
+        EXPECT_EQ(true, bpm->unpin_page(tmp_page_id, true));
+    }
+
+    std::atomic<lsn_t> persist_lsn{num_pages / 2};
+    bpm->start_flusher([&persist_lsn] { return persist_lsn.load(); }, std::chrono::milliseconds(1), 8, 0.0, 1.0);
+
+    // 等待后台线程写回，直到脏页比例达到预期或超时
+    auto wait_dirty_ratio = [&](double expected) {
+        for (int i = 0; i < 2000 && bpm->get_dirty_ratio() > expected; i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    };
+    wait_dirty_ratio(static_cast<double>(num_pages / 2) / buffer_pool_size);
+
+    char buf[PAGE_SIZE];
+    for (int i = 0; i < num_pages; i++) {
+        auto *page = bpm->fetch_page(page_ids[i]);
+        ASSERT_NE(nullptr, page);
+        // 日志尚未落盘的页面不能被写回
+        EXPECT_EQ(page->get_page_lsn() > persist_lsn, page->is_dirty());
+        if (page->is_dirty()) {
+            disk_manager->read_page(fd, page_ids[i].page_no, buf, PAGE_SIZE);
+            EXPECT_NE(0, std::memcmp(buf, page->get_data(), PAGE_SIZE));
+        }
+        EXPECT_EQ(true, bpm->unpin_page(page_ids[i], false));
+    }
+
+    // 日志全部落盘后剩余的脏页也被写回。脏位在写回之前清除，需要等后台线程退出后再检查磁盘上的内容
+    persist_lsn = num_pages;
+    wait_dirty_ratio(0.0);
+    EXPECT_EQ(0.0, bpm->get_dirty_ratio());
+    bpm.reset();
+    for (int i = 0; i < num_pages; i++) {
+        disk_manager->read_page(fd, page_ids[i].page_no, buf, PAGE_SIZE);
+        EXPECT_EQ(0, std::strcmp(std::to_string(page_ids[i].page_no).c_str(), buf + Page::OFFSET_PAGE_HDR));
+    }
+
+    disk_manager_->close_file(fd);
+}
+
+/**
+ * @brief 测试后台刷脏线程：没有用set_lsn_file登记的文件页头不是page_lsn，其中的脏页不受persist_lsn的限制
+ */
+TEST_F(BufferPoolManagerTest, BackgroundFlusherNonLsnFileTest) {
+    const int num_pages = 16;
+    const size_t buffer_pool_size = 32;
+
+    const std::string filename = "background_flusher_non_lsn_test";
+    auto disk_manager = BufferPoolManagerTest::disk_manager_.get();
+    disk_manager_->create_file(filename);
+    int fd = disk_manager_->open_file(filename);
+
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager, 4);
+    for (int i = 0; i < num_pages; i++) {
+        PageId tmp_page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        auto *page = bpm->new_page(&tmp_page_id);
+        ASSERT_NE(nullptr, page);
+        // 页头偏移0处是其他字段，读作page_lsn时远大于persist_lsn
+        page->set_page_lsn(1000 + i);
+        EXPECT_EQ(true, bpm->unpin_page(tmp_page_id, true));
+    }
+
+    bpm->start_flusher([] { return lsn_t(0); }, std::chrono::milliseconds(1), 8, 0.0, 1.0);
+    for (int i = 0; i < 2000 && bpm->get_dirty_ratio() > 0.0; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(0.0, bpm->get_dirty_ratio());
+    bpm->stop_flusher();
+
+    bpm.reset();
+    disk_manager_->close_file(fd);
+}
+
+/**
+ * @brief 测试帧内存区：每一帧的页面数据都按PAGE_SIZE对齐，可以直接用于O_DIRECT读写
+ */
+TEST_F(BufferPoolManagerTest, DirectIoTest) {
+    const int num_pages = 256;
+    const size_t buffer_pool_size = 64;
+
+    const std::string filename = "direct_io_test";
+    DiskManager disk_manager(USE_IO_URING, true);
+    disk_manager.create_file(filename);
+    int fd = disk_manager.open_file(filename);
+
+    // 缓冲池小于页面个数，页面在换出时写回
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, &disk_manager, 4);
+    std::vector<PageId> page_ids;
+    for (int i = 0; i < num_pages; i++) {
+        PageId tmp_page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        auto *page = bpm->new_page(&tmp_page_id);
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(page->get_data()) % PAGE_SIZE);
+        strcpy(page->get_data(), std::to_string(tmp_page_id.page_no).c_str());
+        page_ids.push_back(tmp_page_id);
+        EXPECT_EQ(true, bpm->unpin_page(tmp_page_id, true));
+    }
+    bpm->flush_all_pages(fd);
+
+    bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, &disk_manager, 4);
+    for (int start = 0; start < num_pages; start += 32) {
+        bpm->load_pages(fd, start, 32);
+        for (int i = start; i < start + 32; i++) {
+            auto *page = bpm->fetch_page(page_ids[i]);
+            ASSERT_NE(nullptr, page);
+            EXPECT_EQ(0, std::strcmp(std::to_string(i).c_str(), page->get_data()));
+            EXPECT_EQ(true, bpm->unpin_page(page_ids[i], false));
+        }
+    }
+
+    bpm.reset();
+    disk_manager.close_file(fd);
+}
+
+/**
+ * @brief 测试缓冲池按文件统计的命中、换出、写回次数和操作耗时，多个线程的计数应当被汇总到一起
+ */
+TEST_F(BufferPoolManagerTest, StatsTest) {
+    const size_t buffer_pool_size = 10;
+    const int num_threads = 4;
+    const int num_fetches = 100;
+
+    disk_manager_->create_file("stats_test_a");
+    disk_manager_->create_file("stats_test_b");
+    int fd_a = disk_manager_->open_file("stats_test_a");
+    int fd_b = disk_manager_->open_file("stats_test_b");
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager_.get());
+
+    // 新建20个脏页，后10个页面各换出一个脏页
+    for (int i = 0; i < 20; i++) {
+        PageId page_id = {.fd = fd_a, .page_no = INVALID_PAGE_ID};
+        ASSERT_NE(nullptr, bpm->new_page(&page_id));
+        EXPECT_EQ(true, bpm->unpin_page(page_id, true));
+    }
+    // 页面10~19命中，页面0未命中并换出脏页10
+    for (int i = 10; i < 20; i++) {
+        ASSERT_NE(nullptr, bpm->fetch_page(PageId{fd_a, i}));
+        EXPECT_EQ(true, bpm->unpin_page(PageId{fd_a, i}, false));
+    }
+    ASSERT_NE(nullptr, bpm->fetch_page(PageId{fd_a, 0}));
+    EXPECT_EQ(true, bpm->unpin_page(PageId{fd_a, 0}, false));
+    EXPECT_EQ(true, bpm->flush_page(PageId{fd_a, 11}));
+
+    // 文件b的新页面换出已经写回的干净页11，之后由多个线程同时命中
+    PageId page_b = {.fd = fd_b, .page_no = INVALID_PAGE_ID};
+    ASSERT_NE(nullptr, bpm->new_page(&page_b));
+    EXPECT_EQ(true, bpm->unpin_page(page_b, true));
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < num_fetches; i++) {
+                ASSERT_NE(nullptr, bpm->fetch_page(page_b));
+                bpm->unpin_page(page_b, false);
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    auto stats = bpm->get_stats()->snapshot();
+    ASSERT_EQ(2u, stats.size());
+    BufferFileStats &stats_a = stats[fd_a];
+    EXPECT_EQ(10u, stats_a.hits);
+    EXPECT_EQ(1u, stats_a.misses);
+    EXPECT_EQ(12u, stats_a.evictions);
+    EXPECT_EQ(12u, stats_a.writebacks);
+    EXPECT_EQ(11u, stats_a.op_count[BUFFER_OP_FETCH]);
+    EXPECT_EQ(20u, stats_a.op_count[BUFFER_OP_NEW]);
+    EXPECT_EQ(1u, stats_a.op_count[BUFFER_OP_FLUSH]);
+    EXPECT_LE(stats_a.percentile_ns(BUFFER_OP_FETCH, 0.5), stats_a.percentile_ns(BUFFER_OP_FETCH, 1.0));
+    EXPECT_GT(stats_a.percentile_ns(BUFFER_OP_NEW, 1.0), 0u);
+
+    BufferFileStats &stats_b = stats[fd_b];
+    EXPECT_EQ(static_cast<uint64_t>(num_threads * num_fetches), stats_b.hits);
+    EXPECT_EQ(0u, stats_b.misses);
+    EXPECT_EQ(0u, stats_b.evictions);
+    EXPECT_EQ(1.0, stats_b.hit_ratio());
+
+    std::vector<std::string> row = BufferPoolStats::format_row("stats_test_b", stats_b);
+    ASSERT_EQ(BufferPoolStats::get_captions().size(), row.size());
+    EXPECT_EQ(std::to_string(num_threads * num_fetches), row[1]);
+
+    bpm->get_stats()->reset();
+    stats = bpm->get_stats()->snapshot();
+    EXPECT_EQ(0u, stats[fd_a].hits + stats[fd_a].op_count[BUFFER_OP_NEW] + stats[fd_b].hits);
+
+    bpm.reset();
+    disk_manager_->close_file(fd_a);
+    disk_manager_->close_file(fd_b);
+}
+
+/**
+ * @brief 测试缓冲池快照的保存和预热：预热后快照中的页面都应当命中缓冲池
+ */
+TEST_F(BufferPoolManagerTest, WarmUpTest) {
+    const int num_pages = 100;
+    const size_t buffer_pool_size = 64;
+    const std::string snapshot_name = "warm_up_test.snapshot";
+
+    const std::string filename = "warm_up_test";
+    disk_manager_->create_file(filename);
+    int fd = disk_manager_->open_file(filename);
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager_.get(), 4);
+    for (int i = 0; i < num_pages; i++) {
+        PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        auto *page = bpm->new_page(&page_id);
+        ASSERT_NE(nullptr, page);
+        strcpy(page->get_data(), std::to_string(page_id.page_no).c_str());
+        EXPECT_EQ(true, bpm->unpin_page(page_id, true));
+    }
+    bpm->flush_all_pages(fd);
+
+    // 缓冲池中只有被访问过的页面
+    std::vector<page_id_t> hot_pages;
+    for (int i = 5; i < 21; i++) hot_pages.push_back(i);
+    hot_pages.push_back(50);
+    hot_pages.push_back(52);
+    for (int i = 90; i < num_pages; i++) hot_pages.push_back(i);
+    bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager_.get(), 4);
+    for (auto page_no : hot_pages) {
+        ASSERT_NE(nullptr, bpm->fetch_page(PageId{fd, page_no}));
+        EXPECT_EQ(true, bpm->unpin_page(PageId{fd, page_no}, false));
+    }
+    bpm->save_snapshot(snapshot_name);
+
+    // 重启后预热，快照中的页面全部命中
+    bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager_.get(), 4);
+    EXPECT_EQ(0u, bpm->warm_up("no_such.snapshot"));
+    EXPECT_EQ(hot_pages.size(), bpm->warm_up(snapshot_name, 3));
+    for (auto page_no : hot_pages) {
+        auto *page = bpm->fetch_page(PageId{fd, page_no});
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ(0, std::strcmp(std::to_string(page_no).c_str(), page->get_data()));
+        EXPECT_EQ(true, bpm->unpin_page(PageId{fd, page_no}, false));
+    }
+    auto stats = bpm->get_stats()->snapshot();
+    EXPECT_EQ(hot_pages.size(), stats[fd].hits);
+    EXPECT_EQ(0u, stats[fd].misses);
+
+    // 后台预热，文件关闭之前停止
+    bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager_.get(), 4);
+    bpm->start_warm_up(snapshot_name);
+    bpm->stop_warm_up();
+
+    bpm.reset();
+    disk_manager_->close_file(fd);
+}
@@ -0,0 +1,118 @@
+#include "replacer/clock_replacer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+/**
+ * @brief 简单测试ClockReplacer的基本功能
+ */
+TEST(ClockReplacerTest, SimpleTest) {
+    ClockReplacer clock_replacer(7);
+
+    // Scenario: unpin six elements, i.e. add them to the replacer.
+    clock_replacer.unpin(1);
+    clock_replacer.unpin(2);
+    clock_replacer.unpin(3);
+    clock_replacer.unpin(4);
+    clock_replacer.unpin(5);
+    clock_replacer.unpin(6);
+    clock_replacer.unpin(1);
+    EXPECT_EQ(6, clock_replacer.Size());
+
+    // Scenario: get three victims from the clock.
+    // 第一圈清除所有访问位，第二圈从指针位置开始按帧号顺序淘汰
+    int value;
+    clock_replacer.victim(&value);
+    EXPECT_EQ(1, value);
+    clock_replacer.victim(&value);
+    EXPECT_EQ(2, value);
+    clock_replacer.victim(&value);
+    EXPECT_EQ(3, value);
+
+    // Scenario: pin elements in the replacer.
+    // Note that 3 has already been victimized, so pinning 3 should have no effect.
+    clock_replacer.pin(3);
+    clock_replacer.pin(4);
+    EXPECT_EQ(2, clock_replacer.Size());
+
+    // Scenario: unpin 4. It gets a second chance, so 5 and 6 are victimized before it.
+    clock_replacer.unpin(4);
+
+    clock_replacer.victim(&value);
+    EXPECT_EQ(5, value);
+    clock_replacer.victim(&value);
+    EXPECT_EQ(6, value);
+    clock_replacer.victim(&value);
+    EXPECT_EQ(4, value);
+    EXPECT_EQ(0, clock_replacer.Size());
+    EXPECT_EQ(false, clock_replacer.victim(&value));
+}
+
+/**
+ * @brief 被再次访问(unpin)的帧获得二次机会，晚于其余帧被淘汰
+ */
+TEST(ClockReplacerTest, SecondChanceTest) {
+    ClockReplacer clock_replacer(4);
+    int value;
+
+    for (int i = 0; i < 4; i++) clock_replacer.unpin(i);
+    // 淘汰0后，指针停在1，此时1,2,3的访问位都已被清除
+    EXPECT_EQ(true, clock_replacer.victim(&value));
+    EXPECT_EQ(0, value);
+
+    // 再次访问2
+    clock_replacer.pin(2);
+    clock_replacer.unpin(2);
+
+    EXPECT_EQ(true, clock_replacer.victim(&value));
+    EXPECT_EQ(1, value);
+    EXPECT_EQ(true, clock_replacer.victim(&value));
+    EXPECT_EQ(3, value);
+    EXPECT_EQ(true, clock_replacer.victim(&value));
+    EXPECT_EQ(2, value);
+}
+
+/**
+ * @brief 并发测试ClockReplacer
+ */
+TEST(ClockReplacerTest, ConcurrencyTest) {
+    const int num_threads = 5;
+    const int value_size = 1000;
+    std::shared_ptr<ClockReplacer> clock_replacer{new ClockReplacer(value_size)};
+    std::vector<std::thread> threads;
+    std::vector<int> value(value_size);
+    for (int i = 0; i < value_size; i++) {
+        value[i] = i;
+    }
+    auto rng = std::default_random_engine{};
+    std::shuffle(value.begin(), value.end(), rng);
+
+    for (int tid = 0; tid < num_threads; tid++) {
+        threads.push_back(std::thread([tid, &clock_replacer, &value]() {
+            int share = value_size / num_threads;
+            for (int i = 0; i < share; i++) {
+                clock_replacer->unpin(value[tid * share + i]);
+            }
+        }));
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    int result;
+    std::vector<int> out_values;
+    for (int i = 0; i < value_size; i++) {
+        EXPECT_EQ(true, clock_replacer->victim(&result));
+        out_values.push_back(result);
+    }
+    std::sort(value.begin(), value.end());
+    std::sort(out_values.begin(), out_values.end());
+    EXPECT_EQ(value, out_values);
+    EXPECT_EQ(false, clock_replacer->victim(&result));
+}
@@ -147,3 +147,164 @@ TEST_F(DiskManagerTest, PageOperation) {
     disk_manager_->destroy_file(filename);
     EXPECT_EQ(disk_manager_->is_file(filename), false);
 }
+
+/**
+ * @brief 测试批量读写连续页面 read_pages/write_pages
+ * @note lab1 计分：5 points
+ */
+TEST_F(DiskManagerTest, MultiPageOperation) {
+    const std::string filename = "MultiPageOperationTestFile";
+    // 清理残留文件
+    if (disk_manager_->is_file(filename)) {
+        disk_manager_->destroy_file(filename);
+    }
+    disk_manager_->create_file(filename);
+    int fd = disk_manager_->open_file(filename);
+
+    // 每个页面的数据在内存中不连续
+    std::vector<std::vector<char>> data(MAX_PAGES, std::vector<char>(PAGE_SIZE));
+    std::vector<const char *> write_bufs;
+    for (auto &page : data) {
+        rand_buf(page.data(), PAGE_SIZE);
+        write_bufs.push_back(page.data());
+    }
+    disk_manager_->write_pages(fd, 0, write_bufs.data(), MAX_PAGES);
+
+    // 单页读取与批量写入的结果一致
+    char buf[PAGE_SIZE];
+    for (int page_no = 0; page_no < MAX_PAGES; page_no++) {
+        disk_manager_->read_page(fd, page_no, buf, PAGE_SIZE);
+        EXPECT_EQ(std::memcmp(buf, data[page_no].data(), PAGE_SIZE), 0);
+    }
+
+    // 从中间开始批量读取，超出文件末尾的部分保持不变
+    const int start_page_no = MAX_PAGES / 2;
+    const int num_pages = MAX_PAGES - start_page_no + 4;
+    std::vector<std::vector<char>> read_data(num_pages, std::vector<char>(PAGE_SIZE, 0));
+    std::vector<char *> read_bufs;
+    for (auto &page : read_data) {
+        read_bufs.push_back(page.data());
+    }
+    disk_manager_->read_pages(fd, start_page_no, read_bufs.data(), num_pages);
+    for (int i = 0; i < num_pages; i++) {
+        if (start_page_no + i < MAX_PAGES) {
+            EXPECT_EQ(std::memcmp(read_data[i].data(), data[start_page_no + i].data(), PAGE_SIZE), 0);
+        } else {
+            EXPECT_EQ(std::vector<char>(PAGE_SIZE, 0), read_data[i]);
+        }
+    }
+
+    disk_manager_->close_file(fd);
+    disk_manager_->destroy_file(filename);
+}
+
+/**
+ * @brief 测试IoBatch批量提交读写请求，分别使用io_uring和同步读写两种方式
+ */
+TEST_F(DiskManagerTest, BatchedOperation) {
+    const std::string filename = "BatchedOperationTestFile";
+    for (bool use_io_uring : {true, false}) {
+        DiskManager disk_manager(use_io_uring);
+        if (disk_manager.is_file(filename)) {
+            disk_manager.destroy_file(filename);
+        }
+        disk_manager.create_file(filename);
+        int fd = disk_manager.open_file(filename);
+
+        // 每个页面一个写请求，请求个数超过io_uring的队列深度
+        std::vector<std::vector<char>> data(MAX_PAGES, std::vector<char>(PAGE_SIZE));
+        std::vector<const char *> write_bufs;
+        for (auto &page : data) {
+            rand_buf(page.data(), PAGE_SIZE);
+            write_bufs.push_back(page.data());
+        }
+        IoBatch write_batch;
+        for (int page_no = MAX_PAGES - 1; page_no >= 0; page_no--) {
+            write_batch.add_write(fd, page_no, &write_bufs[page_no], 1);
+        }
+        disk_manager.submit_io(&write_batch);
+        disk_manager.wait_io(&write_batch);
+        EXPECT_TRUE(write_batch.all_succeeded());
+
+        // 每4个连续页面一个读请求，最后一个请求超出文件末尾
+        const int run_length = 4;
+        const int num_pages = MAX_PAGES + run_length;
+        std::vector<std::vector<char>> read_data(num_pages, std::vector<char>(PAGE_SIZE, 0));
+        std::vector<char *> read_bufs;
+        for (auto &page : read_data) {
+            read_bufs.push_back(page.data());
+        }
+        IoBatch read_batch;
+        for (int page_no = 0; page_no < num_pages; page_no += run_length) {
+            read_batch.add_read(fd, page_no, &read_bufs[page_no], run_length);
+        }
+        disk_manager.submit_io(&read_batch);
+        disk_manager.wait_io(&read_batch);
+        EXPECT_TRUE(read_batch.all_succeeded());
+        for (int i = 0; i < num_pages; i++) {
+            if (i < MAX_PAGES) {
+                EXPECT_EQ(std::memcmp(read_data[i].data(), data[i].data(), PAGE_SIZE), 0);
+            } else {
+                EXPECT_EQ(std::vector<char>(PAGE_SIZE, 0), read_data[i]);
+            }
+        }
+
+        disk_manager.close_file(fd);
+        disk_manager.destroy_file(filename);
+    }
+}
+
+/**
+ * @brief 测试以O_DIRECT打开文件时的读写，包括没有按块对齐的文件头和普通内存中的页面
+ */
+TEST_F(DiskManagerTest, DirectIoOperation) {
+    const std::string filename = "DirectIoOperationTestFile";
+    DiskManager disk_manager(USE_IO_URING, true);
+    if (disk_manager.is_file(filename)) {
+        disk_manager.destroy_file(filename);
+    }
+    disk_manager.create_file(filename);
+    int fd = disk_manager.open_file(filename);
+
+    // 不足一页的文件头写入第0页，写入第1页之后再读出，文件头不能被覆盖
+    char header[100];
+    rand_buf(header, sizeof(header));
+    disk_manager.write_page(fd, 0, header, sizeof(header));
+
+    // 按PAGE_SIZE对齐的内存和普通内存中的页面
+    const int num_pages = 16;
+    char *aligned = static_cast<char *>(aligned_alloc(PAGE_SIZE, num_pages * PAGE_SIZE));
+    std::vector<std::vector<char>> data(num_pages, std::vector<char>(PAGE_SIZE));
+    std::vector<const char *> write_bufs;
+    for (int i = 0; i < num_pages; i++) {
+        rand_buf(data[i].data(), PAGE_SIZE);
+        char *buf = i % 2 == 0 ? aligned + i * PAGE_SIZE : data[i].data();
+        memcpy(buf, data[i].data(), PAGE_SIZE);
+        write_bufs.push_back(buf);
+    }
+    IoBatch write_batch;
+    write_batch.add_write(fd, 1, write_bufs.data(), num_pages / 2);
+    write_batch.add_write(fd, 1 + num_pages / 2, write_bufs.data() + num_pages / 2, num_pages / 2);
+    disk_manager.submit_io(&write_batch);
+    disk_manager.wait_io(&write_batch);
+    EXPECT_TRUE(write_batch.all_succeeded());
+
+    char read_header[sizeof(header)];
+    disk_manager.read_page(fd, 0, read_header, sizeof(read_header));
+    EXPECT_EQ(std::memcmp(header, read_header, sizeof(header)), 0);
+
+    std::vector<std::vector<char>> read_data(num_pages, std::vector<char>(PAGE_SIZE, 0));
+    std::vector<char *> read_bufs;
+    for (int i = 0; i < num_pages; i++) {
+        read_bufs.push_back(i % 2 == 0 ? aligned + i * PAGE_SIZE : read_data[i].data());
+    }
+    memset(aligned, 0, num_pages * PAGE_SIZE);
+    disk_manager.read_pages(fd, 1, read_bufs.data(), num_pages);
+    for (int i = 0; i < num_pages; i++) {
+        EXPECT_EQ(std::memcmp(read_bufs[i], data[i].data(), PAGE_SIZE), 0);
+    }
+
+    free(aligned);
+    disk_manager.close_file(fd);
+    disk_manager.destroy_file(filename);
+}
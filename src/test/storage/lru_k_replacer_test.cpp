@@ -0,0 +1,283 @@
+#include "replacer/lru_k_replacer.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+// 统计全局operator new的调用次数，用来检查replacer构造之后不再分配内存
+static std::atomic<size_t> allocation_count{0};
+
+void *operator new(size_t size) {
+    allocation_count++;
+    void *p = std::malloc(size == 0 ? 1 : size);
+    if (p == nullptr) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+
+/**
+ * @brief 简单测试LRUKReplacer的基本功能
+ */
+TEST(LRUKReplacerTest, SimpleTest) {
+    LRUKReplacer lru_k_replacer(7, 2);
+    int value;
+
+    // 帧1..6各访问一次，帧1,2再访问一次(中间夹着其他帧的访问，不算相关访问)
+    for (int i = 1; i <= 6; i++) lru_k_replacer.pin(i);
+    lru_k_replacer.pin(1);
+    lru_k_replacer.pin(2);
+    for (int i = 1; i <= 6; i++) lru_k_replacer.unpin(i);
+    EXPECT_EQ(6, lru_k_replacer.Size());
+
+    // 只访问过一次的帧按最早访问时间先被淘汰
+    lru_k_replacer.victim(&value);
+    EXPECT_EQ(3, value);
+    lru_k_replacer.victim(&value);
+    EXPECT_EQ(4, value);
+
+    // 帧3被淘汰后历史清空，重新访问一次仍然先于访问过两次的帧被淘汰
+    lru_k_replacer.pin(3);
+    lru_k_replacer.unpin(3);
+    lru_k_replacer.victim(&value);
+    EXPECT_EQ(5, value);
+    lru_k_replacer.victim(&value);
+    EXPECT_EQ(6, value);
+    lru_k_replacer.victim(&value);
+    EXPECT_EQ(3, value);
+
+    // 访问过两次的帧按倒数第二次访问时间淘汰
+    lru_k_replacer.victim(&value);
+    EXPECT_EQ(1, value);
+    lru_k_replacer.victim(&value);
+    EXPECT_EQ(2, value);
+    EXPECT_EQ(0, lru_k_replacer.Size());
+    EXPECT_EQ(false, lru_k_replacer.victim(&value));
+}
+
+/**
+ * @brief 模拟顺序扫描：大量只访问一次的页面不应把反复访问的热点页挤出
+ */
+TEST(LRUKReplacerTest, ScanResistanceTest) {
+    const int num_frames = 16;
+    const int num_hot = 4;
+    LRUKReplacer lru_k_replacer(num_frames, 2);
+    int value;
+
+    // 热点页被访问多次
+    for (int round = 0; round < 3; round++) {
+        for (int i = 0; i < num_hot; i++) {
+            lru_k_replacer.pin(i);
+            lru_k_replacer.unpin(i);
+        }
+    }
+    // 扫描页每个只访问一次，同一页上的连续访问是相关访问，只算一次
+    for (int i = num_hot; i < num_frames; i++) {
+        for (int j = 0; j < 8; j++) {
+            lru_k_replacer.pin(i);
+            lru_k_replacer.unpin(i);
+        }
+    }
+
+    for (int i = num_hot; i < num_frames; i++) {
+        EXPECT_EQ(true, lru_k_replacer.victim(&value));
+        EXPECT_LE(num_hot, value);
+    }
+    EXPECT_EQ(num_hot, lru_k_replacer.Size());
+}
+
+/**
+ * @brief pin后的帧不能被淘汰
+ */
+TEST(LRUKReplacerTest, PinTest) {
+    LRUKReplacer lru_k_replacer(4, 2);
+    int value;
+
+    for (int i = 0; i < 4; i++) lru_k_replacer.unpin(i);
+    lru_k_replacer.pin(0);
+    lru_k_replacer.pin(2);
+    EXPECT_EQ(2, lru_k_replacer.Size());
+
+    EXPECT_EQ(true, lru_k_replacer.victim(&value));
+    EXPECT_EQ(1, value);
+    EXPECT_EQ(true, lru_k_replacer.victim(&value));
+    EXPECT_EQ(3, value);
+    EXPECT_EQ(false, lru_k_replacer.victim(&value));
+}
+
+/**
+ * @brief 缓冲池内部的固定(刷脏、预读)不算作访问，不改变淘汰顺序
+ */
+TEST(LRUKReplacerTest, InternalPinTest) {
+    LRUKReplacer lru_k_replacer(8, 2);
+    int value;
+
+    // 帧0..3各访问两次，帧4,5各访问一次，帧6只是预读进来，没有访问
+    for (int round = 0; round < 2; round++) {
+        for (int i = 0; i < 4; i++) {
+            lru_k_replacer.pin(i);
+            lru_k_replacer.unpin(i);
+        }
+    }
+    lru_k_replacer.pin(4);
+    lru_k_replacer.unpin(4);
+    lru_k_replacer.pin(5);
+    lru_k_replacer.unpin(5);
+    lru_k_replacer.unpin(6);
+
+    // 后台刷脏按相反的顺序固定并取消固定所有帧
+    for (int i = 6; i >= 0; i--) {
+        lru_k_replacer.pin_internal(i);
+        EXPECT_EQ(6, lru_k_replacer.Size());
+        lru_k_replacer.unpin(i);
+    }
+    EXPECT_EQ(7, lru_k_replacer.Size());
+
+    std::vector<int> expected = {4, 5, 6, 0, 1, 2, 3};
+    for (int frame : expected) {
+        ASSERT_EQ(true, lru_k_replacer.victim(&value));
+        EXPECT_EQ(frame, value);
+    }
+    EXPECT_EQ(false, lru_k_replacer.victim(&value));
+}
+
+/**
+ * @brief 随机的pin/unpin/victim序列下，Size和淘汰顺序与逐帧比较K距离的朴素实现一致
+ */
+TEST(LRUKReplacerTest, ChurnTest) {
+    const int num_frames = 64;
+    const size_t k = 3;
+    LRUKReplacer lru_k_replacer(num_frames, k);
+
+    // 朴素实现：保存每个帧的全部访问时间，victim时扫描所有可淘汰的帧
+    std::vector<std::vector<uint64_t>> accesses(num_frames);
+    std::vector<uint64_t> arrival(num_frames, 0);
+    std::vector<bool> evictable(num_frames, false);
+    uint64_t clock = 0;
+    size_t size = 0;
+    auto record = [&](int frame) {
+        // 与replacer相同：中间没有访问其他帧的连续访问只更新最近一次的时间戳
+        if (!accesses[frame].empty() && accesses[frame].back() + 1 == clock) {
+            accesses[frame].back() = clock++;
+        } else {
+            accesses[frame].push_back(clock++);
+        }
+    };
+    auto sort_key = [&](int frame) {
+        auto &a = accesses[frame];
+        if (a.empty()) return arrival[frame];
+        return a.size() < k ? a.front() : a[a.size() - k];
+    };
+
+    std::mt19937 rng(20231016);
+    for (int step = 0; step < 20000; step++) {
+        int frame = static_cast<int>(rng() % num_frames);
+        switch (rng() % 3) {
+            case 0:
+                lru_k_replacer.pin(frame);
+                if (evictable[frame]) {
+                    evictable[frame] = false;
+                    size--;
+                }
+                record(frame);
+                break;
+            case 1:
+                lru_k_replacer.unpin(frame);
+                if (!evictable[frame]) {
+                    if (accesses[frame].empty()) arrival[frame] = clock++;
+                    evictable[frame] = true;
+                    size++;
+                }
+                break;
+            default: {
+                int expected = -1;
+                for (int i = 0; i < num_frames; i++) {
+                    if (!evictable[i]) continue;
+                    bool infinite = accesses[i].size() < k;
+                    if (expected == -1) {
+                        expected = i;
+                        continue;
+                    }
+                    bool best_infinite = accesses[expected].size() < k;
+                    if (infinite != best_infinite ? infinite : sort_key(i) < sort_key(expected)) expected = i;
+                }
+                int value;
+                ASSERT_EQ(expected != -1, lru_k_replacer.victim(&value));
+                if (expected != -1) {
+                    ASSERT_EQ(expected, value);
+                    evictable[expected] = false;
+                    accesses[expected].clear();
+                    size--;
+                }
+                break;
+            }
+        }
+        ASSERT_EQ(size, lru_k_replacer.Size());
+    }
+}
+
+/**
+ * @brief 构造之后pin/unpin/victim都不分配内存
+ */
+TEST(LRUKReplacerTest, NoAllocationTest) {
+    const int num_frames = 128;
+    LRUKReplacer lru_k_replacer(num_frames, 2);
+    int value;
+
+    size_t before = allocation_count.load();
+    for (int round = 0; round < 10; round++) {
+        for (int i = 0; i < num_frames; i++) {
+            lru_k_replacer.pin(i);
+            lru_k_replacer.unpin(i);
+        }
+        for (int i = 0; i < num_frames; i += 3) lru_k_replacer.pin(i);
+        for (int i = 0; i < num_frames / 2; i++) lru_k_replacer.victim(&value);
+        for (int i = 0; i < num_frames; i++) lru_k_replacer.unpin(i);
+    }
+    while (lru_k_replacer.victim(&value)) {
+    }
+    EXPECT_EQ(before, allocation_count.load());
+}
+
+/**
+ * @brief 帧改为存放其他页面时remove清空访问历史：在扫描的环中反复复用的帧不会被当作热点页
+ */
+TEST(LRUKReplacerTest, RemoveTest) {
+    LRUKReplacer lru_k_replacer(4, 2);
+    int value;
+
+    // 帧0,1是被访问过两次的热点页
+    for (int round = 0; round < 2; round++) {
+        for (int i = 0; i < 2; i++) {
+            lru_k_replacer.pin(i);
+            lru_k_replacer.unpin(i);
+        }
+    }
+    // 帧2是扫描环中的帧，每次读入新页面前被remove，新页面只访问一次
+    for (int page = 0; page < 4; page++) {
+        lru_k_replacer.remove(2);
+        lru_k_replacer.pin(2);
+        lru_k_replacer.unpin(2);
+    }
+    EXPECT_EQ(3, lru_k_replacer.Size());
+
+    // remove会把可以被淘汰的帧移出replacer
+    lru_k_replacer.unpin(3);
+    lru_k_replacer.remove(3);
+    EXPECT_EQ(3, lru_k_replacer.Size());
+
+    std::vector<int> expected = {2, 0, 1};
+    for (int frame : expected) {
+        ASSERT_EQ(true, lru_k_replacer.victim(&value));
+        EXPECT_EQ(frame, value);
+    }
+    EXPECT_EQ(false, lru_k_replacer.victim(&value));
+}
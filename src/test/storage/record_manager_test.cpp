@@ -8,6 +8,7 @@
 #include <cstring>
 #include <ctime>
 #include <iostream>
+#include <thread>
 #include <unordered_map>
 
 #include "gtest/gtest.h"
@@ -223,4 +224,109 @@ TEST(RecordManagerTest, MultipleFilesTest) {
         std::string filename = filenames[i];
         rm_manager->destroy_file(filename);
     }
-}
\ No newline at end of file
+}
+/**
+ * @brief 测试页面大小大于默认PAGE_SIZE的数据库中的记录文件
+ */
+TEST(RecordManagerTest, LargePageTest) {
+    srand((unsigned)time(nullptr));
+
+    char *result = new char[BUFFER_LENGTH];
+    int offset = 0;
+    Context *context = new Context(nullptr, nullptr, nullptr, result, &offset);
+
+    const int page_size = 4 * PAGE_SIZE;
+    auto disk_manager = std::make_unique<DiskManager>(USE_IO_URING, USE_DIRECT_IO, page_size);
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(1024, disk_manager.get());
+    auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+
+    std::unordered_map<Rid, std::string, rid_hash_t, rid_equal_t> mock;
+    std::string filename = "large_page.txt";
+    if (disk_manager->is_file(filename)) {
+        disk_manager->destroy_file(filename);
+    }
+
+    int record_size = 200;
+    rm_manager->create_file(filename, record_size);
+    auto file_handle = rm_manager->open_file(filename);
+    // 每页可以容纳的记录数随页面大小增长
+    int max_bytes = file_handle->file_hdr_.record_size * file_handle->file_hdr_.num_records_per_page +
+                    file_handle->file_hdr_.bitmap_size + (int)sizeof(RmPageHdr);
+    EXPECT_LE(max_bytes, page_size);
+    EXPECT_GT(max_bytes, page_size - record_size - (int)sizeof(RmFileHdr));
+
+    char write_buf[RM_MAX_RECORD_SIZE];
+    for (int i = 0; i < 1000; i++) {
+        rand_buf(record_size, write_buf);
+        Rid rid = file_handle->insert_record(write_buf, context);
+        mock[rid] = std::string(write_buf, record_size);
+    }
+    rm_manager->close_file(file_handle.get());
+
+    // 重新打开文件并从磁盘读出所有页面
+    buffer_pool_manager = std::make_unique<BufferPoolManager>(1024, disk_manager.get());
+    rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+    file_handle = rm_manager->open_file(filename);
+    EXPECT_EQ(1 + (1000 + file_handle->file_hdr_.num_records_per_page - 1) / file_handle->file_hdr_.num_records_per_page,
+              file_handle->file_hdr_.num_pages);
+    check_equal(file_handle.get(), mock);
+
+    rm_manager->close_file(file_handle.get());
+    rm_manager->destroy_file(filename);
+}
+
+/**
+ * @brief 测试事务中插入记录时数据页的page_lsn：日志落盘之前后台刷脏线程不写回这些数据页，落盘之后全部写回
+ */
+TEST(RecordManagerTest, WalFlusherTest) {
+    const size_t buffer_pool_size = 64;
+    const int num_data_pages = 3;
+
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get());
+    auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+    LogManager log_manager(disk_manager.get());
+    Transaction txn(1);
+    Context context(nullptr, &log_manager, &txn);
+
+    std::string filename = "wal_flusher.txt";
+    for (auto &name : {filename, LOG_FILE_NAME}) {
+        if (disk_manager->is_file(name)) {
+            disk_manager->destroy_file(name);
+        }
+    }
+    disk_manager->create_file(LOG_FILE_NAME);
+    rm_manager->create_file(filename, 64);
+    auto file_handle = rm_manager->open_file(filename);
+
+    char write_buf[64];
+    for (int i = 0; i < num_data_pages * file_handle->file_hdr_.num_records_per_page; i++) {
+        rand_buf(64, write_buf);
+        file_handle->insert_record(write_buf, &context);
+    }
+    ASSERT_EQ(1 + num_data_pages, file_handle->file_hdr_.num_pages);
+    for (int page_no = 1; page_no <= num_data_pages; page_no++) {
+        RmPageHandle page_handle = file_handle->fetch_page_handle(page_no);
+        EXPECT_GT(page_handle.page->get_page_lsn(), log_manager.get_persist_lsn());
+        buffer_pool_manager->unpin_page(page_handle.page->get_page_id(), false);
+    }
+
+    double dirty_ratio = static_cast<double>(num_data_pages) / buffer_pool_size;
+    buffer_pool_manager->start_flusher([&log_manager] { return log_manager.get_persist_lsn(); },
+                                       std::chrono::milliseconds(1), 8, 0.0, 1.0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(dirty_ratio, buffer_pool_manager->get_dirty_ratio());
+
+    log_manager.flush_log_to_disk();
+    for (int i = 0; i < 2000 && buffer_pool_manager->get_dirty_ratio() > 0.0; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(0.0, buffer_pool_manager->get_dirty_ratio());
+    buffer_pool_manager->stop_flusher();
+
+    rm_manager->close_file(file_handle.get());
+    rm_manager->destroy_file(filename);
+    disk_manager->close_file(disk_manager->GetLogFd());
+    disk_manager->SetLogFd(-1);
+    disk_manager->destroy_file(LOG_FILE_NAME);
+}